@@ -0,0 +1,87 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "Interner.h"
+#ifdef SMALLRDF_THREADS
+#include <mutex>
+#include <thread>
+#endif  // SMALLRDF_THREADS
+
+using namespace smallrdf;
+using std::chrono::steady_clock;
+
+
+#ifdef SMALLRDF_THREADS
+namespace {
+
+double elapsed(steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(steady_clock::now() - start).count();
+}
+
+//! \brief Intern the node IRIs by the threads, each one interning its share of them
+//!
+//! \param num unsigned  - number of the nodes
+//! \param threads unsigned  - number of the threads
+//! \param intern Intern  - interning of the IRI
+//! \return double  - elapsed time, ms
+template<typename Intern>
+double internAll(unsigned num, unsigned threads, Intern intern)
+{
+	const steady_clock::time_point  start = steady_clock::now();
+	std::thread* workers = new std::thread[threads];
+	for(unsigned t = 0; t < threads; ++t)
+		workers[t] = std::thread([=]() {
+			char  buf[64];
+			for(unsigned i = t; i < num; i += threads) {
+				snprintf(buf, sizeof buf, "http://example.org/node/%u", i);
+				intern(buf);
+			}
+		});
+	for(unsigned t = 0; t < threads; ++t)
+		workers[t].join();
+	delete[] workers;
+	return elapsed(start);
+}
+
+}  // namespace
+#endif  // SMALLRDF_THREADS
+
+int main(int argc, char* argv[])
+{
+#ifdef SMALLRDF_THREADS
+	const unsigned  num = argc >= 2 ? strtoul(argv[1], nullptr, 10) : 100000;
+	// Interning by the threads: the document guarded by a global lock vs the striped interner
+	unsigned  cores = std::thread::hardware_concurrency();
+	if(!cores)
+		cores = 1;
+	// The number of the threads is doubled up to the number of the cores, which is measured last
+	for(unsigned threads = 1; ; threads *= 2) {
+		if(threads > cores)
+			threads = cores;
+		Document  locked;
+		std::mutex  mutex;
+		const double  global = internAll(num, threads, [&locked, &mutex](const char* iri) {
+			std::lock_guard<std::mutex>  lock(mutex);
+			locked.namedNode(*locked.string(String(iri, true)));
+		});
+		Interner  terms;
+		const double  striped = internAll(num, threads, [&terms](const char* iri) {
+			terms.namedNode(*terms.string(String(iri, true)));
+		});
+		printf("Interning, %u threads: global lock %.3f ms, interner %.3f ms\n", threads, global, striped);
+		if(threads == cores)
+			break;
+	}
+	return EXIT_SUCCESS;
+#else
+	(void)argc;
+	(void)argv;
+	puts("Interning is benchmarked with the threads support only");
+	return EXIT_FAILURE;
+#endif  // SMALLRDF_THREADS
+}
@@ -0,0 +1,151 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "Join.h"
+#include "Query.h"
+
+using namespace smallrdf;
+using std::chrono::steady_clock;
+
+
+namespace {
+
+//! \brief Counter of the joined solutions
+struct Counter: JoinVisitor {
+	unsigned long solutions;
+
+	Counter()
+		: solutions(0)  {}
+
+	bool operator()(const Term* key, const QuadIndex::Range* groups, unsigned num) override
+	{
+		unsigned long  prod = 1;
+		for(unsigned i = 0; i < num; ++i)
+			prod *= groups[i].length();
+		solutions += prod;
+		return true;
+	}
+};
+
+const NamedNode* iri(Document& doc, const char* prefix, unsigned id)
+{
+	char  buf[64];
+	snprintf(buf, sizeof buf, "http://example.org/%s/%u", prefix, id);
+	return doc.namedNode(*doc.string(String(buf, true)));
+}
+
+double elapsed(steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+	const unsigned  num = argc >= 2 ? strtoul(argv[1], nullptr, 10) : 100000;
+	const unsigned  rounds = argc >= 3 ? strtoul(argv[2], nullptr, 10) : 5;
+	Document  doc;
+	const NamedNode* type = doc.namedNode(*doc.string(String("http://example.org/type")));
+	const NamedNode* device = doc.namedNode(*doc.string(String("http://example.org/Device")));
+	const NamedNode* location = doc.namedNode(*doc.string(String("http://example.org/location")));
+	const NamedNode* status = doc.namedNode(*doc.string(String("http://example.org/status")));
+	const NamedNode* knows = doc.namedNode(*doc.string(String("http://example.org/knows")));
+	const NamedNode* worksAt = doc.namedNode(*doc.string(String("http://example.org/worksAt")));
+	for(unsigned i = 0; i < num; ++i) {
+		const NamedNode* node = iri(doc, "node", i);
+		// Star: the inputs of distinct selectivity, chain: sparse links to the sparse employees
+		if(i % 2 == 0)
+			doc.quad(*node, *type, *device);
+		if(i % 3 == 0)
+			doc.quad(*node, *location, *iri(doc, "room", i % 97));
+		if(i % 7 == 0)
+			doc.quad(*node, *status, *iri(doc, "status", i % 5));
+		doc.quad(*node, *knows, *iri(doc, "node", (i * 31 + 7) % num));
+		if(i % 11 == 0)
+			doc.quad(*node, *worksAt, *iri(doc, "org", i % 13));
+	}
+	printf("Quads: %u\n", doc.quads.length());
+
+	const Variable* d = doc.variable(*doc.string(String("d")));
+	const Variable* l = doc.variable(*doc.string(String("l")));
+	const Variable* s = doc.variable(*doc.string(String("s")));
+	const Variable* a = doc.variable(*doc.string(String("a")));
+	const Variable* b = doc.variable(*doc.string(String("b")));
+	const Variable* o = doc.variable(*doc.string(String("o")));
+
+	// Star: ?d type Device . ?d location ?l . ?d status ?s
+	BasicGraphPattern  star;
+	star.add(*d, *type, *device);
+	star.add(*d, *location, *l);
+	star.add(*d, *status, *s);
+	Solutions  solutions;
+	star.evaluate(doc, solutions);  // Builds the index
+	steady_clock::time_point  start = steady_clock::now();
+	for(unsigned r = 0; r < rounds; ++r)
+		star.evaluate(doc, solutions);
+	printf("Star, nested loops: %u solutions, %.3f ms\n", solutions.length(), elapsed(start) / rounds);
+
+	Counter  counter;
+	start = steady_clock::now();
+	for(unsigned r = 0; r < rounds; ++r) {
+		JoinCursor  cursors[3];
+		if(!doc.sorted(Quad(nullptr, type, device), 0, cursors[0])
+		|| !doc.sorted(Quad(nullptr, location, nullptr), 0, cursors[1])
+		|| !doc.sorted(Quad(nullptr, status, nullptr), 0, cursors[2]))
+			return EXIT_FAILURE;
+		counter.solutions = 0;
+		leapfrogJoin(cursors, 3, counter);
+	}
+	printf("Star, leapfrog join: %lu solutions, %.3f ms\n", counter.solutions, elapsed(start) / rounds);
+
+	// Chain: ?a knows ?b . ?b worksAt ?o
+	BasicGraphPattern  chain;
+	chain.add(*a, *knows, *b);
+	chain.add(*b, *worksAt, *o);
+	start = steady_clock::now();
+	for(unsigned r = 0; r < rounds; ++r)
+		chain.evaluate(doc, solutions);
+	printf("Chain, nested loops: %u solutions, %.3f ms\n", solutions.length(), elapsed(start) / rounds);
+
+	start = steady_clock::now();
+	for(unsigned r = 0; r < rounds; ++r) {
+		JoinCursor  left;
+		JoinCursor  right;
+		if(!doc.sorted(Quad(nullptr, knows, nullptr), 2, left)
+		|| !doc.sorted(Quad(nullptr, worksAt, nullptr), 0, right))
+			return EXIT_FAILURE;
+		counter.solutions = 0;
+		mergeJoin(left, right, counter);
+	}
+	printf("Chain, merge join: %lu solutions, %.3f ms\n", counter.solutions, elapsed(start) / rounds);
+
+	// Ingestion of the quads of another document: per quad vs in a batch dropping the duplicates
+	Array<Quad>  batch;
+	if(!batch.reserve(doc.quads.length()))
+		return EXIT_FAILURE;
+	for(Dataset::Quads::Iter* pit = doc.quads.begin(); pit != doc.quads.end(); pit = pit->next())
+		batch.add(**pit);
+	start = steady_clock::now();
+	{
+		Document  copy;
+		for(const Quad& quad: batch)
+			copy.quad(*copy.intern(*quad.subject), *copy.intern(*quad.predicate),
+				*copy.intern(*quad.object), quad.graph ? copy.intern(*quad.graph) : nullptr);
+		copy.quadIndex();
+	}
+	const double  single = elapsed(start);
+	start = steady_clock::now();
+	{
+		Document  copy;
+		copy.insert(batch.begin(), batch.length());
+		copy.quadIndex();
+	}
+	printf("Ingestion: per quad %.3f ms, batch %.3f ms\n", single, elapsed(start));
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef BINARYFORMAT_H_
+#define BINARYFORMAT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+namespace smallrdf {
+
+//! \brief Compact binary RDF format
+//!
+//! The serialized data consist of the chunks, each representing a dataset:
+//! - header: magic "SRDF" and the format version byte;
+//! - dictionary of the strings (see FrontCodedDictionary): varint count, varint block size,
+//! 	then the strings sorted by their bytes, where the head of each block is stored as
+//! 	varint length and the bytes, each following string as varint length of the prefix
+//! 	shared with the preceding one, varint length of the suffix and the suffix bytes;
+//! - terms: varint count, then each term as the kind byte, varint string id of the value,
+//! 	and for literals varint (string id + 1) of the language and the datatype (0 if absent);
+//! - quads: varint count, then each quad as varint term ids of the subject,
+//! 	predicate and object, and varint (term id + 1) of the graph (0 if absent).
+//! Ids are indices in the respective sections of the chunk, varints are unsigned LEB128.
+//! Quads are stored in the insertion order, so the parsed document retains the original order.
+namespace binfmt {
+
+static const uint8_t  MAGIC[4] = {'S', 'R', 'D', 'F'};
+static const uint8_t  VERSION = 2;
+static const size_t  HEADER_SIZE = sizeof MAGIC + sizeof VERSION;
+
+//! \brief Size of the varint-encoded value
+inline size_t varintSize(uint32_t val)
+{
+	size_t size = 1;
+	while(val >= 0x80) {
+		val >>= 7;
+		++size;
+	}
+	return size;
+}
+
+//! \brief Write the varint-encoded value
+//!
+//! \param cur uint8_t*  - writing position
+//! \param val uint32_t  - value to be encoded
+//! \return uint8_t*  - position after the written value
+inline uint8_t* writeVarint(uint8_t* cur, uint32_t val)
+{
+	while(val >= 0x80) {
+		*cur++ = static_cast<uint8_t>(val) | 0x80;
+		val >>= 7;
+	}
+	*cur++ = static_cast<uint8_t>(val);
+	return cur;
+}
+
+//! \brief Length of the common prefix of the strings
+inline size_t commonPrefix(const uint8_t* a, size_t alen, const uint8_t* b, size_t blen)
+{
+	const size_t  len = alen < blen ? alen : blen;
+	size_t i = 0;
+	while(i < len && a[i] == b[i])
+		++i;
+	return i;
+}
+
+//! \brief Read the varint-encoded value
+//!
+//! \param cur const uint8_t*  - reading position
+//! \param end const uint8_t*  - end of the data
+//! \param val uint32_t&  - decoded value
+//! \return const uint8_t*  - position after the read value; nullptr if the data are malformed
+const uint8_t* readVarint(const uint8_t* cur, const uint8_t* end, uint32_t& val);
+
+}  // binfmt
+
+}  // smallrdf
+
+#endif  // BINARYFORMAT_H_
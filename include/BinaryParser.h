@@ -0,0 +1,76 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef BINARYPARSER_H_
+#define BINARYPARSER_H_
+
+#include "RDF.hpp"
+#include "BinaryFormat.h"
+
+
+namespace smallrdf {
+
+//! \brief Parser of the compact binary RDF format
+//! \see binfmt
+class BinaryParser {
+public:
+	//! \brief Parse input, extending provided RDF document
+	//!
+	//! \param input const String&  - input to be parsed
+    //! \param doc Document*&  - original RDF document to be extended.
+	//! 	Receives the ownership of the internal storage
+	//! \return Document&  - extended RDF document
+	static Document& parse(const String& input, Document*& doc);
+
+	BinaryParser();
+#if __cplusplus >= 201103L
+	BinaryParser(BinaryParser&& other);
+	BinaryParser(const BinaryParser&)=delete;
+	BinaryParser& operator=(const BinaryParser&)=delete;
+#endif // __cplusplus 11+
+    //! \brief Construct, initializing the internal RDF document
+    //!
+    //! \param doc Document*&  - original RDF document to be extended;
+    //! 	invalidated after the call
+	BinaryParser(Document*& doc);
+
+	~BinaryParser();
+
+    //! \brief Release the document, transferring the ownership and resetting the internal state
+    //!
+    //! \return Document*  - resulting allocated RDF document
+	Document* release();
+    //! \brief Parse all chunks of the input, extending the internal RDF document
+    //! \note Parsing stops on the malformed data, retaining the parsed quads
+    //!
+    //! \param input const String&  - input to be parsed
+    //! \return Document&  - extended RDF document
+	Document& parse(const String& input);
+	//! \brief Whether the last parsing failed because of the malformed data or insufficient memory
+	bool failed() const
+		{ return _failed; }
+protected:
+	typedef const uint8_t  data_t;  //!< Data type
+
+	bool parseChunk();
+	bool readVarint(uint32_t& val);
+    //! \brief Read the front-coded string
+    //!
+    //! \param prev const String*  - preceding string in the block, nullptr for the block head
+    //! \return const String*  - interned string; nullptr if the data are malformed
+	const String* readString(const String* prev);
+	const Term* readTerm();
+	const Quad* readQuad();
+private:
+	Document* _doc;
+	data_t* _cur;
+	data_t* _end;
+	bool _failed;
+	// Dictionary of the parsing chunk
+	Array<const String*> _strings;
+	Array<const Term*> _terms;
+};
+
+}  // smallrdf
+
+#endif  // BINARYPARSER_H_
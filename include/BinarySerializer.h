@@ -0,0 +1,102 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef BINARYSERIALIZER_H_
+#define BINARYSERIALIZER_H_
+
+#include "RDF.hpp"
+#include "BinaryFormat.h"
+#include "FrontCodedDictionary.h"
+
+
+namespace smallrdf {
+
+//! \brief Serializer of RDF datasets to the compact binary format
+//! \see binfmt
+class BinarySerializer {
+	String* _buf;
+	uint8_t* _cur;
+	uint8_t* _end;
+public:
+	//! \brief Serialize RDF dataset to the storage
+	//!
+	//! \param dataset const Dataset&  - input RDF dataset
+	//! \param storage String*&  - resulting serialized data, being extended.
+	//! 	Receives the ownership of the internal storage
+	//! \return const String&  - serialized data
+	static String& serialize(const Dataset& dataset, String*& storage);
+
+	BinarySerializer();
+#if __cplusplus >= 201103L
+	BinarySerializer(BinarySerializer&& other);
+	BinarySerializer(const BinarySerializer&)=delete;
+	BinarySerializer& operator=(const BinarySerializer&)=delete;
+#endif // __cplusplus 11+
+    //! \brief Construct, initializing the internal storage
+    //!
+    //! \param storage String&  - storage, being extended on serialization;
+    //! 	invalidated after the call
+	BinarySerializer(String*& storage);
+	~BinarySerializer();
+
+    //! \brief Release the storage, transferring the ownership and resetting the internal state
+    //!
+    //! \return String*  - resulting allocated storage
+	String* release();
+
+	String& storage();
+	const String& storage() const
+		{ return const_cast<BinarySerializer*>(this)->storage(); }
+
+	//! \brief Iteratively serialize RDF datasets, each forming a chunk of the storage
+	//!
+	//! \param dataset const Dataset&  - RDF dataset being serialized
+	//! \return String&  - serialized data
+	String& serialize(const Dataset& dataset);
+protected:
+	//! \brief Dictionary of the serializing dataset
+	struct Dictionary {
+		typedef Hashmap<const String*, uint32_t, ContentHash<const String*> >  StringIds;
+		typedef Hashmap<const Term*, uint32_t, ContentHash<const Term*> >  TermIds;
+
+		StringIds stringIds;
+		Array<const String*> strings;  //!< Strings by their ids
+		Array<uint32_t> ranks;  //!< Ids of the strings in the front-coded dictionary by their ids
+		TermIds termIds;
+		Array<const Term*> terms;  //!< Terms by their ids
+		Array<const Quad*> quads;  //!< Quads in the traversal order of the dataset
+
+		Dictionary();
+		~Dictionary();
+
+		//! \brief Serialized id of the indexed string
+		uint32_t id(const String* str) const
+			{ return ranks[*stringIds.find(str)]; }
+	};
+
+    //! \brief Build the dictionary of the dataset
+    //!
+    //! \param dataset const Dataset&  - input RDF dataset
+    //! \param dict Dictionary&  - resulting dictionary, where the strings are not ranked yet
+    //! \return bool  - whether the dictionary is built, otherwise the memory is insufficient
+	bool index(const Dataset& dataset, Dictionary& dict) const;
+	bool indexString(const String* str, Dictionary& dict, uint32_t& id) const;
+	bool indexTerm(const Term* term, Dictionary& dict, uint32_t& id) const;
+    //! \brief Rank the dictionary strings by their ids in the front-coded strings
+    //!
+    //! \param strings const FrontCodedDictionary&  - front-coded strings of the dictionary
+    //! \param dict Dictionary&  - dictionary to be ranked
+    //! \return bool  - whether the strings are ranked, otherwise the memory is insufficient
+	bool rank(const FrontCodedDictionary& strings, Dictionary& dict) const;
+    //! \brief Size of the serialized chunk of the ranked dictionary
+	size_t chunkSize(const Dictionary& dict, const FrontCodedDictionary& strings) const;
+	void serializeChunk(const Dictionary& dict, const FrontCodedDictionary& strings);
+
+	void write(uint8_t chr);
+	void writeVarint(uint32_t val);
+	void write(const uint8_t* data, size_t size);
+};
+
+}  // smallrdf
+
+#endif  // BINARYSERIALIZER_H_
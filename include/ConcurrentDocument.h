@@ -0,0 +1,154 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef CONCURRENTDOCUMENT_H_
+#define CONCURRENTDOCUMENT_H_
+
+#include "RDF.hpp"
+
+#ifdef SMALLRDF_THREADS
+#include <atomic>
+#include <mutex>
+
+#include "Interner.h"
+#include "QuadIndex.h"
+
+
+namespace smallrdf {
+
+//! \brief Document shared by a writer and many readers, where the readers query consistent
+//! snapshots of the published quads without locking
+//!
+//! The stored quads are never modified, so a published version is an immutable prefix of
+//! the quads stack: an immutable base index of the older quads and a bounded tail of the newer
+//! ones, which are scanned. The writer rebuilds the base index once the tail outgrows it and
+//! publishes the new version atomically. The replaced versions and indexes are reclaimed by
+//! the epochs: a version retired in the epoch e is released once the epoch e + 2 is reached,
+//! which requires that no reader of the epochs up to e remains.
+//! \note The terms are interned concurrently by any number of threads (see Interner), while
+//! 	storing and publishing the quads are serialized by a mutex, which the readers never
+//! 	acquire while querying
+class ConcurrentDocument {
+public:
+	class View;
+
+	ConcurrentDocument();
+	ConcurrentDocument(const ConcurrentDocument&)=delete;
+	ConcurrentDocument& operator=(const ConcurrentDocument&)=delete;
+    //! \brief Release the document
+    //! \attention All views should be released beforehand
+	~ConcurrentDocument();
+
+	//! \brief Whether the document is constructed, otherwise the memory is insufficient
+	bool valid() const
+		{ return _current.load() != nullptr; }
+	//! \brief Number of the published quads
+	unsigned length() const;
+	//! \brief Current epoch of the reclamation
+	unsigned epoch() const
+		{ return _epoch.load(); }
+	//! \brief Number of the retired versions and indexes pending the reclamation
+	unsigned retired() const;
+
+	// Concurrent interning of the document terms, see Document
+	const String* string(String& str)
+		{ return _terms.string(str); }
+	const String* string(String&& str)
+		{ return string(str); }  // Calls string(String& str);
+	const NamedNode* namedNode(const String& value)
+		{ return _terms.namedNode(value); }
+	const Literal* literal(const String& value, const String* lang=nullptr,
+						   const String* dtype=nullptr)
+		{ return _terms.literal(value, lang, dtype); }
+	const BlankNode* blankNode(const String& value)
+		{ return _terms.blankNode(value); }
+	const Variable* variable(const String& name)
+		{ return _terms.variable(name); }
+	//! \brief Interned term equal to the given one; nullptr if it is absent
+	const Term* findTerm(const Term& term)
+		{ return _terms.findTerm(term); }
+    //! \brief Store the quad of the terms of this document, which becomes visible
+    //! 	to the readers on the next publish()
+    //!
+    //! \param subject const Term&  - subject
+    //! \param predicate const Term&  - predicate
+    //! \param object const Term&  - object
+    //! \param graph=nullptr const Term*  - graph, nullptr denotes the default graph
+    //! \return const Quad*  - stored quad; nullptr if the memory is insufficient
+	const Quad* quad(const Term& subject, const Term& predicate,
+					   const Term& object, const Term* graph = nullptr);
+    //! \brief Publish the stored quads atomically, so the views opened afterwards see them
+    //!
+    //! \return bool  - whether the quads are published, otherwise the memory is insufficient
+	bool publish();
+protected:
+	//! \brief Immutable published state
+	struct Version {
+		Dataset::Quads::Node* head;  //!< The newest quad
+		unsigned length;  //!< Number of the quads
+		const QuadIndex* base;  //!< Index of the oldest quads, nullptr if they are absent
+		unsigned baseLength;  //!< Number of the quads in the base index
+	};
+
+	//! \brief Version or index pending the reclamation
+	struct Retired {
+		Version* version;
+		QuadIndex* base;
+		unsigned epoch;  //!< Epoch of the retirement
+	};
+
+    //! \brief Release the retired items unreachable by the readers, advancing the epoch if possible
+	void reclaim();
+private:
+	mutable std::mutex _writer;  //!< Serialization of the writer operations
+	Interner _terms;
+	Dataset::Quads _quads;  //!< Stored quads, accessed by the writer only
+	std::atomic<Version*> _current;  //!< Published version
+	std::atomic<unsigned> _epoch;
+	std::atomic<unsigned> _readers[2];  //!< Numbers of the readers of the even and odd epochs
+	Array<Retired> _retired;
+};
+
+//! \brief Consistent read-only snapshot of the published quads, which pins the version
+//! until the view is released
+//! \note The pattern terms should be interned in the viewed document. A view is used by
+//! 	a single thread, while any number of views can be opened concurrently
+class ConcurrentDocument::View: public Dataset {
+public:
+	explicit View(ConcurrentDocument& doc);
+	View(const View&)=delete;
+	View& operator=(const View&)=delete;
+	~View();
+
+	//! \brief Number of the quads in the snapshot
+	unsigned length() const override
+		{ return _version ? _version->length : 0; }
+    //! \brief Visit the quads of the snapshot from the newest one
+	bool traverse(QuadVisitor& visitor) const override;
+
+	Quad* find(const Quad& quad) override;
+	Quads match(const Term* subject = nullptr, const Term* predicate = nullptr,
+				const Term* object = nullptr, const Term* graph = nullptr) override;
+	using Dataset::visit;
+	bool visit(const Quad& pattern, QuadVisitor& visitor) override;
+	unsigned count(const Quad& pattern) override;
+	bool exists(const Quad& pattern) override;
+    //! \brief Refused, the published versions are immutable
+    //! \attention Asserts in the debug mode
+    //!
+    //! \return unsigned  - 0
+	unsigned remove(const Quad& pattern) override;
+    //! \brief Refused, the published versions are immutable
+    //! \attention Asserts in the debug mode
+	void compact() override;
+private:
+	ConcurrentDocument& _doc;
+	const Version* _version;
+	unsigned _epoch;  //!< Epoch the view is registered in
+};
+
+}  // smallrdf
+
+#endif  // SMALLRDF_THREADS
+
+#endif  // CONCURRENTDOCUMENT_H_
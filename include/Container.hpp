@@ -6,6 +6,8 @@
 #define CONTAINER_HPP_
 
 #include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>  // malloc
 #include <assert.h>
 
 #if __cplusplus >= 201103L
@@ -104,6 +106,9 @@ class StackNode: public Iterator<T> {
 	T  _val;
 	StackNode* _next;
 
+	template<typename V>
+	friend class Stack;
+
 //	StackNode()
 //		: _empty{0}, _next(nullptr) {}
 public:
@@ -188,6 +193,14 @@ public:
     //! \param val T&  - an object to be added
     //! \return T*  - acquired object, which holds the ownership of its content
 	T* add(T& val) override;
+    //! \brief Remove the items satisfying the predicate in a single pass
+    //!
+    //! \param pred Pred  - predicate of the removed items: bool pred(const T&)
+    //! \return unsigned  - number of the removed items
+	template<typename Pred>
+	unsigned remove(Pred pred);
+	//! \brief Remove the last added item
+	void pop();
 
 	Node* find(const T& val) override;
 
@@ -208,6 +221,290 @@ private:
 template<typename T>
 typename Stack<T>::Node* Stack<T>::_end = Stack<T>::Node::blank();
 
+// Array -----------------------------------------------------------------------
+//! \brief Dynamic array of trivially copyable items
+template<typename T>
+class Array {
+public:
+	typedef T  value_type;
+
+	Array()
+		: _items(nullptr), _length(0), _capacity(0)  {}
+#if __cplusplus >= 201103L
+	Array(Array&& other);
+	Array(const Array&)=delete;
+	Array& operator=(const Array&)=delete;
+#endif // __cplusplus 11+
+	~Array()
+		{ clear(); }
+
+	unsigned length() const  { return _length; }
+	unsigned capacity() const  { return _capacity; }
+
+    //! \brief Ensure the capacity of the array
+    //!
+    //! \param capacity unsigned  - required capacity
+    //! \return bool  - whether the memory is sufficient
+	bool reserve(unsigned capacity);
+    //! \brief Resize the array, the new items are not initialized
+    //!
+    //! \param length unsigned  - required length
+    //! \return bool  - whether the memory is sufficient
+	bool resize(unsigned length);
+    //! \brief Append an item
+    //!
+    //! \param val const T&  - an item to be appended
+    //! \return T*  - stored item; nullptr if the memory is insufficient
+	T* add(const T& val);
+	void pop()
+		{ assert(_length && "Popping an empty array"); --_length; }
+	void clear();
+
+	T& operator[](unsigned i)
+		{ assert(i < _length && "Index out of range"); return _items[i]; }
+	const T& operator[](unsigned i) const
+		{ assert(i < _length && "Index out of range"); return _items[i]; }
+
+	T* begin()  { return _items; }
+	const T* begin() const  { return _items; }
+	T* end()  { return _items + _length; }
+	const T* end() const  { return _items + _length; }
+private:
+	T* _items;
+	unsigned _length;
+	unsigned _capacity;
+};
+
+// Sorting ---------------------------------------------------------------------
+template<typename T>
+void swap(T& a, T& b)
+{
+	T tmp = a;
+	a = b;
+	b = tmp;
+}
+
+//! \brief Sort the trivially copyable items in place
+//! \note Quicksort with the median of three pivot is used, sorting small ranges by insertions.
+//! 	The recursion is performed only for the smaller part, bounding the stack depth by O(log n)
+//!
+//! \param beg T*  - beginning of the items
+//! \param end T*  - end of the items
+//! \param less Less  - strict weak ordering of the items
+template<typename T, typename Less>
+void sort(T* beg, T* end, Less less)
+{
+	while(end - beg > 16) {
+		T* const  mid = beg + (end - beg) / 2;
+		T* const  last = end - 1;
+		if(less(*mid, *beg))
+			swap(*mid, *beg);
+		if(less(*last, *mid)) {
+			swap(*last, *mid);
+			if(less(*mid, *beg))
+				swap(*mid, *beg);
+		}
+		const T  pivot = *mid;
+		T* i = beg;
+		T* j = last;
+		for(;;) {
+			while(less(*i, pivot))
+				++i;
+			while(less(pivot, *j))
+				--j;
+			if(i >= j)
+				break;
+			swap(*i++, *j--);
+		}
+		// [beg, j] <= pivot <= [j + 1, end)
+		T* const  split = j + 1;
+		if(split - beg < end - split) {
+			sort(beg, split, less);
+			beg = split;
+		} else {
+			sort(split, end, less);
+			end = split;
+		}
+	}
+	for(T* i = beg + 1; i < end; ++i) {
+		const T  val = *i;
+		T* j = i;
+		for(; j != beg && less(val, *(j - 1)); --j)
+			*j = *(j - 1);
+		*j = val;
+	}
+}
+
+//! \brief Sort the added items and merge them into the ordered ones in place
+//!
+//! \param items Array<T>&  - ordered items, extended by the added ones
+//! \param adds Array<T>&  - added items, which are sorted and cleared on success
+//! \param less Less  - strict weak ordering of the items
+//! \return bool  - whether the items are merged, otherwise the memory is insufficient
+template<typename T, typename Less>
+bool merge(Array<T>& items, Array<T>& adds, Less less)
+{
+	const unsigned  num = adds.length();
+	if(!num)
+		return true;
+	const unsigned  len = items.length();
+	if(!items.resize(len + num))
+		return false;
+	T* const  src = adds.begin();
+	sort(src, src + num, less);
+	// Merge from the back to perform the merge in place
+	T* const  dest = items.begin();
+	unsigned  ip = len;
+	unsigned  iq = num;
+	unsigned  ir = len + num;
+	while(iq) {
+		if(ip && less(src[iq - 1], dest[ip - 1]))
+			dest[--ir] = dest[--ip];
+		else dest[--ir] = src[--iq];
+	}
+	adds.clear();
+	return true;
+}
+
+// Hashing ---------------------------------------------------------------------
+//! \brief Finalizing mixer of the hash bits (Murmur3)
+inline uint32_t hashMix(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return static_cast<uint32_t>(h);
+}
+
+inline uint64_t hashBits(const void* ptr)  { return reinterpret_cast<uintptr_t>(ptr); }
+inline uint64_t hashBits(uint64_t val)  { return val; }
+
+//! \brief FNV-1a hash of the data
+inline uint32_t hashData(const uint8_t* data, size_t size, uint32_t h=2166136261u)
+{
+	for(const uint8_t* end = data + size; data != end; ++data)
+		h = (h ^ *data) * 16777619u;
+	return h;
+}
+
+//! \brief Hashing of the keys by identity (values of integers and pointers)
+template<typename K>
+struct IdentityHash {
+	static uint32_t hash(K key)  { return hashMix(hashBits(key)); }
+	static bool equal(K a, K b)  { return a == b; }
+};
+
+//! \brief Hashing of the pointers by the content of the pointed objects,
+//! which provide hash() and operator==
+template<typename K>
+struct ContentHash {
+	static uint32_t hash(K key)  { return key->hash(); }
+	static bool equal(K a, K b)  { return a == b || *a == *b; }
+};
+
+// Hashset ---------------------------------------------------------------------
+//! \brief Open addressing hash set of trivially copyable items
+//!
+//! \tparam T  - item type
+//! \tparam H  - hashing traits providing hash(const T&) and equal(const T&, const T&)
+template<typename T, typename H=IdentityHash<T> >
+class Hashset {
+public:
+	typedef T  value_type;
+
+	Hashset()
+		: _items(nullptr), _used(nullptr), _length(0), _capacity(0)  {}
+#if __cplusplus >= 201103L
+	Hashset(const Hashset&)=delete;
+	Hashset& operator=(const Hashset&)=delete;
+#endif // __cplusplus 11+
+	~Hashset()
+		{ clear(); }
+
+	unsigned length() const  { return _length; }
+	//! \brief Number of the slots, which can be traversed by slot()
+	unsigned capacity() const  { return _capacity; }
+
+	T* find(const T& val);
+	const T* find(const T& val) const
+		{ return const_cast<Hashset*>(this)->find(val); }
+    //! \brief Add an item if it is absent
+    //!
+    //! \param val const T&  - an item to be added
+    //! \param added=nullptr bool*  - whether the item has been added
+    //! \return T*  - stored item that is equal to val; nullptr if the memory is insufficient
+	T* add(const T& val, bool* added=nullptr);
+	bool remove(const T& val);
+	void clear();
+    //! \brief Ensure the capacity for the items, so adding them never fails
+    //!
+    //! \param length unsigned  - required number of the items
+    //! \return bool  - whether the memory is sufficient
+	bool reserve(unsigned length);
+
+    //! \brief Item in the slot
+    //!
+    //! \param i unsigned  - slot index < capacity()
+    //! \return T*  - stored item or nullptr if the slot is empty
+	T* slot(unsigned i)
+		{ return _used[i] ? _items + i : nullptr; }
+	const T* slot(unsigned i) const
+		{ return _used[i] ? _items + i : nullptr; }
+protected:
+	bool rehash(unsigned capacity);
+private:
+	T* _items;
+	uint8_t* _used;  //!< Occupied slots
+	unsigned _length;
+	unsigned _capacity;  //!< Power of 2
+};
+
+// Hashmap ---------------------------------------------------------------------
+template<typename K, typename V>
+struct HashEntry {
+	K key;
+	V val;
+};
+
+template<typename K, typename V, typename H>
+struct HashEntryTraits {
+	static uint32_t hash(const HashEntry<K, V>& entry)  { return H::hash(entry.key); }
+	static bool equal(const HashEntry<K, V>& a, const HashEntry<K, V>& b)
+		{ return H::equal(a.key, b.key); }
+};
+
+//! \brief Open addressing hash map of trivially copyable keys and values
+//!
+//! \tparam K  - key type
+//! \tparam V  - value type
+//! \tparam H  - hashing traits of the keys
+template<typename K, typename V, typename H=IdentityHash<K> >
+class Hashmap: public Hashset<HashEntry<K, V>, HashEntryTraits<K, V, H> > {
+public:
+	typedef HashEntry<K, V>  Entry;
+	typedef Hashset<Entry, HashEntryTraits<K, V, H> >  Base;
+
+	V* find(const K& key)
+		{ Entry* res = Base::find(entry(key)); return res ? &res->val : nullptr; }
+	const V* find(const K& key) const
+		{ return const_cast<Hashmap*>(this)->find(key); }
+    //! \brief Add the value if the key is absent
+    //!
+    //! \param key const K&  - key
+    //! \param val const V&  - value
+    //! \param added=nullptr bool*  - whether the value has been added
+    //! \return V*  - value stored by the key; nullptr if the memory is insufficient
+	V* add(const K& key, const V& val, bool* added=nullptr)
+		{ Entry* res = Base::add(entry(key, val), added); return res ? &res->val : nullptr; }
+	bool remove(const K& key)
+		{ return Base::remove(entry(key)); }
+protected:
+	static Entry entry(const K& key, const V& val=V())
+		{ Entry res = {key, val}; return res; }
+};
+
 // Implementation ==============================================================
 //// Managed ---------------------------------------------------------------------
 //template<typename T>
@@ -223,7 +520,162 @@ typename Stack<T>::Node* Stack<T>::_end = Stack<T>::Node::blank();
 //	// TODO: Delete from the hashmap
 //}
 
-// Hashmap ---------------------------------------------------------------------
+// Array -----------------------------------------------------------------------
+#if __cplusplus >= 201103L
+template<typename T>
+Array<T>::Array(Array&& other)
+	: _items(other._items), _length(other._length), _capacity(other._capacity)
+{
+	other._items = nullptr;
+	other._length = other._capacity = 0;
+}
+#endif // __cplusplus 11+
+
+template<typename T>
+bool Array<T>::reserve(unsigned capacity)
+{
+	if(capacity <= _capacity)
+		return true;
+	// Note: realloc is used, so T should be trivially copyable
+	T* items = static_cast<T*>(realloc(_items, sizeof(T) * capacity));
+	if(!items)
+		return false;
+	_items = items;
+	_capacity = capacity;
+	return true;
+}
+
+template<typename T>
+bool Array<T>::resize(unsigned length)
+{
+	if(length > _capacity && !reserve(length))
+		return false;
+	_length = length;
+	return true;
+}
+
+template<typename T>
+T* Array<T>::add(const T& val)
+{
+	if(_length == _capacity && !reserve(_capacity ? _capacity * 2 : 4))
+		return nullptr;
+	_items[_length] = val;
+	return _items + _length++;
+}
+
+template<typename T>
+void Array<T>::clear()
+{
+	free(_items);
+	_items = nullptr;
+	_length = _capacity = 0;
+}
+
+// Hashset ---------------------------------------------------------------------
+template<typename T, typename H>
+T* Hashset<T, H>::find(const T& val)
+{
+	if(!_length)
+		return nullptr;
+	const unsigned  mask = _capacity - 1;
+	for(unsigned i = H::hash(val) & mask; _used[i]; i = (i + 1) & mask)
+		if(H::equal(_items[i], val))
+			return _items + i;
+	return nullptr;
+}
+
+template<typename T, typename H>
+T* Hashset<T, H>::add(const T& val, bool* added)
+{
+	if(added)
+		*added = false;
+	// Keep the load factor <= 3/4
+	if((_length + 1) * 4 > _capacity * 3 && !rehash(_capacity ? _capacity * 2 : 8))
+		return nullptr;
+	const unsigned  mask = _capacity - 1;
+	unsigned i = H::hash(val) & mask;
+	for(; _used[i]; i = (i + 1) & mask)
+		if(H::equal(_items[i], val))
+			return _items + i;
+	_items[i] = val;
+	_used[i] = 1;
+	++_length;
+	if(added)
+		*added = true;
+	return _items + i;
+}
+
+template<typename T, typename H>
+bool Hashset<T, H>::remove(const T& val)
+{
+	T* item = find(val);
+	if(!item)
+		return false;
+	// Backward shift deletion to retain the probing sequences without tombstones
+	const unsigned  mask = _capacity - 1;
+	unsigned i = item - _items;
+	for(unsigned j = (i + 1) & mask; _used[j]; j = (j + 1) & mask) {
+		const unsigned  home = H::hash(_items[j]) & mask;
+		// Move the item to the hole if its home slot is not within (i, j]
+		if((j > i && (home <= i || home > j)) || (j < i && home <= i && home > j)) {
+			_items[i] = _items[j];
+			i = j;
+		}
+	}
+	_used[i] = 0;
+	--_length;
+	return true;
+}
+
+template<typename T, typename H>
+void Hashset<T, H>::clear()
+{
+	free(_items);
+	free(_used);
+	_items = nullptr;
+	_used = nullptr;
+	_length = _capacity = 0;
+}
+
+template<typename T, typename H>
+bool Hashset<T, H>::reserve(unsigned length)
+{
+	// Keep the load factor <= 3/4 as in add()
+	if(length * 4 <= _capacity * 3)
+		return true;
+	unsigned  capacity = _capacity ? _capacity * 2 : 8;
+	while(length * 4 > capacity * 3)
+		capacity *= 2;
+	return rehash(capacity);
+}
+
+template<typename T, typename H>
+bool Hashset<T, H>::rehash(unsigned capacity)
+{
+	T* items = static_cast<T*>(malloc(sizeof(T) * capacity));
+	uint8_t* used = static_cast<uint8_t*>(calloc(capacity, 1));
+	if(!items || !used) {
+		free(items);
+		free(used);
+		return false;
+	}
+	const unsigned  mask = capacity - 1;
+	for(unsigned j = 0; j < _capacity; ++j) {
+		if(!_used[j])
+			continue;
+		unsigned i = H::hash(_items[j]) & mask;
+		while(used[i])
+			i = (i + 1) & mask;
+		items[i] = _items[j];
+		used[i] = 1;
+	}
+	free(_items);
+	free(_used);
+	_items = items;
+	_used = used;
+	_capacity = capacity;
+	return true;
+}
 
 // Stack -----------------------------------------------------------------------
 template<typename T>
@@ -248,6 +700,34 @@ T* Stack<T>::add(T& val)
 	return nullptr;
 }
 
+template<typename T>
+template<typename Pred>
+unsigned Stack<T>::remove(Pred pred)
+{
+	unsigned  num = 0;
+	Node** link = &_root;
+	while(*link != end()) {
+		Node* const  cur = *link;
+		if(pred(**cur)) {
+			*link = cur->_next;
+			delete cur;
+			++num;
+		} else link = &cur->_next;
+	}
+	_length -= num;
+	return num;
+}
+
+template<typename T>
+void Stack<T>::pop()
+{
+	assert(_root != end() && "Popping an empty stack");
+	Node* const  old = _root;
+	_root = old->_next;
+	delete old;
+	--_length;
+}
+
 template<typename T>
 StackNode<T>* Stack<T>::find(const T& val)
 {
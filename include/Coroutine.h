@@ -0,0 +1,226 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef COROUTINE_H_
+#define COROUTINE_H_
+
+#include "RDF.hpp"
+
+#ifdef SMALLRDF_COROUTINES
+#include <stdlib.h>  // abort
+#include <coroutine>
+#include <new>  // nothrow allocation of the coroutine frames
+
+#include "NTriplesParser.h"
+
+
+namespace smallrdf {
+
+//! \brief Lazy sequence of the values yielded by a coroutine
+//!
+//! The coroutine is resumed on each request of the next value, so it is suspended
+//! until the consumer needs more values and released with the generator.
+//! \note The coroutine frame is allocated without exceptions, so the generator of a failed
+//! 	allocation is empty (see valid())
+//! \tparam T  - trivially copyable value, e.g. a pointer
+template<typename T>
+class Generator {
+public:
+	struct promise_type {
+		T value;
+
+		promise_type(): value()  {}
+
+		static Generator get_return_object_on_allocation_failure()
+			{ return Generator(nullptr); }
+		Generator get_return_object()
+			{ return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		std::suspend_always initial_suspend() noexcept
+			{ return {}; }
+		std::suspend_always final_suspend() noexcept
+			{ return {}; }
+		std::suspend_always yield_value(T val) noexcept
+			{ value = val; return {}; }
+		void return_void() noexcept  {}
+		void unhandled_exception() noexcept
+			{ abort(); }  // Note: the library is built without exceptions
+	};
+
+	//! \brief Input iterator over the yielded values
+	class Iter {
+	public:
+		explicit Iter(Generator* gen=nullptr)
+			: _gen(gen)  {}
+
+		T operator*() const
+			{ return _gen->value(); }
+		Iter& operator++()
+			{ if(!_gen->next()) _gen = nullptr; return *this; }
+		bool operator!=(const Iter& other) const
+			{ return _gen != other._gen; }
+	private:
+		Generator* _gen;
+	};
+
+	Generator(Generator&& other) noexcept
+		: _handle(other._handle)  { other._handle = nullptr; }
+	Generator(const Generator&)=delete;
+	Generator& operator=(const Generator&)=delete;
+	~Generator()
+		{ if(_handle) _handle.destroy(); }
+
+	//! \brief Whether the coroutine is allocated, otherwise the memory is insufficient
+	bool valid() const
+		{ return bool(_handle); }
+    //! \brief Resume the coroutine to yield the next value
+    //!
+    //! \return bool  - whether the value is yielded, otherwise the coroutine is completed
+	bool next()
+	{
+		if(!_handle || _handle.done())
+			return false;
+		_handle.resume();
+		return !_handle.done();
+	}
+	//! \brief Last yielded value
+	T value() const
+		{ return _handle.promise().value; }
+
+	Iter begin()
+		{ return Iter(next() ? this : nullptr); }
+	Iter end()
+		{ return Iter(); }
+private:
+	explicit Generator(std::coroutine_handle<promise_type> handle)
+		: _handle(handle)  {}
+
+	std::coroutine_handle<promise_type> _handle;
+};
+
+//! \brief Lazily started asynchronous operation producing a value
+//!
+//! The operation starts when it is awaited by another coroutine, which is resumed once
+//! the operation is completed, or when it is resumed by the event loop (see resume()).
+//! \note The operation of a failed allocation is completed yielding T()
+//! \tparam T  - default constructible and copyable result
+template<typename T>
+class Async {
+public:
+	struct promise_type {
+		T value;
+		std::coroutine_handle<> continuation;  //!< Coroutine awaiting the operation
+
+		promise_type(): value(), continuation()  {}
+
+		//! \brief Resumption of the awaiting coroutine on the completion
+		struct Completion {
+			bool await_ready() const noexcept
+				{ return false; }
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+			{
+				std::coroutine_handle<>  cont = handle.promise().continuation;
+				return cont ? cont : std::noop_coroutine();
+			}
+			void await_resume() const noexcept  {}
+		};
+
+		static Async get_return_object_on_allocation_failure()
+			{ return Async(nullptr); }
+		Async get_return_object()
+			{ return Async(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		std::suspend_always initial_suspend() noexcept
+			{ return {}; }
+		Completion final_suspend() noexcept
+			{ return {}; }
+		void return_value(T val)
+			{ value = val; }
+		void unhandled_exception() noexcept
+			{ abort(); }  // Note: the library is built without exceptions
+	};
+
+	Async(Async&& other) noexcept
+		: _handle(other._handle)  { other._handle = nullptr; }
+	Async(const Async&)=delete;
+	Async& operator=(const Async&)=delete;
+	~Async()
+		{ if(_handle) _handle.destroy(); }
+
+	//! \brief Whether the operation is completed
+	bool done() const
+		{ return !_handle || _handle.done(); }
+	//! \brief Result of the completed operation
+	T result() const
+		{ return _handle ? _handle.promise().value : T(); }
+    //! \brief Start or continue the operation, which is not awaited by a coroutine
+    //!
+    //! \return bool  - whether the operation is completed
+	bool resume()
+	{
+		if(!done())
+			_handle.resume();
+		return done();
+	}
+
+	// Awaiting by a coroutine
+	bool await_ready() const noexcept
+		{ return done(); }
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+		{ _handle.promise().continuation = awaiting; return _handle; }
+	T await_resume() const
+		{ return result(); }
+private:
+	explicit Async(std::coroutine_handle<promise_type> handle)
+		: _handle(handle)  {}
+
+	std::coroutine_handle<promise_type> _handle;
+};
+
+//! \brief Yield the quads of the document matching the pattern, looking them up
+//! 	in the quad index lazily
+//! \attention The document should not be extended till the generator is completed
+//!
+//! \param doc Document&  - queried document
+//! \param pattern Quad  - pattern, where nullptr terms denote any term; the terms should
+//! 	outlive the generator
+//! \return Generator<const Quad*>  - matching quads
+Generator<const Quad*> match(Document& doc, Quad pattern);
+//! \brief Yield the quads of the dataset matching the pattern
+//! \note The matches are collected by Dataset::match() on the first request, since the datasets
+//! 	provide only the eager lookups
+//!
+//! \param dataset Dataset&  - queried dataset
+//! \param pattern Quad  - pattern, where nullptr terms denote any term; the terms should
+//! 	outlive the generator
+//! \return Generator<const Quad*>  - matching quads
+Generator<const Quad*> match(Dataset& dataset, Quad pattern);
+
+//! \brief Parse the N-Triples chunks of the asynchronous byte source
+//!
+//! Each chunk is parsed as a batch, and the control is yielded to the event loop
+//! whenever the source awaits the next chunk, so the parsing of a large input never blocks
+//! the loop longer than a single chunk.
+//! \tparam Source  - source providing read(), which returns an awaitable of the next chunk
+//! 	(const String*); nullptr denotes the end of the input
+//! \param parser NTriplesParser&  - parser extending its document
+//! \param source Source&  - source of the chunks; the chunk is released by the source
+//! 	on the next read
+//! \return Async<bool>  - whether the input is parsed, otherwise a line is malformed
+//! 	or the memory is insufficient
+template<typename Source>
+Async<bool> parse(NTriplesParser& parser, Source& source)
+{
+	const String  none;
+	for(;;) {
+		const String* chunk = co_await source.read();
+		if(!parser.feed(chunk ? *chunk : none, !chunk))
+			co_return false;
+		if(!chunk)
+			co_return true;
+	}
+}
+
+}  // smallrdf
+
+#endif  // SMALLRDF_COROUTINES
+
+#endif  // COROUTINE_H_
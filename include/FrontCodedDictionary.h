@@ -0,0 +1,92 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef FRONTCODEDDICTIONARY_H_
+#define FRONTCODEDDICTIONARY_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+//! \brief Immutable dictionary of strings compressed by the front coding
+//!
+//! Strings are sorted and split into the blocks of the fixed number of strings.
+//! The head of each block is stored fully as varint length and the bytes, each following
+//! string as varint length of the prefix shared with the preceding string, varint length
+//! of the suffix and the suffix bytes. IRIs sharing long namespaces take a fraction
+//! of their plain size.
+//! Ids are the ranks of the strings, so ids order matches the strings order.
+//! Locating a string takes a binary search over the block heads and a scan of a block,
+//! extracting takes a decoding of a block prefix.
+class FrontCodedDictionary {
+public:
+	typedef uint32_t  Id;
+	static const Id  NONE = 0xFFFFFFFF;
+	static const unsigned  BLOCK_SIZE = 16;  //!< Default number of the strings in a block
+
+    //! \brief Construct the dictionary of the strings
+    //!
+    //! \param strings const String* const*  - strings, may be unordered and contain duplicates
+    //! \param num unsigned  - number of the strings
+    //! \param blockSize=BLOCK_SIZE unsigned  - number of the strings in a block, larger blocks
+    //! 	are more compact but slower to access
+	FrontCodedDictionary(const String* const* strings, unsigned num, unsigned blockSize=BLOCK_SIZE);
+    //! \brief Construct the dictionary of the term values of the dataset
+    //!
+    //! \param dataset const Dataset&  - RDF dataset
+    //! \param kind=RTK_NAMED_NODE TermKind  - kind of the terms, whose values are stored
+    //! \param blockSize=BLOCK_SIZE unsigned  - number of the strings in a block
+	explicit FrontCodedDictionary(const Dataset& dataset, TermKind kind=RTK_NAMED_NODE,
+		unsigned blockSize=BLOCK_SIZE);
+#if __cplusplus >= 201103L
+	FrontCodedDictionary(FrontCodedDictionary&&)=default;
+	FrontCodedDictionary(const FrontCodedDictionary&)=delete;
+	FrontCodedDictionary& operator=(const FrontCodedDictionary&)=delete;
+#endif // __cplusplus 11+
+
+	//! \brief Whether the dictionary is constructed, otherwise the memory is insufficient
+	bool valid() const
+		{ return _valid; }
+	//! \brief Number of the stored strings
+	unsigned length() const
+		{ return _length; }
+	//! \brief Size of the compressed data in bytes
+	size_t memory() const
+		{ return _data.length() + _blocks.length() * sizeof(Id); }
+	//! \brief Number of the strings in a block
+	unsigned blockSize() const
+		{ return _blockSize; }
+	//! \brief Encoded blocks, which form the strings section of the binary format (see binfmt)
+	const Array<uint8_t>& data() const
+		{ return _data; }
+
+    //! \brief Locate the string
+    //!
+    //! \param str const String&  - string to be located
+    //! \return Id  - id of the string; NONE if the string is absent
+	Id locate(const String& str) const;
+    //! \brief Extract the string by its id
+    //!
+    //! \param id Id  - string id
+    //! \param str String&  - resulting string, replacing the former content
+    //! \return bool  - whether the string is extracted, otherwise the id is invalid
+    //! 	or the memory is insufficient
+	bool extract(Id id, String& str) const;
+protected:
+	void build(const String** strings, unsigned num);
+	bool append(const uint8_t* data, size_t size);
+	bool appendVarint(uint32_t val);
+    //! \brief Compare the string with the head of the block
+	int compareHead(unsigned block, const String& str) const;
+private:
+	Array<uint8_t> _data;  //!< Encoded blocks
+	Array<Id> _blocks;  //!< Offsets of the blocks in the data
+	unsigned _length;
+	unsigned _blockSize;
+	bool _valid;
+};
+
+}  // smallrdf
+
+#endif  // FRONTCODEDDICTIONARY_H_
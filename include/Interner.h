@@ -0,0 +1,85 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef INTERNER_H_
+#define INTERNER_H_
+
+#include "RDF.hpp"
+
+#ifdef SMALLRDF_THREADS
+#include <mutex>
+
+
+namespace smallrdf {
+
+//! \brief Concurrent interning dictionary of the strings and terms, which returns the same
+//! canonical object for the equal values to any number of threads calling it simultaneously
+//!
+//! The objects are partitioned into the stripes by their content hash, and each stripe
+//! owns its storage and interning index guarded by its own lock, so the threads contend
+//! only when interning the objects of the same stripe.
+//! \note The interned objects are retained until the interner is released
+class Interner {
+public:
+	static const unsigned  STRIPES = 64;
+
+	Interner();
+	Interner(const Interner&)=delete;
+	Interner& operator=(const Interner&)=delete;
+	~Interner();
+
+	//! \brief Number of the interned strings and terms
+	unsigned length() const;
+
+    //! \brief Transfer ownership of the str to the interner, see Document::string()
+    //!
+    //! \param str String*  - original string/view, becoming a view of the stored one
+    //! \return const String*  - stored owned sting; nullptr if the memory is insufficient
+	const String* string(String& str);
+	const String* string(String&& str)
+		{ return string(str); }  // Calls string(String& str);
+	// Note: the term values, languages and datatypes should be interned strings
+	const NamedNode* namedNode(const String& value);
+	const Literal* literal(const String& value, const String* lang=nullptr,
+						   const String* dtype=nullptr);
+	const BlankNode* blankNode(const String& value);
+	const Variable* variable(const String& name);
+    //! \brief Interned term equal to the given one
+    //!
+    //! \param term const Term&  - term of any document
+    //! \return const Term*  - interned term; nullptr if it is absent
+	const Term* findTerm(const Term& term);
+protected:
+	//! \brief Partition of the interned objects
+	struct alignas(64) Stripe {
+		mutable std::mutex lock;
+		Stack<String> strings;
+		Stack<NamedNode> namedNodes;
+		Stack<Literal> literals;
+		Stack<BlankNode> blankNodes;
+		Stack<Variable> variables;
+		Hashset<const String*, ContentHash<const String*> > stringIndex;
+		Hashset<const Term*, ContentHash<const Term*> > termIndex;
+
+		Stripe();
+		~Stripe();
+	};
+
+	Stripe& stripe(uint32_t hash)
+		{ return _stripes[hashMix(hash) % STRIPES]; }
+    //! \brief Intern the term in its stripe
+    //!
+    //! \param terms Stack<T> Stripe::*  - storage of the terms of this kind
+    //! \param term const T&  - interned term
+    //! \return const T*  - stored term; nullptr if the memory is insufficient
+	template<typename T>
+	const T* intern(Stack<T> Stripe::* terms, const T& term);
+private:
+	Stripe _stripes[STRIPES];
+};
+
+}  // smallrdf
+
+#endif  // SMALLRDF_THREADS
+
+#endif  // INTERNER_H_
@@ -0,0 +1,63 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef IRIINDEX_H_
+#define IRIINDEX_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+//! \brief Index of the named nodes ordered by their IRIs, enumerating the IRIs under
+//! a namespace prefix in O(log n + k)
+//!
+//! The named nodes are buffered on addition and merged into the ordered ones on the next
+//! lookup, similar to TextIndex.
+class IriIndex {
+public:
+	//! \brief Range of the named nodes
+	struct Range {
+		const NamedNode* const* beg;
+		const NamedNode* const* end;
+
+		unsigned length() const
+			{ return end - beg; }
+	};
+
+	IriIndex();
+#if __cplusplus >= 201103L
+	IriIndex(const IriIndex&)=delete;
+	IriIndex& operator=(const IriIndex&)=delete;
+#endif // __cplusplus 11+
+
+	//! \brief Number of the indexed named nodes, including the buffered ones
+	unsigned length() const
+		{ return _nodes.length() + _pending.length(); }
+    //! \brief Add the named node
+    //! \note The node should outlive the index
+    //!
+    //! \param node const NamedNode*  - added named node
+    //! \return bool  - whether the node is added, otherwise the memory is insufficient
+	bool add(const NamedNode* node)
+		{ return _pending.add(node) != nullptr; }
+	void clear();
+
+    //! \brief Select the named nodes having the IRI prefix
+    //! \note The range is valid until the next node is added
+    //!
+    //! \param prefix const String&  - prefix of the IRIs, e.g. a namespace
+    //! \param res Range&  - resulting named nodes ordered by their IRIs
+    //! \return bool  - whether the nodes are selected, otherwise the memory is insufficient
+	bool range(const String& prefix, Range& res);
+protected:
+    //! \brief Merge the buffered named nodes into the ordered ones
+	bool flush();
+private:
+	Array<const NamedNode*> _nodes;  //!< Named nodes ordered by their IRIs
+	Array<const NamedNode*> _pending;  //!< Named nodes being merged
+};
+
+}  // smallrdf
+
+#endif  // IRIINDEX_H_
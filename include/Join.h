@@ -0,0 +1,97 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef JOIN_H_
+#define JOIN_H_
+
+#include "QuadIndex.h"
+
+
+namespace smallrdf {
+
+//! \brief Cursor over the quads of an index range sorted by the join field
+//!
+//! The join values are the interned terms ordered by their addresses as in QuadIndex,
+//! so the cursors over the ranges of a single Document can be merged.
+class JoinCursor {
+public:
+	//! \brief Empty cursor
+	JoinCursor();
+    //! \brief Cursor over the range
+    //!
+    //! \param range const QuadIndex::Range&  - range sorted by the field (see QuadIndex::sorted())
+    //! \param field unsigned  - join field (0: subject, 1: predicate, 2: object)
+	JoinCursor(const QuadIndex::Range& range, unsigned field);
+
+	//! \brief Whether all quads are passed
+	bool atEnd() const
+		{ return _cur == _end; }
+	//! \brief Join value of the current quad
+	const Term* key() const
+		{ return QuadIndex::field(**_cur, _field); }
+	//! \brief Current quad
+	const Quad& quad() const
+		{ return **_cur; }
+	//! \brief Number of the remaining quads
+	unsigned length() const
+		{ return _end - _cur; }
+
+	//! \brief Move to the next quad
+	void next()
+		{ ++_cur; }
+    //! \brief Move to the first quad having the join value not less than the key
+    //! \note Galloping search is used, so the cost is logarithmic in the skipped distance
+    //!
+    //! \param key const Term*  - join value to seek
+	void seek(const Term* key);
+    //! \brief Take the quads having the current join value, moving past them
+    //!
+    //! \return QuadIndex::Range  - quads of the current join value
+	QuadIndex::Range group();
+private:
+    //! \brief Skip the quads preceding the key, or having the key if inclusive
+	void skip(const Term* key, bool inclusive);
+
+	const Quad* const* _cur;
+	const Quad* const* _end;
+	QuadIndex::Order _order;
+	unsigned _field;
+};
+
+//! \brief Visitor of the join results
+class JoinVisitor {
+public:
+	virtual ~JoinVisitor()  {}
+
+    //! \brief Visit the quads of all inputs having the join value
+    //!
+    //! \param key const Term*  - join value
+    //! \param groups const QuadIndex::Range*  - matching quads of each input in the input order
+    //! \param num unsigned  - number of the inputs
+    //! \return bool  - whether to continue the join
+	virtual bool operator()(const Term* key, const QuadIndex::Range* groups, unsigned num)=0;
+};
+
+//! \brief Merge join of two sorted inputs advancing them in lockstep
+//!
+//! \param left JoinCursor&  - left input
+//! \param right JoinCursor&  - right input
+//! \param visitor JoinVisitor&  - visitor of the join values present in both inputs
+//! \return bool  - whether the join is completed, otherwise the visitor stopped it
+bool mergeJoin(JoinCursor& left, JoinCursor& right, JoinVisitor& visitor);
+
+//! \brief Leapfrog join of multiple sorted inputs, as in the star patterns
+//!
+//! The lagging input seeks the largest current join value of the inputs, so the
+//! inputs are intersected in time proportional to the smallest one up to a logarithmic factor.
+//! \param cursors JoinCursor*  - inputs
+//! \param num unsigned  - number of the inputs
+//! \param visitor JoinVisitor&  - visitor of the join values present in all inputs
+//! \param failed=nullptr bool*  - whether the memory is insufficient
+//! \return bool  - whether the join is completed, otherwise the visitor stopped it
+//! 	or the memory is insufficient
+bool leapfrogJoin(JoinCursor* cursors, unsigned num, JoinVisitor& visitor, bool* failed=nullptr);
+
+}  // smallrdf
+
+#endif  // JOIN_H_
@@ -0,0 +1,106 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef LANGINDEX_H_
+#define LANGINDEX_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+//! \brief Index of the language-tagged object literals by the subject, predicate and
+//! language tag, which serves the localized lookups (e.g. the English label of a subject)
+//!
+//! The language tags are interned into a small table of the case-insensitively distinct
+//! tags, so the entries are ordered by the tag ids. The quads are buffered on addition
+//! and merged into the ordered entries on the next lookup, similar to ValueIndex.
+//! \note The terms are compared by their pointers, so all quads should refer the terms
+//! 	interned in a single Document
+class LangIndex {
+public:
+	typedef uint16_t  Tag;  //!< Id of the interned language tag
+	static const Tag  NONE = 0xFFFF;
+
+	//! \brief Indexed quad having a language-tagged object literal
+	struct Entry {
+		const Term* subject;
+		const Term* predicate;
+		const Quad* quad;
+		Tag tag;
+	};
+
+	//! \brief Range of the entries
+	struct Range {
+		const Entry* beg;
+		const Entry* end;
+
+		unsigned length() const
+			{ return end - beg; }
+	};
+
+	LangIndex();
+#if __cplusplus >= 201103L
+	LangIndex(const LangIndex&)=delete;
+	LangIndex& operator=(const LangIndex&)=delete;
+#endif // __cplusplus 11+
+	~LangIndex();
+
+	//! \brief Number of the added quads, including the ones without the language tags
+	unsigned observed() const
+		{ return _observed; }
+	//! \brief Number of the indexed quads, including the buffered ones
+	unsigned length() const
+		{ return _entries.length() + _pending.length(); }
+	//! \brief Number of the interned language tags
+	unsigned tags() const
+		{ return _tags.length(); }
+    //! \brief Interned language tag
+    //!
+    //! \param tag Tag  - id of the tag
+    //! \return const String&  - the first interned spelling of the tag
+	const String& tag(Tag tag) const
+		{ return *_tags[tag]; }
+    //! \brief Id of the language tag, compared case-insensitively
+    //!
+    //! \param lang const String&  - language tag
+    //! \return Tag  - id of the tag; NONE if it is not interned
+	Tag find(const String& lang) const
+		{ return find(lang.data(), lang.length()); }
+    //! \brief Add the quad, indexing it if its object is a language-tagged literal
+    //! \note The quad should outlive the index
+    //!
+    //! \param quad const Quad*  - added quad
+    //! \return bool  - whether the quad is added, otherwise the memory is insufficient
+	bool add(const Quad* quad);
+	void clear();
+
+    //! \brief Select the quads of the subject and predicate, whose object literals have
+    //! 	the language tag or its closest BCP47 fallback (e.g. en-US -> en)
+    //!
+    //! \param subject const Term*  - interned subject
+    //! \param predicate const Term*  - interned predicate
+    //! \param lang const String&  - requested language tag
+    //! \param res Range&  - resulting entries of the most specific matching tag
+    //! \return bool  - whether the entries are selected, otherwise the memory is insufficient
+	bool lookup(const Term* subject, const Term* predicate, const String& lang, Range& res);
+protected:
+	Tag find(const uint8_t* lang, size_t len) const;
+    //! \brief Intern the language tag
+    //!
+    //! \param lang const String*  - language tag, which should outlive the index
+    //! \return Tag  - id of the tag; NONE if the memory is insufficient
+	Tag intern(const String* lang);
+    //! \brief Merge the buffered entries into the ordered ones
+	bool flush();
+private:
+	Array<Entry> _entries;  //!< Entries ordered by the subject, predicate and tag
+	Array<Entry> _pending;  //!< Entries being merged
+	Array<const String*> _tags;  //!< Interned language tags by their ids
+	Hashmap<const String*, Tag> _ids;  //!< Ids of the language tag strings
+	unsigned _observed;
+};
+
+}  // smallrdf
+
+#endif  // LANGINDEX_H_
@@ -23,6 +23,8 @@ public:
 	NTriplesParser();
 #if __cplusplus >= 201103L
 	NTriplesParser(NTriplesParser&& other);
+	NTriplesParser(const NTriplesParser&)=delete;
+	NTriplesParser& operator=(const NTriplesParser&)=delete;
 #endif // __cplusplus 11+
     //! \brief Construct, initializing the internal RDF document
     //!
@@ -37,9 +39,25 @@ public:
     //! \return Document*  - resulting allocated RDF document
 	Document* release();
 	Document& parse(const String& input);
+    //! \brief Parse the chunk of the input stream, retaining its incomplete last line
+    //! 	till the next chunk
+    //! \note The chunk may be released after the call
+    //!
+    //! \param chunk const String&  - next chunk of the input
+    //! \param last=false bool  - whether the chunk is the last one, so the retained line is parsed
+    //! \return bool  - whether the chunk is consumed, otherwise a line is malformed or
+    //! 	the memory is insufficient, and the lines following it are skipped
+	bool feed(const String& chunk, bool last=false);
 protected:
 	typedef const uint8_t  data_t;  //!< Data type
 
+    //! \brief Parse the complete lines of the input
+    //!
+    //! \param beg data_t*  - begin of the lines
+    //! \param end data_t*  - end of the lines
+    //! \return bool  - whether all lines are parsed, otherwise a line is malformed or
+    //! 	the memory is insufficient
+	bool parseLines(data_t* beg, data_t* end);
 	const Quad* parseQuad();
 	bool hasNext() const;
 	data_t getNext();
@@ -61,6 +79,7 @@ private:
 	data_t* _buf;
 	data_t* _cur;
 	data_t* _end;
+	String _tail;  //!< Incomplete last line of the fed chunks
 };
 
 }  // smallrdf
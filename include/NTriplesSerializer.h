@@ -20,12 +20,15 @@ public:
 	//! \param dataset const Dataset&  - input RDF dataset
 	//! \param storage String*&  - resulting serialized data, being extended.
 	//! 	Receives the ownership of the internal storage
+	//! \param workers=1 unsigned  - the number of worker threads
 	//! \return const String&  - serialized data
-	static String& serialize(const Dataset& dataset, String*& storage);
+	static String& serialize(const Dataset& dataset, String*& storage, unsigned workers=1);
 
 	NTriplesSerializer();
 #if __cplusplus >= 201103L
     NTriplesSerializer(NTriplesSerializer&& other);
+	NTriplesSerializer(const NTriplesSerializer&)=delete;
+	NTriplesSerializer& operator=(const NTriplesSerializer&)=delete;
 #endif // __cplusplus 11+
     //! \brief Construct, initializing the internal storage
     //!
@@ -46,19 +49,44 @@ public:
 	//! \brief Iteratively serialize RDF datasets
 	//!
 	//! \param dataset const Dataset&  - RDF dataset being serialized
+	//! \param workers=1 unsigned  - the number of worker threads. Quads are
+	//! 	partitioned and each worker writes its partition directly into a disjoint
+	//! 	region of the preallocated storage, yielding the same output as the
+	//! 	sequential serialization
 	//! \return String&  - serialized data
-	String& serialize(const Dataset& dataset);
+	String& serialize(const Dataset& dataset, unsigned workers=1);
 protected:
-	void write(uint8_t chr);
-	void write(const String& str);
+    //! \brief Construct a partition writer for the [beg, end) region of an external buffer
+    //! \note The writer does not own the buffer
+	NTriplesSerializer(uint8_t* beg, uint8_t* end);
+
+    //! \brief Ensure the storage capacity and set the writing position
+    //!
+    //! \param offs size_t  - writing position in the storage
+    //! \param size size_t  - size of the data to be written from the position
+	void reserve(size_t offs, size_t size);
 
+#ifdef SMALLRDF_THREADS
+    //! \brief Serialize the quads by the worker threads
+    //!
+    //! \param beg const Quad* const*  - the first quad being serialized
+    //! \param end const Quad* const*  - the end of the quads
+    //! \param workers unsigned  - the number of worker threads, >= 2
+    //! \param offs size_t  - writing position in the storage
+	void serializeParallel(const Quad* const* beg, const Quad* const* end, unsigned workers, size_t offs);
+#endif  // SMALLRDF_THREADS
+	size_t rangeSize(const Quad* const* beg, const Quad* const* end) const;
+	void serializeRange(const Quad* const* beg, const Quad* const* end);
 
-	//! \brief Evaluate dataset size
+	void write(uint8_t chr);
+	void write(const String& str);
+	//! \brief Write the literal value escaping the quote, backslash and line break characters
+	//! \note The characters to be escaped are detected by a vectorized pre-scan,
+	//! 	so that clean strings are copied at once
 	//!
-	//! \param dataset const Dataset& - dataset to be processed
-	//! \return size_t  - pure size of the dataset (without the null-terminator used in serlization)
-	size_t datasetSize(const Dataset& dataset) const;
-	void serializeDataset(const Dataset& dataset);
+	//! \param str const String&  - literal value
+	void writeEscaped(const String& str);
+
 	size_t quadSize(const Quad& quad) const;
 	void serializeQuad(const Quad& quad);
 	size_t termSize(const Term* term) const;
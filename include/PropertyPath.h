@@ -0,0 +1,165 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef PROPERTYPATH_H_
+#define PROPERTYPATH_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+//! \brief Property path expression composed of the predicate links, inverse,
+//! sequence and transitive paths (p, ^p, p1/p2, p*, p+)
+//!
+//! The path nodes are added bottom-up, each builder returns the index of the added
+//! node or NONE if the memory is insufficient, and the last added node is the root.
+//! \note The predicates should outlive the path
+class PropertyPath {
+public:
+	static const unsigned  NONE = ~0u;
+
+	//! \brief Kinds of the path nodes
+	enum Kind {
+		PK_LINK,  //!< Predicate
+		PK_INVERSE,  //!< ^path
+		PK_SEQUENCE,  //!< path/path
+		PK_ZERO_OR_MORE,  //!< path*
+		PK_ONE_OR_MORE  //!< path+
+	};
+
+	//! \brief Node of the path
+	struct Node {
+		Kind kind;
+		const Term* predicate;  //!< Predicate of PK_LINK
+		unsigned first;  //!< Operand
+		unsigned second;  //!< Second operand of PK_SEQUENCE
+	};
+
+	PropertyPath();
+#if __cplusplus >= 201103L
+	PropertyPath(const PropertyPath&)=delete;
+	PropertyPath& operator=(const PropertyPath&)=delete;
+#endif // __cplusplus 11+
+
+	unsigned link(const Term& predicate);
+	unsigned inverse(unsigned path);
+	unsigned sequence(unsigned first, unsigned second);
+	unsigned zeroOrMore(unsigned path);
+	unsigned oneOrMore(unsigned path);
+	void clear()
+		{ _nodes.clear(); }
+
+	//! \brief Number of the nodes
+	unsigned length() const
+		{ return _nodes.length(); }
+	const Node& node(unsigned i) const
+		{ return _nodes[i]; }
+	//! \brief Root node index or NONE if the path is empty
+	unsigned root() const
+		{ return _nodes.length() ? _nodes.length() - 1 : NONE; }
+protected:
+	unsigned add(Kind kind, const Term* predicate, unsigned first, unsigned second=NONE);
+private:
+	Array<Node> _nodes;
+};
+
+//! \brief Evaluator of the property paths over the dataset index
+//!
+//! The paths are evaluated by the breadth-first traversal of the quads looked up by
+//! Dataset::visit. Transitive closures of the predicate links (p*, p+, (^p)*, (^p)+) are
+//! memoized per the start term and predicate. The quads stored since the memoization
+//! invalidate only the closures of their predicates, while the other modifications
+//! (see Dataset::modifications()), including the reclamation of the terms, release all closures.
+//! \note The datasets storing their quads beyond the quads stack (e.g. ShardedDataset)
+//! 	advance the modification epoch on each insertion, so all closures are released then
+//! \note The memoized terms refer the dataset, which should outlive the evaluator
+class PathEvaluator {
+public:
+	explicit PathEvaluator(Dataset& dataset);
+#if __cplusplus >= 201103L
+	PathEvaluator(const PathEvaluator&)=delete;
+	PathEvaluator& operator=(const PathEvaluator&)=delete;
+#endif // __cplusplus 11+
+	~PathEvaluator();
+
+    //! \brief Evaluate the path from the start term
+    //!
+    //! \param path const PropertyPath&  - evaluating path
+    //! \param start const Term&  - start term
+    //! \param ends Array<const Term*>&  - resulting distinct terms reachable by the path,
+    //! 	replacing the former content
+    //! \return bool  - whether the evaluation is completed, otherwise the memory is insufficient
+	bool evaluate(const PropertyPath& path, const Term& start, Array<const Term*>& ends);
+
+	//! \brief Number of the memoized closures
+	unsigned closures() const
+		{ return _closures.length(); }
+	//! \brief Release the memoized closures
+	void clear();
+protected:
+	//! \brief Memoized transitive closure of a predicate link
+	struct Closure {
+		const Term** terms;  //!< Reachable terms, excluding the start unless it is on a cycle
+		unsigned length;
+		unsigned version;  //!< Version of the predicate the closure is memoized in
+	};
+
+	//! \brief Key of the closure
+	struct Key {
+		const Term* start;
+		const Term* predicate;
+		bool inverse;
+	};
+
+	//! \brief Hashing of the keys by the content of their terms
+	struct KeyHash {
+		static uint32_t hash(const Key& key)
+			{ return hashMix((uint64_t(key.start->hash()) << 32 | key.predicate->hash()) ^ key.inverse); }
+		static bool equal(const Key& a, const Key& b)
+		{
+			return a.inverse == b.inverse && (a.start == b.start || *a.start == *b.start)
+				&& (a.predicate == b.predicate || *a.predicate == *b.predicate);
+		}
+	};
+
+	struct TermSet;
+
+    //! \brief Evaluate the path node from the terms
+    //!
+    //! \param path const PropertyPath&  - evaluating path
+    //! \param node unsigned  - path node
+    //! \param inverse bool  - whether the node is traversed backward
+    //! \param from const Array<const Term*>&  - start terms
+    //! \param to TermSet&  - resulting terms
+    //! \return bool  - whether the evaluation is completed, otherwise the memory is insufficient
+	bool evaluate(const PropertyPath& path, unsigned node, bool inverse,
+		const Array<const Term*>& from, TermSet& to);
+    //! \brief Add the terms linked to the term by the predicate
+    //!
+    //! \param anchor=nullptr Key*  - key to be set to the dataset terms of the first link
+    //! \return bool  - whether the terms are added, otherwise the memory is insufficient
+	bool step(const Term& term, const Term& predicate, bool inverse, TermSet& to, Key* anchor=nullptr);
+    //! \brief Add the memoized transitive closure of the predicate from the start term
+    //! \return bool  - whether the closure is added, otherwise the memory is insufficient
+	bool closure(const Term& start, const Term& predicate, bool inverse, TermSet& to);
+    //! \brief Advance the versions of the predicates of the quads stored since the last call,
+    //! 	releasing all closures if the dataset is modified otherwise
+	void sync();
+    //! \brief Current version of the predicate
+	unsigned version(const Term& predicate) const
+		{ const unsigned* ver = _versions.find(&predicate); return ver ? *ver : 0; }
+private:
+	typedef Hashmap<Key, Closure, KeyHash>  Closures;
+	typedef Hashmap<const Term*, unsigned, ContentHash<const Term*> >  Versions;
+
+	Dataset& _dataset;
+	Closures _closures;
+	Versions _versions;  //!< Numbers of the observed quads by their predicates
+	unsigned _observed;  //!< Number of the observed quads of the quads stack
+	unsigned _epoch;  //!< Modification epoch of the dataset the closures are memoized in
+};
+
+}  // smallrdf
+
+#endif  // PROPERTYPATH_H_
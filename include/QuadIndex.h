@@ -0,0 +1,131 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef QUADINDEX_H_
+#define QUADINDEX_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+//! \brief Index of the quads with interned terms
+//!
+//! The quads are kept in the sorted permutations (SPOG, POSG, OSPG, PSOG), ordered by
+//! the addresses of their terms, so the quads matching any combination of the bound
+//! subject, predicate and object form a contiguous range of one of the permutations,
+//! which is sorted by the following field (see sorted()) for the merge joins.
+//! The added and removed quads are buffered and merged into the permutations on the first
+//! lookup, which amortizes the maintenance for the bulk insertions and removals.
+//! \note The terms are compared by their pointers, so all quads and patterns should
+//! 	refer the terms interned in a single Document
+class QuadIndex {
+public:
+	//! \brief Orders of the quad fields in the permutations
+	enum Order {
+		SPOG,
+		POSG,
+		OSPG,
+		PSOG,  //!< Subjects of a predicate, which are joined in the star patterns
+		ORDERS  //!< Number of the orders
+	};
+
+	//! \brief Range of the quads in a permutation
+	struct Range {
+		const Quad* const* beg;
+		const Quad* const* end;
+		Order order;
+
+		unsigned length() const
+			{ return end - beg; }
+	};
+
+	//! \brief Quad field by its index: subject, predicate, object, graph
+	static const Term* field(const Quad& quad, unsigned i)
+		{ return quad.*FIELDS[i]; }
+	//! \brief Indices of the quad fields in the order
+	static const uint8_t* fields(Order order)
+		{ return ORDER_FIELDS[order]; }
+
+	QuadIndex();
+#if __cplusplus >= 201103L
+	QuadIndex(const QuadIndex&)=delete;
+	QuadIndex& operator=(const QuadIndex&)=delete;
+#endif // __cplusplus 11+
+	~QuadIndex();
+
+	//! \brief Number of the indexed quads, accounting the buffered ones
+	unsigned length() const
+		{ return _perms[SPOG].length() + _pending.length() - _removed.length(); }
+    //! \brief Add the quad to the index
+    //! \note The quad should outlive the index
+    //!
+    //! \param quad const Quad*  - quad to be indexed
+    //! \return bool  - whether the quad is added, otherwise the memory is insufficient
+	bool add(const Quad* quad);
+    //! \brief Remove the quad from the index
+    //! \note The removal is merged on the next lookup, so the selected ranges remain valid
+    //! 	and the quad should outlive the merge
+    //!
+    //! \param quad const Quad*  - indexed quad
+    //! \return bool  - whether the quad is removed, otherwise the memory is insufficient
+	bool remove(const Quad* quad);
+	void clear();
+    //! \brief Merge the buffered quads into the permutations
+    //! \note The removals are merged first and never fail
+    //!
+    //! \return bool  - whether the added quads are merged, otherwise the memory is insufficient
+	bool flush();
+
+    //! \brief Select the range of the quads matching the bound fields
+    //! \note The range is constrained by the longest prefix of the bound fields in
+    //! 	the permutation order, so the remaining bound fields should be filtered
+    //!
+    //! \param pattern const Term* const[4]  - interned terms of the subject, predicate,
+    //! 	object and graph, nullptr denotes any term
+    //! \param range Range&  - resulting range in the most selective permutation
+    //! \return bool  - whether the range is selected, otherwise the memory is insufficient
+	bool range(const Term* const pattern[4], Range& range);
+    //! \brief Permutation having the longest prefix of the bound fields
+    //!
+    //! \param pattern const Term* const[4]  - terms, nullptr denotes an unbound field
+    //! \return Order  - the most selective permutation for the pattern
+	static Order order(const Term* const pattern[4]);
+    //! \brief Select the range of the quads matching the bound fields in the permutation
+    //!
+    //! \param order Order  - permutation order
+    //! \param pattern const Term* const[4]  - interned terms, nullptr denotes any term
+    //! \param range Range&  - resulting range
+    //! \return bool  - whether the range is selected, otherwise the memory is insufficient
+	bool range(Order order, const Term* const pattern[4], Range& range);
+    //! \brief Select the range of the quads matching the bound fields sorted by the field
+    //!
+    //! \param pattern const Term* const[4]  - interned terms, nullptr denotes any term;
+    //! 	the graph is not constrained by the range
+    //! \param field unsigned  - unbound field (subject, predicate or object) to sort the range by
+    //! \param range Range&  - resulting range
+    //! \return bool  - whether the range is selected, otherwise none of the permutations
+    //! 	is sorted by the field after the bound fields or the memory is insufficient
+	bool sorted(const Term* const pattern[4], unsigned field, Range& range);
+
+    //! \brief Whether the quad fits the bound fields of the pattern
+	static bool fits(const Quad& quad, const Term* const pattern[4]);
+    //! \brief Whether all quads of the range fit the pattern, i.e. the bound fields
+    //! 	of the pattern form the key of the range
+    //!
+    //! \param range const Range&  - range selected for the pattern
+    //! \param pattern const Term* const[4]  - interned terms, nullptr denotes any term
+    //! \return bool  - whether the range length is the number of the matching quads
+	static bool exact(const Range& range, const Term* const pattern[4]);
+private:
+	static const Term* const Quad::* const  FIELDS[4];
+	static const uint8_t  ORDER_FIELDS[ORDERS][4];
+
+	Array<const Quad*> _perms[ORDERS];
+	Array<const Quad*> _pending;  //!< Quads being merged into the permutations
+	Hashset<const Quad*> _removed;  //!< Quads being removed from the permutations
+};
+
+}  // smallrdf
+
+#endif  // QUADINDEX_H_
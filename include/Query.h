@@ -0,0 +1,373 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef QUERY_H_
+#define QUERY_H_
+
+#include "QuadIndex.h"
+#include "ValueIndex.h"
+
+
+namespace smallrdf {
+
+class TaskPool;
+
+//! \brief Solutions of a query: rows of the values bound to the variables
+class Solutions {
+public:
+	static const unsigned  NONE = ~0u;
+
+	Solutions();
+#if __cplusplus >= 201103L
+	Solutions(Solutions&&)=default;
+	Solutions(const Solutions&)=delete;
+	Solutions& operator=(const Solutions&)=delete;
+#endif // __cplusplus 11+
+
+    //! \brief Reset the solutions to the columns of the variables
+    //!
+    //! \param variables const Variable* const*  - variables of the columns
+    //! \param num unsigned  - number of the variables
+    //! \return bool  - whether the columns are allocated, otherwise the memory is insufficient
+	bool reset(const Variable* const* variables, unsigned num);
+    //! \brief Append the row
+    //!
+    //! \param values const Term* const*  - values of the variables, nullptr denotes an unbound variable
+    //! \return bool  - whether the row is appended, otherwise the memory is insufficient
+	bool add(const Term* const* values);
+    //! \brief Remove the last row
+	void pop()
+		{ assert(_length && "Popping empty solutions"); _values.resize(_values.length() - width()); --_length; }
+    //! \brief Remove the rows retaining the columns
+	void clear()
+		{ _values.clear(); _length = 0; }
+
+	//! \brief Number of the variables
+	unsigned width() const
+		{ return _variables.length(); }
+	//! \brief Number of the rows
+	unsigned length() const
+		{ return _length; }
+	const Variable* variable(unsigned column) const
+		{ return _variables[column]; }
+    //! \brief Column of the variable
+    //!
+    //! \param var const Variable*  - variable
+    //! \return unsigned  - column index or NONE if the variable is absent
+	unsigned column(const Variable* var) const;
+
+	//! \brief Values of the row
+	const Term* const* row(unsigned i) const
+		{ return _values.begin() + i * width(); }
+	//! \brief Value of the variable in the row; nullptr if the variable is unbound or absent
+	const Term* value(unsigned row, const Variable* var) const;
+private:
+	Array<const Variable*> _variables;
+	Array<const Term*> _values;  //!< Rows of the values
+	unsigned _length;
+};
+
+//! \brief Basic graph pattern: a conjunction of the quad patterns with variables
+//!
+//! The patterns are joined by the nested index lookups (Dataset::visit) in the order
+//! starting from the most selective patterns and following the bound variables.
+//! The selectivity is estimated by the dataset statistics when they are available,
+//! otherwise by the bound fields of the patterns. The variables constrained to the value
+//! ranges are bound only to the values within them, which are looked up by the range scans
+//! (see Dataset::visit) for the patterns having them as the unbound objects.
+class BasicGraphPattern {
+public:
+	static const unsigned  NONE = ~0u;
+
+	BasicGraphPattern();
+#if __cplusplus >= 201103L
+	BasicGraphPattern(BasicGraphPattern&&)=default;
+	BasicGraphPattern(const BasicGraphPattern&)=delete;
+	BasicGraphPattern& operator=(const BasicGraphPattern&)=delete;
+#endif // __cplusplus 11+
+	~BasicGraphPattern();
+
+    //! \brief Add the quad pattern
+    //! \note The terms should outlive the pattern
+    //!
+    //! \param subject const Term&  - subject, may be a Variable
+    //! \param predicate const Term&  - predicate, may be a Variable
+    //! \param object const Term&  - object, may be a Variable
+    //! \param graph=nullptr const Term*  - graph, may be a Variable; nullptr denotes any graph
+    //! \return bool  - whether the pattern is added, otherwise the memory is insufficient
+	bool add(const Term& subject, const Term& predicate, const Term& object,
+		const Term* graph=nullptr);
+	void clear();
+
+	//! \brief Number of the quad patterns
+	unsigned length() const
+		{ return _patterns.length(); }
+	const Quad& pattern(unsigned i) const
+		{ return _patterns[i]; }
+	//! \brief Number of the variables
+	unsigned width() const
+		{ return _variables.length(); }
+	//! \brief Variables in the order of their occurrence
+	const Variable* variable(unsigned i) const
+		{ return _variables[i]; }
+	const Variable* const* variables() const
+		{ return _variables.begin(); }
+    //! \brief Index of the variable
+    //! \return unsigned  - index of the variable or NONE if it is absent
+	unsigned variable(const Variable* var) const;
+    //! \brief Variable index of the pattern field
+    //!
+    //! \param i unsigned  - pattern index
+    //! \param field unsigned  - field index: subject, predicate, object, graph
+    //! \return unsigned  - variable index; NONE for the constants and the any graph
+	unsigned slot(unsigned i, unsigned field) const
+		{ return _slots[i * 4 + field]; }
+    //! \brief Constrain the values of the variable to the range, intersecting the former one
+    //!
+    //! \param var const Variable*  - variable of the patterns
+    //! \param range const ValueRange&  - range of the values
+    //! \return bool  - whether the constraint is added, otherwise the variable is absent
+    //! 	or the memory is insufficient
+	bool constrain(const Variable* var, const ValueRange& range);
+    //! \brief Value range of the variable
+    //!
+    //! \param var unsigned  - variable index
+    //! \return const ValueRange*  - range; nullptr if the variable is not constrained
+	const ValueRange* constraint(unsigned var) const;
+
+    //! \brief Plan the join order of the patterns
+    //!
+    //! \param order Array<unsigned>&  - resulting indices of the patterns in the evaluation order
+    //! \param statistics=nullptr const Statistics*  - statistics of the queried dataset
+    //! \param bound=nullptr const uint8_t*  - whether each variable is bound in advance
+    //! 	(see the bindings of evaluate()); nullptr if none of them is bound
+    //! \return bool  - whether the order is planned, otherwise the memory is insufficient
+	bool plan(Array<unsigned>& order, const Statistics* statistics=nullptr,
+		const uint8_t* bound=nullptr) const;
+    //! \brief Evaluate the pattern on the dataset
+    //!
+    //! \param dataset Dataset&  - queried dataset
+    //! \param solutions Solutions&  - resulting bindings of the variables, replacing the former content
+    //! \return bool  - whether the evaluation is completed, otherwise the memory is insufficient
+	bool evaluate(Dataset& dataset, Solutions& solutions) const;
+    //! \brief Evaluate the pattern on the dataset in the specified join order
+    //!
+    //! \param dataset Dataset&  - queried dataset
+    //! \param order const Array<unsigned>&  - join order of the patterns (see plan())
+    //! \param solutions Solutions&  - resulting bindings of the variables, replacing the former content
+    //! \param bindings=nullptr const Term* const*  - values of the variables bound in advance,
+    //! 	nullptr denotes an unbound variable; the bound values are retained in the solutions
+    //! \return bool  - whether the evaluation is completed, otherwise the memory is insufficient
+	bool evaluate(Dataset& dataset, const Array<unsigned>& order, Solutions& solutions,
+		const Term* const* bindings=nullptr) const;
+protected:
+    //! \brief Selectivity rank of the pattern, lower ranks are more selective
+    //!
+    //! \param i unsigned  - pattern index
+    //! \param bound const uint8_t*  - whether each variable is bound by the preceding patterns
+    //! \return unsigned  - rank of the pattern
+	unsigned rank(unsigned i, const uint8_t* bound) const;
+    //! \brief Estimated number of the quads matching the pattern
+    //!
+    //! \param i unsigned  - pattern index
+    //! \param bound const uint8_t*  - whether each variable is bound by the preceding patterns
+    //! \param statistics const Statistics&  - statistics of the queried dataset
+    //! \return double  - estimated cardinality of the pattern per the bindings
+	double cost(unsigned i, const uint8_t* bound, const Statistics& statistics) const;
+private:
+	//! \brief Value range of a variable
+	struct Constraint {
+		unsigned var;  //!< Variable index
+		ValueRange range;
+	};
+
+	Array<Quad> _patterns;
+	Array<const Variable*> _variables;
+	Array<unsigned> _slots;  //!< Variable indices of the pattern fields
+	Array<Constraint> _constraints;
+};
+
+//! \brief Basic graph pattern prepared for the repeated evaluation on a document
+//!
+//! The constants are resolved to the interned terms of the document, the join order
+//! is planned once and the index permutation of each pattern is fixed, so the executions
+//! look up the index ranges directly. The parameters are the variables bound to
+//! the arguments of each execution. The constants are resolved again once the document
+//! is modified, since the released terms (see Document::reclaim()) may be stored anew.
+//! \note The document and the pattern should outlive the prepared query
+class PreparedQuery {
+public:
+	PreparedQuery();
+#if __cplusplus >= 201103L
+	PreparedQuery(const PreparedQuery&)=delete;
+	PreparedQuery& operator=(const PreparedQuery&)=delete;
+#endif // __cplusplus 11+
+	~PreparedQuery();
+
+    //! \brief Prepare the pattern, replacing the former one
+    //!
+    //! \param doc Document&  - queried document
+    //! \param bgp const BasicGraphPattern&  - pattern
+    //! \param params=nullptr const Variable* const*  - variables of the pattern bound on the execution
+    //! \param num=0 unsigned  - number of the parameters
+    //! \return bool  - whether the query is prepared, otherwise a parameter is absent
+    //! 	in the pattern or the memory is insufficient
+	bool prepare(Document& doc, const BasicGraphPattern& bgp,
+		const Variable* const* params=nullptr, unsigned num=0);
+	void clear();
+
+	//! \brief Number of the parameters
+	unsigned parameters() const
+		{ return _params.length(); }
+	//! \brief Prepared pattern; nullptr if the query is not prepared
+	const BasicGraphPattern* pattern() const
+		{ return _bgp; }
+
+    //! \brief Execute the query
+    //!
+    //! \param args const Term* const*  - values of the parameters, terms of any document
+    //! \param solutions Solutions&  - resulting bindings of the pattern variables,
+    //! 	replacing the former content
+    //! \return bool  - whether the execution is completed, otherwise the memory is insufficient
+	bool execute(const Term* const* args, Solutions& solutions);
+#ifdef SMALLRDF_THREADS
+    //! \brief Execute the query by the workers of the pool
+    //! \note The large index ranges of the scans and the join probes are split into the tasks
+    //! 	executed by any worker, while the small ones are joined by the calling thread,
+    //! 	so the point lookups are not handed over. The order of the solutions is unspecified
+    //!
+    //! \param pool TaskPool&  - pool of the workers
+    //! \param args const Term* const*  - values of the parameters, terms of any document
+    //! \param solutions Solutions&  - resulting bindings of the pattern variables,
+    //! 	replacing the former content
+    //! \return bool  - whether the execution is completed, otherwise the memory is insufficient
+	bool execute(TaskPool& pool, const Term* const* args, Solutions& solutions);
+#endif  // SMALLRDF_THREADS
+protected:
+	//! \brief Pattern in the join order
+	struct Step {
+		const Term* terms[4];  //!< Interned constants, nullptr for the variables and the absent terms
+		unsigned slots[4];  //!< Variable indices of the fields
+		unsigned pattern;  //!< Index of the pattern
+		QuadIndex::Order order;  //!< Permutation of the lookups
+	};
+
+	struct Execution;
+	struct Parallel;
+	struct Scan;
+
+    //! \brief Resolve the constants to the interned terms
+    //! \return bool  - whether all constants are present in the document
+	bool resolve();
+    //! \brief Execute the query sequentially or by the workers of the pool
+    //!
+    //! \param pool TaskPool*  - pool of the workers; nullptr for the sequential execution
+    //! \param args const Term* const*  - values of the parameters
+    //! \param solutions Solutions&  - resulting bindings of the pattern variables
+    //! \return bool  - whether the execution is completed, otherwise the memory is insufficient
+	bool execute(TaskPool* pool, const Term* const* args, Solutions& solutions);
+private:
+	Document* _doc;
+	const BasicGraphPattern* _bgp;
+	Array<Step> _steps;
+	Array<unsigned> _params;  //!< Variable indices of the parameters
+	Array<const Term*> _values;  //!< Values of the variables during the execution
+	unsigned _epoch;  //!< Modification epoch of the document on the resolution
+	bool _resolved;  //!< All constants are interned
+};
+
+//! \brief LRU cache of the prepared queries keyed by their text
+//!
+//! The request handlers issuing the same queries reuse their plans instead of compiling
+//! and planning them again. The texts are compiled to the basic graph patterns by
+//! the compiler of the query language (e.g. SparqlCompiler), so the cache is available
+//! without the SPARQL support.
+//! \note The document and the compiler should outlive the cache
+class QueryCache {
+public:
+	static const unsigned  NONE = ~0u;
+
+	//! \brief Compiler of the query texts
+	class Compiler {
+	public:
+		virtual ~Compiler();
+
+	    //! \brief Compile the query text to the basic graph pattern
+	    //!
+	    //! \param text const String&  - query text
+	    //! \param terms Document&  - document owning the terms of the pattern
+	    //! \param bgp BasicGraphPattern&  - resulting pattern
+	    //! \param params Array<const Variable*>&  - resulting parameters of the pattern
+	    //! \return bool  - whether the text is compiled, otherwise it is malformed,
+	    //! 	unsupported or the memory is insufficient
+		virtual bool compile(const String& text, Document& terms, BasicGraphPattern& bgp,
+			Array<const Variable*>& params)=0;
+	};
+
+    //! \brief Create the cache
+    //!
+    //! \param doc Document&  - queried document
+    //! \param compiler Compiler&  - compiler of the query texts
+    //! \param capacity=16 unsigned  - maximal number of the cached queries, positive
+	QueryCache(Document& doc, Compiler& compiler, unsigned capacity=16);
+#if __cplusplus >= 201103L
+	QueryCache(const QueryCache&)=delete;
+	QueryCache& operator=(const QueryCache&)=delete;
+#endif // __cplusplus 11+
+	~QueryCache();
+
+    //! \brief Prepared query of the text, compiled on a miss evicting the least recently used one
+    //!
+    //! \param text const String&  - query text
+    //! \return PreparedQuery*  - prepared query, valid until it is evicted; nullptr if
+    //! 	the text is not compiled or the memory is insufficient
+	PreparedQuery* query(const String& text);
+	void clear();
+
+	//! \brief Number of the cached queries
+	unsigned length() const
+		{ return _index.length(); }
+	unsigned capacity() const
+		{ return _capacity; }
+	//! \brief Number of the queries taken from the cache
+	unsigned long hits() const
+		{ return _hits; }
+	//! \brief Number of the compiled queries
+	unsigned long misses() const
+		{ return _misses; }
+protected:
+	//! \brief Compiled query owning its terms and pattern
+	struct Plan;
+
+	//! \brief Cached query in the recency list
+	struct Entry {
+		String* text;  //!< Owned copy of the query text
+		Plan* plan;
+		unsigned prev;  //!< More recently used entry or NONE
+		unsigned next;  //!< Less recently used entry or NONE
+	};
+
+    //! \brief Compile and prepare the query
+    //! \return Plan*  - prepared plan; nullptr if the text is not compiled or the memory is insufficient
+	Plan* compile(const String& text);
+    //! \brief Exclude the entry from the recency list
+	void unlink(unsigned i);
+    //! \brief Make the entry the most recently used one
+	void link(unsigned i);
+private:
+	typedef Hashmap<const String*, unsigned, ContentHash<const String*> >  Index;
+
+	Document& _doc;
+	Compiler& _compiler;
+	Index _index;  //!< Entries by the query texts
+	Array<Entry> _entries;
+	unsigned _head;  //!< Most recently used entry or NONE
+	unsigned _tail;  //!< Least recently used entry or NONE
+	unsigned _capacity;
+	unsigned long _hits;
+	unsigned long _misses;
+};
+
+}  // smallrdf
+
+#endif  // QUERY_H_
@@ -17,6 +17,21 @@ typedef String  AString;  // Arduino String
 }  // arddefs
 #endif  // ARDUINO
 
+// Multithreading is available only on hosted platforms, where it can be also disabled explicitly
+#if !defined(ARDUINO) && !defined(SMALLRDF_NO_THREADS) && __cplusplus >= 201103L
+#define SMALLRDF_THREADS
+#endif  // SMALLRDF_THREADS
+
+// Coroutines are available for the C++20 compilers supporting them, and can be also disabled explicitly
+#if !defined(SMALLRDF_NO_COROUTINES) && __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+#define SMALLRDF_COROUTINES
+#endif  // SMALLRDF_COROUTINES
+
+// SPARQL queries are excluded from the Arduino builds to save the flash, and can be also disabled explicitly
+#if !defined(ARDUINO) && !defined(SMALLRDF_NO_SPARQL)
+#define SMALLRDF_SPARQL
+#endif  // SMALLRDF_SPARQL
+
 #include "Container.hpp"
 #include "RDF.h"
 
@@ -132,6 +147,9 @@ public:
 	bool operator==(const String& other) const;
 	bool operator!=(const String& other) const
 		{ return !operator==(other); }
+	//! \brief Hash of the string content
+	uint32_t hash() const
+		{ return hashData(_data, length()); }
 
 	bool allocated() const
 		{ return _allocated; }
@@ -168,6 +186,9 @@ public:
 		{ return kind == other.kind && *value == *other.value; }
 	virtual bool operator!=(const Term& other) const final
 		{ return !operator==(other); }
+	//! \brief Hash of the term content, consistent with operator==
+	virtual uint32_t hash() const
+		{ return value->hash() ^ kind; }
 };
 
 class NamedNode: public Term {
@@ -208,6 +229,7 @@ public:
 	Literal& operator=(const Literal&)=default;
 
 	bool operator==(const Term& other) const override;
+	uint32_t hash() const override;
 };
 
 class BlankNode: public Term {
@@ -227,6 +249,24 @@ public:
 	BlankNode& operator=(const BlankNode&)=default;
 };
 
+//! \brief Variable of the query patterns, which is not stored in the datasets
+class Variable: public Term {
+public:
+	explicit Variable(const String& name);
+#if __cplusplus >= 201103L
+	Variable(Variable&&)=default;
+#endif // __cplusplus 11+
+	//! \brief Copy constructor
+	//! \note Is used because the object does not hold the ownership of its members,
+	//! 	allowing to copy their pointers
+	Variable(const Variable&)=default;
+
+#if __cplusplus >= 201103L
+	Variable& operator=(Variable&&)=default;
+#endif // __cplusplus 11+
+	Variable& operator=(const Variable&)=default;
+};
+
 //! \brief A quad, which does not owns its members
 class Quad {
 public:
@@ -263,27 +303,266 @@ public:
 				const Term* object = nullptr, const Term* graph = nullptr) const;
 };
 
+//! \brief Visitor of the quads
+class QuadVisitor {
+public:
+	virtual ~QuadVisitor()  {}
+
+    //! \brief Visit the quad
+    //!
+    //! \param quad const Quad&  - visiting quad
+    //! \return bool  - whether to continue the visiting
+	virtual bool operator()(const Quad& quad)=0;
+};
+
+//! \brief Observer of the quads stored and removed by the document (see Document::observe)
+class QuadObserver: public QuadVisitor {
+public:
+    //! \brief Notify of the removed quad
+    //! \note The removed quad is retained as a tombstone till the compaction,
+    //! 	so the observer should release its pointer beforehand
+    //!
+    //! \param quad const Quad&  - removed quad
+	virtual void removed(const Quad& quad)=0;
+};
+
+//! \brief IRI prefixes constraining the subjects and objects of the quads
+struct IriPrefix {
+	const String* subject;  //!< Prefix of the subject IRI, nullptr if it is unconstrained
+	const String* object;  //!< Prefix of the object IRI, nullptr if it is unconstrained
+
+	explicit IriPrefix(const String* subj=nullptr, const String* obj=nullptr)
+		: subject(subj), object(obj)  {}
+
+    //! \brief Whether the term is a named node having the IRI prefix
+	static bool matches(const Term& term, const String& prefix);
+    //! \brief Whether the constrained terms of the quad are named nodes having the prefixes
+	bool matches(const Quad& quad) const
+		{ return (!subject || matches(*quad.subject, *subject)) && (!object || matches(*quad.object, *object)); }
+};
+
+class Statistics;
+struct ValueRange;
+
 //! \brief Main interface for the Quad/Triplesotre
 class Dataset {
 public:
+	//! Share of the removed quads (1 / COMPACT_RATIO) triggering the compaction
+	static const unsigned  COMPACT_RATIO = 4;
+
 	typedef Stack<Quad>  Quads;
-	Quads quads;  //!< Actual Quad/Triplestore
+	Quads quads;  //!< Actual Quad/Triplestore, including the removed quads till the compaction
 
+	Dataset()
+		: quads(), _removed(), _epoch(0)  {}
 	virtual ~Dataset()  {}
 
-	Quad* find(const Quad& quad);
-	Quads match(const Term* subject = nullptr, const Term* predicate = nullptr,
+	//! \brief Number of the stored quads excluding the removed ones
+	virtual unsigned length() const
+		{ return quads.length() - removals(); }
+    //! \brief Visit all stored quads excluding the removed ones, without building any index
+    //! \note The derived datasets storing their quads elsewhere than in the quads stack
+    //! 	override it, so the generic serializers and builders should traverse the dataset
+    //! 	rather than the quads stack
+    //!
+    //! \param visitor QuadVisitor&  - visitor of the quads
+    //! \return bool  - whether all quads are visited, otherwise the visitor stopped
+	virtual bool traverse(QuadVisitor& visitor) const;
+	virtual Quad* find(const Quad& quad);
+	virtual Quads match(const Term* subject = nullptr, const Term* predicate = nullptr,
 				const Term* object = nullptr, const Term* graph = nullptr);
+    //! \brief Copy the quads matching the pattern, whose subjects and objects have the IRI prefixes
+    //!
+    //! \param pattern const Quad&  - pattern, where nullptr terms denote any term
+    //! \param prefix const IriPrefix&  - IRI prefixes of the subject and object
+    //! \return Quads  - matching quads
+	Quads match(const Quad& pattern, const IriPrefix& prefix);
+    //! \brief Visit the quads matching the pattern without copying them
+    //!
+    //! \param pattern const Quad&  - pattern, where nullptr terms denote any term
+    //! \param visitor QuadVisitor&  - visitor of the matching quads
+    //! \return bool  - whether all matching quads are visited, otherwise the visitor stopped
+	virtual bool visit(const Quad& pattern, QuadVisitor& visitor);
+    //! \brief Visit the quads matching the pattern, whose objects have the values within the range
+    //!
+    //! \param pattern const Quad&  - pattern, where nullptr terms denote any term;
+    //! 	the object is expected to be unbound
+    //! \param range const ValueRange&  - range of the object values (see ValueIndex.h)
+    //! \param visitor QuadVisitor&  - visitor of the matching quads
+    //! \return bool  - whether all matching quads are visited, otherwise the visitor stopped
+	virtual bool visit(const Quad& pattern, const ValueRange& range, QuadVisitor& visitor);
+    //! \brief Visit the quads matching the pattern, whose subjects and objects have the IRI prefixes
+    //!
+    //! \param pattern const Quad&  - pattern, where nullptr terms denote any term
+    //! \param prefix const IriPrefix&  - IRI prefixes of the subject and object
+    //! \param visitor QuadVisitor&  - visitor of the matching quads
+    //! \return bool  - whether all matching quads are visited, otherwise the visitor stopped
+	virtual bool visit(const Quad& pattern, const IriPrefix& prefix, QuadVisitor& visitor);
+    //! \brief Number of the quads matching the pattern, without copying them
+    //!
+    //! \param pattern const Quad&  - pattern, where nullptr terms denote any term
+    //! \return unsigned  - number of the matching quads
+	virtual unsigned count(const Quad& pattern);
+    //! \brief Whether any quad matches the pattern, stopping at the first match
+    //!
+    //! \param pattern const Quad&  - pattern, where nullptr terms denote any term
+    //! \return bool  - whether a matching quad exists
+	virtual bool exists(const Quad& pattern);
+    //! \brief Cardinality statistics of the quads
+    //!
+    //! \return const Statistics*  - statistics; nullptr if they are not maintained
+	virtual const Statistics* statistics()
+		{ return nullptr; }
+    //! \brief Remove the quads matching the pattern
+    //!
+    //! The removed quads become tombstones, which are skipped by the lookups and retained
+    //! in the quads till the compaction, performed once they form 1 / COMPACT_RATIO of the quads.
+    //! \param pattern const Quad&  - pattern, where nullptr terms denote any term
+    //! \return unsigned  - number of the removed quads; the remaining matches are retained
+    //! 	if the memory is insufficient for their tombstones
+	virtual unsigned remove(const Quad& pattern);
+    //! \brief Whether the quad is removed, so the traversals of the quads should skip it
+	bool removed(const Quad& quad) const
+		{ return _removed.length() && _removed.find(&quad); }
+	//! \brief Number of the removed quads retained till the compaction
+	unsigned removals() const
+		{ return _removed.length(); }
+    //! \brief Release the removed quads
+    //! \attention The pointers to the removed quads become invalid
+	virtual void compact();
+    //! \brief Modification epoch, which is advanced by each change of the quads,
+    //! 	so the results derived from the quads can be validated by it
+    //! \note The quads added to the stack directly advance the epoch as well
+	unsigned epoch() const
+		{ return _epoch + quads.length(); }
+    //! \brief Epoch of the modifications besides the extensions of the quads (e.g. the removals,
+    //! 	compaction and reclamation), which might release the quads and terms
+	unsigned modifications() const
+		{ return _epoch; }
+protected:
+    //! \brief Advance the epoch on the modification, which does not extend the quads
+    //!
+    //! \param released=0 unsigned  - number of the quads released from the stack
+	void modified(unsigned released=0)
+		{ _epoch += released + 1; }
+
+	Hashset<const Quad*> _removed;  //!< Tombstones of the removed quads
+	unsigned _epoch;  //!< Epoch of the modifications besides the extensions of the quads
 };
 
+//! \brief Visitor fetching the first quad
+struct QuadFinder: QuadVisitor {
+	Quad* quad;  //!< Found quad; nullptr if there are no matches
+
+	QuadFinder()
+		: quad(nullptr)  {}
+#if __cplusplus >= 201103L
+	QuadFinder(const QuadFinder&)=delete;
+	QuadFinder& operator=(const QuadFinder&)=delete;
+#endif // __cplusplus 11+
+
+	bool operator()(const Quad& q) override
+		{ quad = const_cast<Quad*>(&q); return false; }
+};
+
+//! \brief Collector of the quad copies, which stops if the memory is insufficient
+struct QuadCopies: QuadVisitor {
+	Dataset::Quads& quads;
+
+	explicit QuadCopies(Dataset::Quads& matches)
+		: quads(matches)  {}
+
+	bool operator()(const Quad& q) override
+		{ return quads.add(q) != nullptr; }
+};
+
+//! \brief Collector of the quad pointers, which stops if the memory is insufficient
+struct QuadRefs: QuadVisitor {
+	Array<const Quad*>& quads;
+	bool failed;  //!< Whether the memory is insufficient
+
+	explicit QuadRefs(Array<const Quad*>& refs)
+		: quads(refs), failed(false)  {}
+
+	bool operator()(const Quad& q) override
+		{ return !(failed = !quads.add(&q)); }
+};
+
+//! \brief Group of the quad insertions and removals staged for the atomic commit
+//! into a document (see Document::commit)
+//! \note The staged quads and patterns refer the terms of any document, which should
+//! 	outlive the commit
+class Changeset {
+public:
+	Array<Quad> inserts;  //!< Quads to be stored, nullptr graph denotes the default graph
+	Array<Quad> removals;  //!< Patterns of the removed quads, nullptr terms denote any term
+
+	Changeset()
+		: inserts(), removals()  {}
+
+    //! \brief Stage the insertion of the quad
+    //! \return bool  - whether the quad is staged, otherwise the memory is insufficient
+	bool insert(const Quad& quad)
+		{ return inserts.add(quad); }
+    //! \brief Stage the removal of the quads matching the pattern
+    //! \return bool  - whether the pattern is staged, otherwise the memory is insufficient
+	bool remove(const Quad& pattern)
+		{ return removals.add(pattern); }
+	//! \brief Whether no changes are staged
+	bool empty() const
+		{ return !inserts.length() && !removals.length(); }
+	//! \brief Discard the staged changes
+	void clear()
+		{ inserts.clear(); removals.clear(); }
+};
+
+class QuadIndex;
+class ValueIndex;
+class TextIndex;
+class IriIndex;
+class LangIndex;
+class JoinCursor;
+
 //! \brief RDF document, which owns all the stored objects, becoming a session memory manager
+//! \note Strings and terms are interned, so equal objects are stored once
+//! 	and can be compared by their pointers. The quads are indexed on the first lookup
+//! 	(see QuadIndex), so they should refer the terms of this document
 class Document: public Dataset {
 	typedef Stack<String>  Strings;
 	Strings _strings;
 
-	typedef Stack<Term>  Terms;
-	Terms _terms;
+	// Note: terms of each kind are stored separately to retain their content
+	typedef Stack<NamedNode>  NamedNodes;
+	NamedNodes _namedNodes;
+	typedef Stack<Literal>  Literals;
+	Literals _literals;
+	typedef Stack<BlankNode>  BlankNodes;
+	BlankNodes _blankNodes;
+	typedef Stack<Variable>  Variables;
+	Variables _variables;
+
+	// Interning indices of the stored objects by their content
+	typedef Hashset<const String*, ContentHash<const String*> >  StringIndex;
+	StringIndex _stringIndex;
+	typedef Hashset<const Term*, ContentHash<const Term*> >  TermIndex;
+	TermIndex _termIndex;
+
+	QuadIndex* _quadIndex;  //!< Index of the quads, created on the first lookup
+	ValueIndex* _valueIndex;  //!< Index of the object values, created on the first range lookup
+	TextIndex* _textIndex;  //!< Index of the literal values, created on the first text lookup
+	IriIndex* _iriIndex;  //!< Index of the named nodes, created on the first prefix lookup
+	LangIndex* _langIndex;  //!< Index of the language-tagged literals, created on the first localized lookup
+	Statistics* _statistics;  //!< Statistics of the quads, created on the first request
+	QuadObserver* _observer;  //!< Observer of the stored and removed quads
+	Hashmap<const Term*, unsigned> _pins;  //!< Numbers of the holders of the terms retained by reclaim()
 public:
+	Document();
+#if __cplusplus >= 201103L
+	Document(const Document&)=delete;
+	Document& operator=(const Document&)=delete;
+#endif // __cplusplus 11+
+	~Document();
+
     //! \brief Transfer ownership of the str to the document
     //!
     //! \param str String*  - original string/view, becoming a view by transferring
@@ -298,11 +577,188 @@ public:
 	const Literal* literal(const String& value, const String* lang=nullptr,
 						   const String* dtyoe=nullptr);
 	const BlankNode* blankNode(const String& value);
+	const Variable* variable(const String& name);
+    //! \brief Store the quad of the terms of this document
+    //!
+    //! \param subject const Term&  - subject
+    //! \param predicate const Term&  - predicate
+    //! \param object const Term&  - object
+    //! \param graph=nullptr const Term*  - graph, nullptr denotes the default graph
+    //! \return const Quad*  - stored quad; nullptr if the memory is insufficient
 	const Quad* quad(const Term& subject, const Term& predicate,
 					   const Term& object, const Term* graph = nullptr);
+    //! \brief Intern the term of any document, copying its strings when they are absent
+    //!
+    //! \param term const Term&  - term, e.g. a view of the parsed values
+    //! \return const Term*  - stored term; nullptr if the memory is insufficient
+	const Term* intern(const Term& term);
+    //! \brief Store the batch of the quads skipping the duplicates
+    //!
+    //! The terms are interned once per distinct term object of the batch, the interned quads
+    //! are sorted to drop the repeated ones and looked up in the quad index synchronized once
+    //! per batch, so the index merges the new quads on the next lookup at once.
+    //! \note The observer and the statistics are notified of each stored quad as in quad()
+    //!
+    //! \param batch const Quad*  - quads of the terms of any document, nullptr graph
+    //! 	denotes the default graph
+    //! \param num unsigned  - number of the quads
+    //! \param failed=nullptr bool*  - whether the memory is insufficient, so a part
+    //! 	of the batch is stored
+    //! \return unsigned  - number of the stored quads, which were absent in the document
+	unsigned insert(const Quad* batch, unsigned num, bool* failed=nullptr);
+    //! \brief Apply the staged changes atomically, so no lookup observes a part of them
+    //!
+    //! The removal patterns are matched against the quads stored before the commit and
+    //! the insertions are applied afterwards, so the changeset replaces the matching quads
+    //! (e.g. all readings of a device), retaining the removed quads that are inserted back.
+    //! The terms are interned, the removed quads are selected and the tombstones are reserved
+    //! before any quad is altered. The quad index merges the whole group on the next lookup,
+    //! while the statistics and the observer account the stored quads once all of them
+    //! are applied.
+    //!
+    //! \param changes Changeset&  - staged changes, cleared once they are applied
+    //! \param inserted=nullptr unsigned*  - number of the stored quads, which were absent
+    //! \param removed=nullptr unsigned*  - number of the removed quads
+    //! \return bool  - whether the changes are applied, otherwise the memory is insufficient
+    //! 	and the quads are left intact (the interned terms are retained)
+	bool commit(Changeset& changes, unsigned* inserted=nullptr, unsigned* removed=nullptr);
+    //! \brief Set the observer notified of each quad stored by quad() and removed by remove()
+    //!
+    //! \param observer QuadObserver*  - observer (e.g. Reasoner), which may store quads
+    //! 	itself; nullptr to reset
+	void observe(QuadObserver* observer)
+		{ _observer = observer; }
+	QuadObserver* observer() const
+		{ return _observer; }
+    //! \brief Remove the quads matching the pattern, selecting them by the quad index
+    //! \note The index permutations are filtered on the next lookup, once per removed batch.
+    //! 	The statistics and the observer are notified of each removed quad
+	unsigned remove(const Quad& pattern) override;
+    //! \brief Remove the stored quad itself, unlike the pattern, whose default graph
+    //! 	matches any graph
+    //!
+    //! \param quad const Quad&  - quad stored in the document, which is not removed yet
+    //! \return bool  - whether the quad is removed, otherwise the memory is insufficient
+	bool removeQuad(const Quad& quad);
+    //! \brief Release the removed quads, rebuilding the value and language indices
+    //! 	on the next request
+	void compact() override;
+    //! \brief Retain the term on reclaim() for its holder, e.g. the vocabulary of a reasoner
+    //!
+    //! \param term const Term&  - term stored in the document
+    //! \return bool  - whether the term is pinned, otherwise the memory is insufficient
+	bool pin(const Term& term);
+    //! \brief Release the pin of the holder (see pin())
+    //!
+    //! \param term const Term&  - pinned term
+	void unpin(const Term& term);
+    //! \brief Compact the quads and release the strings and terms not referred by them
+    //! \note The variables and the pinned terms are retained, since they are referred by
+    //! 	the queries and the other holders
+    //! \attention The pointers to the released strings and terms become invalid,
+    //! 	so their holders should pin them (see pin()) or resolve them again on the epoch change
+    //!
+    //! \return unsigned  - number of the released terms; 0 if the memory is insufficient
+	unsigned reclaim();
+
+	Quad* find(const Quad& quad) override;
+	using Dataset::match;
+	Quads match(const Term* subject = nullptr, const Term* predicate = nullptr,
+				const Term* object = nullptr, const Term* graph = nullptr) override;
+	bool visit(const Quad& pattern, QuadVisitor& visitor) override;
+    //! \brief Visit the quads matching the pattern, whose objects have the values within the range,
+    //! 	scanning the value index when only the predicate (and graph) is bound
+	bool visit(const Quad& pattern, const ValueRange& range, QuadVisitor& visitor) override;
+    //! \brief Visit the quads matching the pattern, whose subjects and objects have the IRI prefixes,
+    //! 	enumerating the prefixed named nodes of the unbound field by the IRI index
+	bool visit(const Quad& pattern, const IriPrefix& prefix, QuadVisitor& visitor) override;
+    //! \brief Visit the quads matching the pattern, whose objects are the literals containing
+    //! 	the text, looking the literals up in the text index
+    //!
+    //! \param pattern const Quad&  - pattern, where nullptr terms denote any term
+    //! \param text const String&  - text contained in the object literals
+    //! \param visitor QuadVisitor&  - visitor of the matching quads
+    //! \param prefix=false bool  - whether the object literals should start with the text
+    //! \return bool  - whether all matching quads are visited, otherwise the visitor
+    //! 	stopped the traversal or the memory is insufficient
+	bool visitText(const Quad& pattern, const String& text, QuadVisitor& visitor, bool prefix=false);
+    //! \brief Object literal of the subject and predicate in the language, or in its closest
+    //! 	BCP47 fallback (e.g. the en-US label falls back to the en one)
+    //!
+    //! \param subject const Term&  - subject
+    //! \param predicate const Term&  - predicate
+    //! \param lang const String&  - language tag, compared case-insensitively
+    //! \return const Literal*  - localized literal; nullptr if it is absent or the memory is insufficient
+	const Literal* localized(const Term& subject, const Term& predicate, const String& lang);
+    //! \brief Number of the quads matching the pattern, taken from the index range bounds
+    //! 	when the bound terms form the key of an index permutation
+	unsigned count(const Quad& pattern) override;
+	bool exists(const Quad& pattern) override;
+    //! \brief Open the cursor over the quads matching the pattern sorted by the field
+    //! for the merge joins (see Join.h)
+    //!
+    //! \param pattern const Quad&  - pattern, where nullptr terms denote any term
+    //! \param field unsigned  - unbound field (0: subject, 1: predicate, 2: object)
+    //! 	the quads are sorted by
+    //! \param cursor JoinCursor&  - resulting cursor, empty if the pattern terms are absent
+    //! \return bool  - whether the cursor is opened, otherwise none of the index permutations
+    //! 	is sorted by the field after the bound fields, the graph is bound
+    //! 	or the memory is insufficient
+	bool sorted(const Quad& pattern, unsigned field, JoinCursor& cursor);
+    //! \brief Cardinality statistics of the quads, maintained since the first request
+    //!
+    //! \return const Statistics*  - statistics; nullptr if the memory is insufficient
+	const Statistics* statistics() override;
+    //! \brief Index of the quads, synchronized with the stored quads
+    //! \note The selected ranges are valid until the next quad is stored
+    //!
+    //! \return QuadIndex*  - index; nullptr if the memory is insufficient
+	QuadIndex* quadIndex();
+    //! \brief Index of the object values, synchronized with the stored quads
+    //! \note The selected ranges are valid until the next quad is stored
+    //!
+    //! \return ValueIndex*  - index; nullptr if the memory is insufficient
+	ValueIndex* valueIndex();
+    //! \brief Index of the literal values, extended by literal() once created
+    //!
+    //! \return TextIndex*  - index; nullptr if the memory is insufficient
+	TextIndex* textIndex();
+    //! \brief Index of the named nodes, extended by namedNode() once created
+    //!
+    //! \return IriIndex*  - index; nullptr if the memory is insufficient
+	IriIndex* iriIndex();
+    //! \brief Index of the language-tagged literals, synchronized with the stored quads
+    //! \note The selected ranges are valid until the next quad is stored
+    //!
+    //! \return LangIndex*  - index; nullptr if the memory is insufficient
+	LangIndex* langIndex();
+    //! \brief Stored term equal to the given one
+    //!
+    //! \param newTerm const Term&  - term of any document
+    //! \return const Term*  - interned term; nullptr if it is absent
+	const Term* findTerm(const Term& newTerm) const;
 protected:
 	const String* findString(const String& newStr) const;
-	const Term* findTerm(const Term& newTerm) const;
+    //! \brief Intern the terms of the quads, resolving each distinct term object once
+    //!
+    //! \param batch const Quad*  - quads of the terms of any document
+    //! \param num unsigned  - number of the quads
+    //! \param rows Array<Quad>&  - resulting quads of the interned terms, which are
+    //! 	formed till the memory is insufficient
+    //! \return bool  - whether all quads are interned, otherwise the memory is insufficient
+	bool internQuads(const Quad* batch, unsigned num, Array<Quad>& rows);
+    //! \brief Mark the stored quad removed, notifying the statistics and the observer
+    //!
+    //! \param quad const Quad&  - stored quad, which is not removed yet
+    //! \return bool  - whether the quad is removed, otherwise the memory is insufficient
+	bool tombstone(const Quad& quad);
+    //! \brief Store the term, which is absent in the document
+    //!
+    //! \param terms Stack<T>&  - storage of the terms of this kind
+    //! \param term const T&  - term to be stored
+    //! \return const T*  - stored term; nullptr if the memory is insufficient
+	template<typename T>
+	const T* addTerm(Stack<T>& terms, const T& term);
 };
 
 }  // smallrdf
@@ -0,0 +1,128 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef REASONER_H_
+#define REASONER_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+//! \brief Forward-chaining RDFS reasoner materializing the entailments in the document
+//!
+//! The reasoner observes the document (see Document::observe) and, on each stored quad,
+//! performs the semi-naive materialization: the quads stored in a round (the delta) are
+//! joined with all stored quads by the rules, and the derived quads, whose triples are
+//! absent in all graphs, form the delta of the next round. The rules are rdfs2 (domain),
+//! rdfs3 (range), rdfs5 and rdfs7 (subPropertyOf), rdfs9 and rdfs11 (subClassOf).
+//! The inferred quads are stored in the graph of the delta quad and marked,
+//! so they can be excluded (see Asserted) or retracted (see retract()).
+//! \note The document should outlive the reasoner, which replaces its former observer
+class Reasoner: public QuadObserver {
+public:
+	class Asserted;
+
+    //! \brief Attach the reasoner to the document, materializing the stored quads
+    //!
+    //! \param doc Document&  - reasoning document
+	explicit Reasoner(Document& doc);
+#if __cplusplus >= 201103L
+	Reasoner(const Reasoner&)=delete;
+	Reasoner& operator=(const Reasoner&)=delete;
+#endif // __cplusplus 11+
+	//! \brief Detach the reasoner from the document
+	~Reasoner() override;
+
+    //! \brief Materialize the entailments of the stored quad
+    //!
+    //! \param quad const Quad&  - quad stored in the document
+    //! \return bool  - true
+	bool operator()(const Quad& quad) override;
+    //! \brief Release the removed quad
+    //! \note The entailments of the removed quad are retained till retract()
+    //!
+    //! \param quad const Quad&  - quad removed from the document
+	void removed(const Quad& quad) override;
+    //! \brief Retract the entailments unsupported after the removals
+    //!
+    //! The inferred quads are removed and the entailments of the remaining quads are
+    //! materialized again, which also completes the materialization failed formerly.
+    //! The rederivation is skipped if nothing was removed since the last one.
+    //! \return bool  - whether all entailments are materialized, otherwise the memory
+    //! 	is insufficient
+	bool retract();
+
+	//! \brief Whether the quad is inferred rather than asserted
+	bool inferred(const Quad& quad) const
+		{ return _inferred.find(&quad) != nullptr; }
+	//! \brief Number of the inferred quads
+	unsigned length() const
+		{ return _inferred.length(); }
+	//! \brief Whether all entailments are materialized, otherwise the memory was insufficient
+	bool complete() const
+		{ return !_failed; }
+protected:
+	//! \brief RDF and RDFS terms of the rules
+	enum Vocabulary {
+		RV_TYPE,  //!< rdf:type
+		RV_SUBCLASS,  //!< rdfs:subClassOf
+		RV_SUBPROPERTY,  //!< rdfs:subPropertyOf
+		RV_DOMAIN,  //!< rdfs:domain
+		RV_RANGE,  //!< rdfs:range
+		RV_NUM
+	};
+
+	//! \brief Hashing of the quads by the identity of their interned terms
+	struct QuadHash {
+		static uint32_t hash(const Quad& quad);
+		static bool equal(const Quad& a, const Quad& b)
+		{
+			return a.subject == b.subject && a.predicate == b.predicate
+				&& a.object == b.object && a.graph == b.graph;
+		}
+	};
+
+	//! \brief Materialize the delta rounds unless they are being materialized
+	void materialize();
+    //! \brief Derive the quads joining the delta quad with the stored ones
+    //! \return bool  - whether the memory is sufficient
+	bool derive(const Quad& quad);
+    //! \brief Add the derived quad unless it is stored or already derived
+    //! \return bool  - whether the memory is sufficient
+	bool infer(const Term* subject, const Term* predicate, const Term* object, const Term* graph);
+    //! \brief Stored quads matching the pattern
+    //! \return bool  - whether the memory is sufficient
+	bool lookup(const Quad& pattern, Array<const Quad*>& matches);
+private:
+	Document& _doc;
+	const Term* _vocab[RV_NUM];
+	Array<const Quad*> _delta;  //!< Quads stored since the last round
+	Array<Quad> _derived;  //!< Quads derived in the round
+	Hashset<Quad, QuadHash> _candidates;  //!< Index of the derived quads
+	Hashset<const Quad*> _inferred;
+	bool _running;  //!< Whether the rounds are being materialized
+	bool _stale;  //!< Whether the quads were removed since the last derivation
+	bool _failed;
+};
+
+//! \brief Visitor filter skipping the inferred quads, so only the asserted ones are visited
+//! \note Is applicable to any traversal of the document, e.g. Document::visit()
+class Reasoner::Asserted: public QuadVisitor {
+public:
+    //! \brief Construct the filter
+    //!
+    //! \param reasoner const Reasoner&  - reasoner of the visited document
+    //! \param visitor QuadVisitor&  - visitor of the asserted quads
+	Asserted(const Reasoner& reasoner, QuadVisitor& visitor)
+		: _reasoner(reasoner), _visitor(visitor)  {}
+
+	bool operator()(const Quad& quad) override;
+private:
+	const Reasoner& _reasoner;
+	QuadVisitor& _visitor;
+};
+
+}  // smallrdf
+
+#endif  // REASONER_H_
@@ -0,0 +1,116 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef SHARDEDDATASET_H_
+#define SHARDEDDATASET_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+class TaskPool;
+
+//! \brief Dataset partitioning the quads by the subject hash across the shards
+//!
+//! The patterns with a bound subject are routed to a single shard, while the other ones
+//! are matched by all shards in parallel (when the multithreading is available) and
+//! the matches are merged by the calling thread. The workers matching the shards are
+//! started on the first parallel lookup and retained by the dataset.
+//! Each shard indexes its quads lazily.
+//! \note The terms are interned in the dataset (see Document), which is not thread-safe
+//! 	itself: a single thread stores the quads and queries the dataset
+class ShardedDataset: public Dataset {
+public:
+	//! Minimal number of the quads to match the shards in parallel
+	static const unsigned  PARALLEL_QUADS_MIN = 4096;
+
+    //! \brief Create the dataset
+    //!
+    //! \param shards=0 unsigned  - number of the shards; 0 to use the number of the hardware threads
+	explicit ShardedDataset(unsigned shards=0);
+#if __cplusplus >= 201103L
+	ShardedDataset(const ShardedDataset&)=delete;
+	ShardedDataset& operator=(const ShardedDataset&)=delete;
+#endif // __cplusplus 11+
+	~ShardedDataset();
+
+	//! \brief Whether the dataset is constructed, otherwise the memory is insufficient
+	bool valid() const
+		{ return _shards != nullptr; }
+	//! \brief Number of the shards
+	unsigned shards() const
+		{ return _num; }
+	//! \brief Number of the stored quads
+	unsigned length() const override;
+    //! \brief Visit the quads of all shards in the order of the shards
+	bool traverse(QuadVisitor& visitor) const override;
+    //! \brief Shard of the subject
+    //!
+    //! \param subject const Term&  - subject of any document
+    //! \return unsigned  - index of the shard
+	unsigned shard(const Term& subject) const
+		{ return hashMix(subject.hash()) % _num; }
+    //! \brief Number of the quads in the shard
+	unsigned shardLength(unsigned shard) const;
+
+	// Interning of the dataset terms, see Document
+	const String* string(String& str)
+		{ return _terms.string(str); }
+#if __cplusplus >= 201103L
+	const String* string(String&& str)
+		{ return string(str); }  // Calls string(String& str);
+#endif // __cplusplus 11+
+	const NamedNode* namedNode(const String& value)
+		{ return _terms.namedNode(value); }
+	const Literal* literal(const String& value, const String* lang=nullptr,
+						   const String* dtype=nullptr)
+		{ return _terms.literal(value, lang, dtype); }
+	const BlankNode* blankNode(const String& value)
+		{ return _terms.blankNode(value); }
+	const Variable* variable(const String& name)
+		{ return _terms.variable(name); }
+    //! \brief Store the quad of the terms of this dataset in the shard of its subject
+    //!
+    //! \param subject const Term&  - subject
+    //! \param predicate const Term&  - predicate
+    //! \param object const Term&  - object
+    //! \param graph=nullptr const Term*  - graph, nullptr denotes the default graph
+    //! \return const Quad*  - stored quad; nullptr if the memory is insufficient
+	const Quad* quad(const Term& subject, const Term& predicate,
+					   const Term& object, const Term* graph = nullptr);
+
+	Quad* find(const Quad& quad) override;
+	Quads match(const Term* subject = nullptr, const Term* predicate = nullptr,
+				const Term* object = nullptr, const Term* graph = nullptr) override;
+	using Dataset::visit;
+	bool visit(const Quad& pattern, QuadVisitor& visitor) override;
+	unsigned count(const Quad& pattern) override;
+	bool exists(const Quad& pattern) override;
+    //! \brief Remove the quads matching the pattern from the shards at once
+    //! \note The shards retain no tombstones: the removal is merged into the shard index
+    //! 	and the quads are released in a single pass over the shard
+	unsigned remove(const Quad& pattern) override;
+protected:
+	struct Shard;
+
+    //! \brief Intern the pattern terms
+    //! \return bool  - whether all terms are interned, otherwise there are no matches
+	bool resolve(const Quad& pattern, const Term* terms[4]) const;
+    //! \brief Apply the operation to each shard, in parallel for the large datasets
+    //!
+    //! \param op Op  - operation called with the shard index
+	template<typename Op>
+	void each(Op op);
+private:
+	Document _terms;  //!< Storage of the interned terms
+	Shard* _shards;
+	unsigned _num;  //!< Number of the shards
+#ifdef SMALLRDF_THREADS
+	TaskPool* _pool;  //!< Workers of the parallel lookups, created on demand
+#endif  // SMALLRDF_THREADS
+};
+
+}  // smallrdf
+
+#endif  // SHARDEDDATASET_H_
@@ -0,0 +1,173 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+//! \brief Read-only dataset operating directly on a memory-mappable image
+//!
+//! The image does not contain pointers, all sections are addressed by offsets from
+//! the image beginning and are 8 bytes aligned:
+//! - header (see Snapshot::Header);
+//! - strings: offsets of the null-terminated strings in the blob, sorted by their bytes;
+//! - terms: (kind, value, lang, dtype) string ids, sorted in this order of the fields;
+//! - quads: (subject, predicate, object, graph) term ids, sorted in SPOG order;
+//! - POS and OSP indices: permutations of the quads sorted in POSG and OSPG orders.
+//! Ids are indices in the respective sections, NONE denotes an absent term or string.
+//! All ids and offsets of the image are validated once on loading, terms of the
+//! matching quads are materialized lazily as views of the image data.
+//! \note The image uses the native byte order
+//! \attention Not thread-safe because of the lazy materialization
+class Snapshot: public Dataset {
+public:
+	typedef uint32_t  Id;
+	static const Id  NONE = 0xFFFFFFFF;
+
+	//! \brief Image header
+	struct Header {
+		uint8_t magic[4];  //!< "SRDS"
+		uint32_t version;
+		uint32_t size;  //!< Size of the image in bytes
+		uint32_t strings;  //!< Number of the strings
+		uint32_t stringOffsets;  //!< Offset of the string offsets Id[strings + 1] in the blob
+		uint32_t stringBlob;  //!< Offset of the strings blob
+		uint32_t terms;  //!< Number of the terms
+		uint32_t termTable;  //!< Offset of the TermEntry[terms]
+		uint32_t quads;  //!< Number of the quads
+		uint32_t quadTable;  //!< Offset of the QuadEntry[quads] in SPOG order
+		uint32_t posIndex;  //!< Offset of the Id[quads] permutation in POSG order
+		uint32_t ospIndex;  //!< Offset of the Id[quads] permutation in OSPG order
+	};
+
+	struct TermEntry {
+		Id kind;
+		Id value;
+		Id lang;
+		Id dtype;
+	};
+
+	struct QuadEntry {
+		Id terms[4];  //!< Subject, predicate, object and graph term ids
+	};
+
+	//! \brief Build the image of the dataset
+	//!
+	//! \param dataset const Dataset&  - input RDF dataset
+	//! \param storage String*&  - resulting image, replacing the former content.
+	//! 	Receives the ownership of the image
+	//! \return bool  - whether the image is built, otherwise the memory is insufficient
+	static bool build(const Dataset& dataset, String*& storage);
+
+#if defined(__unix__) || defined(__APPLE__)
+    //! \brief Memory-map the image file
+    //!
+    //! \param filename const char*  - image file name
+    //! \return Snapshot*  - snapshot owning the mapping; nullptr if the image can not be mapped
+	static Snapshot* map(const char* filename);
+#endif  // __unix__ || __APPLE__
+
+    //! \brief Construct a view of the image
+    //! \note The image should outlive the snapshot
+    //!
+    //! \param image const uint8_t*  - image, 8 bytes aligned
+    //! \param size size_t  - size of the image
+    //! \note The snapshot is invalid if the image is truncated or corrupted, see valid()
+	Snapshot(const uint8_t* image, size_t size);
+#if __cplusplus >= 201103L
+	Snapshot(const Snapshot&)=delete;
+	Snapshot& operator=(const Snapshot&)=delete;
+#endif // __cplusplus 11+
+	~Snapshot();
+
+	//! \brief Whether the image is valid
+	bool valid() const
+		{ return _header; }
+	//! \brief Number of the quads in the image
+	unsigned length() const override
+		{ return _header ? _header->quads : 0; }
+    //! \brief Visit the quads in the SPOG order, materializing them
+    //! \note The visiting stops if the memory is insufficient for the materialization
+	bool traverse(QuadVisitor& visitor) const override;
+
+	Quad* find(const Quad& quad) override;
+	using Dataset::match;
+	Quads match(const Term* subject = nullptr, const Term* predicate = nullptr,
+				const Term* object = nullptr, const Term* graph = nullptr) override;
+	using Dataset::visit;
+	bool visit(const Quad& pattern, QuadVisitor& visitor) override;
+    //! \brief Number of the quads matching the pattern, counted without materializing them
+	unsigned count(const Quad& pattern) override;
+	bool exists(const Quad& pattern) override;
+    //! \brief Refused, the image is read-only
+    //! \attention Asserts in the debug mode
+    //!
+    //! \return unsigned  - 0
+	unsigned remove(const Quad& pattern) override;
+    //! \brief Refused, the image is read-only
+    //! \attention Asserts in the debug mode
+	void compact() override;
+
+    //! \brief Id of the term
+    //!
+    //! \param term const Term&  - term to be located by its content
+    //! \return Id  - term id or NONE if the term is absent
+	Id termId(const Term& term) const;
+	//! \brief Materialized term by its id
+	const Term* term(Id id);
+	//! \brief Materialized quad by its index in the SPOG order
+	Quad* quad(Id index);
+protected:
+	//! \brief Range of the quads
+	struct Range {
+		Id beg;
+		Id end;
+		const Id* perm;  //!< Permutation of the quads or nullptr for the SPOG order
+		const uint8_t* order;  //!< Order of the quad fields
+	};
+
+    //! \brief Validate the ids and offsets of the sections located by the header
+    //!
+    //! \param hdr const Header&  - header with the validated bounds of the sections
+    //! \return bool  - whether all ids and offsets of the image are in bounds
+	bool validate(const Header& hdr) const;
+	Id stringId(const String& str) const;
+	String stringView(Id id) const;
+
+    //! \brief Resolve the pattern terms to their ids
+    //!
+    //! \param pattern const Term* const[4]  - pattern terms, nullptr denotes any term
+    //! \param ids Id[4]  - resulting ids, NONE for the unbound terms
+    //! \return bool  - whether all bound terms are present in the image
+	bool resolve(const Term* const pattern[4], Id ids[4]) const;
+    //! \brief Select the index range of the quads matching the bound ids
+	Range range(const Id ids[4]) const;
+	const QuadEntry& entry(const Range& range, Id i) const
+		{ return _quads[range.perm ? range.perm[i] : i]; }
+	Id index(const Range& range, Id i) const
+		{ return range.perm ? range.perm[i] : i; }
+	//! \brief Whether the quad entry fits the bound ids
+	static bool fits(const QuadEntry& entry, const Id ids[4]);
+private:
+	const uint8_t* _image;
+	size_t _size;  //!< Size of the mapped image, 0 if the image is not mapped
+	const Header* _header;  //!< Header of the valid image, nullptr otherwise
+	const Id* _stringOffsets;
+	const TermEntry* _terms;
+	const QuadEntry* _quads;
+	const Id* _pos;
+	const Id* _osp;
+
+	// Lazily materialized objects
+	String** _stringCache;
+	Term** _termCache;
+	Quad** _quadCache;
+};
+
+}  // smallrdf
+
+#endif  // SNAPSHOT_H_
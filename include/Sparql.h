@@ -0,0 +1,174 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef SPARQL_H_
+#define SPARQL_H_
+
+#include "Query.h"
+
+#ifdef SMALLRDF_SPARQL
+
+namespace smallrdf {
+
+//! \brief SPARQL SELECT query of the supported subset, parsed into a reusable plan
+//!
+//! The supported subset:
+//! - PREFIX declarations, IRIs, prefixed names, 'a', literals with the language or datatype,
+//! 	numbers and booleans;
+//! - SELECT [DISTINCT] of the listed variables or '*';
+//! - WHERE group of the triple patterns (with ';' and ',' lists), FILTER constraints of
+//! 	the comparisons (=, !=, <, >, <=, >=) combined by !, &&, || and BOUND(),
+//! 	and OPTIONAL groups of the triple patterns and constraints (not nested);
+//! - LIMIT and OFFSET.
+//! The blank nodes of the patterns are considered as non-projected variables.
+//! The numeric and xsd:dateTime values are compared by their values, and the filter
+//! comparisons of the variables with such constants are evaluated by the range lookups
+//! (see BasicGraphPattern::constrain()).
+//! \note The query owns its terms, which are matched to the datasets by their content
+class SelectQuery {
+public:
+	static const unsigned  NONE = ~0u;
+
+	SelectQuery();
+#if __cplusplus >= 201103L
+	SelectQuery(const SelectQuery&)=delete;
+	SelectQuery& operator=(const SelectQuery&)=delete;
+#endif // __cplusplus 11+
+	~SelectQuery();
+
+    //! \brief Parse the query, replacing the former one
+    //!
+    //! \param query const String&  - query text
+    //! \return bool  - whether the query is parsed, otherwise it is malformed (see error()),
+    //! 	beyond the supported subset or the memory is insufficient
+	bool parse(const String& query);
+	//! \brief Offset of the parsing error in the query text or NONE
+	unsigned error() const
+		{ return _error; }
+	void clear();
+
+	//! \brief Number of the projected variables
+	unsigned width() const
+		{ return _projection.length(); }
+	const Variable* variable(unsigned i) const
+		{ return _projection[i]; }
+	bool distinct() const
+		{ return _distinct; }
+	//! \brief Maximal number of the solutions or NONE
+	unsigned limit() const
+		{ return _limit; }
+	unsigned offset() const
+		{ return _offset; }
+
+    //! \brief Execute the query on the dataset
+    //!
+    //! \param dataset Dataset&  - queried dataset
+    //! \param solutions Solutions&  - resulting solutions of the projected variables,
+    //! 	replacing the former content
+    //! \return bool  - whether the execution is completed, otherwise the memory is insufficient
+	bool execute(Dataset& dataset, Solutions& solutions) const;
+    //! \brief Pattern of the query consisting of the single group without the filters
+    //! 	and the solution modifiers, which can be prepared (see PreparedQuery)
+    //! \return const BasicGraphPattern*  - pattern; nullptr if the query is not such a plain one
+	const BasicGraphPattern* pattern() const;
+protected:
+	//! \brief Operations of the filter expressions
+	enum Operation {
+		OP_TERM,  //!< Constant term
+		OP_VARIABLE,
+		OP_BOUND,
+		OP_NOT,
+		OP_AND,
+		OP_OR,
+		OP_EQ,
+		OP_NE,
+		OP_LT,
+		OP_GT,
+		OP_LE,
+		OP_GE
+	};
+
+	//! \brief Node of the filter expression
+	struct Expression {
+		Operation op;
+		unsigned left;  //!< Index of the left (single) operand
+		unsigned right;  //!< Index of the right operand
+		const Term* term;  //!< Constant of OP_TERM
+		unsigned var;  //!< Query variable of OP_VARIABLE and OP_BOUND
+	};
+
+	//! \brief Filter of a group
+	struct Filter {
+		unsigned group;  //!< Index of the constrained group
+		unsigned root;  //!< Root expression
+	};
+
+	struct Parser;
+	struct Execution;
+
+    //! \brief Index of the query variable
+    //! \return unsigned  - index of the variable; NONE if it is absent
+	unsigned index(const Variable* var) const;
+    //! \brief Register the query variable if it is absent
+    //! \return unsigned  - index of the variable; NONE if the memory is insufficient
+	unsigned add(const Variable* var);
+    //! \brief Evaluate the expression on the values of the query variables
+    //!
+    //! \param expr unsigned  - expression index
+    //! \param values const Term* const*  - values of the query variables
+    //! \return int  - 1 if the expression holds, 0 if it does not, -1 on the evaluation error
+	int evaluate(unsigned expr, const Term* const* values) const;
+    //! \brief Evaluate the comparison of the values
+    //! \return int  - 1 if the comparison holds, 0 if it does not, -1 on the evaluation error
+	static int compare(Operation op, const Term* a, const Term* b);
+    //! \brief Push the comparisons of the variables with the ordered constants in the filters
+    //! 	down to the patterns of their groups as the value range constraints
+    //!
+    //! \param group unsigned  - index of the group
+    //! \param expr unsigned  - expression of the group filter, the conjunctions are traversed
+    //! \return bool  - whether the constraints are added, otherwise the memory is insufficient
+	bool pushdown(unsigned group, unsigned expr);
+private:
+	Document* _terms;  //!< Constants and variables of the query
+	Array<const Variable*> _variables;  //!< All variables of the query
+	Array<const Variable*> _projection;
+	Array<BasicGraphPattern*> _groups;  //!< Required group followed by the optional ones
+	Array<Expression> _expressions;
+	Array<Filter> _filters;
+	unsigned _limit;
+	unsigned _offset;
+	unsigned _error;
+	bool _distinct;
+};
+
+//! \brief Compiler of the SPARQL queries of the plain basic graph patterns (see SelectQuery::pattern())
+//! 	for QueryCache
+//!
+//! The projection is ignored, since the prepared queries bind all variables of the pattern.
+class SparqlCompiler: public QueryCache::Compiler {
+public:
+    //! \brief Create the compiler
+    //!
+    //! \param params=nullptr const char* const*  - names of the parameter variables
+    //! 	without the leading '?', which should outlive the compiler
+    //! \param num=0 unsigned  - number of the parameters
+	explicit SparqlCompiler(const char* const* params=nullptr, unsigned num=0);
+#if __cplusplus >= 201103L
+	SparqlCompiler(const SparqlCompiler&)=delete;
+	SparqlCompiler& operator=(const SparqlCompiler&)=delete;
+#endif // __cplusplus 11+
+	~SparqlCompiler();
+
+	bool compile(const String& text, Document& terms, BasicGraphPattern& bgp,
+		Array<const Variable*>& params) override;
+private:
+	SelectQuery _query;  //!< Parsed query, which is reused by the compilations
+	const char* const* _params;
+	unsigned _num;
+};
+
+}  // smallrdf
+
+#endif  // SMALLRDF_SPARQL
+
+#endif  // SPARQL_H_
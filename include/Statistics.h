@@ -0,0 +1,117 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef STATISTICS_H_
+#define STATISTICS_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+//! \brief HyperLogLog sketch estimating the number of distinct items
+//! \note 2^BITS one-byte registers are used, yielding ~6.5% standard error
+class HyperLogLog {
+public:
+	static const unsigned  BITS = 8;
+	static const unsigned  REGISTERS = 1u << BITS;
+
+	HyperLogLog();
+
+    //! \brief Add the item
+    //!
+    //! \param hash uint32_t  - hash of the item content
+	void add(uint32_t hash);
+	//! \brief Merge the items of the other sketch
+	void merge(const HyperLogLog& other);
+	//! \brief Estimated number of the distinct items
+	double estimate() const;
+private:
+	uint8_t _registers[REGISTERS];  //!< Maximal ranks of the hashes in each bucket
+};
+
+//! \brief Cardinality statistics of the quads for the cost-based query planning
+//!
+//! The statistics are updated incrementally on each added and removed quad, the terms are
+//! identified by their content, so patterns of any terms can be estimated.
+//! \note The distinct subjects and objects are not decremented on the removals, since the
+//! 	sketches can not forget the items, so they overestimate the shrunk datasets
+class Statistics {
+public:
+	//! \brief Statistics of a predicate
+	struct Predicate {
+		unsigned count;  //!< Number of the quads with the predicate
+		HyperLogLog subjects;  //!< Distinct subjects of the predicate
+		HyperLogLog objects;  //!< Distinct objects of the predicate
+
+		Predicate();
+	};
+
+	//! \brief Occurrences of a term in the quads
+	struct Frequency {
+		unsigned subject;
+		unsigned predicate;
+		unsigned object;
+		unsigned graph;
+	};
+
+	Statistics();
+#if __cplusplus >= 201103L
+	Statistics(const Statistics&)=delete;
+	Statistics& operator=(const Statistics&)=delete;
+#endif // __cplusplus 11+
+	~Statistics();
+
+    //! \brief Account the quad
+    //!
+    //! \param quad const Quad&  - added quad
+    //! \return bool  - whether the quad is accounted, otherwise the memory is insufficient
+	bool add(const Quad& quad);
+    //! \brief Discount the quad
+    //!
+    //! \param quad const Quad&  - removed quad, which was accounted
+    //! \return bool  - whether the quad is discounted, otherwise it was not accounted
+	bool remove(const Quad& quad);
+
+	//! \brief Number of the accounted quads
+	unsigned length() const
+		{ return _length; }
+	//! \brief Number of the distinct predicates
+	unsigned predicates() const
+		{ return _predicates.length(); }
+	//! \brief Estimated number of the distinct subjects
+	double subjects() const
+		{ return _subjects.estimate(); }
+	//! \brief Estimated number of the distinct objects
+	double objects() const
+		{ return _objects.estimate(); }
+
+    //! \brief Statistics of the predicate
+    //! \return const Predicate*  - predicate statistics; nullptr if the predicate is absent
+	const Predicate* predicate(const Term& predicate) const;
+    //! \brief Occurrences of the term
+    //! \return const Frequency*  - term frequency; nullptr if the term is absent
+	const Frequency* frequency(const Term& term) const;
+
+    //! \brief Estimate the number of the quads matching the pattern
+    //!
+    //! \param pattern const Term* const[4]  - subject, predicate, object and graph constants,
+    //! 	nullptr denotes a variable
+    //! \param bound=0 unsigned  - mask (1 << field) of the variables bound to yet unknown values,
+    //! 	as in the nested joins
+    //! \return double  - estimated number of the matching quads
+	double estimate(const Term* const pattern[4], unsigned bound=0) const;
+private:
+	typedef Hashmap<const Term*, unsigned, ContentHash<const Term*> >  PredicateIds;
+	PredicateIds _predicateIds;  //!< Indices of the predicate statistics
+	Array<Predicate> _predicates;
+	typedef Hashmap<const Term*, Frequency, ContentHash<const Term*> >  Frequencies;
+	Frequencies _frequencies;
+	HyperLogLog _subjects;
+	HyperLogLog _objects;
+	unsigned _length;
+};
+
+}  // smallrdf
+
+#endif  // STATISTICS_H_
@@ -0,0 +1,105 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef TASKPOOL_H_
+#define TASKPOOL_H_
+
+#include "Container.hpp"
+#include "RDF.hpp"
+
+#ifdef SMALLRDF_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+
+namespace smallrdf {
+
+class TaskPool;
+
+//! \brief Unit of the work executed by a TaskPool
+class Task {
+public:
+	virtual ~Task()  {}
+
+    //! \brief Execute the task
+    //!
+    //! \param pool TaskPool&  - pool executing the task, which may spawn the subtasks
+    //! \param worker unsigned  - index of the executing worker
+	virtual void operator()(TaskPool& pool, unsigned worker)=0;
+};
+
+//! \brief Work-stealing pool of the worker threads
+//!
+//! Each worker owns a deque of the spawned tasks: the worker takes its most recent task,
+//! which is likely hot in its cache, while the idle workers steal the oldest tasks of
+//! the others, which are the largest ones for the recursively split work. The calling thread
+//! of run() is the worker 0, so the work of a few tasks is never handed over to the other threads.
+class TaskPool {
+public:
+    //! \brief Create the pool
+    //!
+    //! \param workers=0 unsigned  - number of the workers including the calling thread;
+    //! 	0 to use the number of the hardware threads
+	explicit TaskPool(unsigned workers=0);
+	TaskPool(const TaskPool&)=delete;
+	TaskPool& operator=(const TaskPool&)=delete;
+	~TaskPool();
+
+	//! \brief Whether the pool is constructed, otherwise the memory is insufficient
+	bool valid() const
+		{ return _workers != nullptr; }
+	//! \brief Number of the workers including the calling thread
+	unsigned workers() const
+		{ return _num; }
+
+    //! \brief Execute the task on the calling thread and the spawned tasks on all workers,
+    //! 	returning once all of them are completed
+    //! \note The runs are serialized
+    //!
+    //! \param task Task&  - root task executed by the worker 0
+	void run(Task& task);
+    //! \brief Spawn the task for the execution by any worker
+    //!
+    //! \param worker unsigned  - index of the spawning worker
+    //! \param task Task*  - task, which is released by the pool once executed
+    //! \return bool  - whether the task is spawned, otherwise the memory is insufficient
+    //! 	and the task is retained by the caller
+	bool spawn(unsigned worker, Task* task);
+protected:
+	//! \brief Deque of the spawned tasks of a worker
+	struct alignas(64) Worker {
+		std::mutex lock;
+		Array<Task*> tasks;
+		unsigned head;  //!< Index of the oldest task, which is stolen first
+
+		Worker(): lock(), tasks(), head(0)  {}
+	};
+
+    //! \brief Take a task of the worker or steal one of the others
+    //!
+    //! \param worker unsigned  - index of the worker
+    //! \return Task*  - task; nullptr if there are no tasks
+	Task* take(unsigned worker);
+    //! \brief Execute and release the task
+	void execute(Task* task, unsigned worker);
+    //! \brief Loop of a background worker
+	void work(unsigned worker);
+private:
+	Worker* _workers;
+	std::thread* _threads;  //!< Background workers 1 .. _num - 1
+	unsigned _num;  //!< Number of the workers
+	std::atomic<unsigned> _queued;  //!< Number of the tasks in the deques
+	std::atomic<unsigned> _pending;  //!< Number of the spawned tasks being not completed
+	std::mutex _run;  //!< Serialization of the runs
+	std::mutex _idle;
+	std::condition_variable _wake;  //!< Notification of the idle workers and the completed run
+	bool _stop;
+};
+
+}  // smallrdf
+
+#endif  // SMALLRDF_THREADS
+
+#endif  // TASKPOOL_H_
@@ -0,0 +1,75 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef TEXTINDEX_H_
+#define TEXTINDEX_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+//! \brief Text index of the literal values for the substring search and prefix completion
+//!
+//! The substring search scans the postings of the rarest trigram of the text, verifying
+//! the candidates, while the texts shorter than a trigram are matched by the full scan.
+//! The prefix completion selects the range of the literals ordered by their values,
+//! which is a flattened trie of the values.
+//! The literals are buffered on addition and merged into the ordered entries on the next
+//! lookup, similar to ValueIndex.
+//! \note The matching is byte-wise and case-sensitive, so UTF-8 texts are supported
+class TextIndex {
+public:
+	//! \brief Trigram occurrence in a literal value
+	struct Posting {
+		uint32_t trigram;
+		const Literal* literal;
+	};
+
+	TextIndex();
+#if __cplusplus >= 201103L
+	TextIndex(const TextIndex&)=delete;
+	TextIndex& operator=(const TextIndex&)=delete;
+#endif // __cplusplus 11+
+	~TextIndex();
+
+	//! \brief Number of the indexed literals, including the buffered ones
+	unsigned length() const
+		{ return _literals.length() + _pending.length(); }
+	//! \brief Number of the trigram postings, including the buffered ones
+	unsigned postings() const
+		{ return _postings.length() + _pendingPostings.length(); }
+    //! \brief Add the literal
+    //! \note The literal should outlive the index
+    //!
+    //! \param literal const Literal*  - added literal
+    //! \return bool  - whether the literal is added, otherwise the memory is insufficient
+	bool add(const Literal* literal);
+	void clear();
+
+    //! \brief Select the literals containing the text
+    //!
+    //! \param text const String&  - searched text, the empty one matches all literals
+    //! \param res Array<const Literal*>&  - resulting literals, each one is listed once
+    //! \return bool  - whether the literals are selected, otherwise the memory is insufficient
+	bool search(const String& text, Array<const Literal*>& res);
+    //! \brief Select the literals starting with the prefix (autocompletion)
+    //!
+    //! \param prefix const String&  - prefix of the values
+    //! \param res Array<const Literal*>&  - resulting literals ordered by their values
+    //! \param limit unsigned  - maximal number of the resulting literals
+    //! \return bool  - whether the literals are selected, otherwise the memory is insufficient
+	bool complete(const String& prefix, Array<const Literal*>& res, unsigned limit=~0u);
+protected:
+    //! \brief Merge the buffered literals and postings into the ordered ones
+	bool flush();
+private:
+	Array<const Literal*> _literals;  //!< Literals ordered by their values
+	Array<const Literal*> _pending;  //!< Literals being merged
+	Array<Posting> _postings;  //!< Postings ordered by the trigram
+	Array<Posting> _pendingPostings;  //!< Postings being merged
+};
+
+}  // smallrdf
+
+#endif  // TEXTINDEX_H_
@@ -0,0 +1,108 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef VALUEINDEX_H_
+#define VALUEINDEX_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+//! \brief Kinds of the ordered literal values
+enum ValueKind {
+	VK_NONE,  //!< The term has no ordered value
+	VK_NUMBER,  //!< Literal of a numeric XSD datatype
+	VK_DATETIME  //!< xsd:dateTime literal, valued by the seconds since the Unix epoch in UTC
+};
+
+//! \brief Interval of the literal values of a kind
+struct ValueRange {
+	ValueKind kind;
+	double lo;  //!< Lower bound, -HUGE_VAL if it is absent
+	double hi;  //!< Upper bound, HUGE_VAL if it is absent
+	bool loOpen;  //!< The lower bound is excluded
+	bool hiOpen;  //!< The upper bound is excluded
+
+    //! \brief Unbounded range of the values of the kind
+	static ValueRange all(ValueKind kind);
+    //! \brief Ordered value of the term
+    //!
+    //! \param term const Term&  - term
+    //! \param val double&  - resulting value
+    //! \return ValueKind  - kind of the value, VK_NONE if the term is not a valid
+    //! 	numeric or xsd:dateTime literal
+	static ValueKind value(const Term& term, double& val);
+
+	bool contains(ValueKind vkind, double val) const;
+	bool contains(const Term& term) const;
+    //! \brief Intersect the range with another one
+    //! \return bool  - whether the resulting range may contain values
+	bool intersect(const ValueRange& other);
+};
+
+//! \brief Ordered secondary index of the numeric and xsd:dateTime object values
+//! per predicate, which turns the range filters into the range scans
+//!
+//! The quads are buffered on addition and merged into the ordered entries on the next
+//! lookup, similar to QuadIndex.
+//! \note The predicates are compared by their pointers, so all quads should refer
+//! 	the terms interned in a single Document
+class ValueIndex {
+public:
+	//! \brief Indexed value of a quad object
+	struct Entry {
+		const Term* predicate;
+		double value;
+		const Quad* quad;
+		ValueKind kind;
+	};
+
+	//! \brief Range of the entries
+	struct Range {
+		const Entry* beg;
+		const Entry* end;
+
+		unsigned length() const
+			{ return end - beg; }
+	};
+
+	ValueIndex();
+#if __cplusplus >= 201103L
+	ValueIndex(const ValueIndex&)=delete;
+	ValueIndex& operator=(const ValueIndex&)=delete;
+#endif // __cplusplus 11+
+
+	//! \brief Number of the added quads, including the ones without the ordered values
+	unsigned observed() const
+		{ return _observed; }
+	//! \brief Number of the indexed values, including the buffered ones
+	unsigned length() const
+		{ return _entries.length() + _pending.length(); }
+    //! \brief Add the quad, indexing its object value if any
+    //! \note The quad should outlive the index
+    //!
+    //! \param quad const Quad*  - added quad
+    //! \return bool  - whether the quad is added, otherwise the memory is insufficient
+	bool add(const Quad* quad);
+	void clear();
+
+    //! \brief Select the entries of the predicate having the values within the range
+    //!
+    //! \param predicate const Term*  - interned predicate
+    //! \param range const ValueRange&  - range of the values
+    //! \param res Range&  - resulting entries ordered by their values
+    //! \return bool  - whether the entries are selected, otherwise the memory is insufficient
+	bool range(const Term* predicate, const ValueRange& range, Range& res);
+protected:
+    //! \brief Merge the buffered entries into the ordered ones
+	bool flush();
+private:
+	Array<Entry> _entries;  //!< Entries ordered by the predicate, kind and value
+	Array<Entry> _pending;  //!< Entries being merged
+	unsigned _observed;
+};
+
+}  // smallrdf
+
+#endif  // VALUEINDEX_H_
@@ -0,0 +1,19 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include "BinaryFormat.h"
+
+using namespace smallrdf;
+
+
+const uint8_t* binfmt::readVarint(const uint8_t* cur, const uint8_t* end, uint32_t& val)
+{
+	val = 0;
+	for(unsigned shift = 0; cur != end && shift < 32; shift += 7) {
+		const uint8_t  byte = *cur++;
+		val |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if(!(byte & 0x80))
+			return cur;
+	}
+	return nullptr;
+}
@@ -0,0 +1,189 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <string.h>
+
+#include "BinaryParser.h"
+
+using namespace smallrdf;
+using namespace smallrdf::binfmt;
+
+
+BinaryParser::BinaryParser()
+	: _doc(new Document()),
+	  _cur(nullptr),
+	  _end(nullptr),
+	  _failed(false),
+	  _strings(),
+	  _terms()
+{
+}
+
+#if __cplusplus >= 201103L
+BinaryParser::BinaryParser(BinaryParser&& other)
+	: _doc(other._doc),
+	  _cur(other._cur),
+	  _end(other._end),
+	  _failed(other._failed),
+	  _strings(),
+	  _terms()
+{
+	other._doc = new Document();
+	other._cur = other._end = nullptr;
+}
+#endif // __cplusplus 11+
+
+BinaryParser::BinaryParser(Document*& doc)
+	: _doc(doc ? doc : new Document()),
+	  _cur(nullptr),
+	  _end(nullptr),
+	  _failed(false),
+	  _strings(),
+	  _terms()
+{
+	doc = nullptr;  // Invalidate the pointer to ensure self-sufficiency of the internal data
+}
+
+BinaryParser::~BinaryParser()
+{
+	if(_doc) {
+		delete _doc;
+		_doc = nullptr;
+	}
+	_end = _cur = nullptr;
+}
+
+Document* BinaryParser::release()
+{
+	Document *res = _doc;
+	_doc = new Document();  // Reset the internal state to insure its self-sufficiency
+	_end = _cur = nullptr;
+	return res;
+}
+
+Document& BinaryParser::parse(const String& input)
+{
+	assert(_doc && "Internal data should be initialized");
+	_cur = input.data();
+	_end = input.data() + input.length();
+	_failed = false;
+	while(_cur < _end && !_failed)
+		_failed = !parseChunk();
+	_strings.clear();
+	_terms.clear();
+
+	return *_doc;
+}
+
+Document& BinaryParser::parse(const String& input, Document*& doc)
+{
+	BinaryParser parser(doc);
+	parser.parse(input);
+	return *(doc = parser.release());
+}
+
+bool BinaryParser::parseChunk()
+{
+	if(_end - _cur < static_cast<ptrdiff_t>(HEADER_SIZE)
+	|| memcmp(_cur, MAGIC, sizeof MAGIC) || _cur[sizeof MAGIC] != VERSION)
+		return false;
+	_cur += HEADER_SIZE;
+
+	uint32_t num, blockSize;
+	if(!readVarint(num) || !readVarint(blockSize) || !blockSize
+	|| !_strings.resize(0) || !_strings.reserve(num))
+		return false;
+	const String* prev = nullptr;
+	for(uint32_t i = 0; i < num; ++i) {
+		prev = readString(i % blockSize ? prev : nullptr);
+		if(!prev)
+			return false;
+		_strings.add(prev);
+	}
+
+	if(!readVarint(num) || !_terms.resize(0) || !_terms.reserve(num))
+		return false;
+	while(num--) {
+		const Term* term = readTerm();
+		if(!term)
+			return false;
+		_terms.add(term);
+	}
+
+	if(!readVarint(num))
+		return false;
+	while(num--)
+		if(!readQuad())
+			return false;
+	return true;
+}
+
+bool BinaryParser::readVarint(uint32_t& val)
+{
+	const uint8_t* cur = binfmt::readVarint(_cur, _end, val);
+	if(!cur)
+		return false;
+	_cur = cur;
+	return true;
+}
+
+const String* BinaryParser::readString(const String* prev)
+{
+	uint32_t shared = 0, len;
+	if((prev && (!readVarint(shared) || shared > prev->length()))
+	|| !readVarint(len) || len > static_cast<size_t>(_end - _cur))
+		return nullptr;
+	if(!shared && !len)
+		return _doc->string(String(""));
+
+	// Note: the string buffer includes the null-terminator
+	String  str(static_cast<size_t>(shared + len + 1));
+	if(!str.data())
+		return nullptr;
+	if(shared)
+		memcpy(str.data(), prev->data(), shared);
+	memcpy(str.data() + shared, _cur, len);
+	_cur += len;
+	return _doc->string(str);
+}
+
+const Term* BinaryParser::readTerm()
+{
+	if(_cur == _end)
+		return nullptr;
+	const uint8_t  kind = *_cur++;
+	uint32_t id;
+	if(!readVarint(id) || id >= _strings.length())
+		return nullptr;
+	const String& value = *_strings[id];
+
+	switch(kind) {
+	case RTK_NAMED_NODE:
+		return _doc->namedNode(value);
+	case RTK_BLANK_NODE:
+		return _doc->blankNode(value);
+	case RTK_LITERAL: {
+		uint32_t lang, dtype;
+		if(!readVarint(lang) || lang > _strings.length()
+		|| !readVarint(dtype) || dtype > _strings.length())
+			return nullptr;
+		return _doc->literal(value, lang ? _strings[lang - 1] : nullptr,
+			dtype ? _strings[dtype - 1] : nullptr);
+	}
+	default:
+		return nullptr;
+	}
+}
+
+const Quad* BinaryParser::readQuad()
+{
+	uint32_t ids[4];
+	for(unsigned i = 0; i < 4; ++i)
+		if(!readVarint(ids[i]))
+			return nullptr;
+	const unsigned  nterms = _terms.length();
+	if(ids[0] >= nterms || ids[1] >= nterms || ids[2] >= nterms || ids[3] > nterms)
+		return nullptr;
+	return _doc->quad(*_terms[ids[0]], *_terms[ids[1]], *_terms[ids[2]],
+		ids[3] ? _terms[ids[3] - 1] : nullptr);
+}
@@ -0,0 +1,236 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <string.h>
+
+#include "BinarySerializer.h"
+
+using namespace smallrdf;
+using namespace smallrdf::binfmt;
+
+
+BinarySerializer::BinarySerializer()
+	: _buf(new String()),
+	  _cur(_buf ? _buf->data() : nullptr),
+	  _end(_buf ? _buf->data() : nullptr)
+{
+}
+
+#if __cplusplus >= 201103L
+BinarySerializer::BinarySerializer(BinarySerializer&& other)
+	: _buf(other._buf),
+	  _cur(other._cur),
+	  _end(other._end)
+{
+	other._buf = new String();
+	other._cur = other._end = nullptr;
+}
+#endif // __cplusplus 11+
+
+BinarySerializer::BinarySerializer(String*& storage)
+	: _buf(storage ? storage : new String()),
+	  _cur(_buf->data() + _buf->length()),
+	  _end(_buf->data() + _buf->length())
+{
+	storage = nullptr;  // Invalidate the pointer to insure self-sufficiency of the internal data
+}
+
+BinarySerializer::~BinarySerializer()
+{
+	_end = _cur = nullptr;
+	if(_buf)
+		delete _buf;
+	_buf = nullptr;
+}
+
+String* BinarySerializer::release()
+{
+	String *res = _buf;
+	_buf = new String();  // Reset the internal state to insure its self-sufficiency
+	_end = _cur = nullptr;
+	return res;
+}
+
+String& BinarySerializer::storage()
+{
+	assert(_buf && "Internal buffer should be initialized");
+	return *_buf;
+}
+
+BinarySerializer::Dictionary::Dictionary()
+	: stringIds(), strings(), ranks(), termIds(), terms(), quads()
+{
+}
+
+BinarySerializer::Dictionary::~Dictionary()
+{
+}
+
+String& BinarySerializer::serialize(const Dataset& dataset)
+{
+	assert(_buf && "Internal buffer should be initialized");
+	Dictionary  dict;
+	if(!index(dataset, dict))
+		return *_buf;
+	// Note: sorted strings share long prefixes, which are front-coded
+	FrontCodedDictionary  strings(dict.strings.begin(), dict.strings.length());
+	if(!strings.valid() || !rank(strings, dict))
+		return *_buf;
+	const size_t  size = chunkSize(dict, strings);
+
+	size_t offs = 0;
+	if(_cur) {
+		assert(_cur >= _buf->data() && "Serialization position is invalid");
+		offs = _cur - _buf->data();
+	}
+	if(_buf->length() < offs + size && !_buf->resize(offs + size))
+		return *_buf;
+	_cur = _buf->data() + offs;
+	_end = _buf->data() + _buf->length();
+
+	serializeChunk(dict, strings);
+	assert(_cur == _buf->data() + offs + size && "Serialized size mismatch");
+
+	return *_buf;
+}
+
+String& BinarySerializer::serialize(const Dataset& dataset, String*& storage)
+{
+	BinarySerializer serializer(storage);
+	serializer.serialize(dataset);
+	return *(storage = serializer.release());
+}
+
+bool BinarySerializer::index(const Dataset& dataset, Dictionary& dict) const
+{
+	QuadRefs  collector(dict.quads);
+	if(!dict.quads.reserve(dataset.length()) || !dataset.traverse(collector))
+		return false;
+	for(const Quad* const* pquad = dict.quads.begin(); pquad != dict.quads.end(); ++pquad) {
+		const Quad& quad = **pquad;
+		uint32_t id;
+		if(!indexTerm(quad.subject, dict, id) || !indexTerm(quad.predicate, dict, id)
+		|| !indexTerm(quad.object, dict, id) || (quad.graph && !indexTerm(quad.graph, dict, id)))
+			return false;
+	}
+	return true;
+}
+
+bool BinarySerializer::rank(const FrontCodedDictionary& strings, Dictionary& dict) const
+{
+	assert(strings.length() == dict.strings.length() && "The strings should be unique");
+	if(!dict.ranks.resize(dict.strings.length()))
+		return false;
+	for(unsigned i = 0; i < dict.strings.length(); ++i)
+		dict.ranks[i] = strings.locate(*dict.strings[i]);
+	return true;
+}
+
+size_t BinarySerializer::chunkSize(const Dictionary& dict, const FrontCodedDictionary& strings) const
+{
+	size_t size = HEADER_SIZE + varintSize(strings.length()) + varintSize(strings.blockSize())
+		+ strings.data().length() + varintSize(dict.terms.length()) + varintSize(dict.quads.length());
+	for(const Term* const* pterm = dict.terms.begin(); pterm != dict.terms.end(); ++pterm) {
+		const Term& term = **pterm;
+		size += 1 + varintSize(dict.id(term.value));
+		if(term.kind == RTK_LITERAL) {
+			// Note: absent language and datatype are encoded by 0, otherwise id + 1
+			const Literal& literal = static_cast<const Literal&>(term);
+			size += varintSize(literal.lang ? dict.id(literal.lang) + 1 : 0)
+				+ varintSize(literal.dtype ? dict.id(literal.dtype) + 1 : 0);
+		}
+	}
+	for(const Quad* const* pquad = dict.quads.begin(); pquad != dict.quads.end(); ++pquad) {
+		const Quad& quad = **pquad;
+		size += varintSize(*dict.termIds.find(quad.subject))
+			+ varintSize(*dict.termIds.find(quad.predicate))
+			+ varintSize(*dict.termIds.find(quad.object))
+			+ varintSize(quad.graph ? *dict.termIds.find(quad.graph) + 1 : 0);
+	}
+	return size;
+}
+
+bool BinarySerializer::indexString(const String* str, Dictionary& dict, uint32_t& id) const
+{
+	bool added;
+	const uint32_t* pid = dict.stringIds.add(str, dict.strings.length(), &added);
+	if(!pid || (added && !dict.strings.add(str)))
+		return false;
+	id = *pid;
+	return true;
+}
+
+bool BinarySerializer::indexTerm(const Term* term, Dictionary& dict, uint32_t& id) const
+{
+	assert(term && "Null pointer to term");
+	assert(term->kind != RTK_VARIABLE && "Variables can not be serialized");
+	bool added;
+	const uint32_t* pid = dict.termIds.add(term, dict.terms.length(), &added);
+	if(!pid || (added && !dict.terms.add(term)))
+		return false;
+	id = *pid;
+	if(!added)
+		return true;
+
+	uint32_t sid;
+	if(!indexString(term->value, dict, sid))
+		return false;
+	if(term->kind == RTK_LITERAL) {
+		const Literal& literal = static_cast<const Literal&>(*term);
+		if((literal.lang && !indexString(literal.lang, dict, sid))
+		|| (literal.dtype && !indexString(literal.dtype, dict, sid)))
+			return false;
+	}
+	return true;
+}
+
+void BinarySerializer::serializeChunk(const Dictionary& dict, const FrontCodedDictionary& strings)
+{
+	for(unsigned i = 0; i < sizeof MAGIC; ++i)
+		write(MAGIC[i]);
+	write(VERSION);
+
+	writeVarint(strings.length());
+	writeVarint(strings.blockSize());
+	write(strings.data().begin(), strings.data().length());
+
+	writeVarint(dict.terms.length());
+	for(const Term* const* pterm = dict.terms.begin(); pterm != dict.terms.end(); ++pterm) {
+		const Term& term = **pterm;
+		write(static_cast<uint8_t>(term.kind));
+		writeVarint(dict.id(term.value));
+		if(term.kind == RTK_LITERAL) {
+			const Literal& literal = static_cast<const Literal&>(term);
+			writeVarint(literal.lang ? dict.id(literal.lang) + 1 : 0);
+			writeVarint(literal.dtype ? dict.id(literal.dtype) + 1 : 0);
+		}
+	}
+
+	// Note: the dataset quads are iterated from the latest one, so they are written
+	// in the reverse order to retain the insertion order on parsing
+	writeVarint(dict.quads.length());
+	for(const Quad* const* pquad = dict.quads.end(); pquad != dict.quads.begin();) {
+		const Quad& quad = **--pquad;
+		writeVarint(*dict.termIds.find(quad.subject));
+		writeVarint(*dict.termIds.find(quad.predicate));
+		writeVarint(*dict.termIds.find(quad.object));
+		writeVarint(quad.graph ? *dict.termIds.find(quad.graph) + 1 : 0);
+	}
+}
+
+void BinarySerializer::write(uint8_t chr)
+{
+	*_cur++ = chr;
+}
+
+void BinarySerializer::writeVarint(uint32_t val)
+{
+	_cur = binfmt::writeVarint(_cur, val);
+}
+
+void BinarySerializer::write(const uint8_t* data, size_t size)
+{
+	if(size)
+		memcpy(_cur, data, size);
+	_cur += size;
+}
@@ -0,0 +1,238 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <assert.h>
+
+#include "ConcurrentDocument.h"
+
+#ifdef SMALLRDF_THREADS
+
+using namespace smallrdf;
+
+
+namespace {
+
+//! Minimal number of the tail quads to rebuild the base index
+const unsigned  TAIL_QUADS_MIN = 256;
+
+}  // namespace
+
+// ConcurrentDocument ----------------------------------------------------------
+ConcurrentDocument::ConcurrentDocument()
+	: _writer(), _terms(), _quads(), _current(nullptr), _epoch(0), _readers(), _retired()
+{
+	_readers[0].store(0);
+	_readers[1].store(0);
+	Version* const  ver = new Version();
+	if(ver) {
+		ver->head = _quads.begin();
+		ver->length = 0;
+		ver->base = nullptr;
+		ver->baseLength = 0;
+		_current.store(ver);
+	}
+}
+
+ConcurrentDocument::~ConcurrentDocument()
+{
+	assert(!_readers[0].load() && !_readers[1].load() && "The views should be released");
+	for(const Retired& item: _retired) {
+		delete item.version;
+		delete item.base;
+	}
+	Version* const  ver = _current.load();
+	if(ver) {
+		delete ver->base;
+		delete ver;
+	}
+}
+
+unsigned ConcurrentDocument::length() const
+{
+	const Version* const  ver = _current.load();
+	return ver ? ver->length : 0;
+}
+
+unsigned ConcurrentDocument::retired() const
+{
+	std::lock_guard<std::mutex>  lock(_writer);
+	return _retired.length();
+}
+
+const Quad* ConcurrentDocument::quad(const Term& subject, const Term& predicate,
+	const Term& object, const Term* graph)
+{
+	assert(findTerm(subject) == &subject && findTerm(predicate) == &predicate
+		&& findTerm(object) == &object && (!graph || findTerm(*graph) == graph)
+		&& "The quad terms should be interned in the document");
+	std::lock_guard<std::mutex>  lock(_writer);
+	return _quads.add(Quad(subject, predicate, object, graph));
+}
+
+bool ConcurrentDocument::publish()
+{
+	std::lock_guard<std::mutex>  lock(_writer);
+	Version* const  cur = _current.load();
+	const unsigned  len = _quads.length();
+	if(!cur || cur->length == len)
+		return cur != nullptr;
+	// Both the version and the base index might be retired
+	if(!_retired.reserve(_retired.length() + 2))
+		return false;
+	Version* const  ver = new Version(*cur);
+	if(!ver)
+		return false;
+	ver->head = _quads.begin();
+	ver->length = len;
+
+	// Rebuild the base index once the tail outgrows a half of it, so each quad is reindexed
+	// O(log n) times. Note: the tail is scanned on failure
+	QuadIndex*  base = nullptr;
+	if(len - cur->baseLength >= TAIL_QUADS_MIN && len - cur->baseLength >= cur->baseLength / 2
+	&& (base = new QuadIndex())) {
+		const Term* const  any[4] = {nullptr, nullptr, nullptr, nullptr};
+		QuadIndex::Range  range;
+		bool  res = true;
+		for(Dataset::Quads::Iter* pit = ver->head; res && pit != _quads.end(); pit = pit->next())
+			res = base->add(&**pit);
+		// Flush the index, so the readers only read it
+		if(res && base->range(any, range)) {
+			ver->base = base;
+			ver->baseLength = len;
+		} else {
+			delete base;
+			base = nullptr;
+		}
+	}
+
+	_current.store(ver);
+	const Retired  item = {cur, base ? const_cast<QuadIndex*>(cur->base) : nullptr, _epoch.load()};
+	_retired.add(item);
+	reclaim();
+	return true;
+}
+
+void ConcurrentDocument::reclaim()
+{
+	// The epoch is advanced once no reader of the former epoch remains, which shares the counter
+	// with the next epoch
+	unsigned  epoch = _epoch.load();
+	if(!_readers[(epoch + 1) & 1].load())
+		_epoch.store(++epoch);
+	unsigned  num = 0;
+	for(const Retired& item: _retired) {
+		if(item.epoch + 2 <= epoch) {
+			delete item.version;
+			delete item.base;
+		} else _retired[num++] = item;
+	}
+	_retired.resize(num);
+}
+
+// ConcurrentDocument::View ----------------------------------------------------
+ConcurrentDocument::View::View(ConcurrentDocument& doc)
+	: Dataset(), _doc(doc), _version(nullptr), _epoch(0)
+{
+	// Register in the current epoch, retrying if the epoch is advanced meanwhile
+	for(;;) {
+		_epoch = doc._epoch.load();
+		doc._readers[_epoch & 1].fetch_add(1);
+		if(doc._epoch.load() == _epoch)
+			break;
+		doc._readers[_epoch & 1].fetch_sub(1);
+	}
+	_version = doc._current.load();
+}
+
+ConcurrentDocument::View::~View()
+{
+	_doc._readers[_epoch & 1].fetch_sub(1);
+}
+
+Quad* ConcurrentDocument::View::find(const Quad& quad)
+{
+	QuadFinder  finder;
+	visit(quad, finder);
+	return finder.quad;
+}
+
+Dataset::Quads ConcurrentDocument::View::match(const Term* subject, const Term* predicate,
+	const Term* object, const Term* graph)
+{
+	Quads  matches;
+	QuadCopies  copies(matches);
+	visit(Quad(subject, predicate, object, graph), copies);
+	return matches;  // Note: Return value optimization is used here
+}
+
+bool ConcurrentDocument::View::traverse(QuadVisitor& visitor) const
+{
+	if(!_version)
+		return true;
+	const Dataset::Quads::Iter*  pit = _version->head;
+	for(unsigned i = 0; i < _version->length; ++i, pit = pit->next())
+		if(!visitor(**pit))
+			return false;
+	return true;
+}
+
+bool ConcurrentDocument::View::visit(const Quad& pattern, QuadVisitor& visitor)
+{
+	if(!_version)
+		return true;
+	const Term* const  terms[4] = {pattern.subject, pattern.predicate, pattern.object, pattern.graph};
+	// The tail quads, which are newer than the base index
+	Dataset::Quads::Iter*  pit = _version->head;
+	for(unsigned i = _version->baseLength; i < _version->length; ++i, pit = pit->next())
+		if((**pit).match(pattern.subject, pattern.predicate, pattern.object, pattern.graph)
+		&& !visitor(**pit))
+			return false;
+	if(!_version->base)
+		return true;
+	// Note: the base index is flushed, so the lookup does not modify it
+	QuadIndex::Range  range;
+	const_cast<QuadIndex*>(_version->base)->range(terms, range);
+	for(const Quad* const* pquad = range.beg; pquad != range.end; ++pquad)
+		if(QuadIndex::fits(**pquad, terms) && !visitor(**pquad))
+			return false;
+	return true;
+}
+
+unsigned ConcurrentDocument::View::count(const Quad& pattern)
+{
+	if(!_version)
+		return 0;
+	unsigned  num = 0;
+	Dataset::Quads::Iter*  pit = _version->head;
+	for(unsigned i = _version->baseLength; i < _version->length; ++i, pit = pit->next())
+		num += (**pit).match(pattern.subject, pattern.predicate, pattern.object, pattern.graph);
+	if(!_version->base)
+		return num;
+	const Term* const  terms[4] = {pattern.subject, pattern.predicate, pattern.object, pattern.graph};
+	QuadIndex::Range  range;
+	const_cast<QuadIndex*>(_version->base)->range(terms, range);
+	if(QuadIndex::exact(range, terms))
+		return num + range.length();
+	for(const Quad* const* pquad = range.beg; pquad != range.end; ++pquad)
+		num += QuadIndex::fits(**pquad, terms);
+	return num;
+}
+
+bool ConcurrentDocument::View::exists(const Quad& pattern)
+{
+	return find(pattern) != nullptr;
+}
+
+unsigned ConcurrentDocument::View::remove(const Quad& pattern)
+{
+	(void)pattern;
+	assert(0 && "The view is read-only");
+	return 0;
+}
+
+void ConcurrentDocument::View::compact()
+{
+	assert(0 && "The view is read-only");
+}
+
+#endif  // SMALLRDF_THREADS
@@ -0,0 +1,42 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include "Coroutine.h"
+
+#ifdef SMALLRDF_COROUTINES
+#include "QuadIndex.h"
+
+using namespace smallrdf;
+
+
+Generator<const Quad*> smallrdf::match(Document& doc, Quad pattern)
+{
+	// Resolve the pattern to the interned terms
+	const Term*  terms[4] = {pattern.subject, pattern.predicate, pattern.object, pattern.graph};
+	for(unsigned i = 0; i < 4; ++i)
+		if(terms[i] && !(terms[i] = doc.findTerm(*terms[i])))
+			co_return;  // The term is absent, so there are no matches
+
+	QuadIndex* index = doc.quadIndex();
+	QuadIndex::Range  range;
+	if(!index || !index->range(terms, range)) {
+		// Note: the memory is insufficient for the index
+		for(Dataset::Quads::Iter* pit = doc.quads.begin(); pit != doc.quads.end(); pit = pit->next())
+			if((**pit).match(terms[0], terms[1], terms[2], terms[3]) && !doc.removed(**pit))
+				co_yield &**pit;
+		co_return;
+	}
+	for(const Quad* const* pquad = range.beg; pquad != range.end; ++pquad)
+		if(QuadIndex::fits(**pquad, terms))
+			co_yield *pquad;
+}
+
+Generator<const Quad*> smallrdf::match(Dataset& dataset, Quad pattern)
+{
+	Dataset::Quads  matches = dataset.match(pattern.subject, pattern.predicate, pattern.object,
+		pattern.graph);
+	for(Dataset::Quads::Iter* pit = matches.begin(); pit != matches.end(); pit = pit->next())
+		co_yield &**pit;
+}
+
+#endif  // SMALLRDF_COROUTINES
@@ -0,0 +1,182 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <string.h>
+
+#include "BinaryFormat.h"
+#include "FrontCodedDictionary.h"
+
+using namespace smallrdf;
+using namespace smallrdf::binfmt;
+
+typedef FrontCodedDictionary::Id  Id;
+
+const Id  FrontCodedDictionary::NONE;
+const unsigned  FrontCodedDictionary::BLOCK_SIZE;
+
+static int compare(const uint8_t* a, size_t alen, const uint8_t* b, size_t blen)
+{
+	const int  res = memcmp(a, b, alen < blen ? alen : blen);
+	return res ? res : (alen > blen) - (alen < blen);
+}
+
+namespace {
+
+struct StringLess {
+	bool operator()(const String* a, const String* b) const
+		{ return compare(a->data(), a->length(), b->data(), b->length()) < 0; }
+};
+
+}  // namespace
+
+FrontCodedDictionary::FrontCodedDictionary(const String* const* strings, unsigned num, unsigned blockSize)
+	: _data(), _blocks(), _length(0), _blockSize(blockSize), _valid(false)
+{
+	assert(blockSize && "The block should not be empty");
+	Array<const String*>  sorted;
+	if(!sorted.resize(num))
+		return;
+	if(num)
+		memcpy(sorted.begin(), strings, num * sizeof *strings);
+	build(sorted.begin(), num);
+}
+
+FrontCodedDictionary::FrontCodedDictionary(const Dataset& dataset, TermKind kind, unsigned blockSize)
+	: _data(), _blocks(), _length(0), _blockSize(blockSize), _valid(false)
+{
+	assert(blockSize && "The block should not be empty");
+	// Deduplicate the values before sorting them
+	Array<const Quad*>  quads;
+	QuadRefs  collector(quads);
+	if(!quads.reserve(dataset.length()) || !dataset.traverse(collector))
+		return;
+	Hashset<const String*, ContentHash<const String*> >  values;
+	for(const Quad* const* pquad = quads.begin(); pquad != quads.end(); ++pquad) {
+		const Quad& quad = **pquad;
+		const Term* const  terms[4] = {quad.subject, quad.predicate, quad.object, quad.graph};
+		for(unsigned i = 0; i < 4; ++i)
+			if(terms[i] && terms[i]->kind == kind && !values.add(terms[i]->value))
+				return;
+	}
+
+	Array<const String*>  sorted;
+	if(!sorted.reserve(values.length()))
+		return;
+	for(unsigned i = 0; i < values.capacity(); ++i)
+		if(values.slot(i))
+			sorted.add(*values.slot(i));
+	build(sorted.begin(), sorted.length());
+}
+
+void FrontCodedDictionary::build(const String** strings, unsigned num)
+{
+	sort(strings, strings + num, StringLess());
+	const String* prev = nullptr;
+	for(unsigned i = 0; i < num; ++i) {
+		const String& str = *strings[i];
+		if(prev && *prev == str)
+			continue;
+		if(_length % _blockSize) {
+			const size_t  lcp = commonPrefix(prev->data(), prev->length(), str.data(), str.length());
+			if(!appendVarint(lcp) || !appendVarint(str.length() - lcp)
+			|| !append(str.data() + lcp, str.length() - lcp))
+				return;
+		} else if(!_blocks.add(_data.length()) || !appendVarint(str.length())
+		|| !append(str.data(), str.length()))
+			return;
+		prev = &str;
+		++_length;
+	}
+	_valid = true;
+}
+
+bool FrontCodedDictionary::append(const uint8_t* data, size_t size)
+{
+	const unsigned  offs = _data.length();
+	if(!_data.resize(offs + size))
+		return false;
+	if(size)
+		memcpy(_data.begin() + offs, data, size);
+	return true;
+}
+
+bool FrontCodedDictionary::appendVarint(uint32_t val)
+{
+	uint8_t  buf[5];
+	return append(buf, writeVarint(buf, val) - buf);
+}
+
+int FrontCodedDictionary::compareHead(unsigned block, const String& str) const
+{
+	uint32_t  len;
+	const uint8_t* cur = readVarint(_data.begin() + _blocks[block], _data.end(), len);
+	return compare(cur, len, str.data(), str.length());
+}
+
+Id FrontCodedDictionary::locate(const String& str) const
+{
+	// Find the last block with the head not exceeding the string
+	unsigned beg = 0;
+	unsigned end = _blocks.length();
+	while(beg < end) {
+		const unsigned  mid = beg + (end - beg) / 2;
+		if(compareHead(mid, str) <= 0)
+			beg = mid + 1;
+		else end = mid;
+	}
+	if(!beg)
+		return NONE;
+
+	// Scan the block tracking the prefix matched by the current string,
+	// which is less than the located one
+	const unsigned  block = beg - 1;
+	const uint8_t* const  bend = block + 1 < _blocks.length()
+		? _data.begin() + _blocks[block + 1] : _data.end();
+	uint32_t  len;
+	const uint8_t* cur = readVarint(_data.begin() + _blocks[block], bend, len);
+	size_t matched = commonPrefix(cur, len, str.data(), str.length());
+	if(matched == len && len == str.length())
+		return block * _blockSize;
+	cur += len;
+	for(Id id = block * _blockSize + 1; cur < bend; ++id) {
+		uint32_t  lcp;
+		cur = readVarint(readVarint(cur, bend, lcp), bend, len);
+		// The current string exceeds the located one if it diverges from the preceding
+		// string earlier than the latter diverges from the located one
+		if(lcp < matched)
+			return NONE;
+		if(lcp == matched) {
+			const size_t  ext = commonPrefix(cur, len, str.data() + matched, str.length() - matched);
+			matched += ext;
+			if(ext == len && matched == str.length())
+				return id;
+			if(ext < len && (matched == str.length() || cur[ext] > str.data()[matched]))
+				return NONE;
+		}
+		cur += len;
+	}
+	return NONE;
+}
+
+bool FrontCodedDictionary::extract(Id id, String& str) const
+{
+	if(id >= _length)
+		return false;
+	const unsigned  block = id / _blockSize;
+	const uint8_t* cur = _data.begin() + _blocks[block];
+	uint32_t  len;
+	cur = readVarint(cur, _data.end(), len);
+	if(!str.resize(len))
+		return false;
+	memcpy(str.data(), cur, len);
+	cur += len;
+	for(unsigned i = id % _blockSize; i; --i) {
+		uint32_t  lcp;
+		cur = readVarint(readVarint(cur, _data.end(), lcp), _data.end(), len);
+		if(!str.resize(lcp + len))
+			return false;
+		memcpy(str.data() + lcp, cur, len);
+		cur += len;
+	}
+	return true;
+}
@@ -0,0 +1,105 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include "Interner.h"
+
+#ifdef SMALLRDF_THREADS
+
+using namespace smallrdf;
+
+
+const unsigned  Interner::STRIPES;
+
+Interner::Stripe::Stripe()
+	: lock(), strings(), namedNodes(), literals(), blankNodes(), variables(),
+	stringIndex(), termIndex()
+{
+}
+
+Interner::Stripe::~Stripe()
+{
+}
+
+Interner::Interner()
+	: _stripes()
+{
+}
+
+Interner::~Interner()
+{
+}
+
+unsigned Interner::length() const
+{
+	unsigned  res = 0;
+	for(const Stripe& st: _stripes) {
+		std::lock_guard<std::mutex>  lock(st.lock);
+		res += st.stringIndex.length() + st.termIndex.length();
+	}
+	return res;
+}
+
+const String* Interner::string(String& str)
+{
+	Stripe&  st = stripe(str.hash());
+	std::lock_guard<std::mutex>  lock(st.lock);
+	const String* const  key = &str;
+	const String* const*  found = st.stringIndex.find(key);
+	if(found) {
+		str = **found;
+		return *found;
+	}
+	// Note: acquire() fails only if memory is insufficient
+	if(!str.acquire())
+		return nullptr;
+	const String* res = st.strings.add(str);
+	if(res && !st.stringIndex.add(res))
+		return nullptr;
+	return res;
+}
+
+template<typename T>
+const T* Interner::intern(Stack<T> Stripe::* terms, const T& term)
+{
+	Stripe&  st = stripe(term.hash());
+	std::lock_guard<std::mutex>  lock(st.lock);
+	const Term* const  key = &term;
+	const Term* const*  found = st.termIndex.find(key);
+	if(found)
+		return static_cast<const T*>(*found);
+	const T* res = (st.*terms).add(term);
+	if(res && !st.termIndex.add(res))
+		return nullptr;
+	return res;
+}
+
+const NamedNode* Interner::namedNode(const String& value)
+{
+	return intern(&Stripe::namedNodes, NamedNode(value));
+}
+
+const Literal* Interner::literal(const String& value, const String* lang, const String* dtype)
+{
+	return intern(&Stripe::literals, Literal(value, lang, dtype));
+}
+
+const BlankNode* Interner::blankNode(const String& value)
+{
+	return intern(&Stripe::blankNodes, BlankNode(value));
+}
+
+const Variable* Interner::variable(const String& name)
+{
+	return intern(&Stripe::variables, Variable(name));
+}
+
+const Term* Interner::findTerm(const Term& term)
+{
+	Stripe&  st = stripe(term.hash());
+	std::lock_guard<std::mutex>  lock(st.lock);
+	const Term* const  key = &term;
+	const Term* const*  found = st.termIndex.find(key);
+	return found ? *found : nullptr;
+}
+
+#endif  // SMALLRDF_THREADS
@@ -0,0 +1,74 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <string.h>
+
+#include "IriIndex.h"
+
+using namespace smallrdf;
+
+
+namespace {
+
+//! \brief Lexicographical comparison of the string with the prefix of the length
+int compare(const String& a, const uint8_t* data, size_t len)
+{
+	const size_t  alen = a.length();
+	const int  res = memcmp(a.data(), data, alen < len ? alen : len);
+	if(res)
+		return res;
+	return alen < len ? -1 : alen > len;
+}
+
+//! \brief Order of the named nodes by their IRIs
+struct NodeLess {
+	bool operator()(const NamedNode* a, const NamedNode* b) const
+		{ return compare(*a->value, b->value->data(), b->value->length()) < 0; }
+};
+
+}  // namespace
+
+IriIndex::IriIndex()
+	: _nodes(), _pending()
+{
+}
+
+void IriIndex::clear()
+{
+	_nodes.clear();
+	_pending.clear();
+}
+
+bool IriIndex::flush()
+{
+	return merge(_nodes, _pending, NodeLess());
+}
+
+bool IriIndex::range(const String& prefix, Range& res)
+{
+	if(!flush())
+		return false;
+	const uint8_t* const  data = prefix.data();
+	const size_t  len = prefix.length();
+	// First node not preceding the prefix
+	const NamedNode* const*  beg = _nodes.begin();
+	const NamedNode* const*  end = _nodes.end();
+	while(beg < end) {
+		const NamedNode* const*  mid = beg + (end - beg) / 2;
+		if(compare(*(*mid)->value, data, len) < 0)
+			beg = mid + 1;
+		else end = mid;
+	}
+	res.beg = beg;
+	// First node following the prefixed ones, whose truncated IRI exceeds the prefix
+	end = _nodes.end();
+	while(beg < end) {
+		const NamedNode* const*  mid = beg + (end - beg) / 2;
+		const String&  iri = *(*mid)->value;
+		if(iri.length() >= len && !memcmp(iri.data(), data, len))
+			beg = mid + 1;
+		else end = mid;
+	}
+	res.end = beg;
+	return true;
+}
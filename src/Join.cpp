@@ -0,0 +1,137 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include "Join.h"
+
+using namespace smallrdf;
+
+static inline bool less(const Term* a, const Term* b)
+{
+	// Note: the keys are ordered by their addresses as in the QuadIndex
+	return reinterpret_cast<uintptr_t>(a) < reinterpret_cast<uintptr_t>(b);
+}
+
+// JoinCursor ------------------------------------------------------------------
+JoinCursor::JoinCursor()
+	: _cur(nullptr), _end(nullptr), _order(QuadIndex::SPOG), _field(0)
+{
+}
+
+JoinCursor::JoinCursor(const QuadIndex::Range& range, unsigned field)
+	: _cur(range.beg), _end(range.end), _order(range.order), _field(field)
+{
+	assert(field < 3 && "The join field should be the subject, predicate or object");
+}
+
+void JoinCursor::skip(const Term* key, bool inclusive)
+{
+	// Gallop to bracket the position, then bisect the bracket
+	const Quad* const*  lo = _cur;
+	unsigned  step = 1;
+	while(step < unsigned(_end - lo)) {
+		const Term* const  val = QuadIndex::field(*lo[step], _field);
+		if(!(less(val, key) || (inclusive && val == key)))
+			break;
+		lo += step;
+		step *= 2;
+	}
+	const Quad* const*  hi = step < unsigned(_end - lo) ? lo + step : _end;
+	while(lo < hi) {
+		const Quad* const*  mid = lo + (hi - lo) / 2;
+		const Term* const  val = QuadIndex::field(**mid, _field);
+		if(less(val, key) || (inclusive && val == key))
+			lo = mid + 1;
+		else hi = mid;
+	}
+	_cur = lo;
+}
+
+void JoinCursor::seek(const Term* key)
+{
+	if(!atEnd() && less(this->key(), key))
+		skip(key, false);
+}
+
+QuadIndex::Range JoinCursor::group()
+{
+	assert(!atEnd() && "Grouping the passed cursor");
+	QuadIndex::Range  range;
+	range.beg = _cur;
+	range.order = _order;
+	skip(key(), true);
+	range.end = _cur;
+	return range;
+}
+
+// Joins -----------------------------------------------------------------------
+bool smallrdf::mergeJoin(JoinCursor& left, JoinCursor& right, JoinVisitor& visitor)
+{
+	QuadIndex::Range  groups[2];
+	while(!left.atEnd() && !right.atEnd()) {
+		const Term* const  lkey = left.key();
+		const Term* const  rkey = right.key();
+		if(less(lkey, rkey))
+			left.next();
+		else if(less(rkey, lkey))
+			right.next();
+		else {
+			groups[0] = left.group();
+			groups[1] = right.group();
+			if(!visitor(lkey, groups, 2))
+				return false;
+		}
+	}
+	return true;
+}
+
+namespace {
+
+struct CursorLess {
+	bool operator()(const JoinCursor* a, const JoinCursor* b) const
+		{ return less(a->key(), b->key()); }
+};
+
+}  // namespace
+
+bool smallrdf::leapfrogJoin(JoinCursor* cursors, unsigned num, JoinVisitor& visitor, bool* failed)
+{
+	if(failed)
+		*failed = false;
+	for(unsigned i = 0; i < num; ++i)
+		if(cursors[i].atEnd())
+			return true;
+	if(!num)
+		return true;
+
+	Array<JoinCursor*>  order;
+	Array<QuadIndex::Range>  groups;
+	if(!order.resize(num) || !groups.resize(num)) {
+		if(failed)
+			*failed = true;
+		return false;
+	}
+	for(unsigned i = 0; i < num; ++i)
+		order[i] = &cursors[i];
+
+	while(true) {
+		// Cursors are ordered by their keys, so the last one has the largest key
+		sort(order.begin(), order.end(), CursorLess());
+		const Term*  max = order[num - 1]->key();
+		unsigned  ic = 0;
+		while(order[ic]->key() != max) {
+			order[ic]->seek(max);
+			if(order[ic]->atEnd())
+				return true;
+			max = order[ic]->key();
+			ic = (ic + 1) % num;
+		}
+		// All cursors have the same key since the lagging one has reached the largest key
+		for(unsigned i = 0; i < num; ++i)
+			groups[i] = cursors[i].group();
+		if(!visitor(max, groups.begin(), num))
+			return false;
+		for(unsigned i = 0; i < num; ++i)
+			if(cursors[i].atEnd())
+				return true;
+	}
+}
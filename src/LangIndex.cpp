@@ -0,0 +1,141 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include "LangIndex.h"
+
+using namespace smallrdf;
+
+
+namespace {
+
+//! \brief ASCII lower case of the character, the language tags are ASCII
+inline uint8_t lower(uint8_t c)
+{
+	return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+//! \brief Order of the entries by the subject, predicate and tag
+struct EntryLess {
+	bool operator()(const LangIndex::Entry& a, const LangIndex::Entry& b) const
+	{
+		if(a.subject != b.subject)
+			return reinterpret_cast<uintptr_t>(a.subject) < reinterpret_cast<uintptr_t>(b.subject);
+		if(a.predicate != b.predicate)
+			return reinterpret_cast<uintptr_t>(a.predicate) < reinterpret_cast<uintptr_t>(b.predicate);
+		return a.tag < b.tag;
+	}
+};
+
+}  // namespace
+
+const LangIndex::Tag  LangIndex::NONE;
+
+LangIndex::LangIndex()
+	: _entries(), _pending(), _tags(), _ids(), _observed(0)
+{
+}
+
+LangIndex::~LangIndex()
+{
+}
+
+LangIndex::Tag LangIndex::find(const uint8_t* lang, size_t len) const
+{
+	// Note: there are a few distinct tags, so they are scanned
+	for(unsigned i = 0; i < _tags.length(); ++i) {
+		const String&  tag = *_tags[i];
+		if(tag.length() != len)
+			continue;
+		const uint8_t* const  data = tag.data();
+		size_t  j = 0;
+		while(j < len && lower(data[j]) == lower(lang[j]))
+			++j;
+		if(j == len)
+			return i;
+	}
+	return NONE;
+}
+
+LangIndex::Tag LangIndex::intern(const String* lang)
+{
+	const Tag* id = _ids.find(lang);
+	if(id)
+		return *id;
+	Tag  res = find(*lang);
+	if(res == NONE) {
+		if(_tags.length() >= NONE || !_tags.add(lang))
+			return NONE;
+		res = _tags.length() - 1;
+	}
+	return _ids.add(lang, res) ? res : NONE;
+}
+
+bool LangIndex::add(const Quad* quad)
+{
+	const Term&  object = *quad->object;
+	if(object.kind == RTK_LITERAL) {
+		const String* const  lang = static_cast<const Literal&>(object).lang;
+		if(lang && lang->length()) {
+			const Entry  entry = {quad->subject, quad->predicate, quad, intern(lang)};
+			if(entry.tag == NONE || !_pending.add(entry))
+				return false;
+		}
+	}
+	++_observed;
+	return true;
+}
+
+void LangIndex::clear()
+{
+	_entries.clear();
+	_pending.clear();
+	_observed = 0;
+}
+
+bool LangIndex::flush()
+{
+	return merge(_entries, _pending, EntryLess());
+}
+
+bool LangIndex::lookup(const Term* subject, const Term* predicate, const String& lang, Range& res)
+{
+	if(!flush())
+		return false;
+	res.beg = res.end = _entries.end();
+	const EntryLess  eless;
+	const uint8_t* const  data = lang.data();
+	size_t  len = lang.length();
+	while(len) {
+		const Entry  key = {subject, predicate, nullptr, find(data, len)};
+		if(key.tag != NONE) {
+			const Entry*  beg = _entries.begin();
+			const Entry*  end = _entries.end();
+			while(beg < end) {
+				const Entry*  mid = beg + (end - beg) / 2;
+				if(eless(*mid, key))
+					beg = mid + 1;
+				else end = mid;
+			}
+			res.beg = beg;
+			end = _entries.end();
+			while(beg < end) {
+				const Entry*  mid = beg + (end - beg) / 2;
+				if(!eless(key, *mid))
+					beg = mid + 1;
+				else end = mid;
+			}
+			res.end = beg;
+			if(res.beg != res.end)
+				return true;
+		}
+		// Truncate the last subtag and the single-character one preceding it (RFC 4647 lookup),
+		// e.g. zh-Hant-CN-x-private -> zh-Hant-CN -> zh-Hant -> zh
+		while(len && data[len - 1] != '-')
+			--len;
+		len -= len != 0;
+		if(len >= 2 && data[len - 2] == '-')
+			len -= 2;
+	}
+	res.beg = res.end = _entries.end();
+	return true;
+}
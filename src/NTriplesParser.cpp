@@ -12,7 +12,8 @@ NTriplesParser::NTriplesParser()
 	: _doc(new Document()),
 	  _buf(nullptr),
 	  _cur(nullptr),
-	  _end(nullptr)
+	  _end(nullptr),
+	  _tail()
 {
 }
 
@@ -21,8 +22,10 @@ NTriplesParser::NTriplesParser(NTriplesParser&& other)
 	: _doc(other._doc),
 	  _buf(other._buf),
 	  _cur(other._cur),
-	  _end(other._end)
+	  _end(other._end),
+	  _tail()
 {
+	_tail.swap(other._tail);
 	other._doc = new Document();
 	other._buf = other._cur = other._end = nullptr;
 }
@@ -32,7 +35,8 @@ NTriplesParser::NTriplesParser(Document*& doc)
 	: _doc(doc ? doc : new Document()),
 	  _buf(nullptr),
 	  _cur(nullptr),
-	  _end(nullptr)
+	  _end(nullptr),
+	  _tail()
 {
 	doc = nullptr;  // Invalidate the pointer to ensure self-sufficiency of the internal data
 }
@@ -52,6 +56,7 @@ Document* NTriplesParser::release()
 	Document *res = _doc;
 	_doc = new Document();  // Reset the internal state to insure its self-sufficiency
 	_end = _cur = _buf = nullptr;
+	_tail.clear();
 	return res;
 }
 
@@ -67,6 +72,56 @@ Document& NTriplesParser::parse(const String& input)
 	return *_doc;
 }
 
+bool NTriplesParser::feed(const String& chunk, bool last)
+{
+	assert(_doc && "Internal data should be initialized");
+	data_t* beg = chunk.data();
+	data_t* const  end = beg + chunk.length();
+	// The complete lines end with the last line break of the chunk
+	data_t* split = end;
+	if(!last)
+		while(split != beg && split[-1] != '\n')
+			--split;
+	if(_tail.length()) {
+		// Complete the retained line by the chunk prefix
+		data_t* eol = split != beg ? beg : end;
+		while(eol != end && *eol++ != '\n');  // Note: the cycle body is intentionally empty
+		if(eol != beg) {
+			const size_t  len = _tail.length() + (eol - beg);
+			String  part(beg, eol - beg);
+			if((_tail += part).length() != len)
+				return false;
+		}
+		if(split == beg && !last)
+			return true;  // The line is still incomplete
+		const bool  parsed = parseLines(_tail.data(), _tail.data() + _tail.length());
+		_tail.clear();
+		if(!parsed)
+			return false;
+		beg = eol;
+	}
+	if(split > beg && !parseLines(beg, split))
+		return false;
+	if(split != end) {
+		String  rest(split, end - split);
+		if((_tail += rest).length() != size_t(end - split))
+			return false;
+	}
+	return true;
+}
+
+bool NTriplesParser::parseLines(data_t* beg, data_t* end)
+{
+	_buf = _cur = beg;
+	_end = end;
+	// Note: the whitespace is skipped beforehand, so the terms are never read past the end,
+	// which is not the end of the chunk
+	while(readWhiteSpace(), hasNext())
+		if(!parseQuad())
+			return false;
+	return true;
+}
+
 Document& NTriplesParser::parse(const String& input, Document*& doc)
 {
 	NTriplesParser parser(doc);
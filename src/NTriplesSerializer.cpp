@@ -3,11 +3,99 @@
  */
 
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif  // __SSE2__
 
 #include "NTriplesSerializer.h"
+#ifdef SMALLRDF_THREADS
+#include <thread>
+#endif  // SMALLRDF_THREADS
 
 using namespace smallrdf;
 
+//! \brief Escape sequence of the literal character
+//!
+//! \param chr uint8_t  - literal character
+//! \return uint8_t  - escaping character following the backslash; 0 if the character should not be escaped
+static uint8_t escaping(uint8_t chr)
+{
+	switch(chr) {
+	case '"':
+		return '"';
+	case '\\':
+		return '\\';
+	case '\n':
+		return 'n';
+	case '\r':
+		return 'r';
+	default:
+		return 0;
+	}
+}
+
+//! \brief Whether a word contains a byte equal to chr (SWAR)
+static inline bool hasByte(size_t word, uint8_t chr)
+{
+	const size_t  ones = ~size_t(0) / 0xFF;  // 0x0101...01
+	word ^= ones * chr;  // The matching bytes become zero
+	return (word - ones) & ~word & (ones << 7);
+}
+
+//! \brief Fast check whether the string contains any characters to be escaped
+//!
+//! \param str const String&  - literal value
+//! \return bool  - the string requires escaping
+static bool escapable(const String& str)
+{
+	const uint8_t* cur = str.data();
+	const uint8_t* const  end = cur + str.length();
+#ifdef __SSE2__
+	const __m128i  quote = _mm_set1_epi8('"');
+	const __m128i  bslash = _mm_set1_epi8('\\');
+	const __m128i  lf = _mm_set1_epi8('\n');
+	const __m128i  cr = _mm_set1_epi8('\r');
+	for(; end - cur >= 16; cur += 16) {
+		const __m128i  chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+		const __m128i  matches = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, bslash)),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr)));
+		if(_mm_movemask_epi8(matches))
+			return true;
+	}
+#endif  // __SSE2__
+	for(size_t word; end - cur >= static_cast<ptrdiff_t>(sizeof word); cur += sizeof word) {
+		memcpy(&word, cur, sizeof word);  // Note: the data might be unaligned
+		if(hasByte(word, '"') || hasByte(word, '\\') || hasByte(word, '\n') || hasByte(word, '\r'))
+			return true;
+	}
+	for(; cur != end; ++cur)
+		if(escaping(*cur))
+			return true;
+	return false;
+}
+
+//! \brief Length of the escaped string
+//!
+//! \param str const String&  - literal value
+//! \return size_t  - length of the escaped value
+static size_t escapedLength(const String& str)
+{
+	size_t len = str.length();
+	if(!escapable(str))
+		return len;
+	const uint8_t* const  end = str.data() + str.length();
+	for(const uint8_t* cur = str.data(); cur != end; ++cur)
+		if(escaping(*cur))
+			++len;
+	return len;
+}
+
+#ifdef SMALLRDF_THREADS
+//! Minimal number of quads in a partition to pay off a worker thread
+static const unsigned  PARTITION_QUADS_MIN = 512;
+#endif  // SMALLRDF_THREADS
+
 
 NTriplesSerializer::NTriplesSerializer()
 	: _buf(new String()),
@@ -36,6 +124,13 @@ NTriplesSerializer::NTriplesSerializer(String*& storage)
 	storage = nullptr;  // Invalidate the pointer to insure self-sufficiency of the internal data
 }
 
+NTriplesSerializer::NTriplesSerializer(uint8_t* beg, uint8_t* end)
+	: _buf(nullptr),
+	  _cur(beg),
+	  _end(end)
+{
+}
+
 NTriplesSerializer::~NTriplesSerializer()
 {
 	_end = _cur = nullptr;
@@ -58,33 +153,111 @@ String& NTriplesSerializer::storage()
 	return *_buf;
 }
 
-String& NTriplesSerializer::serialize(const Dataset& dataset)
+String& NTriplesSerializer::serialize(const Dataset& dataset, unsigned workers)
 {
 	assert(_buf && "Internal buffer should be initialized");
-	size_t dsize = datasetSize(dataset);
 	size_t offs = 0;
 	if(_cur) {
 		assert(_cur >= _buf->data() && "Serialization position is invalid");
 		offs = _cur - _buf->data();
-		dsize += offs;
 	}
-	if(_buf->length() < dsize)
-		_buf->resize(dsize);
-	_cur = _buf->data() + offs;
-	_end = _buf->data() + _buf->length();
+	// The quads are collected by the traversal, so any dataset is serialized and partitioned evenly
+	Array<const Quad*>  quads;
+	QuadRefs  collector(quads);
+	quads.reserve(dataset.length());
+	dataset.traverse(collector);  // Note: only the collected quads are serialized if the memory is insufficient
+#ifdef SMALLRDF_THREADS
+	const unsigned  wmax = quads.length() / PARTITION_QUADS_MIN;
+	if(workers > wmax)
+		workers = wmax;
+	if(workers >= 2) {
+		serializeParallel(quads.begin(), quads.end(), workers, offs);
+		return *_buf;
+	}
+#endif  // SMALLRDF_THREADS
+	reserve(offs, rangeSize(quads.begin(), quads.end()));
 
-	serializeDataset(dataset);
+	serializeRange(quads.begin(), quads.end());
+	write(0);
 
 	return *_buf;
 }
 
-String& NTriplesSerializer::serialize(const Dataset& dataset, String*& storage)
+String& NTriplesSerializer::serialize(const Dataset& dataset, String*& storage, unsigned workers)
 {
 	NTriplesSerializer serializer(storage);
-	serializer.serialize(dataset);
+	serializer.serialize(dataset, workers);
 	return *(storage = serializer.release());
 }
 
+void NTriplesSerializer::reserve(size_t offs, size_t size)
+{
+	size += offs;
+	if(_buf->length() < size)
+		_buf->resize(size);
+	_cur = _buf->data() + offs;
+	_end = _buf->data() + _buf->length();
+}
+
+#ifdef SMALLRDF_THREADS
+void NTriplesSerializer::serializeParallel(const Quad* const* beg, const Quad* const* end,
+	unsigned workers, size_t offs)
+{
+	struct Partition {
+		const Quad* const* beg;
+		const Quad* const* end;
+		size_t offs;  //!< Offset of the serialized partition
+		size_t size;  //!< Size of the serialized partition
+	};
+
+	// Split the quads into the contiguous partitions of (almost) equal length
+	Partition* parts = new Partition[workers];
+	const size_t  partQuads = (end - beg + workers - 1) / workers;
+	for(unsigned i = 0; i < workers; ++i) {
+		parts[i].beg = beg;
+		beg = static_cast<size_t>(end - beg) > partQuads ? beg + partQuads : end;
+		parts[i].end = beg;
+		parts[i].offs = parts[i].size = 0;
+	}
+
+	// Evaluate the partition sizes, the calling thread processes the first partition
+	std::thread* threads = new std::thread[workers - 1];
+	for(unsigned i = 1; i < workers; ++i)
+		threads[i - 1] = std::thread([this, parts, i]() {
+			parts[i].size = rangeSize(parts[i].beg, parts[i].end);
+		});
+	parts[0].size = rangeSize(parts[0].beg, parts[0].end);
+	for(unsigned i = 1; i < workers; ++i)
+		threads[i - 1].join();
+
+	// Prefix sums of the sizes yield the partition offsets in the output
+	size_t size = 0;
+	for(unsigned i = 0; i < workers; ++i) {
+		parts[i].offs = size;
+		size += parts[i].size;
+	}
+	reserve(offs, size);
+
+	// Serialize the partitions directly into the disjoint regions of the storage
+	uint8_t* const  base = _cur;
+	for(unsigned i = 1; i < workers; ++i)
+		threads[i - 1] = std::thread([base, parts, i]() {
+			NTriplesSerializer  part(base + parts[i].offs, base + parts[i].offs + parts[i].size);
+			part.serializeRange(parts[i].beg, parts[i].end);
+			assert(part._cur == part._end && "Partition size mismatch");
+		});
+	_cur = base;
+	serializeRange(parts[0].beg, parts[0].end);
+	for(unsigned i = 1; i < workers; ++i)
+		threads[i - 1].join();
+	delete[] threads;
+	delete[] parts;
+
+	_cur = base + size;
+	write(0);
+}
+#endif  // SMALLRDF_THREADS
+
 void NTriplesSerializer::write(uint8_t chr)
 {
 	_cur[0] = chr;
@@ -97,25 +270,47 @@ void NTriplesSerializer::write(const String& str)
 	_cur += str.length();
 }
 
-size_t NTriplesSerializer::datasetSize(const Dataset& dataset) const
+void NTriplesSerializer::writeEscaped(const String& str)
+{
+	if(!escapable(str)) {
+		write(str);
+		return;
+	}
+	const uint8_t* const  end = str.data() + str.length();
+	const uint8_t* run = str.data();  // Beginning of the characters being copied as is
+	for(const uint8_t* cur = run; cur != end; ++cur) {
+		const uint8_t  esc = escaping(*cur);
+		if(!esc)
+			continue;
+		memcpy(_cur, run, cur - run);
+		_cur += cur - run;
+		write('\\');
+		write(esc);
+		run = cur + 1;
+	}
+	memcpy(_cur, run, end - run);
+	_cur += end - run;
+}
+
+size_t NTriplesSerializer::rangeSize(const Quad* const* beg, const Quad* const* end) const
 {
 	size_t size = 0;
-	for(const Dataset::Quads::Iter* piq = dataset.quads.begin(); piq != dataset.quads.end(); piq = piq->next())
-		size += quadSize(**piq);
+	for(const Quad* const* pquad = beg; pquad != end; ++pquad)
+		size += quadSize(**pquad);
 	return size;
 }
 
-void NTriplesSerializer::serializeDataset(const Dataset& dataset)
+void NTriplesSerializer::serializeRange(const Quad* const* beg, const Quad* const* end)
 {
-	for(const Dataset::Quads::Iter* piq = dataset.quads.begin(); piq != dataset.quads.end(); piq = piq->next())
-		serializeQuad(**piq);
-	write(0);
+	for(const Quad* const* pquad = beg; pquad != end; ++pquad)
+		serializeQuad(**pquad);
 }
 
 size_t NTriplesSerializer::quadSize(const Quad& quad) const
 {
+	// Note: each term is followed by a space, and the quad is terminated by ".\n"
 	return termSize(quad.subject) + termSize(quad.predicate)
-	       + termSize(quad.object) + termSize(quad.graph) + 5;
+	       + termSize(quad.object) + termSize(quad.graph) + (quad.graph ? 6 : 5);
 }
 
 void NTriplesSerializer::serializeQuad(const Quad& quad)
@@ -179,12 +374,12 @@ void NTriplesSerializer::serializeTerm(const Term* term)
 
 size_t NTriplesSerializer::literalSize(const Literal& literal) const
 {
-	size_t size = literal.value->length() + 2;
+	size_t size = escapedLength(*literal.value) + 2;
 
 	if (literal.lang) {
 		size += literal.lang->length() + 1;
 	} else if (literal.dtype) {
-		size += literal.dtype->length() + 2;
+		size += literal.dtype->length() + 4;  // ^^<dtype>
 	}
 
 	return size;
@@ -193,7 +388,7 @@ size_t NTriplesSerializer::literalSize(const Literal& literal) const
 void NTriplesSerializer::serializeLiteral(const Literal& literal)
 {
 	write('"');
-	write(*literal.value);
+	writeEscaped(*literal.value);
 	write('"');
 
 	if (literal.lang) {
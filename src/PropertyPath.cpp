@@ -0,0 +1,277 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "PropertyPath.h"
+
+using namespace smallrdf;
+
+
+// PropertyPath ----------------------------------------------------------------
+const unsigned  PropertyPath::NONE;
+
+PropertyPath::PropertyPath()
+	: _nodes()  {}
+
+unsigned PropertyPath::add(Kind kind, const Term* predicate, unsigned first, unsigned second)
+{
+	const Node  node = {kind, predicate, first, second};
+	return _nodes.add(node) ? _nodes.length() - 1 : NONE;
+}
+
+unsigned PropertyPath::link(const Term& predicate)
+{
+	return add(PK_LINK, &predicate, NONE);
+}
+
+unsigned PropertyPath::inverse(unsigned path)
+{
+	assert((path == NONE || path < _nodes.length()) && "Invalid operand");
+	return path != NONE ? add(PK_INVERSE, nullptr, path) : NONE;
+}
+
+unsigned PropertyPath::sequence(unsigned first, unsigned second)
+{
+	assert((first == NONE || first < _nodes.length()) && (second == NONE || second < _nodes.length())
+		&& "Invalid operands");
+	return first != NONE && second != NONE ? add(PK_SEQUENCE, nullptr, first, second) : NONE;
+}
+
+unsigned PropertyPath::zeroOrMore(unsigned path)
+{
+	assert((path == NONE || path < _nodes.length()) && "Invalid operand");
+	return path != NONE ? add(PK_ZERO_OR_MORE, nullptr, path) : NONE;
+}
+
+unsigned PropertyPath::oneOrMore(unsigned path)
+{
+	assert((path == NONE || path < _nodes.length()) && "Invalid operand");
+	return path != NONE ? add(PK_ONE_OR_MORE, nullptr, path) : NONE;
+}
+
+// PathEvaluator ---------------------------------------------------------------
+//! \brief Distinct terms in the order of their addition
+struct PathEvaluator::TermSet {
+	Hashset<const Term*, ContentHash<const Term*> > index;
+	Array<const Term*> items;
+
+	TermSet()
+		: index(), items()  {}
+
+    //! \brief Add the term if it is absent
+    //! \return bool  - whether the memory is sufficient
+	bool add(const Term* term)
+	{
+		bool  added = false;
+		if(!index.add(term, &added))
+			return false;
+		return !added || items.add(term);
+	}
+};
+
+namespace {
+
+//! \brief Collector of the linked terms
+template<typename Set, typename Key>
+struct Linker: QuadVisitor {
+	Set& to;
+	Key* anchor;
+	bool inverse;
+	bool failed;
+
+	Linker(Set& terms, Key* key, bool backward)
+		: to(terms), anchor(key), inverse(backward), failed(false)  {}
+	Linker(const Linker&)=delete;
+	Linker& operator=(const Linker&)=delete;
+
+	bool operator()(const Quad& quad) override
+	{
+		if(anchor) {
+			anchor->start = inverse ? quad.object : quad.subject;
+			anchor->predicate = quad.predicate;
+			anchor = nullptr;
+		}
+		failed = !to.add(inverse ? quad.subject : quad.object);
+		return !failed;
+	}
+};
+
+//! \brief Copy the items to the array
+bool assign(Array<const Term*>& dst, const Term* const* beg, const Term* const* end)
+{
+	if(!dst.resize(end - beg))
+		return false;
+	if(beg != end)
+		memcpy(dst.begin(), beg, sizeof(*beg) * (end - beg));
+	return true;
+}
+
+}  // namespace
+
+PathEvaluator::PathEvaluator(Dataset& dataset)
+	: _dataset(dataset), _closures(), _versions(), _observed(dataset.quads.length()),
+	_epoch(dataset.modifications())  {}
+
+PathEvaluator::~PathEvaluator()
+{
+	clear();
+}
+
+void PathEvaluator::clear()
+{
+	for(unsigned i = 0; i < _closures.capacity(); ++i) {
+		Closures::Entry* entry = _closures.slot(i);
+		if(entry)
+			free(entry->val.terms);
+	}
+	_closures.clear();
+	_versions.clear();
+}
+
+void PathEvaluator::sync()
+{
+	// The closures of the modified dataset might refer the released terms
+	if(_epoch != _dataset.modifications() || _observed > _dataset.quads.length()) {
+		clear();
+		_epoch = _dataset.modifications();
+		_observed = _dataset.quads.length();
+		return;
+	}
+	// The stored quads lead the stack
+	for(const Dataset::Quads::Iter* pit = _dataset.quads.begin(); _observed < _dataset.quads.length();
+	++_observed, pit = pit->next()) {
+		unsigned* const  ver = _versions.add((**pit).predicate, 0);
+		if(!ver) {
+			// Note: all closures are released if the memory is insufficient for the versions
+			clear();
+			_observed = _dataset.quads.length();
+			return;
+		}
+		++*ver;
+	}
+}
+
+bool PathEvaluator::evaluate(const PropertyPath& path, const Term& start, Array<const Term*>& ends)
+{
+	ends.clear();
+	if(path.root() == PropertyPath::NONE)
+		return true;
+	sync();
+	Array<const Term*>  from;
+	TermSet  to;
+	return from.add(&start) && evaluate(path, path.root(), false, from, to)
+		&& assign(ends, to.items.begin(), to.items.end());
+}
+
+bool PathEvaluator::evaluate(const PropertyPath& path, unsigned node, bool inverse,
+	const Array<const Term*>& from, TermSet& to)
+{
+	const PropertyPath::Node&  pn = path.node(node);
+	switch(pn.kind) {
+	case PropertyPath::PK_LINK:
+		for(const Term* term: from)
+			if(!step(*term, *pn.predicate, inverse, to))
+				return false;
+		return true;
+	case PropertyPath::PK_INVERSE:
+		return evaluate(path, pn.first, !inverse, from, to);
+	case PropertyPath::PK_SEQUENCE:
+	{
+		// ^(a/b) = ^b/^a
+		TermSet  mid;
+		return evaluate(path, inverse ? pn.second : pn.first, inverse, from, mid)
+			&& evaluate(path, inverse ? pn.first : pn.second, inverse, mid.items, to);
+	}
+	case PropertyPath::PK_ZERO_OR_MORE:
+		for(const Term* term: from)
+			if(!to.add(term))
+				return false;
+		break;
+	case PropertyPath::PK_ONE_OR_MORE:
+		break;
+	default:
+		assert(0 && "Unexpected kind of the path node");
+		return false;
+	}
+
+	// Closure of a predicate link is memoized
+	unsigned  operand = pn.first;
+	bool  inv = inverse;
+	while(path.node(operand).kind == PropertyPath::PK_INVERSE) {
+		operand = path.node(operand).first;
+		inv = !inv;
+	}
+	if(path.node(operand).kind == PropertyPath::PK_LINK) {
+		for(const Term* term: from)
+			if(!closure(*term, *path.node(operand).predicate, inv, to))
+				return false;
+		return true;
+	}
+
+	// Breadth-first traversal of the operand path, where each level extends the reached terms
+	TermSet  reached;
+	if(!evaluate(path, pn.first, inverse, from, reached))
+		return false;
+	Array<const Term*>  frontier;
+	for(unsigned done = 0; done < reached.items.length(); ) {
+		if(!assign(frontier, reached.items.begin() + done, reached.items.end()))
+			return false;
+		done = reached.items.length();
+		if(!evaluate(path, pn.first, inverse, frontier, reached))
+			return false;
+	}
+	for(const Term* term: reached.items)
+		if(!to.add(term))
+			return false;
+	return true;
+}
+
+bool PathEvaluator::step(const Term& term, const Term& predicate, bool inverse, TermSet& to, Key* anchor)
+{
+	Linker<TermSet, Key>  linker(to, anchor, inverse);
+	_dataset.visit(inverse ? Quad(nullptr, &predicate, &term) : Quad(&term, &predicate), linker);
+	return !linker.failed;
+}
+
+bool PathEvaluator::closure(const Term& start, const Term& predicate, bool inverse, TermSet& to)
+{
+	Key  key = {&start, &predicate, inverse};
+	const unsigned  ver = version(predicate);
+	Closure* memo = _closures.find(key);
+	if(memo && memo->version == ver) {
+		for(unsigned i = 0; i < memo->length; ++i)
+			if(!to.add(memo->terms[i]))
+				return false;
+		return true;
+	}
+	// The closure of the extended predicate is evaluated again
+	if(memo) {
+		free(memo->terms);
+		_closures.remove(key);
+	}
+
+	// The key is anchored to the dataset terms, which outlive the call
+	TermSet  reached;
+	if(!step(start, predicate, inverse, reached, &key))
+		return false;
+	for(unsigned i = 0; i < reached.items.length(); ++i)
+		if(!step(*reached.items[i], predicate, inverse, reached))
+			return false;
+	for(const Term* term: reached.items)
+		if(!to.add(term))
+			return false;
+
+	// Unlinked terms are not memoized, being resolved by a single lookup
+	if(!reached.items.length())
+		return true;
+	const Term** terms = static_cast<const Term**>(malloc(sizeof(*terms) * reached.items.length()));
+	if(!terms)
+		return true;  // The result is complete even without the memoization
+	memcpy(terms, reached.items.begin(), sizeof(*terms) * reached.items.length());
+	const Closure  res = {terms, reached.items.length(), ver};
+	if(!_closures.add(key, res))
+		free(terms);
+	return true;
+}
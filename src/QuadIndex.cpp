@@ -0,0 +1,222 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include "QuadIndex.h"
+
+using namespace smallrdf;
+
+const Term* const Quad::* const  QuadIndex::FIELDS[4] = {
+	&Quad::subject, &Quad::predicate, &Quad::object, &Quad::graph};
+
+const uint8_t  QuadIndex::ORDER_FIELDS[ORDERS][4] = {
+	{0, 1, 2, 3},  // SPOG
+	{1, 2, 0, 3},  // POSG
+	{2, 0, 1, 3},  // OSPG
+	{1, 0, 2, 3}};  // PSOG
+
+static inline bool less(const Term* a, const Term* b)
+{
+	// Note: pointers to distinct objects are compared by their addresses
+	return reinterpret_cast<uintptr_t>(a) < reinterpret_cast<uintptr_t>(b);
+}
+
+namespace {
+
+struct QuadLess {
+	const uint8_t* fields;
+
+	bool operator()(const Quad* a, const Quad* b) const
+	{
+		for(unsigned i = 0; i < 4; ++i) {
+			const Term* const  fa = QuadIndex::field(*a, fields[i]);
+			const Term* const  fb = QuadIndex::field(*b, fields[i]);
+			if(fa != fb)
+				return less(fa, fb);
+		}
+		return false;
+	}
+};
+
+//! \brief Compare the key prefix of the quad with the pattern
+//! \return int  - negative if the quad precedes the pattern, positive if it follows the pattern
+int compare(const Quad& quad, const uint8_t* fields, const Term* const pattern[4], unsigned nkey)
+{
+	for(unsigned i = 0; i < nkey; ++i) {
+		const Term* const  val = QuadIndex::field(quad, fields[i]);
+		const Term* const  key = pattern[fields[i]];
+		if(val != key)
+			return less(val, key) ? -1 : 1;
+	}
+	return 0;
+}
+
+//! \brief Number of the leading fields of the order bound in the pattern
+unsigned prefix(const uint8_t* fields, const Term* const pattern[4])
+{
+	unsigned  nkey = 0;
+	while(nkey < 4 && pattern[fields[nkey]])
+		++nkey;
+	return nkey;
+}
+
+//! \brief Drop the removed quads retaining the order of the remaining ones
+void purge(Array<const Quad*>& quads, const Hashset<const Quad*>& removed)
+{
+	const Quad** const  items = quads.begin();
+	unsigned  len = 0;
+	for(unsigned i = 0; i < quads.length(); ++i)
+		if(!removed.find(items[i]))
+			items[len++] = items[i];
+	quads.resize(len);
+}
+
+}  // namespace
+
+QuadIndex::QuadIndex()
+	: _perms(), _pending(), _removed()
+{
+}
+
+QuadIndex::~QuadIndex()
+{
+}
+
+bool QuadIndex::add(const Quad* quad)
+{
+	return _pending.add(quad);
+}
+
+bool QuadIndex::remove(const Quad* quad)
+{
+	return _removed.add(quad);
+}
+
+void QuadIndex::clear()
+{
+	for(unsigned i = 0; i < ORDERS; ++i)
+		_perms[i].clear();
+	_pending.clear();
+	_removed.clear();
+}
+
+bool QuadIndex::flush()
+{
+	if(_removed.length()) {
+		for(unsigned i = 0; i < ORDERS; ++i)
+			purge(_perms[i], _removed);
+		purge(_pending, _removed);
+		_removed.clear();
+	}
+	const unsigned  num = _pending.length();
+	if(!num)
+		return true;
+	const unsigned  len = _perms[SPOG].length();
+	// Reserve all permutations in advance to retain their consistency on failure
+	for(unsigned i = 0; i < ORDERS; ++i)
+		if(!_perms[i].reserve(len + num))
+			return false;
+
+	const Quad** const  pending = _pending.begin();
+	for(unsigned i = 0; i < ORDERS; ++i) {
+		const QuadLess  qless = {ORDER_FIELDS[i]};
+		sort(pending, pending + num, qless);
+		// Merge from the back to perform the merge in place
+		Array<const Quad*>& perm = _perms[i];
+		perm.resize(len + num);
+		const Quad** const  items = perm.begin();
+		unsigned  ip = len;
+		unsigned  iq = num;
+		unsigned  ir = len + num;
+		while(iq) {
+			if(ip && qless(pending[iq - 1], items[ip - 1]))
+				items[--ir] = items[--ip];
+			else items[--ir] = pending[--iq];
+		}
+	}
+	_pending.clear();
+	return true;
+}
+
+bool QuadIndex::range(const Term* const pattern[4], Range& range)
+{
+	return this->range(order(pattern), pattern, range);
+}
+
+QuadIndex::Order QuadIndex::order(const Term* const pattern[4])
+{
+	// Select the permutation with the longest bound prefix
+	Order  res = SPOG;
+	unsigned  nkey = prefix(ORDER_FIELDS[SPOG], pattern);
+	for(unsigned i = POSG; i < ORDERS; ++i) {
+		const unsigned  n = prefix(ORDER_FIELDS[i], pattern);
+		if(n > nkey) {
+			nkey = n;
+			res = static_cast<Order>(i);
+		}
+	}
+	return res;
+}
+
+bool QuadIndex::range(Order order, const Term* const pattern[4], Range& range)
+{
+	if(!flush())
+		return false;
+	const uint8_t* const  fields = ORDER_FIELDS[order];
+	const unsigned  nkey = prefix(fields, pattern);
+	const Array<const Quad*>& perm = _perms[order];
+	range.order = order;
+
+	// Lower bound
+	const Quad* const* beg = perm.begin();
+	const Quad* const* end = perm.end();
+	while(beg < end) {
+		const Quad* const*  mid = beg + (end - beg) / 2;
+		if(compare(**mid, fields, pattern, nkey) < 0)
+			beg = mid + 1;
+		else end = mid;
+	}
+	range.beg = beg;
+	// Upper bound
+	end = perm.end();
+	while(beg < end) {
+		const Quad* const*  mid = beg + (end - beg) / 2;
+		if(compare(**mid, fields, pattern, nkey) <= 0)
+			beg = mid + 1;
+		else end = mid;
+	}
+	range.end = beg;
+	return true;
+}
+
+bool QuadIndex::sorted(const Term* const pattern[4], unsigned field, Range& range)
+{
+	assert(field < 3 && !pattern[field] && "The sorting field should be unbound");
+	unsigned  nbound = 0;
+	for(unsigned i = 0; i < 3; ++i)
+		nbound += pattern[i] != nullptr;
+	// The bound fields should form the prefix followed by the sorting field
+	for(unsigned i = 0; i < ORDERS; ++i) {
+		const uint8_t* const  fields = ORDER_FIELDS[i];
+		if(fields[nbound] == field && prefix(fields, pattern) >= nbound) {
+			const Term* const  terms[4] = {pattern[0], pattern[1], pattern[2], nullptr};
+			return this->range(static_cast<Order>(i), terms, range);
+		}
+	}
+	return false;
+}
+
+bool QuadIndex::exact(const Range& range, const Term* const pattern[4])
+{
+	unsigned  nbound = 0;
+	for(unsigned i = 0; i < 4; ++i)
+		nbound += pattern[i] != nullptr;
+	return prefix(ORDER_FIELDS[range.order], pattern) == nbound;
+}
+
+bool QuadIndex::fits(const Quad& quad, const Term* const pattern[4])
+{
+	for(unsigned i = 0; i < 4; ++i)
+		if(pattern[i] && field(quad, i) != pattern[i])
+			return false;
+	return true;
+}
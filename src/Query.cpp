@@ -0,0 +1,767 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <string.h>
+
+#include "Query.h"
+#include "Statistics.h"
+#include "TaskPool.h"
+
+using namespace smallrdf;
+
+const unsigned  Solutions::NONE;
+const unsigned  BasicGraphPattern::NONE;
+const unsigned  QueryCache::NONE;
+
+// Solutions -------------------------------------------------------------------
+Solutions::Solutions()
+	: _variables(), _values(), _length(0)
+{
+}
+
+bool Solutions::reset(const Variable* const* variables, unsigned num)
+{
+	clear();
+	if(!_variables.resize(num))
+		return false;
+	if(num)
+		memcpy(_variables.begin(), variables, num * sizeof *variables);
+	return true;
+}
+
+bool Solutions::add(const Term* const* values)
+{
+	const unsigned  offs = _values.length();
+	if(!_values.resize(offs + width()))
+		return false;
+	if(width())
+		memcpy(_values.begin() + offs, values, width() * sizeof *values);
+	++_length;
+	return true;
+}
+
+unsigned Solutions::column(const Variable* var) const
+{
+	for(unsigned i = 0; i < width(); ++i)
+		if(_variables[i] == var || *_variables[i] == *var)
+			return i;
+	return NONE;
+}
+
+const Term* Solutions::value(unsigned row, const Variable* var) const
+{
+	const unsigned  col = column(var);
+	return col != NONE ? this->row(row)[col] : nullptr;
+}
+
+// BasicGraphPattern -----------------------------------------------------------
+namespace {
+
+//! \brief State of the pattern evaluation
+struct Evaluation {
+	Dataset& dataset;
+	const BasicGraphPattern& bgp;
+	const unsigned* order;
+	const Term** values;  //!< Values of the variables, nullptr for the unbound ones
+	Solutions& solutions;
+	bool failed;  //!< The memory is insufficient
+
+	//! \brief Join the pattern at the depth of the order
+	bool step(unsigned depth);
+};
+
+//! \brief Visitor binding the variables of a pattern to the matching quads
+struct Binder: QuadVisitor {
+	Evaluation& ev;
+	unsigned depth;
+
+	Binder(Evaluation& evaluation, unsigned idepth)
+		: ev(evaluation), depth(idepth)  {}
+
+	bool operator()(const Quad& quad) override;
+};
+
+bool Evaluation::step(unsigned depth)
+{
+	if(depth == bgp.length()) {
+		failed = !solutions.add(values);
+		return !failed;
+	}
+
+	// Substitute the bound variables
+	const unsigned  ip = order[depth];
+	const Term*  terms[4];
+	for(unsigned f = 0; f < 4; ++f) {
+		const unsigned  var = bgp.slot(ip, f);
+		terms[f] = var == BasicGraphPattern::NONE ? QuadIndex::field(bgp.pattern(ip), f) : values[var];
+	}
+	Binder  binder(*this, depth);
+	// The unbound object constrained to a value range is looked up by the range scan
+	const unsigned  ovar = bgp.slot(ip, 2);
+	const ValueRange* const  range = ovar != BasicGraphPattern::NONE && !terms[2]
+		? bgp.constraint(ovar) : nullptr;
+	if(range)
+		dataset.visit(Quad(terms[0], terms[1], terms[2], terms[3]), *range, binder);
+	else dataset.visit(Quad(terms[0], terms[1], terms[2], terms[3]), binder);
+	return !failed;
+}
+
+bool Binder::operator()(const Quad& quad)
+{
+	const unsigned  ip = ev.order[depth];
+	unsigned  bound[4];
+	unsigned  nbound = 0;
+	bool  fits = true;
+	for(unsigned f = 0; f < 4 && fits; ++f) {
+		const unsigned  var = ev.bgp.slot(ip, f);
+		if(var == BasicGraphPattern::NONE)
+			continue;
+		const Term* const  val = QuadIndex::field(quad, f);
+		const Term*& cur = ev.values[var];
+		// Note: a variable can occur in the pattern several times, and the graph variable
+		// is not bound to the default graph
+		if(!val || (cur && cur != val && *cur != *val))
+			fits = false;
+		else if(!cur) {
+			cur = val;
+			bound[nbound++] = var;
+			const ValueRange* const  range = ev.bgp.constraint(var);
+			fits = !range || range->contains(*val);
+		}
+	}
+	if(fits)
+		ev.step(depth + 1);
+	while(nbound)
+		ev.values[bound[--nbound]] = nullptr;
+	return !ev.failed;
+}
+
+}  // namespace
+
+BasicGraphPattern::BasicGraphPattern()
+	: _patterns(), _variables(), _slots(), _constraints()
+{
+}
+
+BasicGraphPattern::~BasicGraphPattern()
+{
+}
+
+bool BasicGraphPattern::add(const Term& subject, const Term& predicate, const Term& object,
+	const Term* graph)
+{
+	const Term* const  terms[4] = {&subject, &predicate, &object, graph};
+	unsigned  slots[4];
+	for(unsigned f = 0; f < 4; ++f) {
+		slots[f] = NONE;
+		if(!terms[f] || terms[f]->kind != RTK_VARIABLE)
+			continue;
+		const Variable* const  var = static_cast<const Variable*>(terms[f]);
+		slots[f] = variable(var);
+		if(slots[f] == NONE) {
+			if(!_variables.add(var))
+				return false;
+			slots[f] = _variables.length() - 1;
+		}
+	}
+	if(!_slots.reserve(_slots.length() + 4) || !_patterns.add(Quad(subject, predicate, object, graph)))
+		return false;
+	for(unsigned f = 0; f < 4; ++f)
+		_slots.add(slots[f]);
+	return true;
+}
+
+void BasicGraphPattern::clear()
+{
+	_patterns.clear();
+	_variables.clear();
+	_slots.clear();
+	_constraints.clear();
+}
+
+bool BasicGraphPattern::constrain(const Variable* var, const ValueRange& range)
+{
+	const unsigned  ivar = variable(var);
+	if(ivar == NONE)
+		return false;
+	for(Constraint& cons: _constraints)
+		if(cons.var == ivar) {
+			cons.range.intersect(range);
+			return true;
+		}
+	const Constraint  cons = {ivar, range};
+	return _constraints.add(cons);
+}
+
+const ValueRange* BasicGraphPattern::constraint(unsigned var) const
+{
+	for(const Constraint& cons: _constraints)
+		if(cons.var == var)
+			return &cons.range;
+	return nullptr;
+}
+
+unsigned BasicGraphPattern::variable(const Variable* var) const
+{
+	for(unsigned i = 0; i < width(); ++i)
+		if(_variables[i] == var || *_variables[i] == *var)
+			return i;
+	return NONE;
+}
+
+unsigned BasicGraphPattern::rank(unsigned i, const uint8_t* bound) const
+{
+	// Ranks of the combinations of the bound subject (1), predicate (2) and object (4),
+	// where the bound subject is considered the most selective and the predicate the least one
+	static const uint8_t  RANKS[8] = {7, 4, 6, 3, 5, 1, 2, 0};
+	unsigned  mask = 0;
+	for(unsigned f = 0; f < 3; ++f) {
+		const unsigned  var = slot(i, f);
+		if(var == NONE || bound[var])
+			mask |= 1u << f;
+	}
+	// The bound graph refines the rank
+	const unsigned  gvar = slot(i, 3);
+	const bool  graph = gvar != NONE ? bound[gvar] != 0 : _patterns[i].graph != nullptr;
+	return RANKS[mask] * 2 + !graph;
+}
+
+double BasicGraphPattern::cost(unsigned i, const uint8_t* bound, const Statistics& statistics) const
+{
+	const Term*  terms[4];
+	unsigned  mask = 0;
+	for(unsigned f = 0; f < 4; ++f) {
+		const unsigned  var = slot(i, f);
+		terms[f] = var == NONE ? QuadIndex::field(_patterns[i], f) : nullptr;
+		if(var != NONE && bound[var])
+			mask |= 1u << f;
+	}
+	const double  card = statistics.estimate(terms, mask);
+	// The range constraint of the unbound object is considered to pass a third of the values,
+	// which is the conventional default selectivity of the range predicates
+	const unsigned  ovar = slot(i, 2);
+	return ovar != NONE && !bound[ovar] && constraint(ovar) ? card / 3 : card;
+}
+
+bool BasicGraphPattern::plan(Array<unsigned>& order, const Statistics* statistics,
+	const uint8_t* bound0) const
+{
+	order.clear();
+	Array<uint8_t>  bound;
+	Array<uint8_t>  used;
+	if(!order.reserve(length()) || !bound.resize(width()) || !used.resize(length()))
+		return false;
+	if(width()) {
+		if(bound0)
+			memcpy(bound.begin(), bound0, bound.length());
+		else memset(bound.begin(), 0, bound.length());
+	}
+	if(length())
+		memset(used.begin(), 0, used.length());
+
+	// Greedily take the most selective pattern considering the variables bound so far,
+	// the estimated cardinalities are refined by the ranks
+	while(order.length() < length()) {
+		unsigned  best = NONE;
+		unsigned  bestRank = 0;
+		double  bestCost = 0;
+		for(unsigned i = 0; i < length(); ++i) {
+			if(used[i])
+				continue;
+			const unsigned  r = rank(i, bound.begin());
+			const double  c = statistics ? cost(i, bound.begin(), *statistics) : 0;
+			if(best == NONE || c < bestCost || (!(c > bestCost) && r < bestRank)) {
+				best = i;
+				bestRank = r;
+				bestCost = c;
+			}
+		}
+		used[best] = true;
+		order.add(best);
+		for(unsigned f = 0; f < 4; ++f)
+			if(slot(best, f) != NONE)
+				bound[slot(best, f)] = true;
+	}
+	return true;
+}
+
+bool BasicGraphPattern::evaluate(Dataset& dataset, Solutions& solutions) const
+{
+	Array<unsigned>  order;
+	return plan(order, dataset.statistics()) && evaluate(dataset, order, solutions);
+}
+
+bool BasicGraphPattern::evaluate(Dataset& dataset, const Array<unsigned>& order, Solutions& solutions,
+	const Term* const* bindings) const
+{
+	assert(order.length() == length() && "The order should cover all patterns");
+	Array<const Term*>  values;
+	if(!solutions.reset(_variables.begin(), width()) || !values.resize(width()))
+		return false;
+	if(width()) {
+		if(bindings)
+			memcpy(values.begin(), bindings, width() * sizeof(const Term*));
+		else memset(values.begin(), 0, width() * sizeof(const Term*));
+	}
+	for(const Constraint& cons: _constraints)
+		if(values[cons.var] && !cons.range.contains(*values[cons.var]))
+			return true;
+	// Note: the empty pattern yields a single solution of the bindings
+
+	Evaluation  ev = {dataset, *this, order.begin(), values.begin(), solutions, false};
+	return ev.step(0);
+}
+
+// PreparedQuery ---------------------------------------------------------------
+//! \brief State of the prepared query execution
+struct PreparedQuery::Execution {
+	QuadIndex& index;
+	const BasicGraphPattern& bgp;
+	const Step* steps;
+	unsigned length;
+	const Term** values;  //!< Values of the variables, nullptr for the unbound ones
+	Solutions& solutions;
+	bool failed;  //!< The memory is insufficient
+	Parallel* par;  //!< State of the parallel execution; nullptr for the sequential one
+	unsigned worker;  //!< Index of the executing worker
+
+	//! \brief Join the pattern of the step
+	bool step(unsigned depth);
+    //! \brief Join the quads of the range selected for the step
+    //!
+    //! \param depth unsigned  - index of the step
+    //! \param terms const Term* const[4]  - pattern of the step substituting the bound variables
+    //! \param range const QuadIndex::Range&  - range of the step pattern
+    //! \return bool  - whether the join is completed, otherwise the memory is insufficient
+	bool scan(unsigned depth, const Term* const terms[4], const QuadIndex::Range& range);
+};
+
+#ifdef SMALLRDF_THREADS
+namespace {
+
+//! Minimal number of the quads in a range to split it for the workers
+const unsigned  SPLIT_QUADS_MIN = 256;
+
+}  // namespace
+
+//! \brief Parallel execution, which is the root task executed by the calling thread
+struct PreparedQuery::Parallel: Task {
+	TaskPool& pool;
+	Execution& root;  //!< Execution of the calling thread
+	Solutions* results;  //!< Solutions of the workers 1 .. pool.workers() - 1
+	std::atomic<bool> failed;  //!< The memory is insufficient
+
+	Parallel(TaskPool& ipool, Execution& execution)
+		: pool(ipool), root(execution), results(nullptr), failed(false)  {}
+	Parallel(const Parallel&)=delete;
+	Parallel& operator=(const Parallel&)=delete;
+	~Parallel()
+		{ delete[] results; }
+
+	//! \brief Solutions of the worker
+	Solutions& solutions(unsigned worker)
+		{ return worker ? results[worker - 1] : root.solutions; }
+	void operator()(TaskPool&, unsigned) override
+		{ root.step(0); }
+};
+
+//! \brief Task joining a part of the range of a step
+struct PreparedQuery::Scan: Task {
+	Parallel& par;
+	unsigned depth;
+	QuadIndex::Range range;
+	Array<const Term*> values;  //!< Values of the variables bound by the preceding steps
+
+	Scan(Parallel& parallel, unsigned idepth, const QuadIndex::Range& irange)
+		: par(parallel), depth(idepth), range(irange), values()  {}
+
+    //! \brief Copy the values of the variables
+    //! \return bool  - whether the values are copied, otherwise the memory is insufficient
+	bool bind(const Term* const* vals);
+	void operator()(TaskPool& pool, unsigned worker) override;
+};
+
+bool PreparedQuery::Scan::bind(const Term* const* vals)
+{
+	if(!values.resize(par.root.bgp.width()))
+		return false;
+	if(values.length())
+		memcpy(values.begin(), vals, values.length() * sizeof *vals);
+	return true;
+}
+
+void PreparedQuery::Scan::operator()(TaskPool& pool, unsigned worker)
+{
+	if(par.failed.load())
+		return;
+	// Split off the halves of the range for the idle workers, joining the remaining part
+	while(range.length() >= 2 * SPLIT_QUADS_MIN) {
+		const QuadIndex::Range  rest = {range.beg + range.length() / 2, range.end, range.order};
+		Scan* const  task = new Scan(par, depth, rest);
+		if(!task || !task->bind(values.begin()) || !pool.spawn(worker, task)) {
+			delete task;
+			break;
+		}
+		range.end = rest.beg;
+	}
+	const Term*  terms[4];
+	const Execution&  ex = par.root;
+	const Step&  st = ex.steps[depth];
+	for(unsigned f = 0; f < 4; ++f)
+		terms[f] = st.slots[f] == BasicGraphPattern::NONE ? st.terms[f] : values[st.slots[f]];
+	Execution  sub = {ex.index, ex.bgp, ex.steps, ex.length, values.begin(), par.solutions(worker),
+		false, &par, worker};
+	if(!sub.scan(depth, terms, range))
+		par.failed.store(true);
+}
+#endif  // SMALLRDF_THREADS
+
+bool PreparedQuery::Execution::step(unsigned depth)
+{
+	if(depth == length) {
+		failed = !solutions.add(values);
+		return !failed;
+	}
+
+	const Step&  st = steps[depth];
+	const Term*  terms[4];
+	for(unsigned f = 0; f < 4; ++f)
+		terms[f] = st.slots[f] == BasicGraphPattern::NONE ? st.terms[f] : values[st.slots[f]];
+	QuadIndex::Range  range;
+	if(!index.range(st.order, terms, range)) {
+		failed = true;
+		return false;
+	}
+#ifdef SMALLRDF_THREADS
+	// The large range is handed over to the pool, being joined inline on failure
+	if(par && range.length() >= 2 * SPLIT_QUADS_MIN) {
+		Scan* const  task = new Scan(*par, depth, range);
+		if(task && task->bind(values) && par->pool.spawn(worker, task))
+			return true;
+		delete task;
+	}
+#endif  // SMALLRDF_THREADS
+	return scan(depth, terms, range);
+}
+
+bool PreparedQuery::Execution::scan(unsigned depth, const Term* const terms[4],
+	const QuadIndex::Range& range)
+{
+	const Step&  st = steps[depth];
+	for(const Quad* const* pquad = range.beg; pquad != range.end; ++pquad) {
+		if(!QuadIndex::fits(**pquad, terms))
+			continue;
+		// Bind the unbound variables, which may occur in the pattern several times
+		unsigned  bound[4];
+		unsigned  nbound = 0;
+		bool  fits = true;
+		for(unsigned f = 0; f < 4 && fits; ++f) {
+			const unsigned  var = st.slots[f];
+			if(var == BasicGraphPattern::NONE || terms[f])
+				continue;
+			const Term* const  val = QuadIndex::field(**pquad, f);
+			// Note: the graph variable is not bound to the default graph
+			if(!val || (values[var] && values[var] != val))
+				fits = false;
+			else if(!values[var]) {
+				values[var] = val;
+				bound[nbound++] = var;
+				const ValueRange* const  vrange = bgp.constraint(var);
+				fits = !vrange || vrange->contains(*val);
+			}
+		}
+		if(fits)
+			step(depth + 1);
+		while(nbound)
+			values[bound[--nbound]] = nullptr;
+		if(failed)
+			return false;
+	}
+	return true;
+}
+
+PreparedQuery::PreparedQuery()
+	: _doc(nullptr), _bgp(nullptr), _steps(), _params(), _values(), _epoch(0), _resolved(false)
+{
+}
+
+PreparedQuery::~PreparedQuery()
+{
+}
+
+void PreparedQuery::clear()
+{
+	_doc = nullptr;
+	_bgp = nullptr;
+	_steps.clear();
+	_params.clear();
+	_values.clear();
+	_epoch = 0;
+	_resolved = false;
+}
+
+bool PreparedQuery::prepare(Document& doc, const BasicGraphPattern& bgp,
+	const Variable* const* params, unsigned num)
+{
+	clear();
+	Array<uint8_t>  bound;
+	if(!bound.resize(bgp.width()) || !_params.reserve(num) || !_values.resize(bgp.width())
+	|| !_steps.resize(bgp.length()))
+		return false;
+	if(bgp.width())
+		memset(bound.begin(), 0, bound.length());
+	for(unsigned i = 0; i < num; ++i) {
+		const unsigned  var = bgp.variable(params[i]);
+		if(var == BasicGraphPattern::NONE) {
+			clear();
+			return false;
+		}
+		_params.add(var);
+		bound[var] = true;
+	}
+
+	// Fix the join order and the permutation of each pattern per the variables bound before it
+	Array<unsigned>  order;
+	if(!bgp.plan(order, doc.statistics(), bound.begin())) {
+		clear();
+		return false;
+	}
+	for(unsigned i = 0; i < order.length(); ++i) {
+		Step&  st = _steps[i];
+		const Term*  keys[4];
+		st.pattern = order[i];
+		for(unsigned f = 0; f < 4; ++f) {
+			const unsigned  var = bgp.slot(st.pattern, f);
+			st.slots[f] = var;
+			st.terms[f] = nullptr;
+			// Note: the variables are the placeholders of their values
+			if(var == BasicGraphPattern::NONE)
+				keys[f] = QuadIndex::field(bgp.pattern(st.pattern), f);
+			else keys[f] = bound[var] ? bgp.variable(var) : nullptr;
+		}
+		st.order = QuadIndex::order(keys);
+		for(unsigned f = 0; f < 4; ++f)
+			if(st.slots[f] != BasicGraphPattern::NONE)
+				bound[st.slots[f]] = true;
+	}
+	_doc = &doc;
+	_bgp = &bgp;
+	_epoch = doc.epoch();
+	_resolved = resolve();
+	return true;
+}
+
+bool PreparedQuery::resolve()
+{
+	bool  res = true;
+	for(Step& st: _steps)
+		for(unsigned f = 0; f < 4; ++f) {
+			const Term* const  term = QuadIndex::field(_bgp->pattern(st.pattern), f);
+			if(st.slots[f] != BasicGraphPattern::NONE || !term)
+				continue;
+			st.terms[f] = _doc->findTerm(*term);
+			res = res && st.terms[f];
+		}
+	return res;
+}
+
+bool PreparedQuery::execute(const Term* const* args, Solutions& solutions)
+{
+	return execute(static_cast<TaskPool*>(nullptr), args, solutions);
+}
+
+#ifdef SMALLRDF_THREADS
+bool PreparedQuery::execute(TaskPool& pool, const Term* const* args, Solutions& solutions)
+{
+	return execute(&pool, args, solutions);
+}
+#endif  // SMALLRDF_THREADS
+
+bool PreparedQuery::execute(TaskPool* pool, const Term* const* args, Solutions& solutions)
+{
+	assert(_bgp && "The query should be prepared");
+	if(!solutions.reset(_bgp->variables(), _bgp->width()))
+		return false;
+	// The constants are resolved again on the modification, so the released ones are never
+	// referred, while the absent ones yield no solutions till they are stored
+	if(!_resolved || _epoch != _doc->epoch()) {
+		_epoch = _doc->epoch();
+		if(!(_resolved = resolve()))
+			return true;
+	}
+	if(_values.length())
+		memset(_values.begin(), 0, _values.length() * sizeof(const Term*));
+	for(unsigned i = 0; i < _params.length(); ++i) {
+		const Term* const  val = _values[_params[i]] = _doc->findTerm(*args[i]);
+		const ValueRange* const  range = _bgp->constraint(_params[i]);
+		if(!val || (range && !range->contains(*val)))
+			return true;
+	}
+
+	QuadIndex* index = _doc->quadIndex();
+	if(!index) {
+		// Note: the memory is insufficient for the index
+		Array<unsigned>  order;
+		if(!order.reserve(_steps.length()))
+			return false;
+		for(const Step& st: _steps)
+			order.add(st.pattern);
+		return _bgp->evaluate(*_doc, order, solutions, _values.begin());
+	}
+	Execution  ex = {*index, *_bgp, _steps.begin(), _steps.length(), _values.begin(), solutions,
+		false, nullptr, 0};
+#ifdef SMALLRDF_THREADS
+	if(pool && pool->workers() >= 2) {
+		// Note: the index is flushed by the lookup of the first step on the calling thread,
+		// so the workers only read it
+		Parallel  par(*pool, ex);
+		par.results = new Solutions[pool->workers() - 1];
+		if(!par.results)
+			return false;
+		for(unsigned i = 1; i < pool->workers(); ++i)
+			if(!par.solutions(i).reset(_bgp->variables(), _bgp->width()))
+				return false;
+		ex.par = &par;
+		pool->run(par);
+		// The solutions of the other workers are appended to the ones of the calling thread
+		bool  res = !ex.failed && !par.failed.load();
+		for(unsigned i = 1; i < pool->workers() && res; ++i) {
+			const Solutions&  sols = par.solutions(i);
+			for(unsigned r = 0; r < sols.length() && res; ++r)
+				res = solutions.add(sols.row(r));
+		}
+		return res;
+	}
+#endif  // SMALLRDF_THREADS
+	ex.step(0);
+	return !ex.failed;
+}
+
+// QueryCache ------------------------------------------------------------------
+struct QueryCache::Plan {
+	// Note: the members are released in the reverse order, so the query before its pattern
+	// and the pattern before its terms
+	Document terms;
+	BasicGraphPattern bgp;
+	PreparedQuery query;
+
+	Plan(): terms(), bgp(), query()  {}
+	~Plan();
+};
+
+QueryCache::Plan::~Plan()
+{
+}
+
+QueryCache::Compiler::~Compiler()
+{
+}
+
+QueryCache::QueryCache(Document& doc, Compiler& compiler, unsigned capacity)
+	: _doc(doc), _compiler(compiler), _index(), _entries(), _head(NONE), _tail(NONE),
+	_capacity(capacity), _hits(0), _misses(0)
+{
+	assert(capacity && "The capacity should be positive");
+}
+
+QueryCache::~QueryCache()
+{
+	clear();
+}
+
+void QueryCache::clear()
+{
+	for(const Entry& entry: _entries) {
+		delete entry.plan;
+		delete entry.text;
+	}
+	_entries.clear();
+	_index.clear();
+	_head = _tail = NONE;
+}
+
+void QueryCache::unlink(unsigned i)
+{
+	Entry&  entry = _entries[i];
+	if(entry.prev != NONE)
+		_entries[entry.prev].next = entry.next;
+	else _head = entry.next;
+	if(entry.next != NONE)
+		_entries[entry.next].prev = entry.prev;
+	else _tail = entry.prev;
+	entry.prev = entry.next = NONE;
+}
+
+void QueryCache::link(unsigned i)
+{
+	Entry&  entry = _entries[i];
+	entry.prev = NONE;
+	entry.next = _head;
+	if(_head != NONE)
+		_entries[_head].prev = i;
+	else _tail = i;
+	_head = i;
+}
+
+QueryCache::Plan* QueryCache::compile(const String& text)
+{
+	Plan* plan = new Plan();
+	if(!plan)
+		return nullptr;
+	Array<const Variable*>  params;
+	if(!_compiler.compile(text, plan->terms, plan->bgp, params)
+	|| !plan->query.prepare(_doc, plan->bgp, params.begin(), params.length())) {
+		delete plan;
+		return nullptr;
+	}
+	return plan;
+}
+
+PreparedQuery* QueryCache::query(const String& text)
+{
+	const unsigned* found = _index.find(&text);
+	if(found) {
+		++_hits;
+		if(*found != _head) {
+			unlink(*found);
+			link(*found);
+		}
+		return &_entries[*found].plan->query;
+	}
+
+	++_misses;
+	String* key = new String(text.c_str(), true);
+	Plan* plan = key && key->length() == text.length() ? compile(text) : nullptr;
+	if(!plan) {
+		delete key;
+		return nullptr;
+	}
+	unsigned  i = _entries.length();
+	if(i < _capacity) {
+		const Entry  entry = {key, plan, NONE, NONE};
+		if(!_entries.add(entry)) {
+			delete key;
+			delete plan;
+			return nullptr;
+		}
+	} else {
+		// Evict the least recently used query
+		i = _tail;
+		unlink(i);
+		Entry&  entry = _entries[i];
+		_index.remove(entry.text);
+		delete entry.plan;
+		delete entry.text;
+		entry.text = key;
+		entry.plan = plan;
+	}
+	// Note: the index does not grow on the replacement, so only the appended entry can fail
+	if(!_index.add(key, i)) {
+		_entries.pop();
+		delete key;
+		delete plan;
+		return nullptr;
+	}
+	link(i);
+	return &plan->query;
+}
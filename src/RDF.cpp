@@ -6,6 +6,13 @@
 #include <stdlib.h>  // malloc
 #include <assert.h>
 #include "RDF.hpp"
+#include "QuadIndex.h"
+#include "Statistics.h"
+#include "IriIndex.h"
+#include "LangIndex.h"
+#include "TextIndex.h"
+#include "ValueIndex.h"
+#include "Join.h"
 
 using namespace smallrdf;
 
@@ -155,8 +162,10 @@ String* String::release()
 String& String::operator+=(const String& other)
 {
 	size_t offs = length();
-	if(resize(length() + other.length()))
-		memcpy(_data + offs, other._data, other.length() + 1);  // Copy also the null-terminator
+	// Note: other might be this string, so its length is fetched before the resizing
+	size_t olen = other.length();
+	if(resize(offs + olen))
+		memcpy(_data + offs, other._data, olen);  // The null-terminator is set on resize
 	return *this;
 }
 
@@ -185,6 +194,16 @@ Literal::Literal(const String& val, const String* lang, const String* dtype)
 {
 }
 
+uint32_t Literal::hash() const
+{
+	uint32_t h = Term::hash();
+	if(lang)
+		h = hashData(lang->data(), lang->length(), h);
+	if(dtype)
+		h = hashData(dtype->data(), dtype->length(), h ^ '^');
+	return h;
+}
+
 bool Literal::operator==(const Term& other) const
 {
 	if(!Term::operator==(other))
@@ -199,6 +218,11 @@ BlankNode::BlankNode(const String& val)
 {
 }
 
+Variable::Variable(const String& name)
+	: Term(RTK_VARIABLE, name)
+{
+}
+
 Quad::Quad(const Term& subject, const Term& predicate,
            const Term& object, const Term* graph)
 	: subject(&subject),
@@ -235,10 +259,18 @@ bool Quad::match(const Term* subj, const Term* pred, const Term* obj, const Term
 		&& (!gr || graph == gr || (graph && *graph == *gr));
 }
 
+bool IriPrefix::matches(const Term& term, const String& prefix)
+{
+	return term.kind == RTK_NAMED_NODE && term.value->length() >= prefix.length()
+		&& !memcmp(term.value->data(), prefix.data(), prefix.length());
+}
+
+const unsigned  Dataset::COMPACT_RATIO;
+
 Quad* Dataset::find(const Quad& quad)
 {
 	for(Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next())
-		if ((**pit).match(quad.subject, quad.predicate, quad.object, quad.graph))
+		if ((**pit).match(quad.subject, quad.predicate, quad.object, quad.graph) && !removed(**pit))
 			return &**pit;
 	return nullptr;
 }
@@ -248,12 +280,166 @@ Dataset::Quads Dataset::match(const Term* subject, const Term* predicate,
 {
 	Quads matches;
 	for(Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next())
-		if((**pit).match(subject, predicate, object, graph))
+		if((**pit).match(subject, predicate, object, graph) && !removed(**pit))
 			matches.add(**pit);
 
 	return matches;  // Note: Return value optimization is used here
 }
 
+bool Dataset::traverse(QuadVisitor& visitor) const
+{
+	for(const Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next())
+		if(!removed(**pit) && !visitor(**pit))
+			return false;
+	return true;
+}
+
+bool Dataset::visit(const Quad& pattern, QuadVisitor& visitor)
+{
+	for(Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next())
+		if((**pit).match(pattern.subject, pattern.predicate, pattern.object, pattern.graph)
+		&& !removed(**pit) && !visitor(**pit))
+			return false;
+	return true;
+}
+
+namespace {
+
+//! \brief Visitor passing the quads, whose objects have the values within the range
+struct RangeFilter: QuadVisitor {
+	const ValueRange& range;
+	QuadVisitor& visitor;
+
+	RangeFilter(const ValueRange& irange, QuadVisitor& ivisitor)
+		: range(irange), visitor(ivisitor)  {}
+
+	bool operator()(const Quad& q) override
+		{ return !range.contains(*q.object) || visitor(q); }
+};
+
+//! \brief Visitor passing the quads, whose subjects and objects have the IRI prefixes
+struct PrefixFilter: QuadVisitor {
+	const IriPrefix& prefix;
+	QuadVisitor& visitor;
+
+	PrefixFilter(const IriPrefix& iprefix, QuadVisitor& ivisitor)
+		: prefix(iprefix), visitor(ivisitor)  {}
+
+	bool operator()(const Quad& q) override
+		{ return !prefix.matches(q) || visitor(q); }
+};
+
+}  // namespace
+
+bool Dataset::visit(const Quad& pattern, const ValueRange& range, QuadVisitor& visitor)
+{
+	RangeFilter  filter(range, visitor);
+	return visit(pattern, filter);
+}
+
+Dataset::Quads Dataset::match(const Quad& pattern, const IriPrefix& prefix)
+{
+	Quads matches;
+	QuadCopies  copies(matches);
+	visit(pattern, prefix, copies);
+	return matches;  // Note: Return value optimization is used here
+}
+
+bool Dataset::visit(const Quad& pattern, const IriPrefix& prefix, QuadVisitor& visitor)
+{
+	PrefixFilter  filter(prefix, visitor);
+	return visit(pattern, filter);
+}
+
+unsigned Dataset::count(const Quad& pattern)
+{
+	unsigned  num = 0;
+	for(Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next())
+		num += (**pit).match(pattern.subject, pattern.predicate, pattern.object, pattern.graph)
+			&& !removed(**pit);
+	return num;
+}
+
+bool Dataset::exists(const Quad& pattern)
+{
+	for(Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next())
+		if((**pit).match(pattern.subject, pattern.predicate, pattern.object, pattern.graph)
+		&& !removed(**pit))
+			return true;
+	return false;
+}
+
+namespace {
+
+//! \brief Predicate of the removed quads
+struct Tombstone {
+	const Hashset<const Quad*>& removed;
+
+	explicit Tombstone(const Hashset<const Quad*>& tombstones)
+		: removed(tombstones)  {}
+
+	bool operator()(const Quad& q) const
+		{ return removed.find(&q) != nullptr; }
+};
+
+}  // namespace
+
+unsigned Dataset::remove(const Quad& pattern)
+{
+	unsigned  num = 0;
+	for(Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next()) {
+		if(!(**pit).match(pattern.subject, pattern.predicate, pattern.object, pattern.graph))
+			continue;
+		bool  added;
+		if(!_removed.add(&**pit, &added))
+			break;  // Note: the memory is insufficient, so the remaining quads are retained
+		num += added;
+	}
+	if(num)
+		modified();
+	if(_removed.length() && _removed.length() * COMPACT_RATIO >= quads.length())
+		compact();
+	return num;
+}
+
+void Dataset::compact()
+{
+	if(!_removed.length())
+		return;
+	modified(quads.remove(Tombstone(_removed)));
+	_removed.clear();
+}
+
+Document::Document()
+	: Dataset(),
+	  _strings(),
+	  _namedNodes(),
+	  _literals(),
+	  _blankNodes(),
+	  _variables(),
+	  _stringIndex(),
+	  _termIndex(),
+	  _quadIndex(nullptr),
+	  _valueIndex(nullptr),
+	  _textIndex(nullptr),
+	  _iriIndex(nullptr),
+	  _langIndex(nullptr),
+	  _statistics(nullptr),
+	  _observer(nullptr),
+	  _pins()
+{
+}
+
+Document::~Document()
+{
+	delete _statistics;
+	delete _langIndex;
+	delete _iriIndex;
+	delete _textIndex;
+	delete _valueIndex;
+	delete _quadIndex;
+}
+
 const String* Document::string(String& str)
 {
 	const String* found = findString(str);
@@ -262,7 +448,21 @@ const String* Document::string(String& str)
 		return found;
 	}
 	// Note: acquire() fails only if memory is insufficient
-	return str.acquire() ? _strings.add(str) : nullptr;
+	if(!str.acquire())
+		return nullptr;
+	const String* res = _strings.add(str);
+	if(res && !_stringIndex.add(res))
+		return nullptr;
+	return res;
+}
+
+template<typename T>
+const T* Document::addTerm(Stack<T>& terms, const T& term)
+{
+	const T* res = terms.add(term);
+	if(res && !_termIndex.add(res))
+		return nullptr;
+	return res;
 }
 
 const NamedNode* Document::namedNode(const String& value)
@@ -271,8 +471,14 @@ const NamedNode* Document::namedNode(const String& value)
 	const Term* found = findTerm(cur);
 
 	if (found)
-		return reinterpret_cast<const NamedNode*>(found);
-	return reinterpret_cast<const NamedNode*>(_terms.add(cur));
+		return static_cast<const NamedNode*>(found);
+	const NamedNode* res = addTerm(_namedNodes, cur);
+	// The index is rebuilt on the next request if the memory is insufficient
+	if(res && _iriIndex && !_iriIndex->add(res)) {
+		delete _iriIndex;
+		_iriIndex = nullptr;
+	}
+	return res;
 }
 
 const Literal* Document::literal(const String& value,
@@ -283,8 +489,14 @@ const Literal* Document::literal(const String& value,
 	const Term* found = findTerm(cur);
 
 	if (found)
-		return reinterpret_cast<const Literal*>(found);
-	return reinterpret_cast<const Literal*>(_terms.add(cur));
+		return static_cast<const Literal*>(found);
+	const Literal* res = addTerm(_literals, cur);
+	// The index is rebuilt on the next request if the memory is insufficient
+	if(res && _textIndex && !_textIndex->add(res)) {
+		delete _textIndex;
+		_textIndex = nullptr;
+	}
+	return res;
 }
 
 const BlankNode* Document::blankNode(const String& value)
@@ -293,8 +505,18 @@ const BlankNode* Document::blankNode(const String& value)
 	const Term* found = findTerm(cur);
 
 	if (found)
-		return reinterpret_cast<const BlankNode*>(found);
-	return reinterpret_cast<const BlankNode*>(_terms.add(cur));
+		return static_cast<const BlankNode*>(found);
+	return addTerm(_blankNodes, cur);
+}
+
+const Variable* Document::variable(const String& name)
+{
+	const Variable cur(name);
+	const Term* found = findTerm(cur);
+
+	if (found)
+		return static_cast<const Variable*>(found);
+	return addTerm(_variables, cur);
 }
 
 const Quad* Document::quad(const Term& subject,
@@ -302,27 +524,715 @@ const Quad* Document::quad(const Term& subject,
                              const Term& object,
                              const Term* graph)
 {
-	return quads.add(Quad(subject, predicate, object, graph));
+	assert(findTerm(subject) == &subject && findTerm(predicate) == &predicate
+		&& findTerm(object) == &object && (!graph || findTerm(*graph) == graph)
+		&& "The quad terms should be stored in the document");
+	// Note: the quad is indexed lazily on the next lookup
+	const Quad* res = quads.add(Quad(subject, predicate, object, graph));
+	// Note: failed accounting is retried on the next statistics() request
+	if(res && _statistics)
+		_statistics->add(*res);
+	if(res && _observer)
+		(*_observer)(*res);
+	return res;
 }
 
-const String* Document::findString(const String& newStr) const
+const Term* Document::intern(const Term& term)
 {
-	for(const Strings::Iter* pit = _strings.begin(); pit != _strings.end(); pit = pit->next())
-		if (**pit == newStr)
-			return &**pit;
+	const Term* found = findTerm(term);
+	if(found)
+		return found;
+	// Note: the views become the stored strings, copying the absent ones
+	String  view;
+	view = *term.value;
+	const String* value = string(view);
+	if(!value)
+		return nullptr;
+	switch(term.kind) {
+	case RTK_NAMED_NODE:
+		return namedNode(*value);
+	case RTK_BLANK_NODE:
+		return blankNode(*value);
+	case RTK_LITERAL: {
+		const Literal& lit = static_cast<const Literal&>(term);
+		const String* lang = nullptr;
+		const String* dtype = nullptr;
+		if(lit.lang) {
+			view = *lit.lang;
+			if(!(lang = string(view)))
+				return nullptr;
+		}
+		if(lit.dtype) {
+			view = *lit.dtype;
+			if(!(dtype = string(view)))
+				return nullptr;
+		}
+		return literal(*value, lang, dtype);
+	}
+	case RTK_VARIABLE:
+		return variable(*value);
+	default:
+		assert(0 && "Invalid term kind");
+		return nullptr;
+	}
+}
 
-	return nullptr;
+namespace {
+
+//! \brief Quads order by the addresses of the interned terms, as in QuadIndex
+struct QuadLess {
+	static uintptr_t key(const Term* term)
+		{ return reinterpret_cast<uintptr_t>(term); }
+
+	bool operator()(const Quad& a, const Quad& b) const
+	{
+		if(a.subject != b.subject)
+			return key(a.subject) < key(b.subject);
+		if(a.predicate != b.predicate)
+			return key(a.predicate) < key(b.predicate);
+		if(a.object != b.object)
+			return key(a.object) < key(b.object);
+		return key(a.graph) < key(b.graph);
+	}
+};
+
+//! \brief Stored quad equal to the one of the interned terms
+//!
+//! \param index QuadIndex&  - synchronized index of the stored quads
+//! \param row const Quad&  - quad of the interned terms
+//! \param quad const Quad*&  - resulting stored quad; nullptr if it is absent
+//! \return bool  - whether the quad is looked up, otherwise the memory is insufficient
+bool findStored(QuadIndex& index, const Quad& row, const Quad*& quad)
+{
+	const Term* const  terms[4] = {row.subject, row.predicate, row.object, nullptr};
+	QuadIndex::Range  range;
+	quad = nullptr;
+	if(!index.range(terms, range))
+		return false;
+	const Quad* const*  pquad = range.beg;
+	while(pquad != range.end && !(QuadIndex::fits(**pquad, terms) && (*pquad)->graph == row.graph))
+		++pquad;
+	if(pquad != range.end)
+		quad = *pquad;
+	return true;
 }
 
-const Term* Document::findTerm(const Term& newTerm) const
+}  // namespace
+
+bool Document::internQuads(const Quad* batch, unsigned num, Array<Quad>& rows)
 {
-	for(const Terms::Iter* pit = _terms.begin(); pit != _terms.end(); pit = pit->next())
-		if (**pit == newTerm)
-			return &**pit;
+	if(!rows.reserve(rows.length() + num))
+		return false;
+	// Intern the terms, resolving each distinct term object once
+	Hashmap<const Term*, const Term*>  interned;
+	for(unsigned i = 0; i < num; ++i) {
+		const Term*  terms[4] = {batch[i].subject, batch[i].predicate, batch[i].object, batch[i].graph};
+		for(unsigned f = 0; f < 4; ++f) {
+			if(!terms[f])
+				continue;
+			const Term* const* cached = interned.find(terms[f]);
+			if(cached)
+				terms[f] = *cached;
+			else {
+				const Term* const  term = intern(*terms[f]);
+				if(!term || !interned.add(terms[f], term))
+					return false;
+				terms[f] = term;
+			}
+		}
+		rows.add(Quad(terms[0], terms[1], terms[2], terms[3]));
+	}
+	return true;
+}
+
+unsigned Document::insert(const Quad* batch, unsigned num, bool* failed)
+{
+	Array<Quad>  rows;
+	bool  res = internQuads(batch, num, rows);
+
+	// Drop the repeated quads of the batch and the ones present in the document
+	const QuadLess  less;
+	sort(rows.begin(), rows.end(), less);
+	QuadIndex* const  index = quads.length() ? quadIndex() : nullptr;
+	res = res && (index || !quads.length());
+	unsigned  stored = 0;
+	for(unsigned i = 0; i < rows.length() && res; ++i) {
+		const Quad&  row = rows[i];
+		if(i && !less(rows[i - 1], row))
+			continue;
+		if(index) {
+			const Quad*  found;
+			if(!findStored(*index, row, found)) {
+				res = false;
+				break;
+			}
+			if(found)
+				continue;
+		}
+		// Note: the index is synchronized before the lookups, so the stored quads are merged
+		// into it on the next lookup
+		const Quad* const  quad = quads.add(row);
+		if(!quad) {
+			res = false;
+			break;
+		}
+		++stored;
+		if(_statistics)
+			_statistics->add(*quad);
+		if(_observer)
+			(*_observer)(*quad);
+	}
+	if(failed)
+		*failed = !res;
+	return stored;
+}
+
+bool Document::commit(Changeset& changes, unsigned* inserted, unsigned* removed)
+{
+	if(inserted)
+		*inserted = 0;
+	if(removed)
+		*removed = 0;
+	// Note: the interned terms are not referred by the quads till the changes are applied
+	Array<Quad>  rows;
+	if(!internQuads(changes.inserts.begin(), changes.inserts.length(), rows))
+		return false;
+	QuadIndex* const  index = quads.length() ? quadIndex() : nullptr;
+	if(!index && quads.length())
+		return false;
+
+	// Select the removed quads among the stored ones
+	Hashset<const Quad*>  drops;
+	for(unsigned i = 0; i < changes.removals.length() && index; ++i) {
+		const Quad&  pattern = changes.removals[i];
+		const Term*  terms[4] = {pattern.subject, pattern.predicate, pattern.object, pattern.graph};
+		unsigned  f = 0;
+		while(f < 4 && (!terms[f] || (terms[f] = findTerm(*terms[f]))))
+			++f;
+		if(f < 4)
+			continue;  // The term is absent, so there are no matches
+		QuadIndex::Range  range;
+		if(!index->range(terms, range))
+			return false;
+		for(const Quad* const* pquad = range.beg; pquad != range.end; ++pquad)
+			if(QuadIndex::fits(**pquad, terms) && !drops.add(*pquad))
+				return false;
+	}
 
+	// Drop the repeated inserted quads and the stored ones, retaining the removed quads
+	// that are inserted back
+	const QuadLess  less;
+	sort(rows.begin(), rows.end(), less);
+	unsigned  num = 0;
+	for(unsigned i = 0; i < rows.length(); ++i) {
+		if(i && !less(rows[i - 1], rows[i]))
+			continue;
+		const Quad*  found = nullptr;
+		if(index && !findStored(*index, rows[i], found))
+			return false;
+		if(found)
+			drops.remove(found);
+		else rows[num++] = rows[i];
+	}
+	rows.resize(num);
+	// The tombstones are reserved, so the quads are never altered partially
+	if(!_removed.reserve(_removed.length() + drops.length()))
+		return false;
+	for(unsigned i = 0; i < num; ++i)
+		if(!quads.add(rows[i])) {
+			while(i--)
+				quads.pop();
+			return false;
+		}
+
+	// Note: the index is synchronized before the changes, so the stored quads are merged
+	// into it with the removals on the next lookup
+	bool  indexed = true;
+	for(unsigned i = 0; i < drops.capacity(); ++i) {
+		const Quad* const* pquad = drops.slot(i);
+		if(!pquad)
+			continue;
+		tombstone(**pquad);
+		indexed = indexed && index->remove(*pquad);
+	}
+	// The index is rebuilt on the next lookup if the memory is insufficient
+	if(!indexed)
+		index->clear();
+	if(drops.length())
+		modified();
+	if(inserted)
+		*inserted = num;
+	if(removed)
+		*removed = drops.length();
+	changes.clear();
+
+	// Account the group once it is applied; the stack prepends the quads, so the stored ones
+	// are leading and retain their positions when the observer stores the derived quads
+	Quads::Iter* const  head = quads.begin();
+	if(_statistics) {
+		Quads::Iter* pit = head;
+		for(unsigned i = 0; i < num; ++i, pit = pit->next())
+			if(!_statistics->add(**pit)) {
+				// The statistics are rebuilt on the next request
+				delete _statistics;
+				_statistics = nullptr;
+				break;
+			}
+	}
+	if(_observer) {
+		Quads::Iter* pit = head;
+		for(unsigned i = 0; i < num; ++i, pit = pit->next())
+			(*_observer)(**pit);
+	}
+	if(_removed.length() && _removed.length() * COMPACT_RATIO >= quads.length())
+		compact();
+	return true;
+}
+
+Quad* Document::find(const Quad& quad)
+{
+	QuadFinder  finder;
+	visit(quad, finder);
+	return finder.quad;
+}
+
+Dataset::Quads Document::match(const Term* subject, const Term* predicate,
+                               const Term* object, const Term* graph)
+{
+	Quads matches;
+	QuadCopies  copies(matches);
+	visit(Quad(subject, predicate, object, graph), copies);
+	return matches;
+}
+
+bool Document::visit(const Quad& pattern, QuadVisitor& visitor)
+{
+	// Resolve the pattern to the interned terms
+	const Term*  terms[4] = {pattern.subject, pattern.predicate, pattern.object, pattern.graph};
+	for(unsigned i = 0; i < 4; ++i)
+		if(terms[i] && !(terms[i] = findTerm(*terms[i])))
+			return true;  // The term is absent, so there are no matches
+
+	QuadIndex* index = quadIndex();
+	QuadIndex::Range  range;
+	if(!index || !index->range(terms, range))
+		return Dataset::visit(pattern, visitor);  // Note: the memory is insufficient for the index
+	for(const Quad* const* pquad = range.beg; pquad != range.end; ++pquad)
+		if(QuadIndex::fits(**pquad, terms) && !visitor(**pquad))
+			return false;
+	return true;
+}
+
+bool Document::visit(const Quad& pattern, const ValueRange& range, QuadVisitor& visitor)
+{
+	// The value index is scanned when the predicate is the only bound field except the graph,
+	// otherwise the bound subject is more selective
+	if(!pattern.predicate || pattern.subject || pattern.object)
+		return Dataset::visit(pattern, range, visitor);
+	const Term* const  predicate = findTerm(*pattern.predicate);
+	const Term* const  graph = pattern.graph ? findTerm(*pattern.graph) : nullptr;
+	if(!predicate || (pattern.graph && !graph))
+		return true;  // The term is absent, so there are no matches
+
+	ValueIndex* index = valueIndex();
+	ValueIndex::Range  entries;
+	if(!index || !index->range(predicate, range, entries))
+		return Dataset::visit(pattern, range, visitor);  // Note: the memory is insufficient for the index
+	for(const ValueIndex::Entry* entry = entries.beg; entry != entries.end; ++entry)
+		if((!graph || entry->quad->graph == graph) && !removed(*entry->quad) && !visitor(*entry->quad))
+			return false;
+	return true;
+}
+
+bool Document::visit(const Quad& pattern, const IriPrefix& prefix, QuadVisitor& visitor)
+{
+	const bool  subjects = prefix.subject && !pattern.subject;
+	const bool  objects = prefix.object && !pattern.object;
+	IriIndex* index = subjects || objects ? iriIndex() : nullptr;
+	IriIndex::Range  srange;
+	IriIndex::Range  orange;
+	if(!index || (subjects && !index->range(*prefix.subject, srange))
+	|| (objects && !index->range(*prefix.object, orange)))
+		return Dataset::visit(pattern, prefix, visitor);  // Note: the memory is insufficient for the index
+
+	// The prefixed named nodes of the smaller range are bound in turn, filtering the other field
+	const bool  bySubject = subjects && (!objects || srange.length() <= orange.length());
+	const IriIndex::Range&  range = bySubject ? srange : orange;
+	PrefixFilter  filter(prefix, visitor);
+	Quad  lookup(pattern);
+	for(const NamedNode* const* pnode = range.beg; pnode != range.end; ++pnode) {
+		(bySubject ? lookup.subject : lookup.object) = *pnode;
+		if(!visit(lookup, filter))
+			return false;
+	}
+	return true;
+}
+
+bool Document::visitText(const Quad& pattern, const String& text, QuadVisitor& visitor, bool prefix)
+{
+	const Term*  terms[4] = {pattern.subject, pattern.predicate, pattern.object, pattern.graph};
+	for(unsigned i = 0; i < 4; ++i)
+		if(terms[i] && !(terms[i] = findTerm(*terms[i])))
+			return true;  // The term is absent, so there are no matches
+	Quad  lookup(terms[0], terms[1], terms[2], terms[3]);
+
+	TextIndex* index = textIndex();
+	Array<const Literal*>  literals;
+	if(!index || !(prefix ? index->complete(text, literals) : index->search(text, literals)))
+		return false;
+	for(const Literal* literal: literals) {
+		if(terms[2] && terms[2] != literal)
+			continue;
+		lookup.object = literal;
+		if(!visit(lookup, visitor))
+			return false;
+	}
+	return true;
+}
+
+const Literal* Document::localized(const Term& subject, const Term& predicate, const String& lang)
+{
+	const Term* const  subj = findTerm(subject);
+	const Term* const  pred = findTerm(predicate);
+	if(!subj || !pred)
+		return nullptr;
+	LangIndex* index = langIndex();
+	LangIndex::Range  range;
+	if(!index || !index->lookup(subj, pred, lang, range))
+		return nullptr;
+	for(const LangIndex::Entry* entry = range.beg; entry != range.end; ++entry)
+		if(!removed(*entry->quad))
+			return static_cast<const Literal*>(entry->quad->object);
 	return nullptr;
 }
 
+unsigned Document::count(const Quad& pattern)
+{
+	const Term*  terms[4] = {pattern.subject, pattern.predicate, pattern.object, pattern.graph};
+	for(unsigned i = 0; i < 4; ++i)
+		if(terms[i] && !(terms[i] = findTerm(*terms[i])))
+			return 0;
+
+	QuadIndex* index = quadIndex();
+	QuadIndex::Range  range;
+	if(!index || !index->range(terms, range))
+		return Dataset::count(pattern);
+	if(QuadIndex::exact(range, terms))
+		return range.length();
+	unsigned  num = 0;
+	for(const Quad* const* pquad = range.beg; pquad != range.end; ++pquad)
+		num += QuadIndex::fits(**pquad, terms);
+	return num;
+}
+
+bool Document::exists(const Quad& pattern)
+{
+	return find(pattern) != nullptr;
+}
+
+bool Document::sorted(const Quad& pattern, unsigned field, JoinCursor& cursor)
+{
+	// Note: the graph is the last field of all permutations, so it can not precede the sorting field
+	if(pattern.graph)
+		return false;
+	const Term*  terms[4] = {pattern.subject, pattern.predicate, pattern.object, nullptr};
+	for(unsigned i = 0; i < 3; ++i)
+		if(terms[i] && !(terms[i] = findTerm(*terms[i]))) {
+			cursor = JoinCursor();  // The term is absent, so there are no matches
+			return true;
+		}
+
+	QuadIndex* index = quadIndex();
+	QuadIndex::Range  range;
+	if(!index || !index->sorted(terms, field, range))
+		return false;
+	cursor = JoinCursor(range, field);
+	return true;
+}
+
+unsigned Document::remove(const Quad& pattern)
+{
+	const Term*  terms[4] = {pattern.subject, pattern.predicate, pattern.object, pattern.graph};
+	for(unsigned i = 0; i < 4; ++i)
+		if(terms[i] && !(terms[i] = findTerm(*terms[i])))
+			return 0;  // The term is absent, so there are no matches
+
+	QuadIndex* index = quadIndex();
+	QuadIndex::Range  range;
+	unsigned  num = 0;
+	if(!index || !index->range(terms, range)) {
+		// Note: the memory is insufficient for the index, which is rebuilt skipping the tombstones
+		if(_quadIndex)
+			_quadIndex->clear();
+		for(Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next()) {
+			if(!QuadIndex::fits(**pit, terms) || removed(**pit))
+				continue;
+			if(!tombstone(**pit))
+				break;
+			++num;
+		}
+	} else {
+		bool  indexed = true;  // Whether the removals are buffered by the index
+		for(const Quad* const* pquad = range.beg; pquad != range.end; ++pquad) {
+			if(!QuadIndex::fits(**pquad, terms))
+				continue;
+			if(!tombstone(**pquad))
+				break;  // Note: the memory is insufficient, so the remaining quads are retained
+			++num;
+			// Note: the buffered removals do not alter the range
+			indexed = indexed && index->remove(*pquad);
+		}
+		// The index is rebuilt on the next lookup if the memory is insufficient
+		if(!indexed)
+			index->clear();
+	}
+	if(num)
+		modified();
+	if(_removed.length() && _removed.length() * COMPACT_RATIO >= quads.length())
+		compact();
+	return num;
+}
+
+bool Document::removeQuad(const Quad& quad)
+{
+	assert(!removed(quad) && "The quad is removed already");
+	// Note: the index is synchronized beforehand, so the removal is buffered consistently
+	QuadIndex* const  index = quadIndex();
+	if(!tombstone(quad))
+		return false;
+	// The index is rebuilt on the next lookup if the memory is insufficient
+	if(index && !index->remove(&quad))
+		index->clear();
+	modified();
+	if(_removed.length() * COMPACT_RATIO >= quads.length())
+		compact();
+	return true;
+}
+
+void Document::compact()
+{
+	if(!_removed.length())
+		return;
+	// The quad index refers the tombstones till their removal is merged
+	if(_quadIndex && !_quadIndex->flush())
+		_quadIndex->clear();
+	// The indices referring the released quads are rebuilt on the next request
+	delete _valueIndex;
+	_valueIndex = nullptr;
+	delete _langIndex;
+	_langIndex = nullptr;
+	Dataset::compact();
+}
+
+bool Document::tombstone(const Quad& quad)
+{
+	if(!_removed.add(&quad))
+		return false;
+	// Note: the statistics are rebuilt on the next request if the quad is not accounted
+	if(_statistics && !_statistics->remove(quad)) {
+		delete _statistics;
+		_statistics = nullptr;
+	}
+	if(_observer)
+		_observer->removed(quad);
+	return true;
+}
+
+namespace {
+
+//! \brief Predicate of the stored items not referred by anything, unindexing them
+template<typename T, typename Index>
+struct Unreferenced {
+	const Hashset<const T*>& used;
+	Index& index;
+
+	Unreferenced(const Hashset<const T*>& referred, Index& items)
+		: used(referred), index(items)  {}
+
+	bool operator()(const T& item) const
+	{
+		if(used.find(&item))
+			return false;
+		index.remove(&item);
+		return true;
+	}
+};
+
+}  // namespace
+
+bool Document::pin(const Term& term)
+{
+	assert(findTerm(term) == &term && "The term should be stored in the document");
+	unsigned* const  holders = _pins.add(&term, 0);
+	if(!holders)
+		return false;
+	++*holders;
+	return true;
+}
+
+void Document::unpin(const Term& term)
+{
+	unsigned* const  holders = _pins.find(&term);
+	assert(holders && "The term should be pinned");
+	if(holders && !--*holders)
+		_pins.remove(&term);
+}
+
+unsigned Document::reclaim()
+{
+	compact();
+	// Terms referred by the quads and the pinned ones
+	Hashset<const Term*>  terms;
+	for(unsigned i = 0; i < _pins.capacity(); ++i)
+		if(_pins.slot(i) && !terms.add(_pins.slot(i)->key))
+			return 0;
+	for(Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next()) {
+		const Quad&  quad = **pit;
+		if(!terms.add(quad.subject) || !terms.add(quad.predicate) || !terms.add(quad.object)
+		|| (quad.graph && !terms.add(quad.graph)))
+			return 0;
+	}
+	const Unreferenced<Term, TermIndex>  unusedTerm(terms, _termIndex);
+	const unsigned  num = _namedNodes.remove(unusedTerm) + _literals.remove(unusedTerm)
+		+ _blankNodes.remove(unusedTerm);
+	if(!num)
+		return 0;
+	// Note: the results referring the released terms are invalidated by the epoch
+	modified();
+	// The indices referring the released terms are rebuilt on the next request
+	delete _textIndex;
+	_textIndex = nullptr;
+	delete _iriIndex;
+	_iriIndex = nullptr;
+	delete _statistics;
+	_statistics = nullptr;
+
+	// Strings referred by the retained terms, including the variables
+	Hashset<const String*>  strings;
+	for(unsigned i = 0; i < _termIndex.capacity(); ++i) {
+		const Term* const* pterm = _termIndex.slot(i);
+		if(!pterm)
+			continue;
+		if(!strings.add((*pterm)->value))
+			return num;
+		if((*pterm)->kind != RTK_LITERAL)
+			continue;
+		const Literal&  lit = static_cast<const Literal&>(**pterm);
+		if((lit.lang && !strings.add(lit.lang)) || (lit.dtype && !strings.add(lit.dtype)))
+			return num;
+	}
+	_strings.remove(Unreferenced<String, StringIndex>(strings, _stringIndex));
+	return num;
+}
+
+const Statistics* Document::statistics()
+{
+	// The quads might be replaced
+	const unsigned  live = quads.length() - _removed.length();
+	if(_statistics && _statistics->length() > live) {
+		delete _statistics;
+		_statistics = nullptr;
+	}
+	if(!_statistics && !(_statistics = new Statistics()))
+		return nullptr;
+	// Account the quads added bypassing quad(), skipping the removed ones
+	for(Quads::Iter* pit = quads.begin(); _statistics->length() < live; pit = pit->next())
+		if(!removed(**pit) && !_statistics->add(**pit))
+			return nullptr;
+	return _statistics;
+}
+
+QuadIndex* Document::quadIndex()
+{
+	if(!_quadIndex && !(_quadIndex = new QuadIndex()))
+		return nullptr;
+	// Note: the removed quads are retained in the stack till the compaction
+	const unsigned  live = quads.length() - _removed.length();
+	// The quads might be replaced
+	if(_quadIndex->length() > live)
+		_quadIndex->clear();
+	// Note: the stack prepends the quads, so the new ones are leading, while the removed ones
+	// are met only on the rebuilding
+	for(Quads::Iter* pit = quads.begin(); _quadIndex->length() < live; pit = pit->next())
+		if(!removed(**pit) && !_quadIndex->add(&**pit)) {
+			_quadIndex->clear();
+			return nullptr;
+		}
+	return _quadIndex;
+}
+
+ValueIndex* Document::valueIndex()
+{
+	if(!_valueIndex && !(_valueIndex = new ValueIndex()))
+		return nullptr;
+	// The quads might be replaced
+	if(_valueIndex->observed() > quads.length())
+		_valueIndex->clear();
+	for(Quads::Iter* pit = quads.begin(); _valueIndex->observed() < quads.length(); pit = pit->next())
+		if(!_valueIndex->add(&**pit)) {
+			_valueIndex->clear();
+			return nullptr;
+		}
+	return _valueIndex;
+}
+
+TextIndex* Document::textIndex()
+{
+	if(_textIndex)
+		return _textIndex;
+	if(!(_textIndex = new TextIndex()))
+		return nullptr;
+	for(Literals::Iter* pit = _literals.begin(); pit != _literals.end(); pit = pit->next())
+		if(!_textIndex->add(&**pit)) {
+			delete _textIndex;
+			_textIndex = nullptr;
+			break;
+		}
+	return _textIndex;
+}
+
+IriIndex* Document::iriIndex()
+{
+	if(_iriIndex)
+		return _iriIndex;
+	if(!(_iriIndex = new IriIndex()))
+		return nullptr;
+	for(NamedNodes::Iter* pit = _namedNodes.begin(); pit != _namedNodes.end(); pit = pit->next())
+		if(!_iriIndex->add(&**pit)) {
+			delete _iriIndex;
+			_iriIndex = nullptr;
+			break;
+		}
+	return _iriIndex;
+}
+
+LangIndex* Document::langIndex()
+{
+	if(!_langIndex && !(_langIndex = new LangIndex()))
+		return nullptr;
+	// The quads might be replaced
+	if(_langIndex->observed() > quads.length())
+		_langIndex->clear();
+	for(Quads::Iter* pit = quads.begin(); _langIndex->observed() < quads.length(); pit = pit->next())
+		if(!_langIndex->add(&**pit)) {
+			_langIndex->clear();
+			return nullptr;
+		}
+	return _langIndex;
+}
+
+const String* Document::findString(const String& newStr) const
+{
+	const String* const* found = _stringIndex.find(&newStr);
+	return found ? *found : nullptr;
+}
+
+const Term* Document::findTerm(const Term& newTerm) const
+{
+	const Term* const* found = _termIndex.find(&newTerm);
+	return found ? *found : nullptr;
+}
+
 // Implementation of C interface ===============================================
 // String -------------------------------------------------------------------
 String* rdf_string_create(const uint8_t* data, size_t size)
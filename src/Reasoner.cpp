@@ -0,0 +1,218 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include "Reasoner.h"
+
+using namespace smallrdf;
+
+
+namespace {
+
+const char* const  VOCABULARY[] = {
+	"http://www.w3.org/1999/02/22-rdf-syntax-ns#type",
+	"http://www.w3.org/2000/01/rdf-schema#subClassOf",
+	"http://www.w3.org/2000/01/rdf-schema#subPropertyOf",
+	"http://www.w3.org/2000/01/rdf-schema#domain",
+	"http://www.w3.org/2000/01/rdf-schema#range"
+};
+
+}  // namespace
+
+uint32_t Reasoner::QuadHash::hash(const Quad& quad)
+{
+	return hashMix(hashBits(quad.subject) * 31 + hashBits(quad.predicate)) * 31
+		^ hashMix(hashBits(quad.object) * 31 + hashBits(quad.graph));
+}
+
+Reasoner::Reasoner(Document& doc)
+	: _doc(doc), _vocab(), _delta(), _derived(), _candidates(), _inferred(),
+	_running(false), _stale(false), _failed(false)
+{
+	// The vocabulary is pinned, so it is retained on the reclamation of the unused terms
+	for(unsigned i = 0; i < RV_NUM; ++i) {
+		const String* iri = doc.string(String(VOCABULARY[i]));
+		const Term* const  term = iri ? doc.namedNode(*iri) : nullptr;
+		if(!term || !doc.pin(*term)) {
+			_failed = true;
+			return;
+		}
+		_vocab[i] = term;
+	}
+	doc.observe(this);
+	// The stored quads form the initial delta
+	for(Document::Quads::Iter* pit = doc.quads.begin(); pit != doc.quads.end(); pit = pit->next())
+		if(!doc.removed(**pit) && !_delta.add(&**pit)) {
+			_failed = true;
+			break;
+		}
+	materialize();
+}
+
+Reasoner::~Reasoner()
+{
+	for(const Term* term: _vocab)
+		if(term)
+			_doc.unpin(*term);
+	if(_doc.observer() == this)
+		_doc.observe(nullptr);
+}
+
+bool Reasoner::operator()(const Quad& quad)
+{
+	if(!_delta.add(&quad))
+		_failed = true;
+	materialize();
+	return true;
+}
+
+void Reasoner::removed(const Quad& quad)
+{
+	_stale = true;
+	_inferred.remove(&quad);
+	// Note: the delta is pending only if the quad is removed while materializing
+	unsigned  num = 0;
+	for(const Quad* q: _delta)
+		if(q != &quad)
+			_delta[num++] = q;
+	_delta.resize(num);
+}
+
+bool Reasoner::retract()
+{
+	if(!_stale && !_failed)
+		return true;
+	// The removal notifications release the inferred quads
+	Array<const Quad*>  inferred;
+	if(!inferred.reserve(_inferred.length()))
+		return false;
+	for(unsigned i = 0; i < _inferred.capacity(); ++i)
+		if(_inferred.slot(i))
+			inferred.add(*_inferred.slot(i));
+	for(const Quad* quad: inferred)
+		if(!_doc.removeQuad(*quad))
+			return false;
+
+	// The remaining quads form the initial delta as on the attachment
+	_failed = false;
+	for(Document::Quads::Iter* pit = _doc.quads.begin(); pit != _doc.quads.end(); pit = pit->next())
+		if(!_doc.removed(**pit) && !_delta.add(&**pit)) {
+			_failed = true;
+			break;
+		}
+	materialize();
+	_stale = false;
+	return !_failed;
+}
+
+bool Reasoner::Asserted::operator()(const Quad& quad)
+{
+	return _reasoner.inferred(quad) || _visitor(quad);
+}
+
+void Reasoner::materialize()
+{
+	if(_running)
+		return;
+	_running = true;
+	while(_delta.length()) {
+		// Derive all quads of the round before storing them, so the index is updated once
+		_derived.clear();
+		_candidates.clear();
+		for(const Quad* quad: _delta)
+			if(!derive(*quad))
+				_failed = true;
+		_delta.clear();
+		// The stored quads are observed as the next delta
+		for(const Quad& quad: _derived) {
+			const Quad* res = _doc.quad(*quad.subject, *quad.predicate, *quad.object, quad.graph);
+			if(!res || !_inferred.add(res))
+				_failed = true;
+		}
+	}
+	_running = false;
+}
+
+bool Reasoner::lookup(const Quad& pattern, Array<const Quad*>& matches)
+{
+	matches.clear();
+	QuadRefs  refs(matches);
+	_doc.visit(pattern, refs);
+	return !refs.failed;
+}
+
+bool Reasoner::infer(const Term* subject, const Term* predicate, const Term* object, const Term* graph)
+{
+	// Literals are not valid subjects (e.g. the range of a datatype property)
+	if(subject->kind == RTK_LITERAL)
+		return true;
+	// Note: the triples stored in any graph are not duplicated
+	const Quad  quad(subject, predicate, object, graph);
+	if(_candidates.find(quad) || _doc.exists(Quad(subject, predicate, object)))
+		return true;
+	return _candidates.add(quad) && _derived.add(quad);
+}
+
+bool Reasoner::derive(const Quad& quad)
+{
+	const Term* const  type = _vocab[RV_TYPE];
+	const Term* const  subclass = _vocab[RV_SUBCLASS];
+	const Term* const  subproperty = _vocab[RV_SUBPROPERTY];
+	const Term* const  s = quad.subject;
+	const Term* const  p = quad.predicate;
+	const Term* const  o = quad.object;
+	const Term* const  g = quad.graph;
+	Array<const Quad*>  matches;
+	bool  res = true;
+
+	// The quad as an instance of its predicate: rdfs7, rdfs2, rdfs3
+	res = res && lookup(Quad(p, subproperty), matches);
+	for(const Quad* m: matches)
+		res = res && infer(s, m->object, o, g);
+	res = res && lookup(Quad(p, _vocab[RV_DOMAIN]), matches);
+	for(const Quad* m: matches)
+		res = res && infer(s, type, m->object, g);
+	res = res && lookup(Quad(p, _vocab[RV_RANGE]), matches);
+	for(const Quad* m: matches)
+		res = res && infer(o, type, m->object, g);
+
+	// The quad as a schema statement
+	if(p == type) {
+		// rdfs9
+		res = res && lookup(Quad(o, subclass), matches);
+		for(const Quad* m: matches)
+			res = res && infer(s, type, m->object, g);
+	} else if(p == subclass) {
+		// rdfs9, rdfs11 in both directions
+		res = res && lookup(Quad(nullptr, type, s), matches);
+		for(const Quad* m: matches)
+			res = res && infer(m->subject, type, o, g);
+		res = res && lookup(Quad(o, subclass), matches);
+		for(const Quad* m: matches)
+			res = res && infer(s, subclass, m->object, g);
+		res = res && lookup(Quad(nullptr, subclass, s), matches);
+		for(const Quad* m: matches)
+			res = res && infer(m->subject, subclass, o, g);
+	} else if(p == subproperty) {
+		// rdfs7, rdfs5 in both directions
+		res = res && lookup(Quad(nullptr, s), matches);
+		for(const Quad* m: matches)
+			res = res && infer(m->subject, o, m->object, g);
+		res = res && lookup(Quad(o, subproperty), matches);
+		for(const Quad* m: matches)
+			res = res && infer(s, subproperty, m->object, g);
+		res = res && lookup(Quad(nullptr, subproperty, s), matches);
+		for(const Quad* m: matches)
+			res = res && infer(m->subject, subproperty, o, g);
+	} else if(p == _vocab[RV_DOMAIN]) {
+		// rdfs2
+		res = res && lookup(Quad(nullptr, s), matches);
+		for(const Quad* m: matches)
+			res = res && infer(m->subject, type, o, g);
+	} else if(p == _vocab[RV_RANGE]) {
+		// rdfs3
+		res = res && lookup(Quad(nullptr, s), matches);
+		for(const Quad* m: matches)
+			res = res && infer(m->object, type, o, g);
+	}
+	return res;
+}
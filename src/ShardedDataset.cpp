@@ -0,0 +1,387 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <assert.h>
+
+#include "QuadIndex.h"
+#include "ShardedDataset.h"
+
+#ifdef SMALLRDF_THREADS
+#include "TaskPool.h"
+#endif  // SMALLRDF_THREADS
+
+using namespace smallrdf;
+
+
+namespace {
+
+//! \brief Collector of the matching quads of a shard
+struct QuadMatches: QuadVisitor {
+	Array<const Quad*> quads;
+	bool complete;  //!< Whether all matches are collected, otherwise the memory is insufficient
+
+	QuadMatches(): quads(), complete(true)  {}
+
+	bool operator()(const Quad& q) override
+		{ return complete = quads.add(&q); }
+};
+
+//! \brief Predicate of the quads fitting the pattern
+struct QuadFit {
+	const Term* const* terms;
+
+	explicit QuadFit(const Term* const pattern[4])
+		: terms(pattern)  {}
+
+	bool operator()(const Quad& q) const
+		{ return QuadIndex::fits(q, terms); }
+};
+
+#ifdef SMALLRDF_THREADS
+//! \brief Task applying the operation to a shard
+template<typename Op>
+struct ShardTask: Task {
+	Op& op;
+	unsigned shard;
+
+	ShardTask(Op& iop, unsigned ishard)
+		: op(iop), shard(ishard)  {}
+
+	void operator()(TaskPool&, unsigned) override
+		{ op(shard); }
+};
+
+//! \brief Root task spawning the tasks of the shards, which processes the first shard itself
+template<typename Op>
+struct ShardsTask: Task {
+	Op& op;
+	unsigned num;  //!< Number of the shards
+
+	ShardsTask(Op& iop, unsigned inum)
+		: op(iop), num(inum)  {}
+
+	void operator()(TaskPool& pool, unsigned worker) override
+	{
+		for(unsigned i = 1; i < num; ++i) {
+			ShardTask<Op>* const  task = new ShardTask<Op>(op, i);
+			// Note: the shard is processed by the calling thread if the memory is insufficient
+			if(!task || !pool.spawn(worker, task)) {
+				delete task;
+				op(i);
+			}
+		}
+		op(0);
+	}
+};
+#endif  // SMALLRDF_THREADS
+
+}  // namespace
+
+// ShardedDataset::Shard -------------------------------------------------------
+//! \brief Partition of the quads with its lazily synchronized index
+struct ShardedDataset::Shard {
+	Quads quads;
+	QuadIndex index;
+
+	Shard(): quads(), index()  {}
+
+    //! \brief Index the quads stored since the former synchronization
+    //!
+    //! \return bool  - whether the index is synchronized, otherwise the memory is insufficient
+	bool sync();
+    //! \brief Visit the quads matching the pattern of the interned terms
+    //!
+    //! \param terms const Term* const[4]  - pattern terms, nullptr matches any term
+    //! \param visitor QuadVisitor&  - visitor of the matching quads
+    //! \return bool  - whether all matches are visited, otherwise stopped by the visitor
+	bool visit(const Term* const terms[4], QuadVisitor& visitor);
+	unsigned count(const Term* const terms[4]);
+    //! \brief Remove and release the quads matching the pattern of the interned terms
+    //!
+    //! \param terms const Term* const[4]  - pattern terms, nullptr matches any term
+    //! \return unsigned  - number of the removed quads
+	unsigned remove(const Term* const terms[4]);
+};
+
+bool ShardedDataset::Shard::sync()
+{
+	// The quads are prepended, so the new ones precede the indexed ones
+	unsigned  num = quads.length() - index.length();
+	for(Quads::Iter* pit = quads.begin(); num && pit != quads.end(); pit = pit->next(), --num)
+		if(!index.add(&**pit)) {
+			index.clear();
+			return false;
+		}
+	return true;
+}
+
+bool ShardedDataset::Shard::visit(const Term* const terms[4], QuadVisitor& visitor)
+{
+	QuadIndex::Range  range;
+	if(!sync() || !index.range(terms, range)) {
+		// Note: the memory is insufficient for the index
+		for(Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next())
+			if(QuadIndex::fits(**pit, terms) && !visitor(**pit))
+				return false;
+		return true;
+	}
+	for(const Quad* const* pquad = range.beg; pquad != range.end; ++pquad)
+		if(QuadIndex::fits(**pquad, terms) && !visitor(**pquad))
+			return false;
+	return true;
+}
+
+unsigned ShardedDataset::Shard::count(const Term* const terms[4])
+{
+	unsigned  num = 0;
+	QuadIndex::Range  range;
+	if(!sync() || !index.range(terms, range)) {
+		for(Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next())
+			num += QuadIndex::fits(**pit, terms);
+		return num;
+	}
+	if(QuadIndex::exact(range, terms))
+		return range.length();
+	for(const Quad* const* pquad = range.beg; pquad != range.end; ++pquad)
+		num += QuadIndex::fits(**pquad, terms);
+	return num;
+}
+
+unsigned ShardedDataset::Shard::remove(const Term* const terms[4])
+{
+	// The removal is merged into the index before the quads are released
+	QuadIndex::Range  range;
+	bool  indexed = sync() && index.range(terms, range);
+	if(indexed)
+		for(const Quad* const* pquad = range.beg; indexed && pquad != range.end; ++pquad)
+			if(QuadIndex::fits(**pquad, terms))
+				indexed = index.remove(*pquad);
+	// Note: the index is rebuilt on the next lookup if the memory is insufficient
+	if(!indexed || !index.flush())
+		index.clear();
+	return quads.remove(QuadFit(terms));
+}
+
+// ShardedDataset --------------------------------------------------------------
+const unsigned  ShardedDataset::PARALLEL_QUADS_MIN;
+
+ShardedDataset::ShardedDataset(unsigned shards)
+	: Dataset(), _terms(), _shards(nullptr), _num(0)
+#ifdef SMALLRDF_THREADS
+	, _pool(nullptr)
+#endif  // SMALLRDF_THREADS
+{
+	if(!shards) {
+#ifdef SMALLRDF_THREADS
+		shards = std::thread::hardware_concurrency();
+#endif  // SMALLRDF_THREADS
+		if(!shards)
+			shards = 1;
+	}
+	_shards = new Shard[shards];
+	if(_shards)
+		_num = shards;
+}
+
+ShardedDataset::~ShardedDataset()
+{
+#ifdef SMALLRDF_THREADS
+	delete _pool;
+#endif  // SMALLRDF_THREADS
+	delete[] _shards;
+}
+
+unsigned ShardedDataset::length() const
+{
+	unsigned  num = 0;
+	for(unsigned i = 0; i < _num; ++i)
+		num += _shards[i].quads.length();
+	return num;
+}
+
+bool ShardedDataset::traverse(QuadVisitor& visitor) const
+{
+	for(unsigned i = 0; i < _num; ++i)
+		for(const Quads::Iter* pit = _shards[i].quads.begin(); pit != _shards[i].quads.end(); pit = pit->next())
+			if(!visitor(**pit))
+				return false;
+	return true;
+}
+
+unsigned ShardedDataset::shardLength(unsigned shard) const
+{
+	assert(shard < _num && "The shard is out of range");
+	return _shards[shard].quads.length();
+}
+
+const Quad* ShardedDataset::quad(const Term& subject, const Term& predicate,
+	const Term& object, const Term* graph)
+{
+	assert(_terms.findTerm(subject) == &subject && _terms.findTerm(predicate) == &predicate
+		&& _terms.findTerm(object) == &object && (!graph || _terms.findTerm(*graph) == graph)
+		&& "The quad terms should be interned in the dataset");
+	if(!_num)
+		return nullptr;
+	const Quad* res = _shards[shard(subject)].quads.add(Quad(subject, predicate, object, graph));
+	if(res)
+		modified();
+	return res;
+}
+
+bool ShardedDataset::resolve(const Quad& pattern, const Term* terms[4]) const
+{
+	terms[0] = pattern.subject;
+	terms[1] = pattern.predicate;
+	terms[2] = pattern.object;
+	terms[3] = pattern.graph;
+	for(unsigned i = 0; i < 4; ++i)
+		if(terms[i] && !(terms[i] = _terms.findTerm(*terms[i])))
+			return false;
+	return true;
+}
+
+template<typename Op>
+void ShardedDataset::each(Op op)
+{
+#ifdef SMALLRDF_THREADS
+	// Each shard is processed by a single worker of the pool retained by the dataset,
+	// the calling thread processes the first one
+	if(_num >= 2 && length() >= PARALLEL_QUADS_MIN) {
+		if(!_pool && (_pool = new TaskPool(_num)) && !_pool->valid()) {
+			delete _pool;
+			_pool = nullptr;
+		}
+		if(_pool) {
+			ShardsTask<Op>  root(op, _num);
+			_pool->run(root);
+			return;
+		}
+	}
+#endif  // SMALLRDF_THREADS
+	for(unsigned i = 0; i < _num; ++i)
+		op(i);
+}
+
+Quad* ShardedDataset::find(const Quad& quad)
+{
+	QuadFinder  finder;
+	visit(quad, finder);
+	return finder.quad;
+}
+
+Dataset::Quads ShardedDataset::match(const Term* subject, const Term* predicate,
+	const Term* object, const Term* graph)
+{
+	Quads  matches;
+	QuadCopies  copies(matches);
+	visit(Quad(subject, predicate, object, graph), copies);
+	return matches;  // Note: Return value optimization is used here
+}
+
+bool ShardedDataset::visit(const Quad& pattern, QuadVisitor& visitor)
+{
+	const Term*  terms[4];
+	if(!_num || !resolve(pattern, terms))
+		return true;  // The term is absent, so there are no matches
+	// The bound subject resides in a single shard
+	if(terms[0])
+		return _shards[shard(*terms[0])].visit(terms, visitor);
+
+	// The shards are matched independently and their matches are merged by the calling thread
+	QuadMatches* const  matches = new QuadMatches[_num];
+	if(!matches) {
+		for(unsigned i = 0; i < _num; ++i)
+			if(!_shards[i].visit(terms, visitor))
+				return false;
+		return true;
+	}
+	Shard* const  shards = _shards;
+	each([shards, &terms, matches](unsigned i) {
+		shards[i].visit(terms, matches[i]);
+	});
+	bool  res = true;
+	for(unsigned i = 0; res && i < _num; ++i) {
+		if(!matches[i].complete) {
+			// Note: the memory is insufficient for the matches, so the shard is revisited
+			res = _shards[i].visit(terms, visitor);
+			continue;
+		}
+		for(const Quad* quad: matches[i].quads)
+			if(!(res = visitor(*quad)))
+				break;
+	}
+	delete[] matches;
+	return res;
+}
+
+unsigned ShardedDataset::count(const Quad& pattern)
+{
+	const Term*  terms[4];
+	if(!_num || !resolve(pattern, terms))
+		return 0;
+	if(terms[0])
+		return _shards[shard(*terms[0])].count(terms);
+
+	unsigned* const  counts = new unsigned[_num];
+	if(!counts) {
+		unsigned  num = 0;
+		for(unsigned i = 0; i < _num; ++i)
+			num += _shards[i].count(terms);
+		return num;
+	}
+	Shard* const  shards = _shards;
+	each([shards, &terms, counts](unsigned i) {
+		counts[i] = shards[i].count(terms);
+	});
+	unsigned  num = 0;
+	for(unsigned i = 0; i < _num; ++i)
+		num += counts[i];
+	delete[] counts;
+	return num;
+}
+
+bool ShardedDataset::exists(const Quad& pattern)
+{
+	const Term*  terms[4];
+	if(!_num || !resolve(pattern, terms))
+		return false;
+	QuadFinder  finder;
+	if(terms[0]) {
+		_shards[shard(*terms[0])].visit(terms, finder);
+		return finder.quad;
+	}
+
+	// Each shard stops at its first match instead of collecting all of them
+	uint8_t* const  found = new uint8_t[_num];
+	if(!found) {
+		for(unsigned i = 0; i < _num && !finder.quad; ++i)
+			_shards[i].visit(terms, finder);
+		return finder.quad;
+	}
+	Shard* const  shards = _shards;
+	each([shards, &terms, found](unsigned i) {
+		QuadFinder  first;
+		shards[i].visit(terms, first);
+		found[i] = first.quad != nullptr;
+	});
+	bool  res = false;
+	for(unsigned i = 0; !res && i < _num; ++i)
+		res = found[i];
+	delete[] found;
+	return res;
+}
+
+unsigned ShardedDataset::remove(const Quad& pattern)
+{
+	const Term*  terms[4];
+	if(!_num || !resolve(pattern, terms))
+		return 0;  // The term is absent, so there are no matches
+	unsigned  num = 0;
+	if(terms[0])
+		num = _shards[shard(*terms[0])].remove(terms);
+	else for(unsigned i = 0; i < _num; ++i)
+		num += _shards[i].remove(terms);
+	if(num)
+		modified();
+	return num;
+}
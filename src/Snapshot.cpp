@@ -0,0 +1,697 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif  // __unix__ || __APPLE__
+
+#include "Snapshot.h"
+
+using namespace smallrdf;
+
+typedef Snapshot::Id  Id;
+
+static const uint8_t  MAGIC[4] = {'S', 'R', 'D', 'S'};
+static const uint32_t  VERSION = 1;
+
+// Orders of the quad fields in the indices
+static const uint8_t  SPOG[4] = {0, 1, 2, 3};
+static const uint8_t  POSG[4] = {1, 2, 0, 3};
+static const uint8_t  OSPG[4] = {2, 0, 1, 3};
+
+static inline size_t align8(size_t size)
+{
+	return (size + 7) & ~size_t(7);
+}
+
+static int compare(const uint8_t* a, size_t alen, const uint8_t* b, size_t blen)
+{
+	const int  res = memcmp(a, b, alen < blen ? alen : blen);
+	return res ? res : (alen > blen) - (alen < blen);
+}
+
+// Building --------------------------------------------------------------------
+namespace {
+
+struct StringLess {
+	const Array<const String*>& strings;
+
+	bool operator()(Id a, Id b) const
+	{
+		const String& sa = *strings[a];
+		const String& sb = *strings[b];
+		return compare(sa.data(), sa.length(), sb.data(), sb.length()) < 0;
+	}
+};
+
+struct TermLess {
+	const Array<Snapshot::TermEntry>& terms;
+
+	bool operator()(Id a, Id b) const
+		{ return less(terms[a], terms[b]); }
+
+	static bool less(const Snapshot::TermEntry& a, const Snapshot::TermEntry& b)
+	{
+		if(a.kind != b.kind)
+			return a.kind < b.kind;
+		if(a.value != b.value)
+			return a.value < b.value;
+		if(a.lang != b.lang)
+			return a.lang < b.lang;
+		return a.dtype < b.dtype;
+	}
+};
+
+struct QuadLess {
+	const Snapshot::QuadEntry* quads;
+	const uint8_t* order;
+
+	bool operator()(Id a, Id b) const
+		{ return less(quads[a], quads[b], order); }
+
+	static bool less(const Snapshot::QuadEntry& a, const Snapshot::QuadEntry& b, const uint8_t* order)
+	{
+		for(unsigned i = 0; i < 4; ++i)
+			if(a.terms[order[i]] != b.terms[order[i]])
+				return a.terms[order[i]] < b.terms[order[i]];
+		return false;
+	}
+};
+
+struct QuadEntryLess {
+	bool operator()(const Snapshot::QuadEntry& a, const Snapshot::QuadEntry& b) const
+		{ return QuadLess::less(a, b, SPOG); }
+};
+
+//! \brief Dictionary of the dataset being imaged
+struct Dictionary {
+	typedef Hashmap<const String*, Id, ContentHash<const String*> >  StringIds;
+	typedef Hashmap<const Term*, Id, ContentHash<const Term*> >  TermIds;
+
+	StringIds stringIds;
+	Array<const String*> strings;
+	TermIds termIds;
+	Array<const Term*> terms;
+
+	Dictionary();
+	~Dictionary();
+
+	bool addString(const String* str, Id& id)
+	{
+		if(!str) {
+			id = Snapshot::NONE;
+			return true;
+		}
+		bool added;
+		const Id* pid = stringIds.add(str, strings.length(), &added);
+		if(!pid || (added && !strings.add(str)))
+			return false;
+		id = *pid;
+		return true;
+	}
+
+	bool addTerm(const Term* term, Id& id)
+	{
+		if(!term) {
+			id = Snapshot::NONE;
+			return true;
+		}
+		assert(term->kind != RTK_VARIABLE && "Variables can not be stored in the snapshot");
+		bool added;
+		const Id* pid = termIds.add(term, terms.length(), &added);
+		if(!pid || (added && !terms.add(term)))
+			return false;
+		id = *pid;
+		Id sid;
+		if(added && !addString(term->value, sid))
+			return false;
+		if(added && term->kind == RTK_LITERAL) {
+			const Literal& literal = static_cast<const Literal&>(*term);
+			if(!addString(literal.lang, sid) || !addString(literal.dtype, sid))
+				return false;
+		}
+		return true;
+	}
+};
+
+Dictionary::Dictionary()
+	: stringIds(), strings(), termIds(), terms()  {}
+
+Dictionary::~Dictionary()  {}
+
+//! \brief Ranks of the items sorted by the comparator
+template<typename Less>
+bool rank(unsigned num, Less less, Array<Id>& order, Array<Id>& ranks)
+{
+	if(!order.resize(num) || !ranks.resize(num))
+		return false;
+	for(Id i = 0; i < num; ++i)
+		order[i] = i;
+	sort(order.begin(), order.end(), less);
+	for(Id i = 0; i < num; ++i)
+		ranks[order[i]] = i;
+	return true;
+}
+
+}  // namespace
+
+bool Snapshot::build(const Dataset& dataset, String*& storage)
+{
+	// Collect the strings and terms
+	Dictionary  dict;
+	Array<const Quad*>  refs;
+	QuadRefs  collector(refs);
+	if(!refs.reserve(dataset.length()) || !dataset.traverse(collector))
+		return false;
+	Array<QuadEntry>  quads;
+	if(!quads.resize(refs.length()))
+		return false;
+	QuadEntry* pquad = quads.begin();
+	for(const Quad* const* pref = refs.begin(); pref != refs.end(); ++pref) {
+		const Quad& quad = **pref;
+		if(!dict.addTerm(quad.subject, pquad->terms[0]) || !dict.addTerm(quad.predicate, pquad->terms[1])
+		|| !dict.addTerm(quad.object, pquad->terms[2]) || !dict.addTerm(quad.graph, pquad->terms[3]))
+			return false;
+		++pquad;
+	}
+
+	// Sort the strings and terms, replacing their ids with the ranks
+	Array<Id>  order;
+	Array<Id>  stringRanks;
+	const StringLess  sless = {dict.strings};
+	if(!rank(dict.strings.length(), sless, order, stringRanks))
+		return false;
+	Array<const String*>  strings;
+	if(!strings.resize(order.length()))
+		return false;
+	for(Id i = 0; i < order.length(); ++i)
+		strings[i] = dict.strings[order[i]];
+
+	Array<TermEntry>  terms;
+	if(!terms.resize(dict.terms.length()))
+		return false;
+	for(Id i = 0; i < dict.terms.length(); ++i) {
+		const Term& term = *dict.terms[i];
+		TermEntry& entry = terms[i];
+		entry.kind = term.kind;
+		entry.value = stringRanks[*dict.stringIds.find(term.value)];
+		entry.lang = entry.dtype = NONE;
+		if(term.kind == RTK_LITERAL) {
+			const Literal& literal = static_cast<const Literal&>(term);
+			if(literal.lang)
+				entry.lang = stringRanks[*dict.stringIds.find(literal.lang)];
+			if(literal.dtype)
+				entry.dtype = stringRanks[*dict.stringIds.find(literal.dtype)];
+		}
+	}
+	Array<Id>  termRanks;
+	const TermLess  tless = {terms};
+	if(!rank(terms.length(), tless, order, termRanks))
+		return false;
+
+	for(QuadEntry* pq = quads.begin(); pq != quads.end(); ++pq)
+		for(unsigned i = 0; i < 4; ++i)
+			if(pq->terms[i] != NONE)
+				pq->terms[i] = termRanks[pq->terms[i]];
+	sort(quads.begin(), quads.end(), QuadEntryLess());
+
+	Array<Id>  pos;
+	Array<Id>  osp;
+	if(!pos.resize(quads.length()) || !osp.resize(quads.length()))
+		return false;
+	for(Id i = 0; i < quads.length(); ++i)
+		pos[i] = osp[i] = i;
+	const QuadLess  posLess = {quads.begin(), POSG};
+	sort(pos.begin(), pos.end(), posLess);
+	const QuadLess  ospLess = {quads.begin(), OSPG};
+	sort(osp.begin(), osp.end(), ospLess);
+
+	// Layout of the image
+	Header  hdr;
+	memcpy(hdr.magic, MAGIC, sizeof MAGIC);
+	hdr.version = VERSION;
+	size_t size = align8(sizeof hdr);
+	hdr.strings = strings.length();
+	hdr.stringOffsets = size;
+	size = align8(size + sizeof(Id) * (strings.length() + 1));
+	hdr.stringBlob = size;
+	for(const String* const* pstr = strings.begin(); pstr != strings.end(); ++pstr)
+		size += (*pstr)->length() + 1;
+	size = align8(size);
+	hdr.terms = terms.length();
+	hdr.termTable = size;
+	size += sizeof(TermEntry) * terms.length();
+	hdr.quads = quads.length();
+	hdr.quadTable = size;
+	size += sizeof(QuadEntry) * quads.length();
+	hdr.posIndex = size;
+	size = align8(size + sizeof(Id) * quads.length());
+	hdr.ospIndex = size;
+	size = align8(size + sizeof(Id) * quads.length());
+	if(size > NONE)
+		return false;
+	hdr.size = size;
+
+	// Write the image, zeroing the padding
+	String* image = new String(size + 1);
+	if(!image || !image->data()) {
+		delete image;
+		return false;
+	}
+	uint8_t* const  data = image->data();
+	memset(data, 0, size);
+	memcpy(data, &hdr, sizeof hdr);
+	Id* offsets = reinterpret_cast<Id*>(data + hdr.stringOffsets);
+	Id offs = 0;
+	for(const String* const* pstr = strings.begin(); pstr != strings.end(); ++pstr) {
+		*offsets++ = offs;
+		memcpy(data + hdr.stringBlob + offs, (*pstr)->data(), (*pstr)->length());
+		offs += (*pstr)->length() + 1;
+	}
+	*offsets = offs;
+	for(Id i = 0; i < terms.length(); ++i)
+		memcpy(data + hdr.termTable + sizeof(TermEntry) * i, &terms[order[i]], sizeof(TermEntry));
+	memcpy(data + hdr.quadTable, quads.begin(), sizeof(QuadEntry) * quads.length());
+	memcpy(data + hdr.posIndex, pos.begin(), sizeof(Id) * pos.length());
+	memcpy(data + hdr.ospIndex, osp.begin(), sizeof(Id) * osp.length());
+
+	delete storage;
+	storage = image;
+	return true;
+}
+
+// Querying --------------------------------------------------------------------
+#if defined(__unix__) || defined(__APPLE__)
+Snapshot* Snapshot::map(const char* filename)
+{
+	const int  fd = open(filename, O_RDONLY);
+	if(fd < 0)
+		return nullptr;
+	struct stat  st;
+	void* image = MAP_FAILED;
+	if(!fstat(fd, &st) && st.st_size > 0)
+		image = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);  // Note: the mapping retains the file
+	if(image == MAP_FAILED)
+		return nullptr;
+
+	Snapshot* res = new Snapshot(static_cast<const uint8_t*>(image), st.st_size);
+	if(!res || !res->valid()) {
+		delete res;
+		munmap(image, st.st_size);
+		return nullptr;
+	}
+	res->_size = st.st_size;
+	return res;
+}
+#endif  // __unix__ || __APPLE__
+
+Snapshot::Snapshot(const uint8_t* image, size_t size)
+	: Dataset(),
+	  _image(image),
+	  _size(0),
+	  _header(nullptr),
+	  _stringOffsets(nullptr),
+	  _terms(nullptr),
+	  _quads(nullptr),
+	  _pos(nullptr),
+	  _osp(nullptr),
+	  _stringCache(nullptr),
+	  _termCache(nullptr),
+	  _quadCache(nullptr)
+{
+	// Validate the header and bounds of the sections
+	const Header* hdr = reinterpret_cast<const Header*>(image);
+	if(!image || reinterpret_cast<uintptr_t>(image) % 8 || size < sizeof(Header)
+	|| memcmp(hdr->magic, MAGIC, sizeof MAGIC) || hdr->version != VERSION || hdr->size > size)
+		return;
+	const size_t  bound = hdr->size;
+	if(hdr->stringOffsets % 8 || hdr->stringOffsets + sizeof(Id) * (size_t(hdr->strings) + 1) > bound
+	|| hdr->stringBlob > bound || hdr->termTable % 8
+	|| hdr->termTable + sizeof(TermEntry) * size_t(hdr->terms) > bound
+	|| hdr->quadTable % 8 || hdr->quadTable + sizeof(QuadEntry) * size_t(hdr->quads) > bound
+	|| hdr->posIndex % 8 || hdr->posIndex + sizeof(Id) * size_t(hdr->quads) > bound
+	|| hdr->ospIndex % 8 || hdr->ospIndex + sizeof(Id) * size_t(hdr->quads) > bound)
+		return;
+	_stringOffsets = reinterpret_cast<const Id*>(image + hdr->stringOffsets);
+	if(hdr->stringBlob + size_t(_stringOffsets[hdr->strings]) > bound)
+		return;
+	_terms = reinterpret_cast<const TermEntry*>(image + hdr->termTable);
+	_quads = reinterpret_cast<const QuadEntry*>(image + hdr->quadTable);
+	_pos = reinterpret_cast<const Id*>(image + hdr->posIndex);
+	_osp = reinterpret_cast<const Id*>(image + hdr->ospIndex);
+	if(validate(*hdr))
+		_header = hdr;
+}
+
+bool Snapshot::validate(const Header& hdr) const
+{
+	// Strings should be null-terminated and fit the blob
+	const uint8_t*  blob = _image + hdr.stringBlob;
+	for(Id i = 0; i < hdr.strings; ++i)
+		if(_stringOffsets[i] >= _stringOffsets[i + 1] || blob[_stringOffsets[i + 1] - 1])
+			return false;
+	// Terms should refer to the present strings
+	for(Id i = 0; i < hdr.terms; ++i) {
+		const TermEntry& entry = _terms[i];
+		if(entry.value >= hdr.strings)
+			return false;
+		switch(entry.kind) {
+		case RTK_NAMED_NODE:
+		case RTK_BLANK_NODE:
+			if(entry.lang != NONE || entry.dtype != NONE)
+				return false;
+			break;
+		case RTK_LITERAL:
+			if((entry.lang != NONE && entry.lang >= hdr.strings)
+			|| (entry.dtype != NONE && entry.dtype >= hdr.strings))
+				return false;
+			break;
+		default:
+			return false;
+		}
+	}
+	// Quads should refer to the present terms, only the graph is optional
+	for(Id i = 0; i < hdr.quads; ++i) {
+		const QuadEntry& entry = _quads[i];
+		for(unsigned j = 0; j < 3; ++j)
+			if(entry.terms[j] >= hdr.terms)
+				return false;
+		if(entry.terms[3] != NONE && entry.terms[3] >= hdr.terms)
+			return false;
+		if(_pos[i] >= hdr.quads || _osp[i] >= hdr.quads)
+			return false;
+	}
+	return true;
+}
+
+Snapshot::~Snapshot()
+{
+	if(_quadCache) {
+		for(Id i = 0; i < _header->quads; ++i)
+			delete _quadCache[i];
+		free(_quadCache);
+	}
+	if(_termCache) {
+		for(Id i = 0; i < _header->terms; ++i)
+			delete _termCache[i];
+		free(_termCache);
+	}
+	if(_stringCache) {
+		for(Id i = 0; i < _header->strings; ++i)
+			delete _stringCache[i];
+		free(_stringCache);
+	}
+#if defined(__unix__) || defined(__APPLE__)
+	if(_size)
+		munmap(const_cast<uint8_t*>(_image), _size);
+#endif  // __unix__ || __APPLE__
+}
+
+Quad* Snapshot::find(const Quad& quad)
+{
+	const Term* const  pattern[4] = {quad.subject, quad.predicate, quad.object, quad.graph};
+	Id ids[4];
+	if(!_header || !resolve(pattern, ids))
+		return nullptr;
+	const Range  r = range(ids);
+	for(Id i = r.beg; i < r.end; ++i)
+		if(fits(entry(r, i), ids))
+			return this->quad(index(r, i));
+	return nullptr;
+}
+
+Dataset::Quads Snapshot::match(const Term* subject, const Term* predicate,
+                               const Term* object, const Term* graph)
+{
+	Quads matches;
+	const Term* const  pattern[4] = {subject, predicate, object, graph};
+	Id ids[4];
+	if(!_header || !resolve(pattern, ids))
+		return matches;
+	const Range  r = range(ids);
+	// Note: the range is traversed backward because the stack prepends the items
+	for(Id i = r.end; i-- > r.beg;) {
+		if(!fits(entry(r, i), ids))
+			continue;
+		Quad* res = quad(index(r, i));
+		if(res)
+			matches.add(*res);
+	}
+	return matches;
+}
+
+bool Snapshot::traverse(QuadVisitor& visitor) const
+{
+	// Note: only the lazily materialized terms and quads are cached, the image is not modified
+	Snapshot* const  self = const_cast<Snapshot*>(this);
+	for(Id i = 0; i < length(); ++i) {
+		const Quad* res = self->quad(i);
+		if(!res || !visitor(*res))
+			return false;
+	}
+	return true;
+}
+
+bool Snapshot::visit(const Quad& pattern, QuadVisitor& visitor)
+{
+	const Term* const  terms[4] = {pattern.subject, pattern.predicate, pattern.object, pattern.graph};
+	Id ids[4];
+	if(!_header || !resolve(terms, ids))
+		return true;
+	const Range  r = range(ids);
+	for(Id i = r.beg; i < r.end; ++i) {
+		if(!fits(entry(r, i), ids))
+			continue;
+		const Quad* res = quad(index(r, i));
+		if(res && !visitor(*res))
+			return false;
+	}
+	return true;
+}
+
+unsigned Snapshot::count(const Quad& pattern)
+{
+	const Term* const  terms[4] = {pattern.subject, pattern.predicate, pattern.object, pattern.graph};
+	Id ids[4];
+	if(!_header || !resolve(terms, ids))
+		return 0;
+	const Range  r = range(ids);
+	// The range is exact when the bound fields form its key
+	unsigned  nkey = 0;
+	while(nkey < 4 && ids[r.order[nkey]] != NONE)
+		++nkey;
+	unsigned  nbound = 0;
+	for(unsigned i = 0; i < 4; ++i)
+		nbound += ids[i] != NONE;
+	if(nkey == nbound)
+		return r.end - r.beg;
+	unsigned  num = 0;
+	for(Id i = r.beg; i < r.end; ++i)
+		num += fits(entry(r, i), ids);
+	return num;
+}
+
+bool Snapshot::exists(const Quad& pattern)
+{
+	const Term* const  terms[4] = {pattern.subject, pattern.predicate, pattern.object, pattern.graph};
+	Id ids[4];
+	if(!_header || !resolve(terms, ids))
+		return false;
+	const Range  r = range(ids);
+	for(Id i = r.beg; i < r.end; ++i)
+		if(fits(entry(r, i), ids))
+			return true;
+	return false;
+}
+
+Id Snapshot::stringId(const String& str) const
+{
+	const uint8_t* blob = _image + _header->stringBlob;
+	Id beg = 0;
+	Id end = _header->strings;
+	while(beg < end) {
+		const Id  mid = beg + (end - beg) / 2;
+		const int  cmp = compare(blob + _stringOffsets[mid],
+			_stringOffsets[mid + 1] - _stringOffsets[mid] - 1, str.data(), str.length());
+		if(!cmp)
+			return mid;
+		if(cmp < 0)
+			beg = mid + 1;
+		else end = mid;
+	}
+	return NONE;
+}
+
+unsigned Snapshot::remove(const Quad& pattern)
+{
+	(void)pattern;
+	assert(0 && "The snapshot is read-only");
+	return 0;
+}
+
+void Snapshot::compact()
+{
+	assert(0 && "The snapshot is read-only");
+}
+
+String Snapshot::stringView(Id id) const
+{
+	// Note: the size includes the null-terminator, so the view is created without copying
+	return String(_image + _header->stringBlob + _stringOffsets[id],
+		_stringOffsets[id + 1] - _stringOffsets[id]);
+}
+
+Id Snapshot::termId(const Term& term) const
+{
+	if(!_header || term.kind == RTK_VARIABLE)
+		return NONE;
+	TermEntry  key = {static_cast<Id>(term.kind), stringId(*term.value), NONE, NONE};
+	if(key.value == NONE)
+		return NONE;
+	if(term.kind == RTK_LITERAL) {
+		const Literal& literal = static_cast<const Literal&>(term);
+		if(literal.lang && (key.lang = stringId(*literal.lang)) == NONE)
+			return NONE;
+		if(literal.dtype && (key.dtype = stringId(*literal.dtype)) == NONE)
+			return NONE;
+	}
+
+	Id beg = 0;
+	Id end = _header->terms;
+	while(beg < end) {
+		const Id  mid = beg + (end - beg) / 2;
+		if(TermLess::less(_terms[mid], key))
+			beg = mid + 1;
+		else if(TermLess::less(key, _terms[mid]))
+			end = mid;
+		else return mid;
+	}
+	return NONE;
+}
+
+const Term* Snapshot::term(Id id)
+{
+	assert(_header && id < _header->terms && "Invalid term id");
+	if(!_termCache && !(_termCache = static_cast<Term**>(calloc(_header->terms, sizeof(Term*)))))
+		return nullptr;
+	if(_termCache[id])
+		return _termCache[id];
+	if(!_stringCache && !(_stringCache = static_cast<String**>(calloc(_header->strings, sizeof(String*)))))
+		return nullptr;
+
+	const TermEntry& entry = _terms[id];
+	const Id  sids[3] = {entry.value, entry.lang, entry.dtype};
+	for(unsigned i = 0; i < 3; ++i)
+		if(sids[i] != NONE && !_stringCache[sids[i]])
+			_stringCache[sids[i]] = new String(stringView(sids[i]));
+	switch(entry.kind) {
+	case RTK_NAMED_NODE:
+		_termCache[id] = new NamedNode(*_stringCache[entry.value]);
+		break;
+	case RTK_BLANK_NODE:
+		_termCache[id] = new BlankNode(*_stringCache[entry.value]);
+		break;
+	case RTK_LITERAL:
+		_termCache[id] = new Literal(*_stringCache[entry.value],
+			entry.lang != NONE ? _stringCache[entry.lang] : nullptr,
+			entry.dtype != NONE ? _stringCache[entry.dtype] : nullptr);
+		break;
+	default:
+		assert(0 && "Invalid term kind");
+		return nullptr;
+	}
+	return _termCache[id];
+}
+
+Quad* Snapshot::quad(Id index)
+{
+	assert(_header && index < _header->quads && "Invalid quad index");
+	if(!_quadCache && !(_quadCache = static_cast<Quad**>(calloc(_header->quads, sizeof(Quad*)))))
+		return nullptr;
+	if(_quadCache[index])
+		return _quadCache[index];
+	const QuadEntry& entry = _quads[index];
+	const Term* terms[4];
+	for(unsigned i = 0; i < 4; ++i)
+		if(entry.terms[i] != NONE) {
+			if(!(terms[i] = term(entry.terms[i])))
+				return nullptr;
+		} else terms[i] = nullptr;
+	return _quadCache[index] = new Quad(*terms[0], *terms[1], *terms[2], terms[3]);
+}
+
+bool Snapshot::resolve(const Term* const pattern[4], Id ids[4]) const
+{
+	for(unsigned i = 0; i < 4; ++i) {
+		if(!pattern[i]) {
+			ids[i] = NONE;
+			continue;
+		}
+		ids[i] = termId(*pattern[i]);
+		if(ids[i] == NONE)
+			return false;
+	}
+	return true;
+}
+
+Snapshot::Range Snapshot::range(const Id ids[4]) const
+{
+	Range  r = {0, _header->quads, nullptr, SPOG};
+	if(ids[0] == NONE) {
+		if(ids[1] != NONE) {
+			r.perm = _pos;
+			r.order = POSG;
+		} else if(ids[2] != NONE) {
+			r.perm = _osp;
+			r.order = OSPG;
+		} else return r;
+	}
+
+	// The key is the prefix of the bound fields in the index order
+	unsigned  nkey = 0;
+	while(nkey < 4 && ids[r.order[nkey]] != NONE)
+		++nkey;
+	// Lower bound
+	Id beg = r.beg;
+	Id end = r.end;
+	while(beg < end) {
+		const Id  mid = beg + (end - beg) / 2;
+		const QuadEntry& qe = entry(r, mid);
+		unsigned i = 0;
+		while(i < nkey && qe.terms[r.order[i]] == ids[r.order[i]])
+			++i;
+		if(i < nkey && qe.terms[r.order[i]] < ids[r.order[i]])
+			beg = mid + 1;
+		else end = mid;
+	}
+	const Id  lower = beg;
+	// Upper bound
+	end = r.end;
+	while(beg < end) {
+		const Id  mid = beg + (end - beg) / 2;
+		const QuadEntry& qe = entry(r, mid);
+		unsigned i = 0;
+		while(i < nkey && qe.terms[r.order[i]] == ids[r.order[i]])
+			++i;
+		if(i == nkey || qe.terms[r.order[i]] < ids[r.order[i]])
+			beg = mid + 1;
+		else end = mid;
+	}
+	r.beg = lower;
+	r.end = beg;
+	return r;
+}
+
+bool Snapshot::fits(const QuadEntry& entry, const Id ids[4])
+{
+	for(unsigned i = 0; i < 4; ++i)
+		if(ids[i] != NONE && entry.terms[i] != ids[i])
+			return false;
+	return true;
+}
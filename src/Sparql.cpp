@@ -0,0 +1,1032 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <string.h>
+#include <ctype.h>
+#include <math.h>  // isnan
+
+#include "Sparql.h"
+
+#ifdef SMALLRDF_SPARQL
+
+using namespace smallrdf;
+
+const unsigned  SelectQuery::NONE;
+
+namespace {
+
+const char  RDF_TYPE[] = "http://www.w3.org/1999/02/22-rdf-syntax-ns#type";
+const char  XSD_INTEGER[] = "http://www.w3.org/2001/XMLSchema#integer";
+const char  XSD_DECIMAL[] = "http://www.w3.org/2001/XMLSchema#decimal";
+const char  XSD_DOUBLE[] = "http://www.w3.org/2001/XMLSchema#double";
+const char  XSD_BOOLEAN[] = "http://www.w3.org/2001/XMLSchema#boolean";
+
+//! \brief Numeric value of the literal having a numeric XSD datatype
+bool numeric(const Term& term, double& val)
+{
+	return ValueRange::value(term, val) == VK_NUMBER;
+}
+
+//! \brief Whether the optional strings are equal
+bool same(const String* a, const String* b)
+{
+	return a == b || (a && b && *a == *b);
+}
+
+//! \brief Lexical order of the strings
+int order(const String& a, const String& b)
+{
+	const size_t  len = a.length() < b.length() ? a.length() : b.length();
+	const int  res = len ? memcmp(a.data(), b.data(), len) : 0;
+	if(res)
+		return res < 0 ? -1 : 1;
+	return a.length() < b.length() ? -1 : a.length() > b.length();
+}
+
+//! \brief Effective boolean value of the term
+//! \return int  - 1 if the value is true, 0 if it is false, -1 if it is undefined
+int truth(const Term* term)
+{
+	if(!term || term->kind != RTK_LITERAL)
+		return -1;
+	const Literal&  lit = static_cast<const Literal&>(*term);
+	double  val;
+	if(numeric(*term, val))
+		return val < 0 || val > 0;
+	if(lit.dtype && !strcmp(lit.dtype->c_str(), XSD_BOOLEAN))
+		return !strcmp(lit.value->c_str(), "true") || !strcmp(lit.value->c_str(), "1");
+	if(lit.dtype && strcmp(lit.dtype->c_str(), "http://www.w3.org/2001/XMLSchema#string"))
+		return -1;
+	return lit.value->length() != 0;
+}
+
+//! \brief Reference to a row of the solutions
+struct RowRef {
+	const Solutions* solutions;
+	unsigned row;
+};
+
+//! \brief Hashing of the rows by the content of their values
+struct RowHash {
+	static uint32_t hash(const RowRef& ref)
+	{
+		const Term* const*  row = ref.solutions->row(ref.row);
+		uint32_t  res = 0;
+		for(unsigned i = 0; i < ref.solutions->width(); ++i)
+			res = res * 31 + (row[i] ? row[i]->hash() : 0);
+		return res;
+	}
+
+	static bool equal(const RowRef& a, const RowRef& b)
+	{
+		const Term* const*  ra = a.solutions->row(a.row);
+		const Term* const*  rb = b.solutions->row(b.row);
+		for(unsigned i = 0; i < a.solutions->width(); ++i)
+			if(ra[i] != rb[i] && (!ra[i] || !rb[i] || *ra[i] != *rb[i]))
+				return false;
+		return true;
+	}
+};
+
+}  // namespace
+
+// Parser ----------------------------------------------------------------------
+//! \brief Recursive descent parser of the query text
+struct SelectQuery::Parser {
+	typedef const uint8_t  data_t;
+
+	SelectQuery& query;
+	Document& doc;
+	data_t* beg;
+	data_t* cur;
+	data_t* end;
+	Array<const String*> prefixes;  //!< Pairs of the prefix names and their namespaces
+
+	Parser(SelectQuery& iquery, const String& text)
+		: query(iquery), doc(*iquery._terms), beg(text.data()), cur(text.data()),
+		end(text.data() + text.length()), prefixes()  {}
+#if __cplusplus >= 201103L
+	Parser(const Parser&)=delete;
+	Parser& operator=(const Parser&)=delete;
+#endif // __cplusplus 11+
+
+	//! \brief Report the malformed query at the current position
+	bool malformed()
+		{ query._error = cur - beg; return false; }
+	//! \brief Skip the whitespaces and comments
+	void skip();
+	//! \brief Consume the character following the whitespaces if it is present
+	bool token(char c);
+	//! \brief Consume the case-insensitive keyword following the whitespaces if it is present
+	bool keyword(const char* kw);
+	//! \brief Whether the character belongs to a name
+	static bool name(uint8_t c)
+		{ return isalnum(c) || c == '_' || c == '-'; }
+	const String* string(data_t* data, size_t len);
+
+	bool parseQuery();
+	bool parseNumber(unsigned& val);
+	bool parseGroup(unsigned group);
+	bool parseTriples(BasicGraphPattern& bgp);
+	const Variable* parseVariable();
+	const String* parseIRI();
+	const Term* parseTerm(bool predicate);
+	const Literal* parseLiteral();
+	const Literal* parseNumeric();
+
+	//! \brief Add the expression
+	//! \return unsigned  - expression index; NONE if the memory is insufficient
+	unsigned expression(Operation op, unsigned left, unsigned right=NONE,
+		const Term* term=nullptr, unsigned var=NONE);
+	unsigned parseOr();
+	unsigned parseAnd();
+	unsigned parseRelation();
+	unsigned parseUnary();
+	unsigned parsePrimary();
+};
+
+void SelectQuery::Parser::skip()
+{
+	while(cur < end) {
+		if(isspace(*cur))
+			++cur;
+		else if(*cur == '#') {
+			while(cur < end && *cur != '\n')
+				++cur;
+		} else break;
+	}
+}
+
+bool SelectQuery::Parser::token(char c)
+{
+	skip();
+	if(cur == end || *cur != c)
+		return false;
+	++cur;
+	return true;
+}
+
+bool SelectQuery::Parser::keyword(const char* kw)
+{
+	skip();
+	data_t*  pos = cur;
+	for(; *kw; ++kw, ++pos)
+		if(pos == end || toupper(*pos) != *kw)
+			return false;
+	// Note: the keywords are distinguished from the prefixed names
+	if(pos != end && (name(*pos) || *pos == ':'))
+		return false;
+	cur = pos;
+	return true;
+}
+
+const String* SelectQuery::Parser::string(data_t* data, size_t len)
+{
+	String  str(len + 1);
+	if(str.length() != len)
+		return nullptr;
+	if(len)
+		memcpy(str.data(), data, len);
+	return doc.string(str);
+}
+
+bool SelectQuery::Parser::parseQuery()
+{
+	while(keyword("PREFIX")) {
+		skip();
+		data_t* const  pbeg = cur;
+		while(cur < end && name(*cur))
+			++cur;
+		const String* const  pname = string(pbeg, cur - pbeg);
+		if(!token(':'))
+			return malformed();
+		skip();
+		const String* const  ns = parseIRI();
+		if(!ns)
+			return malformed();
+		if(!pname || !prefixes.add(pname) || !prefixes.add(ns))
+			return false;
+	}
+
+	if(!keyword("SELECT"))
+		return malformed();
+	// Note: REDUCED permits the elimination of the duplicates
+	query._distinct = keyword("DISTINCT") || keyword("REDUCED");
+	const bool  all = token('*');
+	if(!all) {
+		skip();
+		while(cur < end && (*cur == '?' || *cur == '$')) {
+			const Variable* const  var = parseVariable();
+			if(!var)
+				return malformed();
+			if(query.add(var) == NONE || !query._projection.add(var))
+				return false;
+			skip();
+		}
+		if(!query._projection.length())
+			return malformed();
+	}
+	keyword("WHERE");
+	BasicGraphPattern* const  bgp = new BasicGraphPattern();
+	if(!bgp || !query._groups.add(bgp)) {
+		delete bgp;
+		return false;
+	}
+	if(!parseGroup(0))
+		return false;
+
+	// Solution modifiers
+	while(true) {
+		if(keyword("LIMIT")) {
+			if(!parseNumber(query._limit))
+				return malformed();
+		} else if(keyword("OFFSET")) {
+			if(!parseNumber(query._offset))
+				return malformed();
+		} else break;
+	}
+	skip();
+	if(cur != end)
+		return malformed();
+
+	if(all)
+		for(unsigned i = 0; i < query._variables.length(); ++i) {
+			const Variable* const  var = query._variables[i];
+			// Note: the blank nodes are not projected
+			if(var->value->length() < 2 || memcmp(var->value->data(), "_:", 2))
+				if(!query._projection.add(var))
+					return false;
+		}
+	return true;
+}
+
+bool SelectQuery::Parser::parseNumber(unsigned& val)
+{
+	skip();
+	if(cur == end || !isdigit(*cur))
+		return false;
+	val = 0;
+	while(cur < end && isdigit(*cur))
+		val = val * 10 + (*cur++ - '0');
+	return true;
+}
+
+bool SelectQuery::Parser::parseGroup(unsigned group)
+{
+	if(!token('{'))
+		return malformed();
+	while(true) {
+		if(token('}'))
+			return true;
+		if(token('.'))
+			continue;
+		if(keyword("FILTER")) {
+			const unsigned  root = parsePrimary();
+			if(root == NONE)
+				return false;
+			const Filter  filter = {group, root};
+			if(!query._filters.add(filter))
+				return false;
+		} else if(keyword("OPTIONAL")) {
+			// Note: the nested optional groups are not supported
+			if(group)
+				return malformed();
+			BasicGraphPattern* const  bgp = new BasicGraphPattern();
+			if(!bgp || !query._groups.add(bgp)) {
+				delete bgp;
+				return false;
+			}
+			if(!parseGroup(query._groups.length() - 1))
+				return false;
+		} else if(!parseTriples(*query._groups[group]))
+			return false;
+	}
+}
+
+bool SelectQuery::Parser::parseTriples(BasicGraphPattern& bgp)
+{
+	const Term* const  subject = parseTerm(false);
+	if(!subject)
+		return false;
+	if(subject->kind == RTK_LITERAL)
+		return malformed();
+	do {
+		const Term* const  predicate = parseTerm(true);
+		if(!predicate)
+			return false;
+		if(predicate->kind == RTK_LITERAL || predicate->kind == RTK_BLANK_NODE)
+			return malformed();
+		do {
+			const Term* const  object = parseTerm(false);
+			if(!object)
+				return false;
+			if(!bgp.add(*subject, *predicate, *object))
+				return false;
+		} while(token(','));
+		if(!token(';'))
+			break;
+		// Note: the predicate-object list may end with ';'
+		skip();
+	} while(cur < end && *cur != '.' && *cur != '}');
+	return true;
+}
+
+const Variable* SelectQuery::Parser::parseVariable()
+{
+	// Note: the leading '?' or '$' is verified by the caller
+	data_t* const  vbeg = ++cur;
+	while(cur < end && (isalnum(*cur) || *cur == '_'))
+		++cur;
+	if(cur == vbeg)
+		return nullptr;
+	const String* const  str = string(vbeg, cur - vbeg);
+	return str ? doc.variable(*str) : nullptr;
+}
+
+const String* SelectQuery::Parser::parseIRI()
+{
+	if(cur == end || *cur != '<')
+		return nullptr;
+	data_t* const  ibeg = ++cur;
+	while(cur < end && *cur != '>' && !isspace(*cur))
+		++cur;
+	if(cur == end || *cur != '>')
+		return nullptr;
+	return string(ibeg, cur++ - ibeg);
+}
+
+const Term* SelectQuery::Parser::parseTerm(bool predicate)
+{
+	skip();
+	if(cur == end) {
+		malformed();
+		return nullptr;
+	}
+	const Term*  res = nullptr;
+	const uint8_t  c = *cur;
+	if(c == '?' || c == '$') {
+		const Variable* const  var = parseVariable();
+		if(!var) {
+			malformed();
+			return nullptr;
+		}
+		res = query.add(var) != NONE ? var : nullptr;
+	} else if(c == '<') {
+		const String* const  iri = parseIRI();
+		if(!iri) {
+			malformed();
+			return nullptr;
+		}
+		res = doc.namedNode(*iri);
+	} else if(c == '"' || c == '\'')
+		res = parseLiteral();
+	else if(isdigit(c) || c == '+' || c == '-')
+		res = parseNumeric();
+	else if(c == '_' && cur + 1 < end && cur[1] == ':') {
+		// Blank nodes are the non-projected variables
+		data_t* const  bbeg = cur;
+		cur += 2;
+		while(cur < end && name(*cur))
+			++cur;
+		const String* const  str = string(bbeg, cur - bbeg);
+		const Variable* const  var = str ? doc.variable(*str) : nullptr;
+		res = var && query.add(var) != NONE ? var : nullptr;
+	} else if(predicate && keyword("A")) {
+		const String* const  iri = string(reinterpret_cast<data_t*>(RDF_TYPE), sizeof RDF_TYPE - 1);
+		res = iri ? doc.namedNode(*iri) : nullptr;
+	} else if(keyword("TRUE") || keyword("FALSE")) {
+		const bool  val = toupper(cur[-1]) == 'E' && toupper(cur[-2]) == 'U';  // TRUE rather than FALSE
+		const String* const  str = val ? string(reinterpret_cast<data_t*>("true"), 4)
+			: string(reinterpret_cast<data_t*>("false"), 5);
+		const String* const  dtype = string(reinterpret_cast<data_t*>(XSD_BOOLEAN), sizeof XSD_BOOLEAN - 1);
+		res = str && dtype ? doc.literal(*str, nullptr, dtype) : nullptr;
+	} else {
+		// Prefixed name
+		data_t* const  pbeg = cur;
+		while(cur < end && name(*cur))
+			++cur;
+		data_t* const  pend = cur;
+		if(cur == end || *cur != ':') {
+			malformed();
+			return nullptr;
+		}
+		data_t* const  lbeg = ++cur;
+		while(cur < end && (name(*cur) || *cur == '.' || *cur == ':'))
+			++cur;
+		// Note: the local name does not end with '.'
+		while(cur > lbeg && cur[-1] == '.')
+			--cur;
+		unsigned  ip = 0;
+		while(ip < prefixes.length() && (prefixes[ip]->length() != size_t(pend - pbeg)
+		|| memcmp(prefixes[ip]->data(), pbeg, pend - pbeg)))
+			ip += 2;
+		if(ip == prefixes.length()) {
+			cur = pbeg;
+			malformed();
+			return nullptr;
+		}
+		const String&  ns = *prefixes[ip + 1];
+		String  iri(ns.length() + (cur - lbeg) + 1);
+		if(iri.length() != ns.length() + (cur - lbeg))
+			return nullptr;
+		memcpy(iri.data(), ns.data(), ns.length());
+		memcpy(iri.data() + ns.length(), lbeg, cur - lbeg);
+		const String* const  str = doc.string(iri);
+		res = str ? doc.namedNode(*str) : nullptr;
+	}
+	return res;
+}
+
+const Literal* SelectQuery::Parser::parseLiteral()
+{
+	const uint8_t  quote = *cur++;
+	// Unescape the value into a buffer of the maximal size
+	data_t*  pos = cur;
+	while(pos < end && *pos != quote)
+		pos += *pos == '\\' ? 2 : 1;
+	if(pos >= end) {
+		malformed();
+		return nullptr;
+	}
+	String  buf(pos - cur + 1);
+	if(buf.length() != size_t(pos - cur))
+		return nullptr;
+	uint8_t*  out = buf.data();
+	for(; cur < pos; ++cur) {
+		if(*cur != '\\') {
+			*out++ = *cur;
+			continue;
+		}
+		switch(*++cur) {
+		case 't':
+			*out++ = '\t';
+			break;
+		case 'n':
+			*out++ = '\n';
+			break;
+		case 'r':
+			*out++ = '\r';
+			break;
+		default:
+			*out++ = *cur;
+		}
+	}
+	++cur;  // Closing quote
+	*out = 0;
+	buf.resize(out - buf.data());
+	const String* const  value = doc.string(buf);
+	if(!value)
+		return nullptr;
+
+	const String*  lang = nullptr;
+	const String*  dtype = nullptr;
+	if(cur < end && *cur == '@') {
+		data_t* const  lbeg = ++cur;
+		while(cur < end && name(*cur))
+			++cur;
+		if(cur == lbeg || !(lang = string(lbeg, cur - lbeg))) {
+			malformed();
+			return nullptr;
+		}
+	} else if(cur + 1 < end && cur[0] == '^' && cur[1] == '^') {
+		cur += 2;
+		const Term* const  dt = parseTerm(false);
+		if(!dt)
+			return nullptr;
+		if(dt->kind != RTK_NAMED_NODE) {
+			malformed();
+			return nullptr;
+		}
+		dtype = dt->value;
+	}
+	return doc.literal(*value, lang, dtype);
+}
+
+const Literal* SelectQuery::Parser::parseNumeric()
+{
+	data_t* const  nbeg = cur;
+	if(*cur == '+' || *cur == '-')
+		++cur;
+	const char*  dtype = XSD_INTEGER;
+	data_t* const  digits = cur;
+	while(cur < end && isdigit(*cur))
+		++cur;
+	if(cur < end && *cur == '.' && cur + 1 < end && isdigit(cur[1])) {
+		dtype = XSD_DECIMAL;
+		for(++cur; cur < end && isdigit(*cur);)
+			++cur;
+	}
+	if(cur == digits) {
+		malformed();
+		return nullptr;
+	}
+	if(cur < end && (*cur == 'e' || *cur == 'E')) {
+		dtype = XSD_DOUBLE;
+		if(++cur < end && (*cur == '+' || *cur == '-'))
+			++cur;
+		data_t* const  exp = cur;
+		while(cur < end && isdigit(*cur))
+			++cur;
+		if(cur == exp) {
+			malformed();
+			return nullptr;
+		}
+	}
+	const String* const  value = string(nbeg, cur - nbeg);
+	const String* const  dt = string(reinterpret_cast<data_t*>(dtype), strlen(dtype));
+	return value && dt ? doc.literal(*value, nullptr, dt) : nullptr;
+}
+
+unsigned SelectQuery::Parser::expression(Operation op, unsigned left, unsigned right,
+	const Term* term, unsigned var)
+{
+	const Expression  expr = {op, left, right, term, var};
+	return query._expressions.add(expr) ? query._expressions.length() - 1 : NONE;
+}
+
+unsigned SelectQuery::Parser::parseOr()
+{
+	unsigned  left = parseAnd();
+	while(left != NONE) {
+		skip();
+		if(cur + 1 >= end || cur[0] != '|' || cur[1] != '|')
+			break;
+		cur += 2;
+		const unsigned  right = parseAnd();
+		left = right != NONE ? expression(OP_OR, left, right) : NONE;
+	}
+	return left;
+}
+
+unsigned SelectQuery::Parser::parseAnd()
+{
+	unsigned  left = parseRelation();
+	while(left != NONE) {
+		skip();
+		if(cur + 1 >= end || cur[0] != '&' || cur[1] != '&')
+			break;
+		cur += 2;
+		const unsigned  right = parseRelation();
+		left = right != NONE ? expression(OP_AND, left, right) : NONE;
+	}
+	return left;
+}
+
+unsigned SelectQuery::Parser::parseRelation()
+{
+	const unsigned  left = parseUnary();
+	if(left == NONE)
+		return NONE;
+	skip();
+	if(cur == end)
+		return left;
+	Operation  op;
+	const bool  eq = cur + 1 < end && cur[1] == '=';
+	switch(*cur) {
+	case '=':
+		op = OP_EQ;
+		break;
+	case '!':
+		if(!eq)
+			return left;
+		op = OP_NE;
+		break;
+	case '<':
+		op = eq ? OP_LE : OP_LT;
+		break;
+	case '>':
+		op = eq ? OP_GE : OP_GT;
+		break;
+	default:
+		return left;
+	}
+	cur += *cur != '=' && eq ? 2 : 1;
+	const unsigned  right = parseUnary();
+	return right != NONE ? expression(op, left, right) : NONE;
+}
+
+unsigned SelectQuery::Parser::parseUnary()
+{
+	skip();
+	if(cur < end && *cur == '!' && !(cur + 1 < end && cur[1] == '=')) {
+		++cur;
+		const unsigned  operand = parseUnary();
+		return operand != NONE ? expression(OP_NOT, operand) : NONE;
+	}
+	return parsePrimary();
+}
+
+unsigned SelectQuery::Parser::parsePrimary()
+{
+	if(token('(')) {
+		const unsigned  res = parseOr();
+		if(res != NONE && !token(')')) {
+			malformed();
+			return NONE;
+		}
+		return res;
+	}
+	if(keyword("BOUND")) {
+		if(!token('(') || (skip(), cur == end) || (*cur != '?' && *cur != '$')) {
+			malformed();
+			return NONE;
+		}
+		const Variable* const  var = parseVariable();
+		const unsigned  index = var ? query.add(var) : NONE;
+		if(index == NONE || !token(')')) {
+			malformed();
+			return NONE;
+		}
+		return expression(OP_BOUND, NONE, NONE, nullptr, index);
+	}
+	const Term* const  term = parseTerm(false);
+	if(!term)
+		return NONE;
+	if(term->kind == RTK_VARIABLE) {
+		const unsigned  index = query.add(static_cast<const Variable*>(term));
+		return index != NONE ? expression(OP_VARIABLE, NONE, NONE, nullptr, index) : NONE;
+	}
+	return expression(OP_TERM, NONE, NONE, term);
+}
+
+// Execution -------------------------------------------------------------------
+//! \brief State of the query execution
+struct SelectQuery::Execution {
+	typedef Hashset<RowRef, RowHash>  Rows;
+
+	const SelectQuery& query;
+	Dataset& dataset;
+	const Statistics* statistics;
+	Solutions& solutions;
+	Array<const Term*> values;  //!< Values of the query variables
+	Array<unsigned> offsets;  //!< Offsets of the group variables in the columns
+	Array<unsigned> columns;  //!< Query variables of the group variables
+	Array<unsigned> projection;  //!< Query variables of the projected ones
+	Array<const Term*> row;  //!< Projected row
+	Solutions distinct;  //!< All distinct solutions, including the skipped ones
+	Rows rows;  //!< Index of the distinct solutions
+	unsigned skipped;
+	bool failed;
+
+	Execution(const SelectQuery& iquery, Dataset& idataset, Solutions& isolutions)
+		: query(iquery), dataset(idataset), statistics(idataset.statistics()),
+		solutions(isolutions), values(), offsets(), columns(), projection(), row(),
+		distinct(), rows(), skipped(0), failed(false)  {}
+#if __cplusplus >= 201103L
+	Execution(const Execution&)=delete;
+	Execution& operator=(const Execution&)=delete;
+#endif // __cplusplus 11+
+	~Execution();
+
+	//! \brief Prepare the columns of the variables
+	bool init();
+	//! \brief Whether the filters of the group hold on the current values
+	bool fits(unsigned group) const;
+	//! \brief Extend the current values by the solutions of the group and the following ones
+	//! \return bool  - whether to continue the execution
+	bool extend(unsigned group);
+	//! \brief Output the projected solution of the current values
+	//! \return bool  - whether to continue the execution
+	bool emit();
+};
+
+SelectQuery::Execution::~Execution()
+{
+}
+
+bool SelectQuery::Execution::init()
+{
+	const unsigned  width = query._variables.length();
+	if(!values.resize(width) || !projection.resize(query.width()) || !row.resize(query.width())
+	|| !offsets.resize(query._groups.length() + 1))
+		return false;
+	for(unsigned i = 0; i < width; ++i)
+		values[i] = nullptr;
+	for(unsigned i = 0; i < query.width(); ++i)
+		projection[i] = query.index(query._projection[i]);
+	for(unsigned g = 0; g < query._groups.length(); ++g) {
+		const BasicGraphPattern&  bgp = *query._groups[g];
+		offsets[g] = columns.length();
+		for(unsigned i = 0; i < bgp.width(); ++i)
+			if(!columns.add(query.index(bgp.variable(i))))
+				return false;
+	}
+	offsets[query._groups.length()] = columns.length();
+	if(!solutions.reset(query._projection.begin(), query.width()))
+		return false;
+	return !query._distinct || distinct.reset(query._projection.begin(), query.width());
+}
+
+bool SelectQuery::Execution::fits(unsigned group) const
+{
+	for(unsigned i = 0; i < query._filters.length(); ++i) {
+		const Filter&  filter = query._filters[i];
+		if(filter.group == group && query.evaluate(filter.root, values.begin()) != 1)
+			return false;
+	}
+	return true;
+}
+
+bool SelectQuery::Execution::extend(unsigned group)
+{
+	if(group == query._groups.length())
+		return !fits(0) || emit();
+
+	const BasicGraphPattern&  bgp = *query._groups[group];
+	const unsigned* const  cols = columns.begin() + offsets[group];
+	Array<const Term*>  bindings;
+	Array<uint8_t>  bound;
+	if(!bindings.resize(bgp.width()) || !bound.resize(bgp.width()))
+		return !(failed = true);
+	for(unsigned i = 0; i < bgp.width(); ++i) {
+		bindings[i] = values[cols[i]];
+		bound[i] = bindings[i] != nullptr;
+	}
+	Array<unsigned>  order;
+	Solutions  matches;
+	if(!bgp.plan(order, statistics, bound.begin())
+	|| !bgp.evaluate(dataset, order, matches, bindings.begin()))
+		return !(failed = true);
+
+	bool  matched = false;
+	for(unsigned r = 0; r < matches.length(); ++r) {
+		const Term* const*  match = matches.row(r);
+		for(unsigned i = 0; i < bgp.width(); ++i)
+			values[cols[i]] = match[i];
+		// Note: the filters of the required group constrain the whole solution
+		const bool  proceed = !group || fits(group);
+		matched = matched || proceed;
+		if(proceed && !extend(group + 1))
+			return false;
+	}
+	for(unsigned i = 0; i < bgp.width(); ++i)
+		values[cols[i]] = bindings[i];
+	// The optional group retains the solution without its matches
+	return matched || !group || extend(group + 1);
+}
+
+bool SelectQuery::Execution::emit()
+{
+	for(unsigned i = 0; i < projection.length(); ++i)
+		row[i] = values[projection[i]];
+	if(query._distinct) {
+		if(!distinct.add(row.begin()))
+			return !(failed = true);
+		const RowRef  ref = {&distinct, distinct.length() - 1};
+		bool  added;
+		if(!rows.add(ref, &added))
+			return !(failed = true);
+		if(!added) {
+			distinct.pop();
+			return true;
+		}
+	}
+	if(skipped < query._offset) {
+		++skipped;
+		return true;
+	}
+	if(!solutions.add(row.begin()))
+		return !(failed = true);
+	return query._limit == NONE || solutions.length() < query._limit;
+}
+
+// SelectQuery -----------------------------------------------------------------
+SelectQuery::SelectQuery()
+	: _terms(nullptr), _variables(), _projection(), _groups(), _expressions(), _filters(),
+	_limit(NONE), _offset(0), _error(NONE), _distinct(false)
+{
+}
+
+SelectQuery::~SelectQuery()
+{
+	clear();
+}
+
+void SelectQuery::clear()
+{
+	for(unsigned i = 0; i < _groups.length(); ++i)
+		delete _groups[i];
+	_groups.clear();
+	_variables.clear();
+	_projection.clear();
+	_expressions.clear();
+	_filters.clear();
+	// Note: the terms are released after the patterns referring them
+	delete _terms;
+	_terms = nullptr;
+	_limit = NONE;
+	_offset = 0;
+	_error = NONE;
+	_distinct = false;
+}
+
+bool SelectQuery::parse(const String& query)
+{
+	clear();
+	if(!(_terms = new Document()))
+		return false;
+	Parser  parser(*this, query);
+	bool  res = parser.parseQuery();
+	for(unsigned i = 0; res && i < _filters.length(); ++i)
+		res = pushdown(_filters[i].group, _filters[i].root);
+	if(res)
+		return true;
+	// Retain the error position only
+	const unsigned  error = _error;
+	clear();
+	_error = error;
+	return false;
+}
+
+const BasicGraphPattern* SelectQuery::pattern() const
+{
+	return _groups.length() == 1 && !_filters.length() && !_distinct && _limit == NONE
+		&& !_offset ? _groups[0] : nullptr;
+}
+
+unsigned SelectQuery::index(const Variable* var) const
+{
+	// Note: the variables are interned in the query terms
+	for(unsigned i = 0; i < _variables.length(); ++i)
+		if(_variables[i] == var)
+			return i;
+	return NONE;
+}
+
+unsigned SelectQuery::add(const Variable* var)
+{
+	const unsigned  res = index(var);
+	if(res != NONE)
+		return res;
+	return _variables.add(var) ? _variables.length() - 1 : NONE;
+}
+
+bool SelectQuery::execute(Dataset& dataset, Solutions& solutions) const
+{
+	Execution  ex(*this, dataset, solutions);
+	if(!ex.init())
+		return false;
+	if(!_groups.length() || !_limit)
+		return true;
+	ex.extend(0);
+	return !ex.failed;
+}
+
+int SelectQuery::evaluate(unsigned expr, const Term* const* values) const
+{
+	const Expression&  ex = _expressions[expr];
+	int  left;
+	int  right;
+	switch(ex.op) {
+	case OP_TERM:
+		return truth(ex.term);
+	case OP_VARIABLE:
+		return truth(values[ex.var]);
+	case OP_BOUND:
+		return values[ex.var] != nullptr;
+	case OP_NOT:
+		left = evaluate(ex.left, values);
+		return left < 0 ? left : !left;
+	case OP_AND:
+		left = evaluate(ex.left, values);
+		right = evaluate(ex.right, values);
+		if(!left || !right)
+			return 0;
+		return left < 0 || right < 0 ? -1 : 1;
+	case OP_OR:
+		left = evaluate(ex.left, values);
+		right = evaluate(ex.right, values);
+		if(left == 1 || right == 1)
+			return 1;
+		return left < 0 || right < 0 ? -1 : 0;
+	case OP_EQ:
+	case OP_NE:
+	case OP_LT:
+	case OP_GT:
+	case OP_LE:
+	case OP_GE:
+		break;
+	default:
+		return -1;
+	}
+
+	// Comparison of the operand values
+	const Expression&  lex = _expressions[ex.left];
+	const Expression&  rex = _expressions[ex.right];
+	const Term* const  a = lex.op == OP_TERM ? lex.term : lex.op == OP_VARIABLE ? values[lex.var] : nullptr;
+	const Term* const  b = rex.op == OP_TERM ? rex.term : rex.op == OP_VARIABLE ? values[rex.var] : nullptr;
+	return a && b ? compare(ex.op, a, b) : -1;
+}
+
+int SelectQuery::compare(Operation op, const Term* a, const Term* b)
+{
+	// Results of the comparisons for the less (bit 0), equal (bit 1) and greater (bit 2) operands
+	static const uint8_t  HOLDS[] = {2, 5, 1, 4, 3, 6};  // EQ, NE, LT, GT, LE, GE
+	int  ord;
+	double  x;
+	double  y;
+	const ValueKind  kind = ValueRange::value(*a, x);
+	if(kind != VK_NONE && ValueRange::value(*b, y) == kind)
+		ord = x < y ? -1 : y < x;
+	else if(a->kind == RTK_LITERAL && b->kind == RTK_LITERAL
+	&& same(static_cast<const Literal*>(a)->lang, static_cast<const Literal*>(b)->lang)
+	&& same(static_cast<const Literal*>(a)->dtype, static_cast<const Literal*>(b)->dtype))
+		ord = order(*a->value, *b->value);
+	else if(op == OP_EQ || op == OP_NE)
+		return (*a == *b) == (op == OP_EQ);
+	else return -1;
+	return (HOLDS[op - OP_EQ] >> (ord + 1)) & 1;
+}
+
+bool SelectQuery::pushdown(unsigned group, unsigned expr)
+{
+	const Expression&  ex = _expressions[expr];
+	Operation  op = ex.op;
+	switch(op) {
+	case OP_AND:
+		return pushdown(group, ex.left) && pushdown(group, ex.right);
+	case OP_EQ:
+	case OP_LT:
+	case OP_GT:
+	case OP_LE:
+	case OP_GE:
+		break;
+	case OP_TERM:
+	case OP_VARIABLE:
+	case OP_BOUND:
+	case OP_NOT:
+	case OP_OR:
+	case OP_NE:
+	default:
+		return true;
+	}
+
+	// Comparison of a variable with a constant, which is mirrored if it is the left operand
+	const Expression*  var = &_expressions[ex.left];
+	const Expression*  val = &_expressions[ex.right];
+	if(var->op == OP_TERM && val->op == OP_VARIABLE) {
+		const Expression* const  tmp = var;
+		var = val;
+		val = tmp;
+		if(op != OP_EQ)
+			op = op == OP_LT ? OP_GT : op == OP_GT ? OP_LT : op == OP_LE ? OP_GE : OP_LE;
+	}
+	if(var->op != OP_VARIABLE || val->op != OP_TERM)
+		return true;
+	double  bound;
+	const ValueKind  kind = ValueRange::value(*val->term, bound);
+	if(kind == VK_NONE || isnan(bound))
+		return true;
+	ValueRange  range = ValueRange::all(kind);
+	if(op != OP_GT && op != OP_GE) {
+		range.hi = bound;
+		range.hiOpen = op == OP_LT;
+	}
+	if(op != OP_LT && op != OP_LE) {
+		range.lo = bound;
+		range.loOpen = op == OP_GT;
+	}
+	// Note: the variable bound by the enclosing group is not constrained in the optional one
+	BasicGraphPattern* const  bgp = _groups[group];
+	const Variable* const  qvar = _variables[var->var];
+	return bgp->variable(qvar) == BasicGraphPattern::NONE || bgp->constrain(qvar, range);
+}
+
+// SparqlCompiler --------------------------------------------------------------
+SparqlCompiler::SparqlCompiler(const char* const* params, unsigned num)
+	: _query(), _params(params), _num(num)
+{
+}
+
+SparqlCompiler::~SparqlCompiler()
+{
+}
+
+bool SparqlCompiler::compile(const String& text, Document& terms, BasicGraphPattern& bgp,
+	Array<const Variable*>& params)
+{
+	bgp.clear();
+	params.clear();
+	const BasicGraphPattern* const  src = _query.parse(text) ? _query.pattern() : nullptr;
+	if(!src)
+		return false;
+	// The terms are interned in the document of the compiled pattern outliving the query
+	bool  res = true;
+	for(unsigned i = 0; i < src->length() && res; ++i) {
+		const Quad&  pattern = src->pattern(i);
+		const Term* const  subject = terms.intern(*pattern.subject);
+		const Term* const  predicate = terms.intern(*pattern.predicate);
+		const Term* const  object = terms.intern(*pattern.object);
+		const Term* const  graph = pattern.graph ? terms.intern(*pattern.graph) : nullptr;
+		res = subject && predicate && object && (graph || !pattern.graph)
+			&& bgp.add(*subject, *predicate, *object, graph);
+	}
+	for(unsigned i = 0; i < _num && res; ++i) {
+		const Term* const  var = terms.findTerm(Variable(String(_params[i])));
+		res = var && params.add(static_cast<const Variable*>(var));
+	}
+	_query.clear();
+	return res;
+}
+
+#endif  // SMALLRDF_SPARQL
@@ -0,0 +1,186 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "Statistics.h"
+
+using namespace smallrdf;
+
+const unsigned  HyperLogLog::BITS;
+const unsigned  HyperLogLog::REGISTERS;
+
+// HyperLogLog -----------------------------------------------------------------
+HyperLogLog::HyperLogLog()
+{
+	memset(_registers, 0, sizeof _registers);
+}
+
+void HyperLogLog::add(uint32_t hash)
+{
+	// Note: the content hashes are mixed to spread their bits uniformly
+	const uint32_t  h = hashMix(hash);
+	uint32_t  rest = h << BITS;
+	uint8_t  rank = 1;
+	while(!(rest & 0x80000000u) && rank <= 32 - BITS) {
+		rest <<= 1;
+		++rank;
+	}
+	uint8_t&  reg = _registers[h >> (32 - BITS)];
+	if(reg < rank)
+		reg = rank;
+}
+
+void HyperLogLog::merge(const HyperLogLog& other)
+{
+	for(unsigned i = 0; i < REGISTERS; ++i)
+		if(_registers[i] < other._registers[i])
+			_registers[i] = other._registers[i];
+}
+
+double HyperLogLog::estimate() const
+{
+	double  sum = 0;
+	unsigned  zeros = 0;
+	for(unsigned i = 0; i < REGISTERS; ++i) {
+		sum += ldexp(1, -_registers[i]);
+		zeros += !_registers[i];
+	}
+	const double  m = REGISTERS;
+	const double  est = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+	// Linear counting is more accurate for the small cardinalities
+	return est <= 2.5 * m && zeros ? m * log(m / zeros) : est;
+}
+
+// Statistics ------------------------------------------------------------------
+Statistics::Statistics()
+	: _predicateIds(), _predicates(), _frequencies(), _subjects(), _objects(), _length(0)
+{
+}
+
+Statistics::~Statistics()
+{
+}
+
+Statistics::Predicate::Predicate()
+	: count(0), subjects(), objects()
+{
+}
+
+bool Statistics::add(const Quad& quad)
+{
+	bool  added;
+	const unsigned* pid = _predicateIds.add(quad.predicate, _predicates.length(), &added);
+	if(!pid)
+		return false;
+	if(added) {
+		if(!_predicates.add(Predicate())) {
+			_predicateIds.remove(quad.predicate);
+			return false;
+		}
+	}
+	Predicate&  pred = _predicates[*pid];
+	const uint32_t  shash = quad.subject->hash();
+	const uint32_t  ohash = quad.object->hash();
+	++pred.count;
+	pred.subjects.add(shash);
+	pred.objects.add(ohash);
+	_subjects.add(shash);
+	_objects.add(ohash);
+
+	static const Frequency  none = {0, 0, 0, 0};
+	const Term* const  terms[4] = {quad.subject, quad.predicate, quad.object, quad.graph};
+	unsigned Frequency::* const  fields[4] = {&Frequency::subject, &Frequency::predicate,
+		&Frequency::object, &Frequency::graph};
+	for(unsigned i = 0; i < 4; ++i) {
+		if(!terms[i])
+			continue;
+		Frequency* freq = _frequencies.add(terms[i], none);
+		if(!freq)
+			return false;
+		++(freq->*fields[i]);
+	}
+	++_length;
+	return true;
+}
+
+bool Statistics::remove(const Quad& quad)
+{
+	const unsigned* pid = _predicateIds.find(quad.predicate);
+	if(!pid || !_predicates[*pid].count)
+		return false;
+	const Term* const  terms[4] = {quad.subject, quad.predicate, quad.object, quad.graph};
+	unsigned Frequency::* const  fields[4] = {&Frequency::subject, &Frequency::predicate,
+		&Frequency::object, &Frequency::graph};
+	Frequency*  freqs[4] = {nullptr, nullptr, nullptr, nullptr};
+	for(unsigned i = 0; i < 4; ++i)
+		if(terms[i] && (!(freqs[i] = _frequencies.find(terms[i])) || !(freqs[i]->*fields[i])))
+			return false;
+	// Note: the sketches retain the removed items
+	--_predicates[*pid].count;
+	for(unsigned i = 0; i < 4; ++i)
+		if(freqs[i])
+			--(freqs[i]->*fields[i]);
+	--_length;
+	return true;
+}
+
+const Statistics::Predicate* Statistics::predicate(const Term& predicate) const
+{
+	const unsigned* pid = _predicateIds.find(&predicate);
+	return pid ? &_predicates[*pid] : nullptr;
+}
+
+const Statistics::Frequency* Statistics::frequency(const Term& term) const
+{
+	return _frequencies.find(&term);
+}
+
+double Statistics::estimate(const Term* const pattern[4], unsigned bound) const
+{
+	if(!_length)
+		return 0;
+	const double  total = _length;
+	double  count = total;
+	double  subjects = this->subjects();
+	double  objects = this->objects();
+	if(pattern[1]) {
+		const Predicate*  pred = predicate(*pattern[1]);
+		// Note: the quads of the predicate might be removed, retaining the predicate
+		if(!pred || !pred->count)
+			return 0;
+		count = pred->count;
+		subjects = pred->subjects.estimate();
+		objects = pred->objects.estimate();
+	} else if(bound & 2)
+		count = total / predicates();
+	if(subjects < 1)
+		subjects = 1;
+	if(objects < 1)
+		objects = 1;
+
+	// Selectivities of the fields are considered independent
+	double  est = count;
+	if(pattern[0]) {
+		const Frequency*  freq = frequency(*pattern[0]);
+		if(!freq || !freq->subject)
+			return 0;
+		est *= pattern[1] ? fmin(freq->subject, count / subjects) / count : freq->subject / total;
+	} else if(bound & 1)
+		est /= subjects;
+	if(pattern[2]) {
+		const Frequency*  freq = frequency(*pattern[2]);
+		if(!freq || !freq->object)
+			return 0;
+		est *= pattern[1] ? fmin(freq->object, count / objects) / count : freq->object / total;
+	} else if(bound & 4)
+		est /= objects;
+	if(pattern[3]) {
+		const Frequency*  freq = frequency(*pattern[3]);
+		if(!freq || !freq->graph)
+			return 0;
+		est *= freq->graph / total;
+	}
+	return est;
+}
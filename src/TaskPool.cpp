@@ -0,0 +1,147 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <assert.h>
+
+#include "TaskPool.h"
+
+#ifdef SMALLRDF_THREADS
+
+using namespace smallrdf;
+
+
+TaskPool::TaskPool(unsigned workers)
+	: _workers(nullptr), _threads(nullptr), _num(0), _queued(0), _pending(0), _run(), _idle()
+	, _wake(), _stop(false)
+{
+	if(!workers && !(workers = std::thread::hardware_concurrency()))
+		workers = 1;
+	_workers = new Worker[workers];
+	if(!_workers)
+		return;
+	if(workers >= 2 && !(_threads = new std::thread[workers - 1])) {
+		delete[] _workers;
+		_workers = nullptr;
+		return;
+	}
+	_num = workers;
+	for(unsigned i = 1; i < _num; ++i)
+		_threads[i - 1] = std::thread([this, i]() { work(i); });
+}
+
+TaskPool::~TaskPool()
+{
+	{
+		std::lock_guard<std::mutex>  lock(_idle);
+		_stop = true;
+	}
+	_wake.notify_all();
+	for(unsigned i = 1; i < _num; ++i)
+		_threads[i - 1].join();
+	delete[] _threads;
+	delete[] _workers;
+}
+
+void TaskPool::run(Task& task)
+{
+	assert(_num && "The pool should be constructed");
+	std::lock_guard<std::mutex>  serial(_run);
+	task(*this, 0);
+	// The calling thread helps the workers until all spawned tasks are completed,
+	// sleeping while the remaining tasks are being executed by the workers
+	for(;;) {
+		Task* const  sub = take(0);
+		if(sub) {
+			execute(sub, 0);
+			continue;
+		}
+		std::unique_lock<std::mutex>  lock(_idle);
+		_wake.wait(lock, [this]() { return !_pending.load() || _queued.load(); });
+		if(!_pending.load())
+			return;
+	}
+}
+
+bool TaskPool::spawn(unsigned worker, Task* task)
+{
+	assert(worker < _num && "The worker is out of range");
+	Worker&  own = _workers[worker];
+	{
+		std::lock_guard<std::mutex>  lock(own.lock);
+		if(!own.tasks.add(task))
+			return false;
+		_pending.fetch_add(1);
+		_queued.fetch_add(1);
+	}
+	if(_num >= 2) {
+		// Note: the idle workers check the queued tasks holding the lock, so the wakeup is not lost
+		{ std::lock_guard<std::mutex>  lock(_idle); }
+		_wake.notify_one();
+	}
+	return true;
+}
+
+Task* TaskPool::take(unsigned worker)
+{
+	if(!_queued.load())
+		return nullptr;
+	// The own most recent task
+	Worker&  own = _workers[worker];
+	{
+		std::lock_guard<std::mutex>  lock(own.lock);
+		if(own.tasks.length() > own.head) {
+			Task* const  task = own.tasks[own.tasks.length() - 1];
+			own.tasks.pop();
+			if(own.tasks.length() == own.head) {
+				own.tasks.clear();
+				own.head = 0;
+			}
+			_queued.fetch_sub(1);
+			return task;
+		}
+	}
+	// The oldest task of another worker
+	for(unsigned i = 1; i < _num; ++i) {
+		Worker&  victim = _workers[(worker + i) % _num];
+		std::lock_guard<std::mutex>  lock(victim.lock);
+		if(victim.tasks.length() > victim.head) {
+			Task* const  task = victim.tasks[victim.head++];
+			if(victim.tasks.length() == victim.head) {
+				victim.tasks.clear();
+				victim.head = 0;
+			}
+			_queued.fetch_sub(1);
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+void TaskPool::execute(Task* task, unsigned worker)
+{
+	(*task)(*this, worker);
+	delete task;
+	if(_pending.fetch_sub(1) == 1) {
+		// Note: the calling thread of run() checks the pending tasks holding the lock,
+		// so the wakeup is not lost
+		{ std::lock_guard<std::mutex>  lock(_idle); }
+		_wake.notify_all();
+	}
+}
+
+void TaskPool::work(unsigned worker)
+{
+	for(;;) {
+		Task* const  task = take(worker);
+		if(task) {
+			execute(task, worker);
+			continue;
+		}
+		std::unique_lock<std::mutex>  lock(_idle);
+		_wake.wait(lock, [this]() { return _stop || _queued.load(); });
+		if(_stop)
+			return;
+	}
+}
+
+#endif  // SMALLRDF_THREADS
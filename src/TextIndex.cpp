@@ -0,0 +1,199 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <string.h>
+
+#include "TextIndex.h"
+
+using namespace smallrdf;
+
+
+namespace {
+
+//! \brief Trigram code of the 3 bytes
+inline uint32_t trigram(const uint8_t* data)
+{
+	return uint32_t(data[0]) << 16 | uint32_t(data[1]) << 8 | data[2];
+}
+
+//! \brief Lexicographical comparison of the strings
+int compare(const String& a, const uint8_t* data, size_t len)
+{
+	const size_t  alen = a.length();
+	const int  res = memcmp(a.data(), data, alen < len ? alen : len);
+	if(res)
+		return res;
+	return alen < len ? -1 : alen > len;
+}
+
+//! \brief Whether the string contains the text
+bool contains(const String& str, const uint8_t* text, size_t len)
+{
+	if(!len)
+		return true;
+	if(len > str.length())
+		return false;
+	const uint8_t*  data = str.data();
+	const uint8_t* const  last = data + (str.length() - len);
+	while(data <= last) {
+		data = static_cast<const uint8_t*>(memchr(data, *text, last - data + 1));
+		if(!data)
+			return false;
+		if(!memcmp(data, text, len))
+			return true;
+		++data;
+	}
+	return false;
+}
+
+//! \brief Order of the literals by their values
+struct LiteralLess {
+	bool operator()(const Literal* a, const Literal* b) const
+		{ return compare(*a->value, b->value->data(), b->value->length()) < 0; }
+};
+
+//! \brief Order of the postings by the trigram and literal
+struct PostingLess {
+	bool operator()(const TextIndex::Posting& a, const TextIndex::Posting& b) const
+	{
+		if(a.trigram != b.trigram)
+			return a.trigram < b.trigram;
+		return reinterpret_cast<uintptr_t>(a.literal) < reinterpret_cast<uintptr_t>(b.literal);
+	}
+};
+
+//! \brief Order of the trigrams
+struct TrigramLess {
+	bool operator()(uint32_t a, uint32_t b) const
+		{ return a < b; }
+};
+
+}  // namespace
+
+TextIndex::TextIndex()
+	: _literals(), _pending(), _postings(), _pendingPostings()
+{
+}
+
+TextIndex::~TextIndex()
+{
+}
+
+bool TextIndex::add(const Literal* literal)
+{
+	const String&  value = *literal->value;
+	const uint8_t* const  data = value.data();
+	const size_t  len = value.length();
+	// Distinct trigrams of the value
+	Array<uint32_t>  trigrams;
+	if(len >= 3 && !trigrams.reserve(len - 2))
+		return false;
+	for(size_t i = 0; i + 3 <= len; ++i)
+		trigrams.add(trigram(data + i));
+	sort(trigrams.begin(), trigrams.end(), TrigramLess());
+
+	const unsigned  npending = _pendingPostings.length();
+	for(unsigned i = 0; i < trigrams.length(); ++i) {
+		if(i && trigrams[i] == trigrams[i - 1])
+			continue;
+		const Posting  posting = {trigrams[i], literal};
+		if(!_pendingPostings.add(posting)) {
+			_pendingPostings.resize(npending);
+			return false;
+		}
+	}
+	if(!_pending.add(literal)) {
+		_pendingPostings.resize(npending);
+		return false;
+	}
+	return true;
+}
+
+void TextIndex::clear()
+{
+	_literals.clear();
+	_pending.clear();
+	_postings.clear();
+	_pendingPostings.clear();
+}
+
+bool TextIndex::flush()
+{
+	return merge(_literals, _pending, LiteralLess())
+		&& merge(_postings, _pendingPostings, PostingLess());
+}
+
+bool TextIndex::search(const String& text, Array<const Literal*>& res)
+{
+	res.clear();
+	if(!flush())
+		return false;
+	const uint8_t* const  data = text.data();
+	const size_t  len = text.length();
+	if(len < 3) {
+		for(const Literal* literal: _literals)
+			if(contains(*literal->value, data, len) && !res.add(literal))
+				return false;
+		return true;
+	}
+
+	// The postings of the rarest trigram of the text bound the candidates
+	const Posting*  beg = _postings.end();
+	const Posting*  end = _postings.end();
+	unsigned  num = ~0u;
+	for(size_t i = 0; i + 3 <= len; ++i) {
+		const uint32_t  code = trigram(data + i);
+		const Posting*  lo = _postings.begin();
+		const Posting*  hi = _postings.end();
+		while(lo < hi) {
+			const Posting*  mid = lo + (hi - lo) / 2;
+			if(mid->trigram < code)
+				lo = mid + 1;
+			else hi = mid;
+		}
+		hi = _postings.end();
+		for(const Posting* top = lo; top < hi; ) {
+			const Posting*  mid = top + (hi - top) / 2;
+			if(mid->trigram <= code)
+				top = mid + 1;
+			else hi = mid;
+		}
+		if(unsigned(hi - lo) < num) {
+			beg = lo;
+			end = hi;
+			num = hi - lo;
+			if(!num)
+				return true;
+		}
+	}
+	for(; beg != end; ++beg)
+		if(contains(*beg->literal->value, data, len) && !res.add(beg->literal))
+			return false;
+	return true;
+}
+
+bool TextIndex::complete(const String& prefix, Array<const Literal*>& res, unsigned limit)
+{
+	res.clear();
+	if(!flush())
+		return false;
+	const uint8_t* const  data = prefix.data();
+	const size_t  len = prefix.length();
+	// First literal not preceding the prefix
+	const Literal* const*  beg = _literals.begin();
+	const Literal* const*  end = _literals.end();
+	while(beg < end) {
+		const Literal* const*  mid = beg + (end - beg) / 2;
+		if(compare(*(*mid)->value, data, len) < 0)
+			beg = mid + 1;
+		else end = mid;
+	}
+	for(end = _literals.end(); beg != end && res.length() < limit; ++beg) {
+		const String&  value = *(*beg)->value;
+		if(value.length() < len || memcmp(value.data(), data, len))
+			break;
+		if(!res.add(*beg))
+			return false;
+	}
+	return true;
+}
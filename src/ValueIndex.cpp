@@ -0,0 +1,219 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <math.h>  // HUGE_VAL, isnan
+#include <stdlib.h>  // strtod
+#include <string.h>
+
+#include "ValueIndex.h"
+
+using namespace smallrdf;
+
+
+namespace {
+
+const char  XSD[] = "http://www.w3.org/2001/XMLSchema#";
+
+//! \brief Parse the fixed number of digits
+bool digits(const char*& str, unsigned num, long& val)
+{
+	val = 0;
+	for(unsigned i = 0; i < num; ++i, ++str) {
+		if(*str < '0' || *str > '9')
+			return false;
+		val = val * 10 + (*str - '0');
+	}
+	return true;
+}
+
+//! \brief Number of the days since the Unix epoch of the proleptic Gregorian date
+long days(long year, long month, long day)
+{
+	// Note: the year is considered to start in March, so the leap day is the last one
+	year -= month <= 2;
+	const long  era = (year >= 0 ? year : year - 399) / 400;
+	const long  yoe = year - era * 400;
+	const long  doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	const long  doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + doe - 719468;
+}
+
+//! \brief Seconds since the Unix epoch of the xsd:dateTime lexical form:
+//! [-]YYYY-MM-DDThh:mm:ss[.s+][Z|(+|-)hh:mm], where the absent timezone is considered UTC
+bool dateTime(const char* str, double& val)
+{
+	const bool  negative = *str == '-';
+	str += negative;
+	long  year = 0;
+	unsigned  ndig = 0;
+	for(; *str >= '0' && *str <= '9'; ++str, ++ndig)
+		year = year * 10 + (*str - '0');
+	long  month, day, hour, minute, second;
+	if(ndig < 4 || *str++ != '-' || !digits(str, 2, month) || *str++ != '-' || !digits(str, 2, day)
+	|| *str++ != 'T' || !digits(str, 2, hour) || *str++ != ':' || !digits(str, 2, minute)
+	|| *str++ != ':' || !digits(str, 2, second))
+		return false;
+	if(month < 1 || month > 12 || day < 1 || day > 31 || hour > 24 || minute > 59 || second > 60
+	|| (hour == 24 && (minute || second)))
+		return false;
+	double  frac = 0;
+	if(*str == '.') {
+		char*  end;
+		frac = strtod(str, &end);
+		if(end == str + 1)
+			return false;
+		str = end;
+	}
+	long  offset = 0;
+	if(*str == 'Z')
+		++str;
+	else if(*str == '+' || *str == '-') {
+		const long  sign = *str++ == '-' ? -1 : 1;
+		long  tzh, tzm;
+		if(!digits(str, 2, tzh) || *str++ != ':' || !digits(str, 2, tzm) || tzh > 14 || tzm > 59)
+			return false;
+		offset = sign * (tzh * 3600 + tzm * 60);
+	}
+	if(*str)
+		return false;
+	val = double(days(negative ? -year : year, month, day)) * 86400
+		+ hour * 3600 + minute * 60 + second + frac - offset;
+	return true;
+}
+
+//! \brief Order of the entries by the predicate, kind and value
+struct EntryLess {
+	bool operator()(const ValueIndex::Entry& a, const ValueIndex::Entry& b) const
+	{
+		if(a.predicate != b.predicate)
+			return reinterpret_cast<uintptr_t>(a.predicate) < reinterpret_cast<uintptr_t>(b.predicate);
+		if(a.kind != b.kind)
+			return a.kind < b.kind;
+		return a.value < b.value;
+	}
+};
+
+}  // namespace
+
+// ValueRange ------------------------------------------------------------------
+ValueRange ValueRange::all(ValueKind kind)
+{
+	const ValueRange  res = {kind, -HUGE_VAL, HUGE_VAL, false, false};
+	return res;
+}
+
+ValueKind ValueRange::value(const Term& term, double& val)
+{
+	if(term.kind != RTK_LITERAL)
+		return VK_NONE;
+	const String* const  dtype = static_cast<const Literal&>(term).dtype;
+	const size_t  xlen = sizeof XSD - 1;
+	if(!dtype || dtype->length() <= xlen || memcmp(dtype->data(), XSD, xlen))
+		return VK_NONE;
+	const char* const  name = dtype->c_str() + xlen;
+	const char* const  str = term.value->c_str();
+	if(!strcmp(name, "dateTime"))
+		return dateTime(str, val) ? VK_DATETIME : VK_NONE;
+	static const char* const  TYPES[] = {"integer", "decimal", "double", "float", "int", "long",
+		"short", "byte", "nonNegativeInteger", "positiveInteger", "negativeInteger",
+		"nonPositiveInteger", "unsignedLong", "unsignedInt", "unsignedShort", "unsignedByte"};
+	unsigned  i = 0;
+	while(i < sizeof TYPES / sizeof *TYPES && strcmp(name, TYPES[i]))
+		++i;
+	if(i == sizeof TYPES / sizeof *TYPES)
+		return VK_NONE;
+	char*  end;
+	val = strtod(str, &end);
+	return end != str && !*end ? VK_NUMBER : VK_NONE;
+}
+
+bool ValueRange::contains(ValueKind vkind, double val) const
+{
+	return vkind == kind && (loOpen ? val > lo : val >= lo) && (hiOpen ? val < hi : val <= hi);
+}
+
+bool ValueRange::contains(const Term& term) const
+{
+	// Note: the value is not set for VK_NONE, which is never contained
+	double  val = 0;
+	const ValueKind  vkind = value(term, val);
+	return vkind != VK_NONE && contains(vkind, val);
+}
+
+bool ValueRange::intersect(const ValueRange& other)
+{
+	if(other.kind != kind)
+		kind = VK_NONE;
+	// Note: the bounds are not NaN, so the unordered bounds are equal
+	if(other.lo > lo || (!(other.lo < lo) && other.loOpen)) {
+		lo = other.lo;
+		loOpen = other.loOpen;
+	}
+	if(other.hi < hi || (!(other.hi > hi) && other.hiOpen)) {
+		hi = other.hi;
+		hiOpen = other.hiOpen;
+	}
+	return kind != VK_NONE && (lo < hi || (!(lo > hi) && !loOpen && !hiOpen));
+}
+
+// ValueIndex ------------------------------------------------------------------
+ValueIndex::ValueIndex()
+	: _entries(), _pending(), _observed(0)
+{
+}
+
+bool ValueIndex::add(const Quad* quad)
+{
+	Entry  entry = {quad->predicate, 0, quad, VK_NONE};
+	entry.kind = ValueRange::value(*quad->object, entry.value);
+	// Note: NaN values are not ordered
+	if(entry.kind != VK_NONE && !isnan(entry.value) && !_pending.add(entry))
+		return false;
+	++_observed;
+	return true;
+}
+
+void ValueIndex::clear()
+{
+	_entries.clear();
+	_pending.clear();
+	_observed = 0;
+}
+
+bool ValueIndex::flush()
+{
+	return merge(_entries, _pending, EntryLess());
+}
+
+bool ValueIndex::range(const Term* predicate, const ValueRange& range, Range& res)
+{
+	if(!flush())
+		return false;
+	res.beg = res.end = _entries.end();
+	if(range.kind == VK_NONE)
+		return true;
+	const EntryLess  eless;
+	const Entry  lo = {predicate, range.lo, nullptr, range.kind};
+	const Entry  hi = {predicate, range.hi, nullptr, range.kind};
+
+	// First entry not preceding the lower bound (or following it if the bound is open)
+	const Entry*  beg = _entries.begin();
+	const Entry*  end = _entries.end();
+	while(beg < end) {
+		const Entry*  mid = beg + (end - beg) / 2;
+		if(range.loOpen ? !eless(lo, *mid) : eless(*mid, lo))
+			beg = mid + 1;
+		else end = mid;
+	}
+	res.beg = beg;
+	// First entry following the upper bound (or not preceding it if the bound is open)
+	end = _entries.end();
+	while(beg < end) {
+		const Entry*  mid = beg + (end - beg) / 2;
+		if(range.hiOpen ? eless(*mid, hi) : !eless(hi, *mid))
+			beg = mid + 1;
+		else end = mid;
+	}
+	res.end = beg;
+	return true;
+}
@@ -0,0 +1,81 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <gtest/gtest.h>
+
+#include "BinaryParser.h"
+#include "BinarySerializer.h"
+#include "NTriplesSerializer.h"
+
+using namespace smallrdf;
+
+
+TEST(BinaryParser, RoundTrip) {
+  Document doc;
+  const NamedNode* subject = doc.namedNode(*doc.string(String("http://example.org/subject")));
+  const NamedNode* predicate = doc.namedNode(*doc.string(String("http://example.org/predicate")));
+  const NamedNode* graph = doc.namedNode(*doc.string(String("http://example.org/graph")));
+  const BlankNode* blank = doc.blankNode(*doc.string(String("b0")));
+  const String* lang = doc.string(String("en"));
+  const String* dtype = doc.string(String("http://www.w3.org/2001/XMLSchema#integer"));
+  doc.quad(*subject, *predicate, *doc.literal(*doc.string(String("label")), lang));
+  doc.quad(*subject, *predicate, *doc.literal(*doc.string(String("42")), nullptr, dtype));
+  doc.quad(*blank, *predicate, *subject, graph);
+  doc.quad(*subject, *predicate, *doc.literal(*doc.string(String(""))));
+
+  String* binary = nullptr;
+  BinarySerializer::serialize(doc, binary);
+  Document* parsed = nullptr;
+  BinaryParser  parser(parsed);
+  const Document& res = parser.parse(*binary);
+  ASSERT_FALSE(parser.failed());
+  ASSERT_EQ(doc.quads.length(), res.quads.length());
+
+  // The parsed document retains the quads order
+  String* expected = nullptr;
+  NTriplesSerializer::serialize(doc, expected);
+  String* actual = nullptr;
+  NTriplesSerializer::serialize(res, actual);
+  ASSERT_STREQ(expected->c_str(), actual->c_str());
+
+  delete actual;
+  delete expected;
+  delete binary;
+}
+
+TEST(BinaryParser, Chunks) {
+  Document doc;
+  const NamedNode* subject = doc.namedNode(*doc.string(String("http://example.org/subject")));
+  const NamedNode* predicate = doc.namedNode(*doc.string(String("http://example.org/predicate")));
+  doc.quad(*subject, *predicate, *subject);
+
+  String* binary = nullptr;
+  BinarySerializer::serialize(doc, binary);
+  BinarySerializer::serialize(doc, binary);
+  Document* parsed = nullptr;
+  BinaryParser::parse(*binary, parsed);
+  ASSERT_EQ(2, parsed->quads.length());
+  // Terms are interned across the chunks
+  ASSERT_EQ((**parsed->quads.begin()).subject, (**parsed->quads.begin()->next()).subject);
+
+  delete parsed;
+  delete binary;
+}
+
+TEST(BinaryParser, Malformed) {
+  Document doc;
+  const NamedNode* subject = doc.namedNode(*doc.string(String("http://example.org/subject")));
+  doc.quad(*subject, *subject, *subject);
+  String* binary = nullptr;
+  BinarySerializer::serialize(doc, binary);
+
+  BinaryParser  parser;
+  const String  truncated(binary->data(), binary->length() - 1);
+  ASSERT_EQ(0, parser.parse(truncated).quads.length());
+  ASSERT_TRUE(parser.failed());
+
+  const String  invalid("SRDX");
+  parser.parse(invalid);
+  ASSERT_TRUE(parser.failed());
+  delete binary;
+}
@@ -0,0 +1,66 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <gtest/gtest.h>
+
+#include "BinarySerializer.h"
+#include "NTriplesSerializer.h"
+
+using namespace smallrdf;
+
+
+TEST(BinarySerializer, Header) {
+  Dataset dataset;
+  String* res = nullptr;
+  BinarySerializer::serialize(dataset, res);
+
+  // Header and the empty sections of strings (with the block size), terms and quads
+  ASSERT_EQ(9, res->length());
+  ASSERT_EQ(0, memcmp(res->data(), "SRDF\x02\0\x10\0\0", 9));
+  delete res;
+}
+
+TEST(BinarySerializer, Compact) {
+  Document doc;
+  const NamedNode* predicate = doc.namedNode(*doc.string(String("http://example.org/device/sensor/value")));
+  const String* dtype = doc.string(String("http://www.w3.org/2001/XMLSchema#integer"));
+  char buf[64];
+  for(unsigned i = 0; i < 256; ++i) {
+    snprintf(buf, sizeof buf, "http://example.org/device/%u/sensor/%u", i / 16, i % 16);
+    const NamedNode* subject = doc.namedNode(*doc.string(String(buf, true)));
+    snprintf(buf, sizeof buf, "%u", i % 32);
+    doc.quad(*subject, *predicate, *doc.literal(*doc.string(String(buf, true)), nullptr, dtype));
+  }
+
+  String* ntriples = nullptr;
+  NTriplesSerializer::serialize(doc, ntriples);
+  String* binary = nullptr;
+  BinarySerializer::serialize(doc, binary);
+  // Each string is stored once and quads are encoded by the term ids
+  ASSERT_LT(binary->length() * 3, ntriples->length());
+  delete binary;
+  delete ntriples;
+}
+
+TEST(BinarySerializer, FrontCoded) {
+  Document doc;
+  const NamedNode* predicate = doc.namedNode(*doc.string(String("http://example.org/ontology#next")));
+  size_t plain = 0;
+  char buf[64];
+  // Unordered IRIs sharing long prefixes are front-coded once sorted
+  const NamedNode* prev = nullptr;
+  for(unsigned i = 0; i < 256; ++i) {
+    const unsigned  id = i * 97 % 256;
+    snprintf(buf, sizeof buf, "http://example.org/device/%u/sensor/%u", id / 16, id % 16);
+    const NamedNode* subject = doc.namedNode(*doc.string(String(buf, true)));
+    plain += subject->value->length();
+    if(prev)
+      doc.quad(*subject, *predicate, *prev);
+    prev = subject;
+  }
+
+  String* binary = nullptr;
+  BinarySerializer::serialize(doc, binary);
+  ASSERT_LT(binary->length() * 2, plain);
+  delete binary;
+}
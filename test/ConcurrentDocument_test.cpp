@@ -0,0 +1,121 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "ConcurrentDocument.h"
+
+#ifdef SMALLRDF_THREADS
+#include <atomic>
+#include <thread>
+
+using namespace smallrdf;
+
+
+//! \brief Store the readings of the sensor, each one is typed and valued
+static void readings(ConcurrentDocument& doc, unsigned sensor, unsigned num)
+{
+  const NamedNode* type = doc.namedNode(*doc.string(String("http://www.w3.org/1999/02/22-rdf-syntax-ns#type")));
+  const NamedNode* reading = doc.namedNode(*doc.string(String("http://example.org/Reading")));
+  const NamedNode* value = doc.namedNode(*doc.string(String("http://example.org/value")));
+  char buf[64];
+  for(unsigned i = 0; i < num; ++i) {
+    sprintf(buf, "http://example.org/sensor/%u/reading/%u", sensor, i);
+    const NamedNode* subject = doc.namedNode(*doc.string(String(buf, true)));
+    sprintf(buf, "%u", i);
+    doc.quad(*subject, *type, *reading);
+    doc.quad(*subject, *value, *doc.literal(*doc.string(String(buf, true))));
+  }
+}
+
+TEST(ConcurrentDocument, Isolation) {
+  ConcurrentDocument doc;
+  ASSERT_TRUE(doc.valid());
+  const NamedNode* type = doc.namedNode(*doc.string(String("http://www.w3.org/1999/02/22-rdf-syntax-ns#type")));
+  readings(doc, 0, 100);
+  ConcurrentDocument::View empty(doc);
+  ASSERT_EQ(0, empty.count(Quad(nullptr, type)));
+
+  ASSERT_TRUE(doc.publish());
+  ASSERT_EQ(200, doc.length());
+  ConcurrentDocument::View first(doc);
+  readings(doc, 1, 1000);
+  // The stored quads are invisible until published
+  ASSERT_EQ(100, first.count(Quad(nullptr, type)));
+  ASSERT_TRUE(doc.publish());
+  ConcurrentDocument::View second(doc);
+  ASSERT_EQ(1100, second.count(Quad(nullptr, type)));
+  ASSERT_EQ(100, first.count(Quad(nullptr, type)));
+  ASSERT_EQ(0, empty.count(Quad(nullptr, type)));
+
+  // Lookups in the base index and in the tail
+  const NamedNode* subject = doc.namedNode(*doc.string(String("http://example.org/sensor/1/reading/7")));
+  ASSERT_EQ(2, second.match(subject).length());
+  ASSERT_TRUE(second.exists(Quad(subject, type)));
+  ASSERT_FALSE(first.exists(Quad(subject, type)));
+  ASSERT_TRUE(second.find(Quad(nullptr, nullptr, doc.literal(*doc.string(String("999"))))));
+  readings(doc, 2, 10);
+  ASSERT_TRUE(doc.publish());
+  ConcurrentDocument::View third(doc);
+  ASSERT_EQ(1110, third.count(Quad(nullptr, type)));
+  ASSERT_EQ(1, third.count(Quad(doc.namedNode(*doc.string(String("http://example.org/sensor/2/reading/3"))), type)));
+}
+
+TEST(ConcurrentDocument, Reclaim) {
+  ConcurrentDocument doc;
+  const unsigned  epoch = doc.epoch();
+  {
+    ConcurrentDocument::View view(doc);
+    for(unsigned i = 0; i < 4; ++i) {
+      readings(doc, i, 200);
+      ASSERT_TRUE(doc.publish());
+    }
+    // The epoch is advanced once, the former versions are pinned by the view
+    ASSERT_EQ(epoch + 1, doc.epoch());
+    ASSERT_EQ(4, doc.retired());
+    ASSERT_EQ(0, view.length());
+  }
+  readings(doc, 4, 1);
+  ASSERT_TRUE(doc.publish());
+  readings(doc, 5, 1);
+  ASSERT_TRUE(doc.publish());
+  ASSERT_EQ(epoch + 3, doc.epoch());
+  ASSERT_EQ(1, doc.retired());
+}
+
+TEST(ConcurrentDocument, Threads) {
+  ConcurrentDocument doc;
+  const NamedNode* type = doc.namedNode(*doc.string(String("http://www.w3.org/1999/02/22-rdf-syntax-ns#type")));
+  const NamedNode* value = doc.namedNode(*doc.string(String("http://example.org/value")));
+  const unsigned  batches = 40;
+  std::atomic<bool>  done(false);
+  std::atomic<unsigned>  failures(0);
+
+  // Each published batch stores the typed and valued readings, so a consistent snapshot
+  // has as many types as values, and the snapshots grow monotonically
+  std::thread  readers[4];
+  for(std::thread& reader: readers)
+    reader = std::thread([&]() {
+      unsigned  last = 0;
+      while(!done.load()) {
+        ConcurrentDocument::View view(doc);
+        const unsigned  types = view.count(Quad(nullptr, type));
+        if(types != view.count(Quad(nullptr, value)) || types < last || 2 * types != view.length())
+          ++failures;
+        last = types;
+      }
+    });
+  for(unsigned i = 0; i < batches; ++i) {
+    readings(doc, i, 50);
+    doc.publish();
+  }
+  done.store(true);
+  for(std::thread& reader: readers)
+    reader.join();
+  ASSERT_EQ(0, failures.load());
+  ConcurrentDocument::View view(doc);
+  ASSERT_EQ(batches * 50, view.count(Quad(nullptr, type)));
+}
+
+#endif  // SMALLRDF_THREADS
@@ -0,0 +1,137 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "Coroutine.h"
+
+#ifdef SMALLRDF_COROUTINES
+using namespace smallrdf;
+
+
+//! \brief Byte source yielding the chunks of the input, suspending the reader on each read
+//! 	till the event loop polls the source
+struct ChunkSource {
+  const char* input;
+  size_t size;  //!< Size of the chunk
+  size_t offs;
+  String chunk;
+  std::coroutine_handle<> reader;  //!< Reader awaiting the chunk
+
+  struct Read {
+    ChunkSource& source;
+
+    bool await_ready() const noexcept
+      { return false; }
+    void await_suspend(std::coroutine_handle<> handle) noexcept
+      { source.reader = handle; }
+    const String* await_resume()
+      { return source.next(); }
+  };
+
+  ChunkSource(const char* data, size_t len)
+    : input(data), size(len), offs(0), chunk(), reader()  {}
+  ChunkSource(const ChunkSource&)=delete;
+  ChunkSource& operator=(const ChunkSource&)=delete;
+
+  Read read()
+    { return Read{*this}; }
+  const String* next()
+  {
+    const size_t  len = strlen(input + offs);
+    if(!len)
+      return nullptr;
+    chunk = String(reinterpret_cast<const uint8_t*>(input + offs), len < size ? len : size);
+    offs += len < size ? len : size;
+    return &chunk;
+  }
+  //! \brief Event loop tick: resume the awaiting reader
+  bool poll()
+  {
+    if(!reader)
+      return false;
+    std::coroutine_handle<>  handle = reader;
+    reader = nullptr;
+    handle.resume();
+    return true;
+  }
+};
+
+//! \brief Store the readings of the sensor
+static void fill(Document& doc, unsigned num)
+{
+  const NamedNode* type = doc.namedNode(*doc.string(String("http://example.org/type")));
+  const NamedNode* reading = doc.namedNode(*doc.string(String("http://example.org/Reading")));
+  char buf[64];
+  for(unsigned i = 0; i < num; ++i) {
+    sprintf(buf, "http://example.org/reading/%u", i);
+    const NamedNode* subject = doc.namedNode(*doc.string(String(buf, true)));
+    doc.quad(*subject, *type, *reading);
+  }
+}
+
+TEST(Coroutine, Generator) {
+  Document  doc;
+  fill(doc, 100);
+  const String  iri("http://example.org/type");
+  const NamedNode  type(iri);
+  Generator<const Quad*>  quads = match(doc, Quad(nullptr, &type));
+  ASSERT_TRUE(quads.valid());
+  unsigned  num = 0;
+  for(const Quad* quad: quads) {
+    ASSERT_TRUE(*quad->predicate == type);
+    ++num;
+  }
+  ASSERT_EQ(100, num);
+  ASSERT_FALSE(quads.next());
+
+  // The consumer stops early, releasing the suspended coroutine
+  Generator<const Quad*>  first = match(static_cast<Dataset&>(doc), Quad(nullptr, &type));
+  ASSERT_TRUE(first.next());
+  ASSERT_TRUE(first.value());
+  const String  absent("http://example.org/absent");
+  const NamedNode  none(absent);
+  Generator<const Quad*>  empty = match(doc, Quad(&none));
+  ASSERT_FALSE(empty.next());
+}
+
+TEST(Coroutine, Parse) {
+  const char* input =
+      "<http://example.org/s1> <http://example.org/p> \"first\" .\n"
+      "<http://example.org/s2> <http://example.org/p> <http://example.org/o> .\n"
+      "<http://example.org/s3> <http://example.org/p> \"third\" .\n";
+  NTriplesParser  parser;
+  ChunkSource  source(input, 40);
+  Async<bool>  parsing = parse(parser, source);
+  // The parsing yields the control on each chunk
+  unsigned  ticks = 0;
+  ASSERT_FALSE(parsing.resume());
+  while(source.poll())
+    ++ticks;
+  ASSERT_TRUE(parsing.done());
+  ASSERT_TRUE(parsing.result());
+  ASSERT_EQ((strlen(input) + 39) / 40 + 1, ticks);
+  Document* doc = parser.release();
+  ASSERT_EQ(3, doc->quads.length());
+  delete doc;
+}
+
+//! \brief Coroutine awaiting the parsing
+static Async<unsigned> load(NTriplesParser& parser, ChunkSource& source)
+{
+  const bool  res = co_await parse(parser, source);
+  co_return res ? 1 : 0;
+}
+
+TEST(Coroutine, Await) {
+  NTriplesParser  parser;
+  ChunkSource  source("<http://example.org/s> <http://example.org/p> \"o\" .\n", 8);
+  Async<unsigned>  loading = load(parser, source);
+  ASSERT_FALSE(loading.resume());
+  while(source.poll());
+  ASSERT_TRUE(loading.done());
+  ASSERT_EQ(1, loading.result());
+}
+
+#endif  // SMALLRDF_COROUTINES
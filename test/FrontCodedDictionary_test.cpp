@@ -0,0 +1,66 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "FrontCodedDictionary.h"
+
+using namespace smallrdf;
+
+
+TEST(FrontCodedDictionary, LocateExtract) {
+  const char* const  cstrs[] = {"http://example.org/b", "http://example.org/a", "",
+    "http://example.org/ab", "http://example.org/a", "http://example.com/", "z"};
+  const unsigned  num = sizeof cstrs / sizeof *cstrs;
+  String* strs[num];
+  for(unsigned i = 0; i < num; ++i)
+    strs[i] = new String(cstrs[i]);
+
+  // Small blocks exercise both the heads and the front-coded strings
+  FrontCodedDictionary  dict(strs, num, 3);
+  ASSERT_TRUE(dict.valid());
+  // Duplicates are stored once
+  ASSERT_EQ(num - 1, dict.length());
+  // Ids are the ranks of the strings
+  ASSERT_EQ(0, dict.locate(String("")));
+  ASSERT_EQ(1, dict.locate(String("http://example.com/")));
+  ASSERT_EQ(3, dict.locate(String("http://example.org/ab")));
+  for(unsigned i = 0; i < num; ++i) {
+    const FrontCodedDictionary::Id  id = dict.locate(*strs[i]);
+    ASSERT_NE(FrontCodedDictionary::NONE, id);
+    String  str;
+    ASSERT_TRUE(dict.extract(id, str));
+    ASSERT_STREQ(cstrs[i], str.c_str());
+  }
+  ASSERT_EQ(FrontCodedDictionary::NONE, dict.locate(String("http://example.org/")));
+  ASSERT_EQ(FrontCodedDictionary::NONE, dict.locate(String("http://example.org/aa")));
+  ASSERT_EQ(FrontCodedDictionary::NONE, dict.locate(String("http://example.org/c")));
+  ASSERT_EQ(FrontCodedDictionary::NONE, dict.locate(String("zz")));
+  String  str;
+  ASSERT_FALSE(dict.extract(dict.length(), str));
+
+  for(unsigned i = 0; i < num; ++i)
+    delete strs[i];
+}
+
+TEST(FrontCodedDictionary, Compact) {
+  Document doc;
+  const NamedNode* predicate = doc.namedNode(*doc.string(String("http://example.org/ontology#value")));
+  size_t size = predicate->value->length() + 1;
+  char iri[64];
+  for(unsigned i = 0; i < 256; ++i) {
+    sprintf(iri, "http://example.org/device/%u/sensor/%u", i / 8, i % 8);
+    const NamedNode* subject = doc.namedNode(*doc.string(String(iri, true)));
+    size += subject->value->length() + 1;
+    doc.quad(*subject, *predicate, *doc.literal(*doc.string(String("0"))));
+  }
+
+  FrontCodedDictionary  dict(doc);
+  ASSERT_TRUE(dict.valid());
+  ASSERT_EQ(257, dict.length());
+  ASSERT_LT(dict.memory() * 3, size);
+  // Literals are not included
+  ASSERT_EQ(FrontCodedDictionary::NONE, dict.locate(String("0")));
+  ASSERT_NE(FrontCodedDictionary::NONE, dict.locate(String("http://example.org/device/31/sensor/7")));
+}
@@ -0,0 +1,60 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "Interner.h"
+
+#ifdef SMALLRDF_THREADS
+#include <thread>
+
+using namespace smallrdf;
+
+
+TEST(Interner, Canonical) {
+  Interner terms;
+  const String* iri = terms.string(String("http://example.org/a"));
+  ASSERT_TRUE(iri);
+  String view("http://example.org/a");
+  ASSERT_EQ(iri, terms.string(view));
+  ASSERT_EQ(iri->data(), view.data());
+  const NamedNode* node = terms.namedNode(*iri);
+  ASSERT_EQ(node, terms.namedNode(*terms.string(String("http://example.org/a"))));
+  // Terms of distinct kinds are distinct
+  ASSERT_NE(static_cast<const Term*>(node), terms.blankNode(*iri));
+  const String* en = terms.string(String("en"));
+  ASSERT_NE(terms.literal(*iri), terms.literal(*iri, en));
+  ASSERT_EQ(terms.literal(*iri, en), terms.literal(*iri, en));
+  ASSERT_EQ(node, terms.findTerm(NamedNode(String("http://example.org/a"))));
+  ASSERT_EQ(nullptr, terms.findTerm(NamedNode(String("http://example.org/b"))));
+  ASSERT_EQ(6, terms.length());
+}
+
+TEST(Interner, Threads) {
+  Interner terms;
+  const unsigned  num = 2000;
+  // Each thread interns the same overlapping values in a different order
+  const NamedNode*  nodes[4][num];
+  std::thread  threads[4];
+  for(unsigned t = 0; t < 4; ++t)
+    threads[t] = std::thread([&terms, &nodes, t]() {
+      char buf[64];
+      for(unsigned i = 0; i < num; ++i) {
+        const unsigned  id = t % 2 ? num - 1 - i : i;
+        sprintf(buf, "http://example.org/node/%u", id);
+        const String* iri = terms.string(String(buf, true));
+        nodes[t][id] = iri ? terms.namedNode(*iri) : nullptr;
+      }
+    });
+  for(std::thread& thread: threads)
+    thread.join();
+  ASSERT_EQ(2 * num, terms.length());
+  for(unsigned i = 0; i < num; ++i) {
+    ASSERT_TRUE(nodes[0][i]);
+    for(unsigned t = 1; t < 4; ++t)
+      ASSERT_EQ(nodes[0][i], nodes[t][i]);
+  }
+}
+
+#endif  // SMALLRDF_THREADS
@@ -0,0 +1,79 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "IriIndex.h"
+
+using namespace smallrdf;
+
+
+//! \brief Devices of the buildings located in the rooms
+static void fill(Document& doc, unsigned buildings, unsigned devices)
+{
+  const NamedNode* locatedIn = doc.namedNode(*doc.string(String("http://example.org/locatedIn")));
+  const NamedNode* label = doc.namedNode(*doc.string(String("http://www.w3.org/2000/01/rdf-schema#label")));
+  char buf[96];
+  for(unsigned b = 0; b < buildings; ++b)
+    for(unsigned i = 0; i < devices; ++i) {
+      sprintf(buf, "http://example.org/building/%u/device/%u", b, i);
+      const NamedNode* device = doc.namedNode(*doc.string(String(buf, true)));
+      sprintf(buf, "http://example.org/building/%u/room/%u", b, i % 4);
+      doc.quad(*device, *locatedIn, *doc.namedNode(*doc.string(String(buf, true))));
+      sprintf(buf, "device/%u", i);
+      doc.quad(*device, *label, *doc.literal(*doc.string(String(buf, true))));
+    }
+}
+
+TEST(IriIndex, Range) {
+  Document doc;
+  fill(doc, 3, 12);
+  IriIndex* index = doc.iriIndex();
+  ASSERT_TRUE(index);
+  // Devices, rooms and 2 predicates
+  ASSERT_EQ(3 * 12 + 3 * 4 + 2, index->length());
+
+  IriIndex::Range range;
+  ASSERT_TRUE(index->range(String("http://example.org/building/1/device/"), range));
+  ASSERT_EQ(12, range.length());
+  ASSERT_TRUE(index->range(String("http://example.org/building/1/device/1"), range));
+  ASSERT_EQ(3, range.length());  // 1, 10, 11
+  ASSERT_TRUE(index->range(String("http://example.org/building/"), range));
+  ASSERT_EQ(3 * 12 + 3 * 4, range.length());
+  ASSERT_TRUE(index->range(String("http://example.org/building/3"), range));
+  ASSERT_EQ(0, range.length());
+  ASSERT_TRUE(index->range(String(""), range));
+  ASSERT_EQ(index->length(), range.length());
+
+  // The named nodes interned later are indexed
+  doc.namedNode(*doc.string(String("http://example.org/building/3")));
+  ASSERT_TRUE(index->range(String("http://example.org/building/3"), range));
+  ASSERT_EQ(1, range.length());
+}
+
+TEST(IriIndex, Match) {
+  Document doc;
+  fill(doc, 3, 12);
+  const String building(String("http://example.org/building/2/"));
+  const String room(String("http://example.org/building/2/room/1"));
+  const String device(String("http://example.org/building/2/device/1"));
+
+  // Quads of the prefixed subjects
+  ASSERT_EQ(2 * 12, doc.match(Quad(), IriPrefix(&building)).length());
+  // Prefixed objects, which are not literals
+  ASSERT_EQ(3, doc.match(Quad(), IriPrefix(nullptr, &room)).length());  // Devices 1, 5 and 9
+  // Both prefixes, matching the index lookup with the filtered scan
+  const NamedNode* locatedIn = doc.namedNode(*doc.string(String("http://example.org/locatedIn")));
+  Dataset::Quads quads = doc.match(Quad(nullptr, locatedIn), IriPrefix(&device, &room));
+  ASSERT_EQ(1, quads.length());  // device/1, the devices 10 and 11 are in the rooms 2 and 3
+  ASSERT_EQ(String("http://example.org/building/2/device/1"), *(**quads.begin()).subject->value);
+  Dataset  scan;
+  for(Dataset::Quads::Iter* pit = doc.quads.begin(); pit != doc.quads.end(); pit = pit->next())
+    scan.quads.add(**pit);
+  ASSERT_EQ(1, scan.match(Quad(nullptr, locatedIn), IriPrefix(&device, &room)).length());
+  ASSERT_EQ(2 * 12, scan.match(Quad(), IriPrefix(&building)).length());
+  // The bound subject is checked
+  ASSERT_EQ(0, doc.match(Quad(doc.namedNode(*doc.string(String("http://example.org/building/0/device/0")))),
+    IriPrefix(&building)).length());
+}
@@ -0,0 +1,126 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "Join.h"
+
+using namespace smallrdf;
+
+
+namespace {
+
+//! \brief Collector of the join values and the number of the joined quads
+struct Collector: JoinVisitor {
+  unsigned keys;
+  unsigned quads;
+  unsigned limit;
+
+  Collector(unsigned ilimit=~0u)
+    : keys(0), quads(0), limit(ilimit)  {}
+
+  bool operator()(const Term* key, const QuadIndex::Range* groups, unsigned num) override
+  {
+    unsigned  prod = 1;
+    for(unsigned i = 0; i < num; ++i) {
+      for(const Quad* const* pq = groups[i].beg; pq != groups[i].end; ++pq)
+        EXPECT_TRUE((*pq)->subject == key || (*pq)->object == key);
+      prod *= groups[i].length();
+    }
+    quads += prod;
+    return ++keys < limit;
+  }
+};
+
+}  // namespace
+
+TEST(Join, Star) {
+  Document doc;
+  const NamedNode* type = doc.namedNode(*doc.string(String("http://example.org/type")));
+  const NamedNode* device = doc.namedNode(*doc.string(String("http://example.org/Device")));
+  const NamedNode* location = doc.namedNode(*doc.string(String("http://example.org/location")));
+  const NamedNode* label = doc.namedNode(*doc.string(String("http://example.org/label")));
+  char iri[64];
+  for(unsigned i = 0; i < 300; ++i) {
+    sprintf(iri, "http://example.org/device/%u", i);
+    const NamedNode* dev = doc.namedNode(*doc.string(String(iri, true)));
+    // Each input covers a distinct subset of the subjects
+    if(i % 2 == 0)
+      doc.quad(*dev, *type, *device);
+    if(i % 3 == 0)
+      doc.quad(*dev, *location, *doc.literal(*doc.string(String(iri + 19, true))));
+    if(i % 5 == 0) {
+      doc.quad(*dev, *label, *doc.literal(*doc.string(String("a"))));
+      doc.quad(*dev, *label, *doc.literal(*doc.string(String("b"))));
+    }
+  }
+
+  JoinCursor  cursors[3];
+  ASSERT_TRUE(doc.sorted(Quad(nullptr, type, device), 0, cursors[0]));
+  ASSERT_TRUE(doc.sorted(Quad(nullptr, location, nullptr), 0, cursors[1]));
+  ASSERT_TRUE(doc.sorted(Quad(nullptr, label, nullptr), 0, cursors[2]));
+  ASSERT_EQ(150, cursors[0].length());
+  ASSERT_EQ(120, cursors[2].length());
+
+  // Subjects divisible by 30 have two labels
+  Collector  star;
+  ASSERT_TRUE(leapfrogJoin(cursors, 3, star));
+  ASSERT_EQ(10, star.keys);
+  ASSERT_EQ(20, star.quads);
+
+  JoinCursor  left;
+  JoinCursor  right;
+  ASSERT_TRUE(doc.sorted(Quad(nullptr, type, device), 0, left));
+  ASSERT_TRUE(doc.sorted(Quad(nullptr, label, nullptr), 0, right));
+  Collector  pair;
+  ASSERT_TRUE(mergeJoin(left, right, pair));
+  ASSERT_EQ(30, pair.keys);
+  ASSERT_EQ(60, pair.quads);
+
+  // The visitor stops the join
+  ASSERT_TRUE(doc.sorted(Quad(nullptr, type, device), 0, cursors[0]));
+  ASSERT_TRUE(doc.sorted(Quad(nullptr, location, nullptr), 0, cursors[1]));
+  Collector  limited(3);
+  ASSERT_FALSE(leapfrogJoin(cursors, 2, limited));
+  ASSERT_EQ(3, limited.keys);
+
+  // Absent terms yield empty inputs, the bound graph is not supported
+  const NamedNode absent(*doc.string(String("http://example.org/absent")));
+  ASSERT_TRUE(doc.sorted(Quad(nullptr, &absent, nullptr), 0, left));
+  ASSERT_TRUE(left.atEnd());
+  ASSERT_FALSE(doc.sorted(Quad(nullptr, type, nullptr, device), 0, left));
+}
+
+TEST(Join, Chain) {
+  Document doc;
+  const NamedNode* knows = doc.namedNode(*doc.string(String("http://example.org/knows")));
+  const NamedNode* worksAt = doc.namedNode(*doc.string(String("http://example.org/worksAt")));
+  const NamedNode* people[16];
+  char iri[64];
+  for(unsigned i = 0; i < 16; ++i) {
+    sprintf(iri, "http://example.org/person/%u", i);
+    people[i] = doc.namedNode(*doc.string(String(iri, true)));
+  }
+  for(unsigned i = 0; i < 16; ++i) {
+    doc.quad(*people[i], *knows, *people[(i + 1) % 16]);
+    doc.quad(*people[i], *knows, *people[(i + 2) % 16]);
+    if(i % 4 == 0)
+      doc.quad(*people[i], *worksAt, *doc.namedNode(*doc.string(String("http://example.org/org"))));
+  }
+
+  // ?a knows ?b . ?b worksAt ?c joins the objects of the former with the subjects of the latter
+  JoinCursor  left;
+  JoinCursor  right;
+  ASSERT_TRUE(doc.sorted(Quad(nullptr, knows, nullptr), 2, left));
+  ASSERT_TRUE(doc.sorted(Quad(nullptr, worksAt, nullptr), 0, right));
+  Collector  chain;
+  ASSERT_TRUE(mergeJoin(left, right, chain));
+  ASSERT_EQ(4, chain.keys);
+  ASSERT_EQ(8, chain.quads);
+
+  // Predicates are not sorted after the bound object
+  ASSERT_FALSE(doc.sorted(Quad(nullptr, nullptr, people[0]), 1, left));
+  ASSERT_TRUE(doc.sorted(Quad(nullptr, nullptr, people[0]), 0, left));
+  ASSERT_EQ(2, left.length());
+}
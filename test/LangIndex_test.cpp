@@ -0,0 +1,70 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "LangIndex.h"
+
+using namespace smallrdf;
+
+
+//! \brief Localized labels of the cities
+static void fill(Document& doc, unsigned cities)
+{
+  const NamedNode* label = doc.namedNode(*doc.string(String("http://www.w3.org/2000/01/rdf-schema#label")));
+  static const char* const  LANGS[] = {"en", "en-GB", "fr", "zh-Hant"};
+  char buf[64];
+  for(unsigned i = 0; i < cities; ++i) {
+    sprintf(buf, "http://example.org/city/%u", i);
+    const NamedNode* city = doc.namedNode(*doc.string(String(buf, true)));
+    // Each city lacks one of the labels
+    for(unsigned j = 0; j < sizeof LANGS / sizeof *LANGS; ++j) {
+      if(j == i % 4)
+        continue;
+      sprintf(buf, "city %u (%s)", i, LANGS[j]);
+      doc.quad(*city, *label, *doc.literal(*doc.string(String(buf, true)), doc.string(String(LANGS[j]))));
+    }
+    sprintf(buf, "%u", i);
+    doc.quad(*city, *label, *doc.literal(*doc.string(String(buf, true))));
+  }
+}
+
+static const Literal* localized(Document& doc, unsigned city, const char* lang)
+{
+  char buf[64];
+  sprintf(buf, "http://example.org/city/%u", city);
+  return doc.localized(*doc.namedNode(*doc.string(String(buf, true))),
+    *doc.namedNode(*doc.string(String("http://www.w3.org/2000/01/rdf-schema#label"))), String(lang));
+}
+
+TEST(LangIndex, Lookup) {
+  Document doc;
+  fill(doc, 8);
+  LangIndex* index = doc.langIndex();
+  ASSERT_TRUE(index);
+  ASSERT_EQ(4, index->tags());
+  ASSERT_EQ(8 * 3, index->length());
+  ASSERT_EQ(8 * 4, index->observed());
+  ASSERT_EQ(index->find(String("en-GB")), index->find(String("EN-gb")));
+  ASSERT_EQ(LangIndex::NONE, index->find(String("de")));
+
+  // Exact and case-insensitive tags
+  ASSERT_EQ(String("city 1 (en)"), *localized(doc, 1, "en")->value);
+  ASSERT_EQ(String("city 0 (en-GB)"), *localized(doc, 0, "EN-gb")->value);
+  // Fallback to the less specific tags
+  ASSERT_EQ(String("city 2 (en)"), *localized(doc, 2, "en-US")->value);
+  ASSERT_EQ(String("city 1 (en)"), *localized(doc, 1, "en-GB")->value);
+  ASSERT_EQ(String("city 0 (zh-Hant)"), *localized(doc, 0, "zh-Hant-TW-x-private")->value);
+  ASSERT_EQ(nullptr, localized(doc, 3, "zh-Hant-TW"));
+  ASSERT_EQ(nullptr, localized(doc, 0, "en"));
+  ASSERT_EQ(nullptr, localized(doc, 0, "de"));
+  ASSERT_EQ(nullptr, localized(doc, 9, "en"));
+
+  // The index follows the added quads
+  const NamedNode* city = doc.namedNode(*doc.string(String("http://example.org/city/0")));
+  doc.quad(*city, *doc.namedNode(*doc.string(String("http://www.w3.org/2000/01/rdf-schema#label"))),
+    *doc.literal(*doc.string(String("Stadt 0")), doc.string(String("de"))));
+  ASSERT_EQ(String("Stadt 0"), *localized(doc, 0, "de-AT")->value);
+  ASSERT_EQ(5, index->tags());
+}
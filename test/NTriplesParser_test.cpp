@@ -50,3 +50,38 @@ TEST(NTriplesParser, Literal) {
 
   delete doc;  // Release memory from the aquired object
 }
+
+TEST(NTriplesParser, Feed) {
+  const char* input =
+      "<http://example.org/s1> <http://example.org/p> \"first\" .\n"
+      "<http://example.org/s2> <http://example.org/p> <http://example.org/o> .\n"
+      "_:b1 <http://example.org/p> \"third\"@en .\n"
+      "<http://example.org/s4> <http://example.org/p> \"last\"";
+  const size_t  len = strlen(input);
+  // The chunks split the lines and the terms at any position
+  for(size_t size = 1; size <= len; size += 7) {
+    NTriplesParser  parser;
+    for(size_t offs = 0; offs < len; offs += size) {
+      const size_t  num = len - offs < size ? len - offs : size;
+      String  chunk(reinterpret_cast<const uint8_t*>(input + offs), num);
+      ASSERT_TRUE(parser.feed(chunk));
+    }
+    ASSERT_TRUE(parser.feed(String(), true));
+    Document* doc = parser.release();
+    ASSERT_EQ(4, doc->quads.length());
+    const String  object("http://example.org/o");
+    ASSERT_TRUE(doc->findTerm(NamedNode(object)));
+    const String  last("last");
+    ASSERT_TRUE(doc->findTerm(Literal(last)));
+    delete doc;
+  }
+
+  // The malformed line fails the chunk
+  NTriplesParser  parser;
+  ASSERT_TRUE(parser.feed(String("<http://example.org/s1> <http://example.org/p> \"first\" .\n")));
+  ASSERT_FALSE(parser.feed(String("<http://example.org/s2> <http://example.org/p> .\n")));
+  ASSERT_FALSE(parser.feed(String("<http://example.org/s3> \"p\" \"third\" .\n"), true));
+  Document* doc = parser.release();
+  ASSERT_EQ(1, doc->quads.length());
+  delete doc;
+}
@@ -48,3 +48,54 @@ TEST(NTriplesSerializer, Literal) {
   ASSERT_TRUE(exp2 == *res);
   delete res;
 }
+
+TEST(NTriplesSerializer, Parallel) {
+  Document doc;
+  const NamedNode* predicate = doc.namedNode(*doc.string(String("http://example.org/predicate")));
+  char buf[64];
+  for(unsigned i = 0; i < 2048; ++i) {
+    snprintf(buf, sizeof buf, "http://example.org/subject%u", i);
+    const NamedNode* subject = doc.namedNode(*doc.string(String(buf, true)));
+    snprintf(buf, sizeof buf, "http://example.org/object%u", i % 7);
+    const NamedNode* object = doc.namedNode(*doc.string(String(buf, true)));
+    doc.quad(*subject, *predicate, *object);
+  }
+
+  NTriplesSerializer  seq;
+  const String& expected = seq.serialize(doc);
+  String* res = nullptr;
+  NTriplesSerializer::serialize(doc, res, 4);
+  ASSERT_EQ(expected.length(), res->length());
+  ASSERT_STREQ(expected.c_str(), res->c_str());
+  delete res;
+}
+
+TEST(NTriplesSerializer, LiteralEscaping) {
+  Dataset dataset;
+  const String subjectStr("http://example.org/subject");
+  const String predicateStr("http://example.org/predicate");
+  const String objectStr("say \"hi\"\\\n");
+  // Note: the characters to be escaped follow the vectorized blocks
+  const String longStr("a long literal value without specials, followed by \"quotes\"\r\n");
+  const String cleanStr("a long literal value without any characters to be escaped");
+  NamedNode subject(subjectStr);
+  NamedNode predicate(predicateStr);
+  Literal object(objectStr);
+  Literal longObject(longStr);
+  Literal cleanObject(cleanStr);
+  dataset.quads.add(Quad(subject, predicate, cleanObject));
+  dataset.quads.add(Quad(subject, predicate, longObject));
+  dataset.quads.add(Quad(subject, predicate, object));
+
+  const char* expected =
+      "<http://example.org/subject> <http://example.org/predicate> \"say \\\"hi\\\"\\\\\\n\" .\n"
+      "<http://example.org/subject> <http://example.org/predicate> "
+        "\"a long literal value without specials, followed by \\\"quotes\\\"\\r\\n\" .\n"
+      "<http://example.org/subject> <http://example.org/predicate> "
+        "\"a long literal value without any characters to be escaped\" .\n";
+  NTriplesSerializer  ser;
+  const String& res = ser.serialize(dataset);
+  ASSERT_STREQ(expected, res.c_str());
+  // The size precomputation accounts for the escapes
+  ASSERT_EQ(strlen(expected), res.length());
+}
@@ -0,0 +1,181 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <gtest/gtest.h>
+
+#include "PropertyPath.h"
+
+using namespace smallrdf;
+
+
+//! \brief Whether the terms contain the IRI
+static bool contains(const Array<const Term*>& terms, const char* iri)
+{
+  for(const Term* term: terms)
+    if(*term->value == String(iri))
+      return true;
+  return false;
+}
+
+TEST(PropertyPath, Transitive) {
+  Document doc;
+  const NamedNode* knows = doc.namedNode(*doc.string(String("http://example.org/knows")));
+  const NamedNode* a = doc.namedNode(*doc.string(String("http://example.org/a")));
+  const NamedNode* b = doc.namedNode(*doc.string(String("http://example.org/b")));
+  const NamedNode* c = doc.namedNode(*doc.string(String("http://example.org/c")));
+  const NamedNode* d = doc.namedNode(*doc.string(String("http://example.org/d")));
+  doc.quad(*a, *knows, *b);
+  doc.quad(*b, *knows, *c);
+  doc.quad(*c, *knows, *d);
+
+  PropertyPath  plus;
+  plus.oneOrMore(plus.link(*knows));
+  PathEvaluator  eval(doc);
+  Array<const Term*>  ends;
+  ASSERT_TRUE(eval.evaluate(plus, *a, ends));
+  ASSERT_EQ(3, ends.length());
+  ASSERT_FALSE(contains(ends, "http://example.org/a"));
+  ASSERT_TRUE(contains(ends, "http://example.org/d"));
+  ASSERT_EQ(1, eval.closures());
+
+  // The memoized closure is reused, the start term is matched by its content
+  ASSERT_TRUE(eval.evaluate(plus, *doc.namedNode(*doc.string(String("http://example.org/a"))), ends));
+  ASSERT_EQ(3, ends.length());
+  ASSERT_EQ(1, eval.closures());
+
+  PropertyPath  star;
+  star.zeroOrMore(star.link(*knows));
+  ASSERT_TRUE(eval.evaluate(star, *a, ends));
+  ASSERT_EQ(4, ends.length());
+  ASSERT_TRUE(contains(ends, "http://example.org/a"));
+  ASSERT_EQ(1, eval.closures());
+
+  // The closure is invalidated by the new links, including a cycle
+  const NamedNode* e = doc.namedNode(*doc.string(String("http://example.org/e")));
+  doc.quad(*d, *knows, *e);
+  doc.quad(*e, *knows, *a);
+  ASSERT_TRUE(eval.evaluate(plus, *a, ends));
+  ASSERT_EQ(5, ends.length());
+  ASSERT_TRUE(contains(ends, "http://example.org/a"));
+  ASSERT_EQ(1, eval.closures());
+
+  // Unlinked terms are not memoized
+  const NamedNode* f = doc.namedNode(*doc.string(String("http://example.org/f")));
+  ASSERT_TRUE(eval.evaluate(star, *f, ends));
+  ASSERT_EQ(1, ends.length());
+  ASSERT_EQ(f, ends[0]);
+  ASSERT_EQ(1, eval.closures());
+
+  // The closures are released once the dataset is modified, including the reclamation
+  // of their start terms
+  ASSERT_TRUE(eval.evaluate(plus, *e, ends));
+  ASSERT_EQ(2, eval.closures());
+  const unsigned  epoch = doc.epoch();
+  ASSERT_EQ(2, doc.remove(Quad(e)) + doc.remove(Quad(nullptr, nullptr, e)));
+  ASSERT_TRUE(doc.reclaim());
+  ASSERT_NE(epoch, doc.epoch());
+  ASSERT_TRUE(eval.evaluate(plus, *a, ends));
+  ASSERT_EQ(3, ends.length());
+  ASSERT_FALSE(contains(ends, "http://example.org/e"));
+  ASSERT_EQ(1, eval.closures());
+}
+
+TEST(PropertyPath, Versions) {
+  Document doc;
+  const NamedNode* knows = doc.namedNode(*doc.string(String("http://example.org/knows")));
+  const NamedNode* likes = doc.namedNode(*doc.string(String("http://example.org/likes")));
+  const NamedNode* a = doc.namedNode(*doc.string(String("http://example.org/a")));
+  const NamedNode* b = doc.namedNode(*doc.string(String("http://example.org/b")));
+  const NamedNode* c = doc.namedNode(*doc.string(String("http://example.org/c")));
+  doc.quad(*a, *knows, *b);
+  doc.quad(*a, *likes, *b);
+
+  PropertyPath  known;
+  known.oneOrMore(known.link(*knows));
+  PropertyPath  liked;
+  liked.oneOrMore(liked.link(*likes));
+  PathEvaluator  eval(doc);
+  Array<const Term*>  ends;
+  ASSERT_TRUE(eval.evaluate(known, *a, ends));
+  ASSERT_EQ(1, ends.length());
+  ASSERT_TRUE(eval.evaluate(liked, *a, ends));
+  ASSERT_EQ(1, ends.length());
+  ASSERT_EQ(2, eval.closures());
+
+  // The insertions invalidate only the closures of their predicates
+  doc.quad(*b, *knows, *c);
+  ASSERT_TRUE(eval.evaluate(liked, *a, ends));
+  ASSERT_EQ(1, ends.length());
+  ASSERT_EQ(2, eval.closures());
+  ASSERT_TRUE(eval.evaluate(known, *a, ends));
+  ASSERT_EQ(2, ends.length());
+  ASSERT_TRUE(contains(ends, "http://example.org/c"));
+  ASSERT_EQ(2, eval.closures());
+
+  // The removals release all closures
+  ASSERT_EQ(1, doc.remove(Quad(b, knows, c)));
+  ASSERT_TRUE(eval.evaluate(liked, *a, ends));
+  ASSERT_EQ(1, ends.length());
+  ASSERT_EQ(1, eval.closures());
+  ASSERT_TRUE(eval.evaluate(known, *a, ends));
+  ASSERT_EQ(1, ends.length());
+  ASSERT_EQ(2, eval.closures());
+}
+
+TEST(PropertyPath, Composite) {
+  Document doc;
+  const NamedNode* parent = doc.namedNode(*doc.string(String("http://example.org/parent")));
+  const NamedNode* name = doc.namedNode(*doc.string(String("http://example.org/name")));
+  const NamedNode* a = doc.namedNode(*doc.string(String("http://example.org/a")));
+  const NamedNode* b = doc.namedNode(*doc.string(String("http://example.org/b")));
+  const NamedNode* c = doc.namedNode(*doc.string(String("http://example.org/c")));
+  const NamedNode* d = doc.namedNode(*doc.string(String("http://example.org/d")));
+  const NamedNode* e = doc.namedNode(*doc.string(String("http://example.org/e")));
+  // a -> b -> c -> d -> e
+  doc.quad(*b, *parent, *a);
+  doc.quad(*c, *parent, *b);
+  doc.quad(*d, *parent, *c);
+  doc.quad(*e, *parent, *d);
+  doc.quad(*a, *name, *doc.literal(*doc.string(String("A"))));
+  doc.quad(*c, *name, *doc.literal(*doc.string(String("C"))));
+
+  PathEvaluator  eval(doc);
+  Array<const Term*>  ends;
+
+  // Inverse link: children
+  PropertyPath  path;
+  path.inverse(path.link(*parent));
+  ASSERT_TRUE(eval.evaluate(path, *a, ends));
+  ASSERT_EQ(1, ends.length());
+  ASSERT_EQ(b, ends[0]);
+
+  // Descendants
+  path.clear();
+  path.oneOrMore(path.inverse(path.link(*parent)));
+  ASSERT_TRUE(eval.evaluate(path, *b, ends));
+  ASSERT_EQ(3, ends.length());
+  ASSERT_TRUE(contains(ends, "http://example.org/e"));
+
+  // Names of the ancestors
+  path.clear();
+  path.sequence(path.oneOrMore(path.link(*parent)), path.link(*name));
+  ASSERT_TRUE(eval.evaluate(path, *e, ends));
+  ASSERT_EQ(2, ends.length());
+
+  // Inverse sequence: ^(parent/name) relates the names to the children
+  path.clear();
+  path.inverse(path.sequence(path.link(*parent), path.link(*name)));
+  ASSERT_TRUE(eval.evaluate(path, *doc.literal(*doc.string(String("C"))), ends));
+  ASSERT_EQ(1, ends.length());
+  ASSERT_EQ(d, ends[0]);
+
+  // Transitive closure of a sequence is traversed without the memoization
+  path.clear();
+  const unsigned  step = path.link(*parent);
+  path.oneOrMore(path.sequence(step, step));
+  ASSERT_TRUE(eval.evaluate(path, *e, ends));
+  ASSERT_EQ(2, ends.length());
+  ASSERT_TRUE(contains(ends, "http://example.org/c"));
+  ASSERT_TRUE(contains(ends, "http://example.org/a"));
+  ASSERT_EQ(2, eval.closures());
+}
@@ -0,0 +1,280 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "Query.h"
+#include "TaskPool.h"
+
+using namespace smallrdf;
+
+
+//! \brief Devices having sensors with observations
+static void fill(Document& doc, unsigned devices, unsigned sensors)
+{
+  const NamedNode* hasSensor = doc.namedNode(*doc.string(String("http://example.org/hasSensor")));
+  const NamedNode* observation = doc.namedNode(*doc.string(String("http://example.org/observation")));
+  const NamedNode* type = doc.namedNode(*doc.string(String("http://example.org/type")));
+  const NamedNode* device = doc.namedNode(*doc.string(String("http://example.org/Device")));
+  char iri[64];
+  for(unsigned i = 0; i < devices; ++i) {
+    sprintf(iri, "http://example.org/device/%u", i);
+    const NamedNode* dev = doc.namedNode(*doc.string(String(iri, true)));
+    doc.quad(*dev, *type, *device);
+    for(unsigned j = 0; j < sensors; ++j) {
+      sprintf(iri, "http://example.org/device/%u/sensor/%u", i, j);
+      const NamedNode* sensor = doc.namedNode(*doc.string(String(iri, true)));
+      doc.quad(*dev, *hasSensor, *sensor);
+      sprintf(iri, "%u", i * sensors + j);
+      doc.quad(*sensor, *observation, *doc.literal(*doc.string(String(iri, true))));
+    }
+  }
+}
+
+TEST(BasicGraphPattern, Join) {
+  Document doc;
+  fill(doc, 8, 4);
+  const Variable* dev = doc.variable(*doc.string(String("dev")));
+  const Variable* sensor = doc.variable(*doc.string(String("sensor")));
+  const Variable* value = doc.variable(*doc.string(String("value")));
+  String  hasSensor("http://example.org/hasSensor");
+  String  observation("http://example.org/observation");
+  String  type("http://example.org/type");
+  String  device("http://example.org/Device");
+  const NamedNode  hasSensorTerm(hasSensor);
+  const NamedNode  observationTerm(observation);
+  const NamedNode  typeTerm(type);
+  const NamedNode  deviceTerm(device);
+
+  BasicGraphPattern  bgp;
+  ASSERT_TRUE(bgp.add(*sensor, observationTerm, *value));
+  ASSERT_TRUE(bgp.add(*dev, hasSensorTerm, *sensor));
+  ASSERT_TRUE(bgp.add(*dev, typeTerm, deviceTerm));
+  ASSERT_EQ(3, bgp.width());
+
+  // The most selective pattern is evaluated first, following the bound variables
+  Array<unsigned>  order;
+  ASSERT_TRUE(bgp.plan(order));
+  ASSERT_EQ(2, order[0]);
+  ASSERT_EQ(1, order[1]);
+  ASSERT_EQ(0, order[2]);
+
+  Solutions  solutions;
+  ASSERT_TRUE(bgp.evaluate(doc, solutions));
+  ASSERT_EQ(32, solutions.length());
+  ASSERT_EQ(3, solutions.width());
+  for(unsigned i = 0; i < solutions.length(); ++i) {
+    const Term* sval = solutions.value(i, sensor);
+    const Term* dval = solutions.value(i, dev);
+    ASSERT_TRUE(sval && dval && solutions.value(i, value));
+    ASSERT_EQ(0, strncmp(sval->value->c_str(), dval->value->c_str(), dval->value->length()));
+  }
+  // The results do not depend on the join order
+  Solutions  unordered;
+  const unsigned  inorder[] = {0, 1, 2};
+  for(unsigned i = 0; i < 3; ++i)
+    order[i] = inorder[i];
+  ASSERT_TRUE(bgp.evaluate(doc, order, unordered));
+  ASSERT_EQ(solutions.length(), unordered.length());
+}
+
+TEST(BasicGraphPattern, Constraints) {
+  Document doc;
+  fill(doc, 2, 2);
+  const Variable* x = doc.variable(*doc.string(String("x")));
+  const Variable* p = doc.variable(*doc.string(String("p")));
+  const NamedNode* loop = doc.namedNode(*doc.string(String("http://example.org/loop")));
+  doc.quad(*loop, *loop, *loop);
+
+  // Repeated variables should be bound to the same term
+  BasicGraphPattern  bgp;
+  ASSERT_TRUE(bgp.add(*x, *p, *x));
+  Solutions  solutions;
+  ASSERT_TRUE(bgp.evaluate(doc, solutions));
+  ASSERT_EQ(1, solutions.length());
+  ASSERT_EQ(loop, solutions.value(0, x));
+
+  // Absent constants yield no solutions
+  String  absent("http://example.org/absent");
+  const NamedNode  absentTerm(absent);
+  bgp.clear();
+  ASSERT_TRUE(bgp.add(*x, absentTerm, *x));
+  ASSERT_TRUE(bgp.evaluate(doc, solutions));
+  ASSERT_EQ(0, solutions.length());
+
+  // Patterns without variables are checked for the existence
+  bgp.clear();
+  ASSERT_TRUE(bgp.add(*loop, *loop, *loop));
+  ASSERT_TRUE(bgp.evaluate(doc, solutions));
+  ASSERT_EQ(1, solutions.length());
+  ASSERT_EQ(0, solutions.width());
+}
+
+TEST(PreparedQuery, Parameters) {
+  Document doc;
+  fill(doc, 8, 4);
+  // The constants and the parameters are terms of another document
+  Document terms;
+  const Variable* dev = terms.variable(*terms.string(String("dev")));
+  const Variable* sensor = terms.variable(*terms.string(String("sensor")));
+  const Variable* value = terms.variable(*terms.string(String("value")));
+  const NamedNode* hasSensor = terms.namedNode(*terms.string(String("http://example.org/hasSensor")));
+  const NamedNode* observation = terms.namedNode(*terms.string(String("http://example.org/observation")));
+  const NamedNode* status = terms.namedNode(*terms.string(String("http://example.org/status")));
+
+  BasicGraphPattern  bgp;
+  ASSERT_TRUE(bgp.add(*dev, *hasSensor, *sensor));
+  ASSERT_TRUE(bgp.add(*sensor, *observation, *value));
+  PreparedQuery  query;
+  const Variable* absentVar = terms.variable(*terms.string(String("absent")));
+  ASSERT_FALSE(query.prepare(doc, bgp, &absentVar, 1));
+  ASSERT_TRUE(query.prepare(doc, bgp, &dev, 1));
+  ASSERT_EQ(1, query.parameters());
+
+  // Each execution matches the evaluation with the bound parameter
+  Solutions  solutions;
+  Solutions  expected;
+  Array<unsigned>  order;
+  ASSERT_TRUE(bgp.plan(order));
+  char iri[64];
+  for(unsigned i = 0; i < 8; ++i) {
+    sprintf(iri, "http://example.org/device/%u", i);
+    const Term* arg = terms.namedNode(*terms.string(String(iri, true)));
+    ASSERT_TRUE(query.execute(&arg, solutions));
+    ASSERT_EQ(4, solutions.length());
+    ASSERT_EQ(bgp.width(), solutions.width());
+    const Term*  bindings[3] = {doc.findTerm(*arg), nullptr, nullptr};
+    ASSERT_TRUE(bgp.evaluate(doc, order, expected, bindings));
+    ASSERT_EQ(expected.length(), solutions.length());
+    for(unsigned r = 0; r < solutions.length(); ++r) {
+      ASSERT_EQ(doc.findTerm(*arg), solutions.value(r, dev));
+      ASSERT_TRUE(solutions.value(r, value));
+    }
+  }
+  const Term* absent = terms.namedNode(*terms.string(String("http://example.org/device/8")));
+  ASSERT_TRUE(query.execute(&absent, solutions));
+  ASSERT_EQ(0, solutions.length());
+
+  // The constants absent on the preparation are resolved once they are stored
+  BasicGraphPattern  statuses;
+  ASSERT_TRUE(statuses.add(*dev, *status, *value));
+  ASSERT_TRUE(query.prepare(doc, statuses));
+  ASSERT_TRUE(query.execute(nullptr, solutions));
+  ASSERT_EQ(0, solutions.length());
+  doc.quad(*doc.namedNode(*doc.string(String("http://example.org/device/0"))),
+    *doc.namedNode(*doc.string(String("http://example.org/status"))),
+    *doc.literal(*doc.string(String("active"))));
+  ASSERT_TRUE(query.execute(nullptr, solutions));
+  ASSERT_EQ(1, solutions.length());
+
+  // The constants released by the reclamation are resolved again once they are stored anew
+  ASSERT_EQ(1, doc.remove(Quad(nullptr, doc.findTerm(*status))));
+  ASSERT_LT(0, doc.reclaim());
+  ASSERT_FALSE(doc.findTerm(*status));
+  ASSERT_TRUE(query.execute(nullptr, solutions));
+  ASSERT_EQ(0, solutions.length());
+  doc.quad(*doc.namedNode(*doc.string(String("http://example.org/device/1"))),
+    *doc.namedNode(*doc.string(String("http://example.org/status"))),
+    *doc.literal(*doc.string(String("idle"))));
+  ASSERT_TRUE(query.execute(nullptr, solutions));
+  ASSERT_EQ(1, solutions.length());
+}
+
+#ifdef SMALLRDF_THREADS
+TEST(PreparedQuery, Parallel) {
+  Document doc;
+  fill(doc, 600, 4);
+  const Variable* dev = doc.variable(*doc.string(String("dev")));
+  const Variable* sensor = doc.variable(*doc.string(String("sensor")));
+  const Variable* value = doc.variable(*doc.string(String("value")));
+  BasicGraphPattern  bgp;
+  ASSERT_TRUE(bgp.add(*dev, *doc.namedNode(*doc.string(String("http://example.org/type"))),
+    *doc.namedNode(*doc.string(String("http://example.org/Device")))));
+  ASSERT_TRUE(bgp.add(*dev, *doc.namedNode(*doc.string(String("http://example.org/hasSensor"))), *sensor));
+  ASSERT_TRUE(bgp.add(*sensor, *doc.namedNode(*doc.string(String("http://example.org/observation"))), *value));
+  PreparedQuery  query;
+  ASSERT_TRUE(query.prepare(doc, bgp, &dev, 1));
+  PreparedQuery  scan;
+  ASSERT_TRUE(scan.prepare(doc, bgp));
+
+  // The large scan is split over the workers yielding the same solutions in any order
+  TaskPool  pool(4);
+  ASSERT_TRUE(pool.valid());
+  Solutions  solutions;
+  Solutions  expected;
+  ASSERT_TRUE(scan.execute(nullptr, expected));
+  ASSERT_TRUE(scan.execute(pool, nullptr, solutions));
+  ASSERT_EQ(2400, expected.length());
+  ASSERT_EQ(expected.length(), solutions.length());
+  Hashset<const Term*>  values;
+  for(unsigned r = 0; r < expected.length(); ++r)
+    ASSERT_TRUE(values.add(expected.value(r, value)));
+  ASSERT_EQ(2400, values.length());
+  Hashset<const Term*>  found;
+  for(unsigned r = 0; r < solutions.length(); ++r) {
+    ASSERT_TRUE(values.find(solutions.value(r, value)));
+    ASSERT_TRUE(found.add(solutions.value(r, value)));
+  }
+  ASSERT_EQ(2400, found.length());
+
+  // The point lookup is joined by the calling thread
+  const Term* arg = doc.namedNode(*doc.string(String("http://example.org/device/42")));
+  ASSERT_TRUE(query.execute(pool, &arg, solutions));
+  ASSERT_EQ(4, solutions.length());
+  for(unsigned r = 0; r < solutions.length(); ++r)
+    ASSERT_EQ(arg, solutions.value(r, dev));
+}
+#endif  // SMALLRDF_THREADS
+
+//! \brief Compiler of the predicate IRIs to the patterns of the subjects and objects,
+//! 	the subject is the parameter
+struct PredicateCompiler: QueryCache::Compiler {
+  bool compile(const String& text, Document& terms, BasicGraphPattern& bgp,
+    Array<const Variable*>& params) override
+  {
+    if(!text.length())
+      return false;
+    String  iri;
+    iri = text;
+    const Variable* subject = terms.variable(*terms.string(String("s")));
+    return bgp.add(*subject, *terms.namedNode(*terms.string(iri)),
+      *terms.variable(*terms.string(String("o")))) && params.add(subject);
+  }
+};
+
+TEST(QueryCache, Eviction) {
+  Document doc;
+  fill(doc, 4, 2);
+
+  PredicateCompiler  compiler;
+  QueryCache  cache(doc, compiler, 2);
+  const String  sensors("http://example.org/hasSensor");
+  const String  observations("http://example.org/observation");
+  const String  types("http://example.org/type");
+  PreparedQuery* query = cache.query(sensors);
+  ASSERT_TRUE(query);
+  ASSERT_EQ(query, cache.query(String("http://example.org/hasSensor")));
+  ASSERT_EQ(1, cache.hits());
+  Document terms;
+  const Term* dev = terms.namedNode(*terms.string(String("http://example.org/device/1")));
+  Solutions  solutions;
+  ASSERT_TRUE(query->execute(&dev, solutions));
+  ASSERT_EQ(2, solutions.length());
+
+  // The least recently used query is evicted
+  ASSERT_TRUE(cache.query(observations));
+  ASSERT_EQ(query, cache.query(sensors));
+  ASSERT_TRUE(cache.query(types));
+  ASSERT_EQ(2, cache.length());
+  ASSERT_EQ(3, cache.misses());
+  ASSERT_EQ(query, cache.query(sensors));
+  ASSERT_TRUE(cache.query(observations));
+  ASSERT_EQ(4, cache.misses());
+  ASSERT_TRUE(cache.query(types)->execute(&dev, solutions));
+  ASSERT_EQ(1, solutions.length());
+
+  // The texts failed to compile are not cached
+  ASSERT_FALSE(cache.query(String("")));
+  ASSERT_EQ(2, cache.length());
+}
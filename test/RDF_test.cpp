@@ -2,9 +2,11 @@
 
  */
 
+#include <stdio.h>
 #include <gtest/gtest.h>
 
 #include "RDF.hpp"
+#include "Statistics.h"
 
 using namespace smallrdf;
 
@@ -172,6 +174,26 @@ TEST(Dataset, find) {
   ASSERT_FALSE(dataset.match(&object).length());
 }
 
+TEST(Dataset, remove) {
+  Dataset dataset;
+  String subjectStr1("http://example.org/subject1");
+  String subjectStr2("http://example.org/subject2");
+  String predicateStr("http://example.org/predicate");
+  NamedNode subject1(subjectStr1);
+  NamedNode subject2(subjectStr2);
+  NamedNode predicate(predicateStr);
+  for(unsigned i = 0; i < 4; ++i)
+    dataset.quads.add(Quad(i % 2 ? subject1 : subject2, predicate, subject1));
+
+  ASSERT_EQ(0, dataset.remove(Quad(&predicate)));
+  ASSERT_EQ(2, dataset.remove(Quad(&subject2)));
+  // The tombstones form the half of the quads, so they are released
+  ASSERT_EQ(0, dataset.removals());
+  ASSERT_EQ(2, dataset.quads.length());
+  ASSERT_EQ(2, dataset.count(Quad()));
+  ASSERT_FALSE(dataset.exists(Quad(&subject2)));
+}
+
 TEST(Document, string) {
   Document doc;
 
@@ -183,3 +205,249 @@ TEST(Document, string) {
   ASSERT_EQ(str1, str2);
   ASSERT_EQ(str1, str3);
 }
+
+TEST(Document, literal) {
+  Document doc;
+
+  const String* value = doc.string(String("test"));
+  const String* lang = doc.string(String("en"));
+  const Literal* lit1 = doc.literal(*value, lang);
+  const Literal* lit2 = doc.literal(*doc.string(String("test")), doc.string(String("en")));
+  const Literal* lit3 = doc.literal(*value);
+
+  ASSERT_EQ(lit1, lit2);
+  ASSERT_NE(lit1, lit3);
+  ASSERT_EQ(lang, lit1->lang);
+  ASSERT_EQ(nullptr, lit3->lang);
+  ASSERT_EQ(nullptr, lit3->dtype);
+}
+
+TEST(Document, match) {
+  Document doc;
+  const NamedNode* subject1 = doc.namedNode(*doc.string(String("http://example.org/subject1")));
+  const NamedNode* subject2 = doc.namedNode(*doc.string(String("http://example.org/subject2")));
+  const NamedNode* predicate = doc.namedNode(*doc.string(String("http://example.org/predicate")));
+  const NamedNode* graph = doc.namedNode(*doc.string(String("http://example.org/graph")));
+  doc.quad(*subject1, *predicate, *subject2);
+  doc.quad(*subject2, *predicate, *subject1, graph);
+  ASSERT_EQ(2, doc.match(nullptr, predicate).length());
+  ASSERT_EQ(1, doc.match(nullptr, nullptr, nullptr, graph).length());
+
+  // The quads added after the lookup are indexed
+  doc.quad(*subject1, *predicate, *subject1);
+  ASSERT_EQ(2, doc.match(subject1).length());
+  ASSERT_EQ(1, doc.match(subject1, nullptr, subject1).length());
+  // Patterns are resolved by the content of their terms
+  String  iri("http://example.org/subject2");
+  const NamedNode  term(iri);
+  ASSERT_EQ(2, doc.match(nullptr, nullptr, subject1).length());
+  ASSERT_EQ(1, doc.match(&term).length());
+  ASSERT_TRUE(doc.find(Quad(&term, predicate, subject1)));
+  ASSERT_FALSE(doc.find(Quad(&term, predicate, subject2)));
+  ASSERT_FALSE(doc.find(Quad(predicate)));
+}
+
+TEST(Document, count) {
+  Document doc;
+  const NamedNode* sensor = doc.namedNode(*doc.string(String("http://example.org/sensor")));
+  const NamedNode* observation = doc.namedNode(*doc.string(String("http://example.org/observation")));
+  const NamedNode* graph = doc.namedNode(*doc.string(String("http://example.org/graph")));
+  char value[16];
+  for(unsigned i = 0; i < 100; ++i) {
+    sprintf(value, "%u", i % 10);
+    doc.quad(*sensor, *observation, *doc.literal(*doc.string(String(value, true))), i % 4 ? nullptr : graph);
+  }
+  ASSERT_EQ(100, doc.count(Quad()));
+  ASSERT_EQ(100, doc.count(Quad(sensor, observation)));
+  ASSERT_EQ(25, doc.count(Quad(nullptr, nullptr, nullptr, graph)));
+  String  zero("0");
+  const Literal  literal(zero);
+  ASSERT_EQ(10, doc.count(Quad(nullptr, nullptr, &literal)));
+  ASSERT_EQ(10, doc.count(Quad(sensor, nullptr, &literal)));
+  ASSERT_EQ(0, doc.count(Quad(observation)));
+  ASSERT_TRUE(doc.exists(Quad(sensor, nullptr, &literal, graph)));
+  ASSERT_FALSE(doc.exists(Quad(observation)));
+
+  // The quads added after the lookup are counted
+  doc.quad(*observation, *observation, *sensor);
+  ASSERT_EQ(1, doc.count(Quad(observation)));
+  ASSERT_TRUE(doc.exists(Quad(observation)));
+  ASSERT_EQ(1, doc.count(Quad(nullptr, observation, sensor)));
+}
+
+TEST(Document, insert) {
+  Document doc;
+  // The batch refers the views of the parsed values, which repeat
+  String  sensor("http://example.org/sensor");
+  String  observation("http://example.org/observation");
+  String  graph("http://example.org/graph");
+  String  en("en");
+  const NamedNode  subj(sensor);
+  const NamedNode  pred(observation);
+  const NamedNode  gr(graph);
+  const NamedNode  obj(sensor);  // Equal to subj, but another term object
+  String  values[4] = {String("0"), String("1"), String("2"), String("0")};
+  const Literal  lits[4] = {Literal(values[0]), Literal(values[1], &en), Literal(values[2]), Literal(values[3])};
+  const Quad  batch[8] = {
+    Quad(subj, pred, lits[0]), Quad(subj, pred, lits[1]), Quad(subj, pred, lits[2]),
+    Quad(subj, pred, lits[3]),  // Duplicate of the first quad
+    Quad(subj, pred, lits[0], &gr), Quad(subj, pred, obj), Quad(subj, pred, lits[1]),
+    Quad(subj, pred, lits[0], &gr)};
+  bool  failed = true;
+  ASSERT_EQ(5, doc.insert(batch, 8, &failed));
+  ASSERT_FALSE(failed);
+  ASSERT_EQ(5, doc.quads.length());
+  // The terms are interned with their copied strings
+  const Term* isensor = doc.findTerm(subj);
+  ASSERT_TRUE(isensor);
+  ASSERT_NE(sensor.data(), isensor->value->data());
+  ASSERT_EQ(isensor, doc.intern(obj));
+  ASSERT_EQ(1, doc.count(Quad(nullptr, nullptr, nullptr, &gr)));
+  ASSERT_EQ(1, doc.count(Quad(nullptr, nullptr, &lits[1])));
+  ASSERT_EQ(0, doc.count(Quad(nullptr, nullptr, &lits[1], &gr)));
+
+  // The quads present in the document are skipped
+  const Quad  more[3] = {Quad(subj, pred, lits[2]), Quad(subj, pred, subj, &gr), Quad(subj, pred, lits[0])};
+  ASSERT_EQ(1, doc.insert(more, 3));
+  ASSERT_EQ(6, doc.quads.length());
+  ASSERT_EQ(2, doc.count(Quad(nullptr, nullptr, nullptr, &gr)));
+  ASSERT_EQ(0, doc.insert(batch, 8));
+  ASSERT_EQ(6, doc.count(Quad()));
+}
+
+TEST(Document, remove) {
+  Document doc;
+  const NamedNode* sensor = doc.namedNode(*doc.string(String("http://example.org/sensor")));
+  const NamedNode* observation = doc.namedNode(*doc.string(String("http://example.org/observation")));
+  const NamedNode* graph = doc.namedNode(*doc.string(String("http://example.org/graph")));
+  char value[16];
+  for(unsigned i = 0; i < 100; ++i) {
+    sprintf(value, "%u", i % 10);
+    doc.quad(*sensor, *observation, *doc.literal(*doc.string(String(value, true))), i % 4 ? nullptr : graph);
+  }
+  String  zero("0");
+  const Literal  literal(zero);
+  ASSERT_EQ(0, doc.remove(Quad(observation)));
+  ASSERT_EQ(10, doc.remove(Quad(nullptr, nullptr, &literal)));
+  // The tombstones are skipped by the lookups, being retained till the compaction
+  ASSERT_EQ(10, doc.removals());
+  ASSERT_EQ(100, doc.quads.length());
+  ASSERT_EQ(90, doc.count(Quad()));
+  ASSERT_EQ(0, doc.count(Quad(sensor, nullptr, &literal)));
+  ASSERT_FALSE(doc.exists(Quad(nullptr, nullptr, &literal)));
+  ASSERT_EQ(90, doc.match(sensor).length());
+  unsigned  tombstones = 0;
+  for(Dataset::Quads::Iter* pit = doc.quads.begin(); pit != doc.quads.end(); pit = pit->next())
+    tombstones += doc.removed(**pit);
+  ASSERT_EQ(10, tombstones);
+  ASSERT_EQ(0, doc.remove(Quad(nullptr, nullptr, &literal)));
+
+  // The stored quads are indexed besides the tombstones
+  const Literal* lit = static_cast<const Literal*>(doc.findTerm(literal));
+  ASSERT_TRUE(doc.quad(*sensor, *observation, *lit));
+  ASSERT_EQ(1, doc.count(Quad(nullptr, nullptr, &literal)));
+  ASSERT_EQ(91, doc.count(Quad()));
+  // 20 quads of the graph remain, so the tombstones exceed the quarter of the quads
+  ASSERT_EQ(20, doc.remove(Quad(nullptr, nullptr, nullptr, graph)));
+  ASSERT_EQ(0, doc.removals());
+  ASSERT_EQ(71, doc.quads.length());
+  ASSERT_EQ(71, doc.count(Quad(sensor)));
+  ASSERT_EQ(0, doc.count(Quad(nullptr, nullptr, nullptr, graph)));
+  ASSERT_EQ(1, doc.count(Quad(nullptr, nullptr, &literal)));
+
+  // The graph is not referred by the quads anymore
+  ASSERT_EQ(1, doc.reclaim());
+  String  iri("http://example.org/graph");
+  const NamedNode  term(iri);
+  ASSERT_FALSE(doc.findTerm(term));
+  ASSERT_EQ(sensor, doc.findTerm(NamedNode(*sensor->value)));
+  ASSERT_EQ(lit, doc.findTerm(literal));
+  ASSERT_EQ(0, doc.reclaim());
+  graph = doc.namedNode(*doc.string(String("http://example.org/graph")));
+  ASSERT_TRUE(doc.quad(*sensor, *observation, *lit, graph));
+  ASSERT_EQ(1, doc.count(Quad(nullptr, nullptr, nullptr, &term)));
+}
+
+//! \brief Observer checking that each notified quad belongs to the complete group
+struct GroupObserver: QuadObserver {
+  Document& doc;
+  const Term* subject;
+  unsigned group;  //!< Number of the quads of the subject once the group is applied
+  unsigned calls;
+  unsigned drops;
+  bool complete;
+
+  GroupObserver(Document& idoc, const Term* isubject, unsigned igroup)
+    : doc(idoc), subject(isubject), group(igroup), calls(0), drops(0), complete(true)  {}
+  GroupObserver(const GroupObserver&)=delete;
+  GroupObserver& operator=(const GroupObserver&)=delete;
+
+  bool operator()(const Quad& q) override
+  {
+    ++calls;
+    complete = complete && q.subject == subject && doc.count(Quad(subject)) == group;
+    return true;
+  }
+
+  void removed(const Quad& q) override
+    { drops += q.subject == subject; }
+};
+
+TEST(Document, commit) {
+  Document doc;
+  const NamedNode* device = doc.namedNode(*doc.string(String("http://example.org/device")));
+  const NamedNode* other = doc.namedNode(*doc.string(String("http://example.org/other")));
+  const NamedNode* reading = doc.namedNode(*doc.string(String("http://example.org/reading")));
+  char value[16];
+  for(unsigned i = 0; i < 8; ++i) {
+    sprintf(value, "%u", i);
+    const Literal* lit = doc.literal(*doc.string(String(value, true)));
+    doc.quad(*device, *reading, *lit);
+    doc.quad(*other, *reading, *lit);
+  }
+  const Statistics* stats = doc.statistics();
+  ASSERT_TRUE(stats);
+
+  // Replace all readings of the device, retaining the one inserted back
+  String  values[3] = {String("8"), String("9"), String("7")};
+  const Literal  lits[3] = {Literal(values[0]), Literal(values[1]), Literal(values[2])};
+  Changeset  changes;
+  ASSERT_TRUE(changes.empty());
+  ASSERT_TRUE(changes.remove(Quad(device, reading)));
+  for(unsigned i = 0; i < 3; ++i)
+    ASSERT_TRUE(changes.insert(Quad(*device, *reading, lits[i])));
+  ASSERT_TRUE(changes.insert(Quad(*device, *reading, lits[0])));
+  GroupObserver  observer(doc, device, 3);
+  doc.observe(&observer);
+  unsigned  inserted = 0;
+  unsigned  removed = 0;
+  ASSERT_TRUE(doc.commit(changes, &inserted, &removed));
+  doc.observe(nullptr);
+  ASSERT_TRUE(changes.empty());
+  ASSERT_EQ(2, inserted);
+  ASSERT_EQ(7, removed);
+  // The observer is notified of the stored quads once the whole group is applied
+  ASSERT_EQ(2, observer.calls);
+  ASSERT_TRUE(observer.complete);
+  ASSERT_EQ(7, observer.drops);
+  ASSERT_EQ(3, doc.count(Quad(device)));
+  ASSERT_EQ(1, doc.count(Quad(device, nullptr, &lits[2])));
+  ASSERT_EQ(8, doc.count(Quad(other)));
+  ASSERT_EQ(11, doc.count(Quad()));
+  // The statistics account both the stored and the removed quads of the group
+  ASSERT_EQ(stats, doc.statistics());
+  ASSERT_EQ(11, stats->length());
+  ASSERT_EQ(3, stats->frequency(*device)->subject);
+  ASSERT_EQ(11, stats->predicate(*reading)->count);
+
+  // The removals of the absent terms and the repeated insertions change nothing
+  String  absent("http://example.org/absent");
+  const NamedNode  node(absent);
+  ASSERT_TRUE(changes.remove(Quad(&node)));
+  ASSERT_TRUE(changes.insert(Quad(*other, *reading, lits[2])));
+  ASSERT_TRUE(doc.commit(changes, &inserted, &removed));
+  ASSERT_EQ(0, inserted);
+  ASSERT_EQ(0, removed);
+  ASSERT_EQ(11, doc.count(Quad()));
+  ASSERT_TRUE(doc.commit(changes));
+}
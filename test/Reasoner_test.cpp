@@ -0,0 +1,186 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "Reasoner.h"
+#include "TestVisitors.h"
+
+using namespace smallrdf;
+
+
+static const NamedNode* iri(Document& doc, const char* name)
+{
+  char buf[96];
+  sprintf(buf, "http://example.org/%s", name);
+  return doc.namedNode(*doc.string(String(buf, true)));
+}
+
+static const NamedNode* rdfs(Document& doc, const char* name)
+{
+  char buf[96];
+  sprintf(buf, "http://www.w3.org/2000/01/rdf-schema#%s", name);
+  return doc.namedNode(*doc.string(String(buf, true)));
+}
+
+static const NamedNode* type(Document& doc)
+{
+  return doc.namedNode(*doc.string(String("http://www.w3.org/1999/02/22-rdf-syntax-ns#type")));
+}
+
+//! \brief Sensor classes and the reading properties
+static void schema(Document& doc)
+{
+  doc.quad(*iri(doc, "Sensor"), *rdfs(doc, "subClassOf"), *iri(doc, "Device"));
+  doc.quad(*iri(doc, "Device"), *rdfs(doc, "subClassOf"), *iri(doc, "Thing"));
+  doc.quad(*iri(doc, "temperature"), *rdfs(doc, "subPropertyOf"), *iri(doc, "reading"));
+  doc.quad(*iri(doc, "reading"), *rdfs(doc, "subPropertyOf"), *iri(doc, "observation"));
+  doc.quad(*iri(doc, "reading"), *rdfs(doc, "domain"), *iri(doc, "Sensor"));
+  doc.quad(*iri(doc, "locatedIn"), *rdfs(doc, "range"), *iri(doc, "Room"));
+}
+
+//! \brief Instances of the schema
+static void data(Document& doc)
+{
+  doc.quad(*iri(doc, "s1"), *iri(doc, "temperature"), *doc.literal(*doc.string(String("21.5"))));
+  doc.quad(*iri(doc, "s1"), *iri(doc, "locatedIn"), *iri(doc, "kitchen"));
+  doc.quad(*iri(doc, "s2"), *type(doc), *iri(doc, "Sensor"));
+}
+
+TEST(Reasoner, Incremental) {
+  Document doc;
+  Reasoner reasoner(doc);
+  ASSERT_EQ(&reasoner, doc.observer());
+  schema(doc);
+  // Transitive subClassOf and subPropertyOf
+  ASSERT_EQ(2, reasoner.length());
+  ASSERT_TRUE(doc.exists(Quad(iri(doc, "Sensor"), rdfs(doc, "subClassOf"), iri(doc, "Thing"))));
+
+  data(doc);
+  ASSERT_TRUE(reasoner.complete());
+  // s1: reading, observation, type Sensor, Device, Thing; kitchen type Room; s2 type Device, Thing
+  ASSERT_EQ(10, reasoner.length());
+  ASSERT_EQ(19, doc.quads.length());
+  const Quad* inferred = doc.find(Quad(iri(doc, "s1"), type(doc), iri(doc, "Thing")));
+  ASSERT_TRUE(inferred);
+  ASSERT_TRUE(reasoner.inferred(*inferred));
+  const Quad* asserted = doc.find(Quad(iri(doc, "s2"), type(doc), iri(doc, "Sensor")));
+  ASSERT_TRUE(asserted);
+  ASSERT_FALSE(reasoner.inferred(*asserted));
+  ASSERT_EQ(1, doc.count(Quad(iri(doc, "kitchen"), type(doc), iri(doc, "Room"))));
+  ASSERT_EQ(0, doc.count(Quad(nullptr, type(doc), iri(doc, "Room"), iri(doc, "graph"))));
+
+  // The schema extension is joined with the stored instances
+  doc.quad(*iri(doc, "Thing"), *rdfs(doc, "subClassOf"), *iri(doc, "Entity"));
+  ASSERT_EQ(2, doc.count(Quad(nullptr, type(doc), iri(doc, "Entity"))));
+  ASSERT_EQ(3, doc.count(Quad(nullptr, rdfs(doc, "subClassOf"), iri(doc, "Entity"))));
+
+  // Entailed triples are not duplicated
+  const unsigned  quads = doc.quads.length();
+  doc.quad(*iri(doc, "s2"), *type(doc), *iri(doc, "Device"));
+  ASSERT_EQ(quads + 1, doc.quads.length());
+}
+
+TEST(Reasoner, Attach) {
+  // Materialization of the stored quads matches the incremental one
+  Document doc;
+  data(doc);
+  schema(doc);
+  {
+    Reasoner reasoner(doc);
+    ASSERT_TRUE(reasoner.complete());
+    ASSERT_EQ(10, reasoner.length());
+    ASSERT_EQ(19, doc.quads.length());
+  }
+  ASSERT_EQ(nullptr, doc.observer());
+  doc.quad(*iri(doc, "s3"), *type(doc), *iri(doc, "Sensor"));
+  ASSERT_EQ(20, doc.quads.length());
+}
+
+TEST(Reasoner, Remove) {
+  Document doc;
+  Reasoner reasoner(doc);
+  schema(doc);
+  data(doc);
+  ASSERT_EQ(10, reasoner.length());
+
+  // The removed quads are released by the reasoner before the compaction
+  ASSERT_EQ(1, doc.remove(Quad(iri(doc, "s1"), type(doc), iri(doc, "Thing"))));
+  ASSERT_EQ(9, reasoner.length());
+  // The entailments of the removed asserted quads are retained
+  ASSERT_EQ(1, doc.remove(Quad(iri(doc, "s2"), type(doc), iri(doc, "Sensor"))));
+  ASSERT_EQ(9, reasoner.length());
+  ASSERT_EQ(2, doc.remove(Quad(iri(doc, "s2"))));
+  ASSERT_EQ(7, reasoner.length());
+  doc.compact();
+  ASSERT_EQ(0, doc.removals());
+  ASSERT_EQ(7, reasoner.length());
+
+  // The reasoner keeps materializing the stored quads
+  doc.quad(*iri(doc, "s3"), *type(doc), *iri(doc, "Device"));
+  ASSERT_TRUE(reasoner.complete());
+  ASSERT_EQ(8, reasoner.length());
+  const Quad* inferred = doc.find(Quad(iri(doc, "s3"), type(doc), iri(doc, "Thing")));
+  ASSERT_TRUE(inferred);
+  ASSERT_TRUE(reasoner.inferred(*inferred));
+}
+
+TEST(Reasoner, Retract) {
+  Document doc;
+  Reasoner reasoner(doc);
+  schema(doc);
+  data(doc);
+  ASSERT_EQ(10, reasoner.length());
+  // Nothing to retract
+  ASSERT_TRUE(reasoner.retract());
+  ASSERT_EQ(10, reasoner.length());
+
+  // The entailments of the removed domain are retracted, the rest are derived again
+  ASSERT_EQ(1, doc.remove(Quad(iri(doc, "reading"), rdfs(doc, "domain"), iri(doc, "Sensor"))));
+  ASSERT_EQ(10, reasoner.length());
+  ASSERT_TRUE(reasoner.retract());
+  ASSERT_TRUE(reasoner.complete());
+  ASSERT_EQ(7, reasoner.length());
+  ASSERT_EQ(0, doc.count(Quad(iri(doc, "s1"), type(doc))));
+  ASSERT_EQ(1, doc.count(Quad(iri(doc, "s1"), iri(doc, "observation"))));
+  const Quad* inferred = doc.find(Quad(iri(doc, "s2"), type(doc), iri(doc, "Thing")));
+  ASSERT_TRUE(inferred);
+  ASSERT_TRUE(reasoner.inferred(*inferred));
+
+  // The reasoner keeps materializing the stored quads
+  doc.quad(*iri(doc, "s1"), *type(doc), *iri(doc, "Sensor"));
+  ASSERT_EQ(9, reasoner.length());
+}
+
+TEST(Reasoner, Asserted) {
+  Document doc;
+  Reasoner reasoner(doc);
+  schema(doc);
+  data(doc);
+
+  QuadCounter  all;
+  ASSERT_TRUE(doc.visit(Quad(nullptr, type(doc)), all));
+  ASSERT_EQ(7, all.quads);
+  // Only s2 type Sensor is asserted
+  QuadCounter  asserted;
+  Reasoner::Asserted  filter(reasoner, asserted);
+  ASSERT_TRUE(doc.visit(Quad(nullptr, type(doc)), filter));
+  ASSERT_EQ(1, asserted.quads);
+}
+
+TEST(Reasoner, Reclaim) {
+  Document doc;
+  Reasoner reasoner(doc);
+  data(doc);
+  // The unused terms are released, while the vocabulary of the reasoner is retained
+  ASSERT_EQ(1, doc.remove(Quad(iri(doc, "s2"))));
+  ASSERT_LT(0, doc.reclaim());
+  ASSERT_EQ(0, reasoner.length());
+
+  // The retained vocabulary is matched by the new quads
+  doc.quad(*iri(doc, "locatedIn"), *rdfs(doc, "range"), *iri(doc, "Room"));
+  ASSERT_TRUE(reasoner.complete());
+  ASSERT_EQ(1, reasoner.length());
+  ASSERT_EQ(1, doc.count(Quad(iri(doc, "kitchen"), type(doc), iri(doc, "Room"))));
+}
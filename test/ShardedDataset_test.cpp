@@ -0,0 +1,144 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "NTriplesSerializer.h"
+#include "ShardedDataset.h"
+#include "Snapshot.h"
+
+using namespace smallrdf;
+
+
+//! \brief Store the readings of the sensors, each one is typed and valued
+template<typename D>
+static void readings(D& doc, unsigned sensors, unsigned num)
+{
+  const NamedNode* type = doc.namedNode(*doc.string(String("http://www.w3.org/1999/02/22-rdf-syntax-ns#type")));
+  const NamedNode* reading = doc.namedNode(*doc.string(String("http://example.org/Reading")));
+  const NamedNode* value = doc.namedNode(*doc.string(String("http://example.org/value")));
+  char buf[64];
+  for(unsigned s = 0; s < sensors; ++s)
+    for(unsigned i = 0; i < num; ++i) {
+      sprintf(buf, "http://example.org/sensor/%u/reading/%u", s, i);
+      const NamedNode* subject = doc.namedNode(*doc.string(String(buf, true)));
+      sprintf(buf, "%u", i % 10);
+      doc.quad(*subject, *type, *reading);
+      doc.quad(*subject, *value, *doc.literal(*doc.string(String(buf, true))));
+    }
+}
+
+TEST(ShardedDataset, Route) {
+  ShardedDataset data(4);
+  ASSERT_TRUE(data.valid());
+  ASSERT_EQ(4, data.shards());
+  readings(data, 4, 100);
+  ASSERT_EQ(800, data.length());
+  unsigned  total = 0;
+  for(unsigned i = 0; i < data.shards(); ++i) {
+    // The subjects are spread over all shards
+    ASSERT_LT(0, data.shardLength(i));
+    total += data.shardLength(i);
+  }
+  ASSERT_EQ(800, total);
+
+  // All quads of the subject reside in its shard
+  const NamedNode* subject = data.namedNode(*data.string(String("http://example.org/sensor/2/reading/7")));
+  const unsigned  shard = data.shard(*subject);
+  ASSERT_LT(shard, data.shards());
+  Dataset::Quads  quads = data.match(subject);
+  ASSERT_EQ(2, quads.length());
+  for(Dataset::Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next())
+    ASSERT_EQ(shard, data.shard(*(**pit).subject));
+  // The pattern terms of another document are resolved
+  const String  iri("http://example.org/sensor/2/reading/7");
+  const NamedNode  foreign(iri);
+  ASSERT_TRUE(data.exists(Quad(&foreign)));
+  ASSERT_FALSE(data.exists(Quad(data.namedNode(*data.string(String("http://example.org/sensor/9"))))));
+}
+
+TEST(ShardedDataset, Match) {
+  // The dataset is large enough to match the shards in parallel
+  Document  doc;
+  ShardedDataset  data(3);
+  readings(doc, 8, 400);
+  readings(data, 8, 400);
+  ASSERT_LE(ShardedDataset::PARALLEL_QUADS_MIN, data.length());
+  ASSERT_EQ(doc.quads.length(), data.length());
+
+  const NamedNode* type = data.namedNode(*data.string(String("http://www.w3.org/1999/02/22-rdf-syntax-ns#type")));
+  const NamedNode* value = data.namedNode(*data.string(String("http://example.org/value")));
+  const Literal* five = data.literal(*data.string(String("5")));
+  const NamedNode* subject = data.namedNode(*data.string(String("http://example.org/sensor/3/reading/15")));
+  const Quad  patterns[] = {
+    Quad(), Quad(nullptr, type), Quad(nullptr, value, five), Quad(nullptr, nullptr, five),
+    Quad(nullptr, type, five), Quad(subject), Quad(subject, value), Quad(subject, type, five)};
+  for(const Quad& pattern: patterns) {
+    const unsigned  num = doc.count(pattern);
+    ASSERT_EQ(num, data.count(pattern));
+    Dataset::Quads  quads = data.match(pattern.subject, pattern.predicate, pattern.object);
+    ASSERT_EQ(num, quads.length());
+    for(Dataset::Quads::Iter* pit = quads.begin(); pit != quads.end(); pit = pit->next())
+      ASSERT_TRUE(doc.exists(**pit));
+    ASSERT_EQ(num != 0, data.exists(pattern));
+  }
+  ASSERT_EQ(320, data.count(Quad(nullptr, value, five)));
+
+  // The quads stored after the matching are indexed lazily
+  const NamedNode* sensor = data.namedNode(*data.string(String("http://example.org/sensor/9")));
+  data.quad(*sensor, *type, *data.namedNode(*data.string(String("http://example.org/Sensor"))));
+  ASSERT_EQ(3201, data.count(Quad(nullptr, type)));
+  ASSERT_EQ(1, data.count(Quad(sensor)));
+}
+
+TEST(ShardedDataset, Remove) {
+  ShardedDataset data(4);
+  readings(data, 4, 100);
+  const NamedNode* type = data.namedNode(*data.string(String("http://www.w3.org/1999/02/22-rdf-syntax-ns#type")));
+  const Literal* five = data.literal(*data.string(String("5")));
+  const NamedNode* subject = data.namedNode(*data.string(String("http://example.org/sensor/2/reading/7")));
+  ASSERT_EQ(40, data.count(Quad(nullptr, nullptr, five)));
+  ASSERT_EQ(40, data.remove(Quad(nullptr, nullptr, five)));
+  ASSERT_EQ(760, data.length());
+  ASSERT_EQ(0, data.count(Quad(nullptr, nullptr, five)));
+  ASSERT_EQ(400, data.count(Quad(nullptr, type)));
+
+  // The subject is removed from its shard
+  const unsigned  shard = data.shard(*subject);
+  const unsigned  len = data.shardLength(shard);
+  ASSERT_EQ(2, data.remove(Quad(subject)));
+  ASSERT_EQ(len - 2, data.shardLength(shard));
+  ASSERT_FALSE(data.exists(Quad(subject)));
+  ASSERT_EQ(399, data.count(Quad(nullptr, type)));
+  ASSERT_EQ(0, data.remove(Quad(subject)));
+}
+
+
+TEST(ShardedDataset, Snapshot) {
+  // The generic builders traverse the quads of the shards
+  ShardedDataset data(4);
+  readings(data, 4, 10);
+  const Literal* five = data.literal(*data.string(String("5")));
+  ASSERT_EQ(4, data.remove(Quad(nullptr, nullptr, five)));
+  String* image = nullptr;
+  ASSERT_TRUE(Snapshot::build(data, image));
+  Snapshot* psnapshot = new Snapshot(image->data(), image->length());
+  ASSERT_TRUE(psnapshot->valid());
+  ASSERT_EQ(data.length(), psnapshot->length());
+  const String  iri("http://example.org/sensor/2/reading/7");
+  const NamedNode  subject(iri);
+  ASSERT_EQ(2, psnapshot->count(Quad(&subject)));
+  ASSERT_EQ(0, psnapshot->count(Quad(nullptr, nullptr, five)));
+
+  // The snapshot is traversed as well
+  String* storage = nullptr;
+  const String&  nt = NTriplesSerializer::serialize(*psnapshot, storage);
+  unsigned  lines = 0;
+  for(unsigned i = 0; i < nt.length(); ++i)
+    lines += nt.data()[i] == '\n';
+  ASSERT_EQ(data.length(), lines);
+  delete storage;
+  delete psnapshot;
+  delete image;
+}
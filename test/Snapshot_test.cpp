@@ -0,0 +1,148 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "Snapshot.h"
+
+using namespace smallrdf;
+
+
+static void fill(Document& doc)
+{
+  const NamedNode* alice = doc.namedNode(*doc.string(String("http://example.org/alice")));
+  const NamedNode* bob = doc.namedNode(*doc.string(String("http://example.org/bob")));
+  const NamedNode* knows = doc.namedNode(*doc.string(String("http://example.org/knows")));
+  const NamedNode* name = doc.namedNode(*doc.string(String("http://example.org/name")));
+  const NamedNode* graph = doc.namedNode(*doc.string(String("http://example.org/graph")));
+  const String* lang = doc.string(String("en"));
+  doc.quad(*alice, *knows, *bob);
+  doc.quad(*bob, *knows, *alice, graph);
+  doc.quad(*alice, *name, *doc.literal(*doc.string(String("Alice")), lang));
+  doc.quad(*bob, *name, *doc.literal(*doc.string(String("Bob")), lang));
+  doc.quad(*doc.blankNode(*doc.string(String("b0"))), *knows, *alice);
+}
+
+static void expectMatch(Dataset& expected, Snapshot& snapshot, const Term* subject,
+  const Term* predicate, const Term* object, const Term* graph = nullptr)
+{
+  Dataset::Quads  exp = expected.match(subject, predicate, object, graph);
+  Dataset::Quads  res = snapshot.match(subject, predicate, object, graph);
+  ASSERT_EQ(exp.length(), res.length());
+  for(const Dataset::Quads::Iter* piq = exp.begin(); piq != exp.end(); piq = piq->next())
+    ASSERT_TRUE(res.find(**piq));
+  ASSERT_EQ(exp.length(), snapshot.count(Quad(subject, predicate, object, graph)));
+  ASSERT_EQ(exp.length() != 0, snapshot.exists(Quad(subject, predicate, object, graph)));
+}
+
+TEST(Snapshot, Match) {
+  Document doc;
+  fill(doc);
+  String* image = nullptr;
+  ASSERT_TRUE(Snapshot::build(doc, image));
+  // Note: the image should outlive the snapshot
+  Snapshot* psnapshot = new Snapshot(image->data(), image->length());
+  Snapshot&  snapshot = *psnapshot;
+  ASSERT_TRUE(snapshot.valid());
+  ASSERT_EQ(doc.quads.length(), snapshot.length());
+
+  // Patterns are resolved by the content of their terms
+  String  alice("http://example.org/alice");
+  String  knows("http://example.org/knows");
+  String  en("en");
+  const NamedNode  subject(alice);
+  const NamedNode  predicate(knows);
+  const Literal  object(*doc.string(String("Bob")), &en);
+  expectMatch(doc, snapshot, nullptr, nullptr, nullptr);
+  expectMatch(doc, snapshot, &subject, nullptr, nullptr);
+  expectMatch(doc, snapshot, nullptr, &predicate, nullptr);
+  expectMatch(doc, snapshot, nullptr, nullptr, &subject);
+  expectMatch(doc, snapshot, nullptr, nullptr, &object);
+  expectMatch(doc, snapshot, &subject, &predicate, nullptr);
+  expectMatch(doc, snapshot, nullptr, &predicate, &subject);
+  expectMatch(doc, snapshot, &subject, nullptr, &object);
+  expectMatch(doc, snapshot, nullptr, &predicate, nullptr, &subject);
+  ASSERT_EQ(0, snapshot.match(&predicate).length());
+
+  const Quad* quad = snapshot.find(Quad(&subject, &predicate));
+  ASSERT_TRUE(quad);
+  ASSERT_STREQ("http://example.org/bob", quad->object->value->c_str());
+  // Materialized objects are cached
+  ASSERT_EQ(quad, snapshot.find(Quad(&subject, &predicate)));
+  ASSERT_FALSE(snapshot.find(Quad(&predicate)));
+
+  delete psnapshot;
+  delete image;
+}
+
+TEST(Snapshot, Invalid) {
+  Document doc;
+  fill(doc);
+  String* image = nullptr;
+  ASSERT_TRUE(Snapshot::build(doc, image));
+  // Truncated image
+  ASSERT_FALSE(Snapshot(image->data(), image->length() / 2).valid());
+  // Corrupted magic
+  image->data()[0] = 'X';
+  Snapshot  snapshot(image->data(), image->length());
+  ASSERT_FALSE(snapshot.valid());
+  ASSERT_EQ(0, snapshot.match().length());
+  delete image;
+}
+
+TEST(Snapshot, Corrupted) {
+  Document doc;
+  fill(doc);
+  String* image = nullptr;
+  ASSERT_TRUE(Snapshot::build(doc, image));
+  uint8_t* data = reinterpret_cast<uint8_t*>(image->data());
+  const Snapshot::Header& hdr = *reinterpret_cast<const Snapshot::Header*>(data);
+  ASSERT_TRUE(Snapshot(data, image->length()).valid());
+
+  // Out of bounds term id of the quad
+  Snapshot::QuadEntry* quads = reinterpret_cast<Snapshot::QuadEntry*>(data + hdr.quadTable);
+  const Snapshot::Id  subject = quads[0].terms[0];
+  quads[0].terms[0] = hdr.terms;
+  ASSERT_FALSE(Snapshot(data, image->length()).valid());
+  quads[0].terms[0] = subject;
+  // Out of bounds string id of the term
+  Snapshot::TermEntry* terms = reinterpret_cast<Snapshot::TermEntry*>(data + hdr.termTable);
+  const Snapshot::Id  value = terms[0].value;
+  terms[0].value = hdr.strings;
+  ASSERT_FALSE(Snapshot(data, image->length()).valid());
+  terms[0].value = value;
+  // Out of order string offsets
+  Snapshot::Id* offsets = reinterpret_cast<Snapshot::Id*>(data + hdr.stringOffsets);
+  const Snapshot::Id  offset = offsets[1];
+  offsets[1] = offsets[2] + 1;
+  ASSERT_FALSE(Snapshot(data, image->length()).valid());
+  offsets[1] = offset;
+  // Out of bounds permutation
+  Snapshot::Id* pos = reinterpret_cast<Snapshot::Id*>(data + hdr.posIndex);
+  pos[0] = hdr.quads;
+  ASSERT_FALSE(Snapshot(data, image->length()).valid());
+  delete image;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(Snapshot, Map) {
+  Document doc;
+  fill(doc);
+  String* image = nullptr;
+  ASSERT_TRUE(Snapshot::build(doc, image));
+  char filename[] = "/tmp/smallrdf_snapshot.srds";
+  FILE* file = fopen(filename, "wb");
+  ASSERT_TRUE(file);
+  ASSERT_EQ(image->length(), fwrite(image->data(), 1, image->length(), file));
+  fclose(file);
+
+  Snapshot* snapshot = Snapshot::map(filename);
+  ASSERT_TRUE(snapshot);
+  ASSERT_EQ(doc.quads.length(), snapshot->match().length());
+  delete snapshot;
+  remove(filename);
+  ASSERT_FALSE(Snapshot::map(filename));
+  delete image;
+}
+#endif  // __unix__ || __APPLE__
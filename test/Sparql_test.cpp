@@ -0,0 +1,163 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "Sparql.h"
+
+using namespace smallrdf;
+
+
+//! \brief Sensors with the readings, a half of them is labeled
+static void fill(Document& doc, unsigned sensors)
+{
+  const NamedNode* type = doc.namedNode(*doc.string(String("http://www.w3.org/1999/02/22-rdf-syntax-ns#type")));
+  const NamedNode* sensor = doc.namedNode(*doc.string(String("http://example.org/Sensor")));
+  const NamedNode* reading = doc.namedNode(*doc.string(String("http://example.org/reading")));
+  const NamedNode* label = doc.namedNode(*doc.string(String("http://example.org/label")));
+  const String* integer = doc.string(String("http://www.w3.org/2001/XMLSchema#integer"));
+  char buf[64];
+  for(unsigned i = 0; i < sensors; ++i) {
+    sprintf(buf, "http://example.org/sensor/%u", i);
+    const NamedNode* node = doc.namedNode(*doc.string(String(buf, true)));
+    doc.quad(*node, *type, *sensor);
+    sprintf(buf, "%u", i * 10);
+    doc.quad(*node, *reading, *doc.literal(*doc.string(String(buf, true)), nullptr, integer));
+    if(i % 2 == 0) {
+      sprintf(buf, "Sensor %u", i % 4);
+      doc.quad(*node, *label, *doc.literal(*doc.string(String(buf, true)), doc.string(String("en"))));
+    }
+  }
+}
+
+TEST(SelectQuery, Filter) {
+  Document doc;
+  fill(doc, 10);
+
+  SelectQuery  query;
+  ASSERT_TRUE(query.parse(String(
+    "PREFIX ex: <http://example.org/>\n"
+    "# Sensors having the large readings\n"
+    "SELECT ?s ?r WHERE {\n"
+    "  ?s a ex:Sensor ; ex:reading ?r .\n"
+    "  FILTER(?r >= 50 && ?r != 70)\n"
+    "}")));
+  ASSERT_EQ(2, query.width());
+  Solutions  solutions;
+  ASSERT_TRUE(query.execute(doc, solutions));
+  ASSERT_EQ(4, solutions.length());
+  for(unsigned i = 0; i < solutions.length(); ++i) {
+    const Term* r = solutions.value(i, query.variable(1));
+    ASSERT_TRUE(r);
+    ASSERT_GE(atoi(r->value->c_str()), 50);
+    ASSERT_NE(70, atoi(r->value->c_str()));
+  }
+
+  // The plan is reused on the updated dataset
+  const NamedNode* node = doc.namedNode(*doc.string(String("http://example.org/sensor/0")));
+  doc.quad(*node, *doc.namedNode(*doc.string(String("http://example.org/reading"))),
+    *doc.literal(*doc.string(String("55.5")), nullptr, doc.string(String("http://www.w3.org/2001/XMLSchema#decimal"))));
+  ASSERT_TRUE(query.execute(doc, solutions));
+  ASSERT_EQ(5, solutions.length());
+
+  // Strings are compared lexically, the language is retained
+  ASSERT_TRUE(query.parse(String(
+    "SELECT * { ?s <http://example.org/label> ?l FILTER (?l < \"Sensor 2\"@en) }")));
+  ASSERT_EQ(2, query.width());
+  ASSERT_TRUE(query.execute(doc, solutions));
+  ASSERT_EQ(3, solutions.length());
+}
+
+TEST(SelectQuery, Optional) {
+  Document doc;
+  fill(doc, 10);
+
+  SelectQuery  query;
+  ASSERT_TRUE(query.parse(String(
+    "PREFIX ex: <http://example.org/>\n"
+    "SELECT ?s ?l { ?s a ex:Sensor OPTIONAL { ?s ex:label ?l FILTER(?l != \"Sensor 0\"@en) } }")));
+  Solutions  solutions;
+  ASSERT_TRUE(query.execute(doc, solutions));
+  ASSERT_EQ(10, solutions.length());
+  unsigned  labeled = 0;
+  for(unsigned i = 0; i < solutions.length(); ++i)
+    labeled += solutions.row(i)[1] != nullptr;
+  ASSERT_EQ(2, labeled);
+
+  ASSERT_TRUE(query.parse(String(
+    "PREFIX ex: <http://example.org/>\n"
+    "SELECT ?s { ?s a ex:Sensor OPTIONAL { ?s ex:label ?l } FILTER(!BOUND(?l)) }")));
+  ASSERT_TRUE(query.execute(doc, solutions));
+  ASSERT_EQ(5, solutions.length());
+}
+
+TEST(SelectQuery, Modifiers) {
+  Document doc;
+  fill(doc, 10);
+
+  SelectQuery  query;
+  ASSERT_TRUE(query.parse(String(
+    "SELECT DISTINCT ?l WHERE { ?s <http://example.org/label> ?l }")));
+  ASSERT_TRUE(query.distinct());
+  Solutions  solutions;
+  ASSERT_TRUE(query.execute(doc, solutions));
+  ASSERT_EQ(2, solutions.length());
+
+  ASSERT_TRUE(query.parse(String(
+    "SELECT ?s WHERE { ?s ?p ?o } LIMIT 4 OFFSET 20")));
+  ASSERT_EQ(4, query.limit());
+  ASSERT_EQ(20, query.offset());
+  ASSERT_TRUE(query.execute(doc, solutions));
+  ASSERT_EQ(4, solutions.length());
+  ASSERT_TRUE(query.parse(String(
+    "SELECT DISTINCT ?l WHERE { ?s <http://example.org/label> ?l } OFFSET 1 LIMIT 5")));
+  ASSERT_TRUE(query.execute(doc, solutions));
+  ASSERT_EQ(1, solutions.length());
+}
+
+TEST(SelectQuery, Malformed) {
+  SelectQuery  query;
+  ASSERT_FALSE(query.parse(String("SELECT ?s WHERE { ?s ?p }")));
+  ASSERT_EQ(24, query.error());
+  ASSERT_FALSE(query.parse(String("SELECT ?s WHERE { ?s ex:p ?o }")));
+  ASSERT_EQ(21, query.error());
+  ASSERT_FALSE(query.parse(String("SELECT ?s { ?s ?p ?o OPTIONAL { ?s ?p ?o OPTIONAL { ?o ?p ?s } } }")));
+  ASSERT_FALSE(query.parse(String("SELECT ?s { ?s ?p ?o } LIMIT")));
+  ASSERT_FALSE(query.parse(String("CONSTRUCT { ?s ?p ?o } WHERE { ?s ?p ?o }")));
+  ASSERT_EQ(0, query.error());
+  ASSERT_TRUE(query.parse(String("select ?s { ?s ?p ?o . }")));
+  ASSERT_EQ(SelectQuery::NONE, query.error());
+}
+
+TEST(SparqlCompiler, Cache) {
+  Document doc;
+  fill(doc, 6);
+
+  const char* const  params[] = {"s"};
+  SparqlCompiler  compiler(params, 1);
+  QueryCache  cache(doc, compiler, 2);
+  const String  labels("PREFIX ex: <http://example.org/> SELECT ?l { ?s ex:label ?l }");
+  PreparedQuery* query = cache.query(labels);
+  ASSERT_TRUE(query);
+  ASSERT_EQ(1, query->parameters());
+  ASSERT_EQ(query, cache.query(String("PREFIX ex: <http://example.org/> SELECT ?l { ?s ex:label ?l }")));
+  ASSERT_EQ(1, cache.hits());
+  // The parameter is bound to the term of another document
+  Document terms;
+  const Term* sensor = terms.namedNode(*terms.string(String("http://example.org/sensor/2")));
+  Solutions  solutions;
+  ASSERT_TRUE(query->execute(&sensor, solutions));
+  ASSERT_EQ(1, solutions.length());
+  sensor = terms.namedNode(*terms.string(String("http://example.org/sensor/3")));
+  ASSERT_TRUE(query->execute(&sensor, solutions));
+  ASSERT_EQ(0, solutions.length());
+
+  // Only the plain patterns having the parameters are compiled
+  ASSERT_FALSE(cache.query(String("SELECT ?s {")));
+  ASSERT_FALSE(cache.query(String("SELECT ?x { ?x ?p ?o }")));
+  ASSERT_FALSE(cache.query(String("SELECT ?s { ?s ?p ?o } LIMIT 1")));
+  ASSERT_FALSE(cache.query(String("SELECT ?s { ?s ?p ?o FILTER(?o > 1) }")));
+  ASSERT_EQ(1, cache.length());
+  ASSERT_EQ(5, cache.misses());
+}
@@ -0,0 +1,119 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "Statistics.h"
+#include "Query.h"
+
+using namespace smallrdf;
+
+
+TEST(HyperLogLog, Estimate) {
+  HyperLogLog  hll;
+  ASSERT_EQ(0, hll.estimate());
+  char buf[16];
+  for(unsigned i = 0; i < 20000; ++i) {
+    const unsigned  len = sprintf(buf, "%u", i % 10000);
+    hll.add(hashData(reinterpret_cast<const uint8_t*>(buf), len));
+  }
+  ASSERT_NEAR(10000, hll.estimate(), 10000 * 0.2);
+
+  HyperLogLog  other;
+  for(unsigned i = 10000; i < 20000; ++i) {
+    const unsigned  len = sprintf(buf, "%u", i);
+    other.add(hashData(reinterpret_cast<const uint8_t*>(buf), len));
+  }
+  hll.merge(other);
+  ASSERT_NEAR(20000, hll.estimate(), 20000 * 0.2);
+}
+
+TEST(Statistics, Document) {
+  Document doc;
+  const NamedNode* type = doc.namedNode(*doc.string(String("http://example.org/type")));
+  const NamedNode* device = doc.namedNode(*doc.string(String("http://example.org/Device")));
+  const NamedNode* label = doc.namedNode(*doc.string(String("http://example.org/label")));
+  char iri[64];
+  for(unsigned i = 0; i < 64; ++i) {
+    sprintf(iri, "http://example.org/device/%u", i);
+    const NamedNode* dev = doc.namedNode(*doc.string(String(iri, true)));
+    doc.quad(*dev, *type, *device);
+  }
+
+  const Statistics* stats = doc.statistics();
+  ASSERT_TRUE(stats);
+  ASSERT_EQ(64, stats->length());
+  // The statistics are updated on the added quads
+  const NamedNode* dev = doc.namedNode(*doc.string(String("http://example.org/device/0")));
+  doc.quad(*dev, *label, *doc.literal(*doc.string(String("Device 0"))));
+  ASSERT_EQ(65, stats->length());
+  ASSERT_EQ(2, stats->predicates());
+  ASSERT_EQ(64, stats->predicate(*type)->count);
+  ASSERT_NEAR(64, stats->predicate(*type)->subjects.estimate(), 64 * 0.1);
+  ASSERT_NEAR(1, stats->predicate(*type)->objects.estimate(), 0.5);
+  ASSERT_EQ(2, stats->frequency(*dev)->subject);
+  ASSERT_EQ(64, stats->frequency(*device)->object);
+  ASSERT_FALSE(stats->predicate(*device));
+
+  // Estimates of the patterns
+  const Term* pattern[4] = {nullptr, type, device, nullptr};
+  ASSERT_NEAR(64, stats->estimate(pattern), 1);
+  pattern[0] = dev;
+  ASSERT_NEAR(1, stats->estimate(pattern), 0.5);
+  pattern[1] = label;
+  pattern[2] = nullptr;
+  ASSERT_NEAR(1, stats->estimate(pattern), 0.5);
+  pattern[0] = device;
+  ASSERT_EQ(0, stats->estimate(pattern));
+  // Bound subject of the type
+  pattern[0] = nullptr;
+  pattern[1] = type;
+  ASSERT_NEAR(1, stats->estimate(pattern, 1), 0.5);
+
+  // The statistics are updated on the removed quads
+  ASSERT_EQ(2, doc.remove(Quad(dev)));
+  ASSERT_EQ(stats, doc.statistics());
+  ASSERT_EQ(63, stats->length());
+  ASSERT_EQ(63, stats->predicate(*type)->count);
+  ASSERT_EQ(0, stats->predicate(*label)->count);
+  ASSERT_EQ(0, stats->frequency(*dev)->subject);
+  ASSERT_EQ(63, stats->frequency(*device)->object);
+  pattern[0] = dev;
+  ASSERT_EQ(0, stats->estimate(pattern));
+  // The predicate without quads yields no matches
+  pattern[0] = doc.namedNode(*doc.string(String("http://example.org/device/1")));
+  pattern[1] = label;
+  ASSERT_EQ(0, stats->estimate(pattern));
+}
+
+TEST(Statistics, Plan) {
+  Document doc;
+  const NamedNode* type = doc.namedNode(*doc.string(String("http://example.org/type")));
+  const NamedNode* device = doc.namedNode(*doc.string(String("http://example.org/Device")));
+  const NamedNode* status = doc.namedNode(*doc.string(String("http://example.org/status")));
+  const Literal* failed = doc.literal(*doc.string(String("failed")));
+  char iri[64];
+  for(unsigned i = 0; i < 64; ++i) {
+    sprintf(iri, "http://example.org/device/%u", i);
+    const NamedNode* dev = doc.namedNode(*doc.string(String(iri, true)));
+    doc.quad(*dev, *type, *device);
+    if(i % 16 == 0)
+      doc.quad(*dev, *status, *failed);
+  }
+
+  const Variable* dev = doc.variable(*doc.string(String("dev")));
+  BasicGraphPattern  bgp;
+  ASSERT_TRUE(bgp.add(*dev, *type, *device));
+  ASSERT_TRUE(bgp.add(*dev, *status, *failed));
+  // Both patterns have the same bound fields, but the failed devices are rare
+  Array<unsigned>  order;
+  ASSERT_TRUE(bgp.plan(order));
+  ASSERT_EQ(0, order[0]);
+  ASSERT_TRUE(bgp.plan(order, doc.statistics()));
+  ASSERT_EQ(1, order[0]);
+
+  Solutions  solutions;
+  ASSERT_TRUE(bgp.evaluate(doc, solutions));
+  ASSERT_EQ(4, solutions.length());
+}
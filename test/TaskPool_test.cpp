@@ -0,0 +1,77 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <gtest/gtest.h>
+
+#include "TaskPool.h"
+
+#ifdef SMALLRDF_THREADS
+#include <atomic>
+
+using namespace smallrdf;
+
+
+//! \brief Task summing the range of the numbers, splitting it recursively
+struct Sum: Task {
+  std::atomic<uint64_t>& total;
+  std::atomic<unsigned>& workers;  //!< Bit mask of the workers executed the tasks
+  uint32_t beg;
+  uint32_t end;
+
+  Sum(std::atomic<uint64_t>& itotal, std::atomic<unsigned>& iworkers, uint32_t ibeg, uint32_t iend)
+    : total(itotal), workers(iworkers), beg(ibeg), end(iend)  {}
+
+  void operator()(TaskPool& pool, unsigned worker) override
+  {
+    workers.fetch_or(1u << worker);
+    while(end - beg > 1000) {
+      const uint32_t  mid = beg + (end - beg) / 2;
+      Sum* const  task = new Sum(total, workers, mid, end);
+      if(!pool.spawn(worker, task)) {
+        delete task;
+        break;
+      }
+      end = mid;
+    }
+    uint64_t  sum = 0;
+    for(uint32_t i = beg; i < end; ++i)
+      sum += i;
+    total.fetch_add(sum);
+  }
+};
+
+TEST(TaskPool, Run) {
+  TaskPool  pool(4);
+  ASSERT_TRUE(pool.valid());
+  ASSERT_EQ(4, pool.workers());
+  const uint32_t  num = 1000000;
+  for(unsigned i = 0; i < 3; ++i) {
+    std::atomic<uint64_t>  total(0);
+    std::atomic<unsigned>  workers(0);
+    Sum  root(total, workers, 0, num);
+    pool.run(root);
+    ASSERT_EQ(uint64_t(num) * (num - 1) / 2, total.load());
+    ASSERT_TRUE(workers.load() & 1);
+  }
+
+  // The small task is executed by the calling thread only
+  std::atomic<uint64_t>  total(0);
+  std::atomic<unsigned>  workers(0);
+  Sum  root(total, workers, 0, 1000);
+  pool.run(root);
+  ASSERT_EQ(1, workers.load());
+  ASSERT_EQ(999 * 1000 / 2, total.load());
+}
+
+TEST(TaskPool, Single) {
+  TaskPool  pool(1);
+  ASSERT_EQ(1, pool.workers());
+  std::atomic<uint64_t>  total(0);
+  std::atomic<unsigned>  workers(0);
+  Sum  root(total, workers, 0, 10000);
+  pool.run(root);
+  ASSERT_EQ(1, workers.load());
+  ASSERT_EQ(9999 * 10000 / 2, total.load());
+}
+
+#endif  // SMALLRDF_THREADS
@@ -0,0 +1,24 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#ifndef TESTVISITORS_H_
+#define TESTVISITORS_H_
+
+#include "RDF.hpp"
+
+
+namespace smallrdf {
+
+//! \brief Counter of the visited quads shared by the tests
+struct QuadCounter: QuadVisitor {
+  unsigned quads;
+
+  QuadCounter(): quads(0)  {}
+
+  bool operator()(const Quad&) override
+    { ++quads; return true; }
+};
+
+}  // smallrdf
+
+#endif  // TESTVISITORS_H_
@@ -0,0 +1,101 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <gtest/gtest.h>
+
+#include "TestVisitors.h"
+#include "TextIndex.h"
+
+using namespace smallrdf;
+
+
+namespace {
+
+const char* const  CITIES[] = {"Paris", "Parma", "Pisa", "Lisbon", "Marseille", "Bern", "Berlin",
+  "Bergamo", "Aarhus", "Montparnasse"};
+
+}  // namespace
+
+//! \brief Labels of the places, the cities are labeled in English and French
+static void fill(Document& doc)
+{
+  const NamedNode* label = doc.namedNode(*doc.string(String("http://www.w3.org/2000/01/rdf-schema#label")));
+  const String* en = doc.string(String("en"));
+  const String* fr = doc.string(String("fr"));
+  char buf[64];
+  for(unsigned i = 0; i < sizeof CITIES / sizeof *CITIES; ++i) {
+    sprintf(buf, "http://example.org/city/%u", i);
+    const NamedNode* city = doc.namedNode(*doc.string(String(buf, true)));
+    const String* name = doc.string(String(CITIES[i]));
+    doc.quad(*city, *label, *doc.literal(*name, en));
+    doc.quad(*city, *label, *doc.literal(*name, fr));
+  }
+}
+
+//! \brief Number of the cities containing the text
+static unsigned cities(const char* text)
+{
+  unsigned num = 0;
+  for(unsigned i = 0; i < sizeof CITIES / sizeof *CITIES; ++i)
+    num += strstr(CITIES[i], text) != nullptr;
+  return num;
+}
+
+TEST(TextIndex, Search) {
+  Document doc;
+  fill(doc);
+  TextIndex* index = doc.textIndex();
+  ASSERT_TRUE(index);
+  ASSERT_EQ(20, index->length());
+
+  Array<const Literal*> literals;
+  for(const char* text: {"ar", "Par", "arse", "erg", "Ber", "n", "", "Rome", "isbonx"}) {
+    ASSERT_TRUE(index->search(String(text), literals));
+    ASSERT_EQ(2 * cities(text), literals.length()) << text;
+    for(const Literal* literal: literals)
+      ASSERT_TRUE(strstr(literal->value->c_str(), text)) << text;
+  }
+
+  // The literals interned later are indexed
+  const Literal* rome = doc.literal(*doc.string(String("Rome")));
+  ASSERT_EQ(21, index->length());
+  ASSERT_TRUE(index->search(String("ome"), literals));
+  ASSERT_EQ(1, literals.length());
+  ASSERT_EQ(rome, literals[0]);
+}
+
+TEST(TextIndex, Complete) {
+  Document doc;
+  fill(doc);
+  TextIndex* index = doc.textIndex();
+  ASSERT_TRUE(index);
+
+  Array<const Literal*> literals;
+  ASSERT_TRUE(index->complete(String("Ber"), literals));
+  ASSERT_EQ(6, literals.length());
+  // Ordered by the values
+  ASSERT_EQ(String("Bergamo"), *literals[0]->value);
+  ASSERT_EQ(String("Berlin"), *literals[2]->value);
+  ASSERT_EQ(String("Bern"), *literals[4]->value);
+  ASSERT_TRUE(index->complete(String("Pa"), literals, 3));
+  ASSERT_EQ(3, literals.length());
+  ASSERT_TRUE(index->complete(String("Berne"), literals));
+  ASSERT_EQ(0, literals.length());
+  ASSERT_TRUE(index->complete(String(""), literals));
+  ASSERT_EQ(20, literals.length());
+
+  // Quads of the matching literals
+  QuadCounter counter;
+  ASSERT_TRUE(doc.visitText(Quad(), String("ar"), counter));
+  ASSERT_EQ(2 * cities("ar"), counter.quads);
+  counter.quads = 0;
+  ASSERT_TRUE(doc.visitText(Quad(doc.namedNode(*doc.string(String("http://example.org/city/1")))),
+    String("Pa"), counter, true));
+  ASSERT_EQ(2, counter.quads);
+  counter.quads = 0;
+  ASSERT_TRUE(doc.visitText(Quad(nullptr, doc.namedNode(*doc.string(String("http://example.org/name")))),
+    String("ar"), counter));
+  ASSERT_EQ(0, counter.quads);
+}
@@ -0,0 +1,162 @@
+/* (c) 2020 Artem Lutov
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "Query.h"
+#include "Sparql.h"
+#include "TestVisitors.h"
+
+using namespace smallrdf;
+
+
+namespace {
+
+const char  XSD_INTEGER[] = "http://www.w3.org/2001/XMLSchema#integer";
+const char  XSD_DATETIME[] = "http://www.w3.org/2001/XMLSchema#dateTime";
+
+}  // namespace
+
+//! \brief Hourly temperature readings of the sensors in January 2020
+static void fill(Document& doc, unsigned sensors, unsigned hours)
+{
+  const NamedNode* temperature = doc.namedNode(*doc.string(String("http://example.org/temperature")));
+  const NamedNode* time = doc.namedNode(*doc.string(String("http://example.org/time")));
+  const NamedNode* sensor = doc.namedNode(*doc.string(String("http://example.org/sensor")));
+  const String* integer = doc.string(String(XSD_INTEGER));
+  const String* dateTime = doc.string(String(XSD_DATETIME));
+  char buf[64];
+  for(unsigned i = 0; i < sensors; ++i) {
+    sprintf(buf, "http://example.org/sensor/%u", i);
+    const NamedNode* sen = doc.namedNode(*doc.string(String(buf, true)));
+    for(unsigned h = 0; h < hours; ++h) {
+      sprintf(buf, "http://example.org/reading/%u/%u", i, h);
+      const NamedNode* reading = doc.namedNode(*doc.string(String(buf, true)));
+      doc.quad(*reading, *sensor, *sen);
+      sprintf(buf, "%u", (i * 7 + h) % 40);
+      doc.quad(*reading, *temperature, *doc.literal(*doc.string(String(buf, true)), nullptr, integer));
+      sprintf(buf, "2020-01-%02uT%02u:00:00Z", 1 + h / 24, h % 24);
+      doc.quad(*reading, *time, *doc.literal(*doc.string(String(buf, true)), nullptr, dateTime));
+    }
+  }
+}
+
+TEST(ValueRange, Value) {
+  Document doc;
+  const String* integer = doc.string(String(XSD_INTEGER));
+  const String* dateTime = doc.string(String(XSD_DATETIME));
+  double val;
+  ASSERT_EQ(VK_NUMBER, ValueRange::value(*doc.literal(*doc.string(String("-12")), nullptr, integer), val));
+  ASSERT_EQ(-12, val);
+  ASSERT_EQ(VK_NONE, ValueRange::value(*doc.literal(*doc.string(String("12a")), nullptr, integer), val));
+  ASSERT_EQ(VK_NONE, ValueRange::value(*doc.literal(*doc.string(String("12"))), val));
+  ASSERT_EQ(VK_DATETIME, ValueRange::value(
+    *doc.literal(*doc.string(String("1970-01-02T00:00:01.5Z")), nullptr, dateTime), val));
+  ASSERT_EQ(86401.5, val);
+  // Timezones are normalized
+  double utc;
+  ASSERT_EQ(VK_DATETIME, ValueRange::value(
+    *doc.literal(*doc.string(String("2020-03-01T10:30:00+02:00")), nullptr, dateTime), val));
+  ASSERT_EQ(VK_DATETIME, ValueRange::value(
+    *doc.literal(*doc.string(String("2020-03-01T08:30:00")), nullptr, dateTime), utc));
+  ASSERT_EQ(utc, val);
+  ASSERT_EQ(1583051400, utc);
+  ASSERT_EQ(VK_NONE, ValueRange::value(
+    *doc.literal(*doc.string(String("2020-13-01T08:30:00")), nullptr, dateTime), val));
+
+  ValueRange range = ValueRange::all(VK_NUMBER);
+  range.lo = 10;
+  range.loOpen = true;
+  ASSERT_FALSE(range.contains(VK_NUMBER, 10));
+  ASSERT_TRUE(range.contains(VK_NUMBER, HUGE_VAL));
+  ASSERT_FALSE(range.contains(VK_DATETIME, 11));
+  ValueRange upper = ValueRange::all(VK_NUMBER);
+  upper.hi = 10;
+  ASSERT_FALSE(range.intersect(upper));
+}
+
+TEST(ValueIndex, Range) {
+  Document doc;
+  fill(doc, 5, 48);
+  const NamedNode* temperature = doc.namedNode(*doc.string(String("http://example.org/temperature")));
+
+  // Index scan matches the filtered scan
+  ValueRange range = ValueRange::all(VK_NUMBER);
+  range.lo = 30;
+  range.loOpen = true;
+  QuadCounter  indexed;
+  ASSERT_TRUE(doc.visit(Quad(nullptr, temperature), range, indexed));
+  QuadCounter  scanned;
+  ASSERT_TRUE(static_cast<Dataset&>(doc).Dataset::visit(Quad(nullptr, temperature), range, scanned));
+  unsigned  expected = 0;
+  for(unsigned i = 0; i < 5; ++i)
+    for(unsigned h = 0; h < 48; ++h)
+      expected += (i * 7 + h) % 40 > 30;
+  ASSERT_EQ(expected, indexed.quads);
+  ASSERT_EQ(scanned.quads, indexed.quads);
+
+  // The index follows the added quads
+  const NamedNode* reading = doc.namedNode(*doc.string(String("http://example.org/reading/x")));
+  doc.quad(*reading, *temperature, *doc.literal(*doc.string(String("35.5")), nullptr,
+    doc.string(String("http://www.w3.org/2001/XMLSchema#decimal"))));
+  indexed.quads = 0;
+  ASSERT_TRUE(doc.visit(Quad(nullptr, temperature), range, indexed));
+  ASSERT_EQ(scanned.quads + 1, indexed.quads);
+  // dateTimes are not numbers
+  indexed.quads = 0;
+  ASSERT_TRUE(doc.visit(Quad(nullptr, temperature), ValueRange::all(VK_DATETIME), indexed));
+  ASSERT_EQ(0, indexed.quads);
+}
+
+TEST(ValueIndex, Pushdown) {
+  Document doc;
+  fill(doc, 5, 48);
+
+  // Readings above the threshold in the time window
+  SelectQuery  query;
+  ASSERT_TRUE(query.parse(String(
+    "PREFIX ex: <http://example.org/>\n"
+    "PREFIX xsd: <http://www.w3.org/2001/XMLSchema#>\n"
+    "SELECT ?r ?v ?t {\n"
+    "  ?r ex:temperature ?v ; ex:time ?t .\n"
+    "  FILTER(?v > 30 && ?t >= \"2020-01-02T00:00:00Z\"^^xsd:dateTime\n"
+    "    && \"2020-01-02T06:00:00+01:00\"^^xsd:dateTime > ?t)\n"
+    "}")));
+  Solutions  solutions;
+  ASSERT_TRUE(query.execute(doc, solutions));
+  // Hours 24..28 of the sensors, whose readings (i * 7 + h) % 40 exceed 30
+  unsigned  expected = 0;
+  for(unsigned i = 0; i < 5; ++i)
+    for(unsigned h = 24; h < 29; ++h)
+      expected += (i * 7 + h) % 40 > 30;
+  ASSERT_EQ(expected, solutions.length());
+
+  // Constrained pattern evaluation matches the filter
+  const Variable* r = doc.variable(*doc.string(String("r")));
+  const Variable* v = doc.variable(*doc.string(String("v")));
+  BasicGraphPattern  bgp;
+  ASSERT_TRUE(bgp.add(*r, *doc.namedNode(*doc.string(String("http://example.org/temperature"))), *v));
+  ValueRange range = ValueRange::all(VK_NUMBER);
+  range.lo = 10;
+  range.hi = 12;
+  ASSERT_FALSE(bgp.constrain(doc.variable(*doc.string(String("t"))), range));
+  ASSERT_TRUE(bgp.constrain(v, range));
+  ASSERT_TRUE(bgp.evaluate(doc, solutions));
+  expected = 0;
+  for(unsigned i = 0; i < 5; ++i)
+    for(unsigned h = 0; h < 48; ++h)
+      expected += (i * 7 + h) % 40 >= 10 && (i * 7 + h) % 40 <= 12;
+  ASSERT_EQ(expected, solutions.length());
+  for(unsigned i = 0; i < solutions.length(); ++i)
+    ASSERT_TRUE(range.contains(*solutions.value(i, v)));
+  // The constraints are intersected
+  range.lo = 11;
+  range.loOpen = true;
+  range.hi = 20;
+  ASSERT_TRUE(bgp.constrain(v, range));
+  ASSERT_TRUE(bgp.evaluate(doc, solutions));
+  for(unsigned i = 0; i < solutions.length(); ++i)
+    ASSERT_EQ(String("12"), *solutions.value(i, v)->value);
+}